@@ -1,8 +1,15 @@
 ﻿// lighing.ps.hlsl
 
-// todo
-#define SHADOW_USE_HARD 0
-#define SHADOW_MAP_CASCADE_COUNT 4
+// cbuffer capacity, the live count is a specialization constant
+#define SHADOW_MAP_MAX_CASCADES 4
+
+// permutation, must match lightingPass::permutation
+#define SHADOW_FILTER_HARD 0
+#define SHADOW_FILTER_PCF3X3 1
+[[vk::constant_id(0)]] const uint shadow_cascade_count = 4;
+[[vk::constant_id(1)]] const uint shadow_filter = SHADOW_FILTER_PCF3X3;
+[[vk::constant_id(2)]] const bool enable_shadows = true;
+[[vk::constant_id(3)]] const bool enable_ibl = true;
 
 struct psIn
 {
@@ -32,7 +39,7 @@ cbuffer camera : register(b0, space0)
 
 cbuffer light : register(b1, space0)
 {
-    float4x4 light_viewproj[SHADOW_MAP_CASCADE_COUNT];
+    float4x4 light_viewproj[SHADOW_MAP_MAX_CASCADES];
 };
 
 cbuffer ibl_param : register(b2, space0)
@@ -52,7 +59,11 @@ SamplerState linear_sampler : register(s7, space0);
 Texture2DArray<float> shadows : register(t8, space0);
 SamplerState shadow_sampler : register(s9, space0);
 
-TextureCube<float4> ibl_irradiance : register(t10, space0);
+// L2 sh, already convolved with the cosine lobe
+cbuffer ibl_sh : register(b10, space0)
+{
+    float4 sh_irradiance[9];
+};
 TextureCube<float4> ibl_specular : register(t11, space0);
 Texture2D<float4> ibl_brdf_lut : register(t12, space0);
 
@@ -84,8 +95,10 @@ uint select_cascade(float view_z_n)
     float dist = abs(view_z_n);
     uint idx = 0;
     [unroll]
-    for (uint i = 0; i < SHADOW_MAP_CASCADE_COUNT; ++i)
+    for (uint i = 0; i < SHADOW_MAP_MAX_CASCADES; ++i)
     {
+        if (i >= shadow_cascade_count)
+            break;
         if (dist < cascade_splits[i])
             return i;
     }
@@ -137,9 +150,9 @@ float sample_shadow_PCF3x3(uint ci, float3 world_pos)
 
 float sample_shadow_withblend(float3 worldpos, float view_z_n, uint ci)
 {
-#if SHADOW_USE_HARD
-    return sample_shadow_point(ci, worldpos);
-#else
+    if (shadow_filter == SHADOW_FILTER_HARD)
+        return sample_shadow_point(ci, worldpos);
+
     float s0 = sample_shadow_PCF3x3(ci, worldpos);
 
     if (cascade_blend <= 0.0) 
@@ -147,10 +160,10 @@ float sample_shadow_withblend(float3 worldpos, float view_z_n, uint ci)
 
     uint  cj = ci;
     float split_l = (ci == 0) ? -1e9 : cascade_splits[ci - 1];
-    float split_r = (ci < SHADOW_MAP_CASCADE_COUNT - 1) ? cascade_splits[ci] : 1e9;
+    float split_r = (ci < shadow_cascade_count - 1) ? cascade_splits[ci] : 1e9;
 
     float w = 1.0;
-    if (view_z_n > split_r - cascade_blend && ci < SHADOW_MAP_CASCADE_COUNT - 1)
+    if (view_z_n > split_r - cascade_blend && ci < shadow_cascade_count - 1)
     {
         cj = ci + 1; w = saturate((split_r - view_z_n) / cascade_blend);
     }
@@ -165,10 +178,24 @@ float sample_shadow_withblend(float3 worldpos, float view_z_n, uint ci)
 
     float s1 = sample_shadow_PCF3x3(cj, worldpos);
     return lerp(s1, s0, w);
-#endif
 }
 
 static const float PI = 3.14159265;
+
+float3 eval_sh_irradiance(float3 n)
+{
+    float3 e = sh_irradiance[0].rgb * 0.282095
+        + sh_irradiance[1].rgb * (0.488603 * n.y)
+        + sh_irradiance[2].rgb * (0.488603 * n.z)
+        + sh_irradiance[3].rgb * (0.488603 * n.x)
+        + sh_irradiance[4].rgb * (1.092548 * n.x * n.y)
+        + sh_irradiance[5].rgb * (1.092548 * n.y * n.z)
+        + sh_irradiance[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+        + sh_irradiance[7].rgb * (1.092548 * n.x * n.z)
+        + sh_irradiance[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(e, 0.0.xxx);
+}
+
 float D_GGX(float noh, float a)
 {
     float a2 = a * a;
@@ -223,8 +250,12 @@ psOut main(psIn i)
     // select cascade
     float view_z = get_view_z(i.uv, depth01);
     float view_z_n = saturate((-view_z - near_far.x) / (near_far.y - near_far.x));
-    uint ci = select_cascade(view_z_n);
-    float shadow = sample_shadow_withblend(pos_w, view_z_n, ci);
+    float shadow = 1.0;
+    if (enable_shadows)
+    {
+        uint ci = select_cascade(view_z_n);
+        shadow = sample_shadow_withblend(pos_w, view_z_n, ci);
+    }
 
     // lighing vectors
     float3 vpos_w = (float3)inv_view[3].xyz;
@@ -250,23 +281,27 @@ psOut main(psIn i)
     float3 diffuse_direct = kd_direct * base_color / PI;
     float3 direct = (diffuse_direct + specular_direct) * nol * shadow;
 
-    // IBL
-    // diffuse IBL : irradiance * kd * base_color
-    float3 kd_ibl = (1.0f - F_schlick_roughness(f0, nov, roughness)) * (1.0f - metalic);
-    float3 irradiance = ibl_irradiance.Sample(linear_sampler, n).rgb;
-    float3 diffuse_ibl = irradiance * kd_ibl * base_color * ibl_intensity_diffuse;
-    
-    // specular IBL & BRDF LUT
-    float3 r = normalize(reflect(-v, n));
-    float mip = roughness * max(specular_mip_count - 1.0f, 0.0f);
-    float3 prefiltered = ibl_specular.SampleLevel(linear_sampler, r, mip).rgb;
-    
-    float2 brdf = ibl_brdf_lut.Sample(linear_sampler, float2(nov, roughness)).rg;
-    float3 f_ibl = F_schlick_roughness(f0, nov, roughness);
-    float3 specular_ibl = prefiltered * (f_ibl * brdf.x + brdf.y) * ibl_intensity_specular;
-    
+    float3 color = direct;
+    if (enable_ibl)
+    {
+        // IBL
+        // diffuse IBL : irradiance * kd * base_color
+        float3 kd_ibl = (1.0f - F_schlick_roughness(f0, nov, roughness)) * (1.0f - metalic);
+        float3 irradiance = eval_sh_irradiance(n);
+        float3 diffuse_ibl = irradiance * kd_ibl * base_color * ibl_intensity_diffuse;
+
+        // specular IBL & BRDF LUT
+        float3 r = normalize(reflect(-v, n));
+        float mip = roughness * max(specular_mip_count - 1.0f, 0.0f);
+        float3 prefiltered = ibl_specular.SampleLevel(linear_sampler, r, mip).rgb;
+
+        float2 brdf = ibl_brdf_lut.Sample(linear_sampler, float2(nov, roughness)).rg;
+        float3 f_ibl = F_schlick_roughness(f0, nov, roughness);
+        float3 specular_ibl = prefiltered * (f_ibl * brdf.x + brdf.y) * ibl_intensity_specular;
+        color += diffuse_ibl + specular_ibl;
+    }
+
     // finalize
-    float3 color = direct + diffuse_ibl + specular_ibl;
     o.scene_color = float4(max(color, 0.f), 1.f);
     return o;
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+﻿// sh_project.cs.hlsl
+
+#include "constant.hlsli"
+
+#define THREAD_COUNT 64
+#define SH_COEFF_COUNT 9
+
+TextureCube<float4> sky_cube : register(t0, space0);
+SamplerState sky_sampler : register(s1, space0);
+
+// L2 irradiance sh, rgb = coeff (cosine lobe convolved), a = unused
+RWStructuredBuffer<float4> sh_irradiance : register(u2, space0);
+
+struct ProjectPC
+{
+    uint face_size;     // sampled face resolution
+    uint mip_level;     // sky cube mip with face_size texels
+};
+[[vk::push_constant]] ProjectPC pc;
+
+groupshared float3 gs_sh[THREAD_COUNT][SH_COEFF_COUNT];
+groupshared float gs_weight[THREAD_COUNT];
+
+void sh_basis(float3 d, out float b[SH_COEFF_COUNT])
+{
+    b[0] = 0.282095;
+    b[1] = 0.488603 * d.y;
+    b[2] = 0.488603 * d.z;
+    b[3] = 0.488603 * d.x;
+    b[4] = 1.092548 * d.x * d.y;
+    b[5] = 1.092548 * d.y * d.z;
+    b[6] = 0.315392 * (3.0 * d.z * d.z - 1.0);
+    b[7] = 1.092548 * d.x * d.z;
+    b[8] = 0.546274 * (d.x * d.x - d.y * d.y);
+}
+
+// solid angle of the cube face region [-1,1]^2 projected on the sphere
+float area_element(float x, float y)
+{
+    return atan2(x * y, sqrt(x * x + y * y + 1.0));
+}
+
+float texel_solid_angle(float2 uv, float half_texel)
+{
+    float x0 = uv.x - half_texel;
+    float x1 = uv.x + half_texel;
+    float y0 = uv.y - half_texel;
+    float y1 = uv.y + half_texel;
+    return area_element(x0, y0) - area_element(x0, y1) - area_element(x1, y0) + area_element(x1, y1);
+}
+
+[numthreads(THREAD_COUNT, 1, 1)]
+void main(uint3 tid : SV_GroupThreadID)
+{
+    // Dispatch: (1, 1, 1)
+    float3 acc[SH_COEFF_COUNT];
+    [unroll]
+    for (uint k = 0; k < SH_COEFF_COUNT; ++k)
+        acc[k] = 0.0.xxx;
+    float weight = 0.0;
+
+    uint face_texels = pc.face_size * pc.face_size;
+    float half_texel = 1.0 / (float)pc.face_size;
+
+    [loop]
+    for (uint i = tid.x; i < face_texels * 6; i += THREAD_COUNT)
+    {
+        uint face = i / face_texels;
+        uint local = i % face_texels;
+        float2 uv = (float2(local % pc.face_size + 0.5, local / pc.face_size + 0.5) / pc.face_size) * 2.0 - 1.0;
+        float3 d = face_dir(face, uv);
+        float w = texel_solid_angle(uv, half_texel);
+        float3 c = sky_cube.SampleLevel(sky_sampler, d, pc.mip_level).rgb;
+
+        float b[SH_COEFF_COUNT];
+        sh_basis(d, b);
+        [unroll]
+        for (uint k = 0; k < SH_COEFF_COUNT; ++k)
+            acc[k] += c * (b[k] * w);
+        weight += w;
+    }
+
+    [unroll]
+    for (uint k = 0; k < SH_COEFF_COUNT; ++k)
+        gs_sh[tid.x][k] = acc[k];
+    gs_weight[tid.x] = weight;
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint s = THREAD_COUNT / 2; s > 0; s >>= 1)
+    {
+        if (tid.x < s)
+        {
+            [unroll]
+            for (uint k = 0; k < SH_COEFF_COUNT; ++k)
+                gs_sh[tid.x][k] += gs_sh[tid.x + s][k];
+            gs_weight[tid.x] += gs_weight[tid.x + s];
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (tid.x == 0)
+    {
+        // total solid angle must be 4π, removes the discretization error
+        float norm = 4.0 * PI / max(gs_weight[0], 1e-6);
+        // clamped cosine convolution per band : A0 = π, A1 = 2π/3, A2 = π/4
+        const float a[SH_COEFF_COUNT] = { PI, 2.0 * PI / 3.0, 2.0 * PI / 3.0, 2.0 * PI / 3.0, PI / 4.0, PI / 4.0, PI / 4.0, PI / 4.0, PI / 4.0 };
+        [unroll]
+        for (uint k = 0; k < SH_COEFF_COUNT; ++k)
+            sh_irradiance[k] = float4(gs_sh[0][k] * norm * a[k], 0.0);
+    }
+}
@@ -41,6 +41,13 @@ void main(uint3 tid : SV_DispatchThreadID,
     float3 n = face_dir(face, uv);
     float3 v = n;
 
+    // mirror lobe, nothing to integrate
+    if (pc.roughness <= 0.0)
+    {
+        specular_cube[idx][uint3(x, y, face)] = float4(sky_cube.SampleLevel(sky_sampler, n, 0).rgb, 1.0);
+        return;
+    }
+
     uint sky_w, sky_h, sky_levels;
     sky_cube.GetDimensions(0, sky_w, sky_h, sky_levels);
 
@@ -73,7 +80,8 @@ void main(uint3 tid : SV_DispatchThreadID,
 
         float omega_p = 1.0 / ((float)pc.num_samples * pdf);
 
-        float mip = 0.5 * log2(max(omega_p / max(omega_s, 1e-12), 1e-12));
+        // filtered importance sampling : +1 bias trades a little blur for far less noise at low sample counts
+        float mip = 0.5 * log2(max(omega_p / max(omega_s, 1e-12), 1e-12)) + 1.0;
         mip = clamp(mip, 0.0, mip_max);
 
         float3 c = sky_cube.SampleLevel(sky_sampler, l, mip).rgb;
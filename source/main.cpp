@@ -2,12 +2,42 @@
 #include "mesh/glTFMesh.h"
 #include "rhi/rhiCmdCenter.h"
 #include "scene/sponzaScene.h"
+#include "scene/stressScene.h"
+#include "scene/camera.h"
+#include "scene/cameraPath.h"
 #include "renderer/renderer.h"
+#include "util/cpuProfiler.h"
+#include "util/benchmark.h"
+#include "util/text.h"
+
+// --headless [--width=N] [--height=N] [--images=N] [--frames=N]
+struct headlessOptions
+{
+    bool enabled = false;
+    rhiHeadlessDesc desc;
+    u32 frames = 300;
+
+    static headlessOptions from_args(const std::vector<std::string_view>& args)
+    {
+        headlessOptions options;
+        for (const std::string_view arg : args)
+        {
+            if (arg == "--headless")
+                options.enabled = true;
+            read_arg(arg, "--width=", options.desc.width);
+            read_arg(arg, "--height=", options.desc.height);
+            read_arg(arg, "--images=", options.desc.image_count);
+            read_arg(arg, "--frames=", options.frames);
+        }
+        return options;
+    }
+};
 
 class engine
 {
 public:
-    engine(const rhi_type t) : type(t) {}
+    engine(const rhi_type t, const renderPathConfig& path_config, const rhiFramePacing& pacing, const std::optional<stressSceneDesc>& stress)
+        : type(t), path_config(path_config), pacing(pacing), stress(stress) {}
     ~engine() = default;
 
     void init(std::string_view application_name, GLFWwindow* window)
@@ -15,30 +45,134 @@ public:
         constexpr u32 width = 1920;
         constexpr u32 height = 1080;
 
-        cmd_center = rhiCmdCenter::create_cmd_center(rhi_type::vulkan);
+        cmd_center = rhiCmdCenter::create_cmd_center(type);
+        cmd_center->set_frame_pacing(pacing);
         cmd_center->initialize(application_name, window, width, height);
-        
-        s = std::make_unique<sponzaScene>();
-        s->start_scene(window);
+        init_scene(window);
+    }
 
-        auto device_context_ptr = cmd_center->get_device_context().lock();
-        auto frame_context_ptr = cmd_center->get_frame_context().lock();
-        r = std::make_unique<renderer>();
-        r->initialize(s.get(), device_context_ptr.get(), frame_context_ptr.get());
+    void init_headless(std::string_view application_name, const rhiHeadlessDesc& desc)
+    {
+        cmd_center = rhiCmdCenter::create_cmd_center(type);
+        cmd_center->set_frame_pacing(pacing);
+        cmd_center->initialize_headless(application_name, desc);
+        init_scene(nullptr);
     }
 
     void update(GLFWwindow* window, float delta)
     {
-        s->update(window, delta);
+        // the scene reads input below, the frame rendered next reacts to it
+        if (auto frame_context = cmd_center->get_frame_context().lock())
+            frame_context->mark_input();
+        {
+            CPU_ZONE("scene::update");
+            s->update(window, delta);
+        }
+        if (!window)
+            return;
+
+        // a minimized window reports 0x0, nothing is drawn until it comes back
+        i32 fb_width = 0, fb_height = 0;
+        glfwGetFramebufferSize(window, &fb_width, &fb_height);
+        minimized = fb_width == 0 || fb_height == 0;
+        if (!minimized)
+            r->request_resize(static_cast<u32>(fb_width), static_cast<u32>(fb_height));
+
+        // F1 geometry path, F2 shadows, F3 gpu trace, F4 cpu trace, F5 camera path recording, F6 screenshot, F7 dynamic sky
+        if (key_pressed(window, GLFW_KEY_F1))
+            path_config.geometry = path_config.geometry == geometryPath::meshlet ? geometryPath::indexed : geometryPath::meshlet;
+        if (key_pressed(window, GLFW_KEY_F2))
+            path_config.shadows = !path_config.shadows;
+        if (key_pressed(window, GLFW_KEY_F3))
+            r->dump_gpu_trace();
+        if (key_pressed(window, GLFW_KEY_F4))
+            profiler::dump_chrome_trace("cache/cpu_trace.json");
+        if (key_pressed(window, GLFW_KEY_F5))
+            toggle_recording();
+        if (key_pressed(window, GLFW_KEY_F6))
+            r->request_screenshot();
+        if (key_pressed(window, GLFW_KEY_F7))
+            path_config.sky_mips_per_frame = path_config.sky_mips_per_frame > 0 ? 0 : 1;
+        if (recording.has_value())
+        {
+            record_time += delta;
+            recording->record(record_time, s->get_camera());
+        }
+        r->set_render_path(path_config);
     }
 
     void render()
     {
+        if (minimized)
+            return;
         r->pre_render(s.get());
         r->render(s.get());
         r->post_render();
     }
 
+    bool is_minimized() const { return minimized; }
+
+    // plays the camera path over the measured frames with a fixed step, the warm-up holds its first key
+    benchmarkExit run_benchmark(const benchmarkOptions& options, const rhiHeadlessDesc& desc)
+    {
+        const std::optional<cameraPath> path = options.camera_path.empty() ? cameraPath::fly_through() : cameraPath::load(options.camera_path);
+        if (!path.has_value())
+            return benchmarkExit::failed;
+
+        constexpr f32 delta_time = 1.f / 60.f;
+        benchmarkRecorder recorder(options);
+        camera* cam = s->get_camera();
+        gpuProfiler* gpu = r->get_gpu_profiler();
+        const auto frame_context = cmd_center->get_frame_context().lock();
+
+        const u32 total = options.warmup + options.frames;
+        for (u32 frame = 0; frame < total; ++frame)
+        {
+            if (frame == options.warmup)
+            {
+                // resolves lag by the frames in flight, the window stays the same length
+                if (gpu)
+                    gpu->reset_stats(options.frames);
+                recorder.begin_measure(counters());
+            }
+
+            const u32 measured = frame >= options.warmup ? frame - options.warmup : 0;
+            path->apply(cam, options.frames > 1 ? static_cast<f32>(measured) / static_cast<f32>(options.frames - 1) : 0.f);
+
+            const u64 begin_ns = profiler::now_ns();
+            {
+                CPU_ZONE("frame");
+                update(nullptr, delta_time);
+                render();
+            }
+            if (frame >= options.warmup)
+                recorder.add_frame(static_cast<f64>(profiler::now_ns() - begin_ns) * 1e-6);
+            for (const rhiFrameLatency& latency : frame_context->take_latency())
+            {
+                if (frame >= options.warmup)
+                    recorder.add_latency(latency);
+            }
+        }
+
+        std::vector<std::pair<std::string, gpuZoneStats>> gpu_stats;
+        if (gpu)
+            gpu_stats = gpu->get_all_stats();
+        recorder.end_measure(counters(), std::move(gpu_stats));
+
+        return recorder.write_report({
+            { "scene", stress ? std::format("stress {}", stress->to_string()) : "sponza" },
+            { "rhi", type == rhi_type::null ? "null" : "vulkan" },
+            { "geometry", std::string(to_string(path_config.geometry)) },
+            { "shadows", path_config.shadows ? "on" : "off" },
+            { "dynamic_sky_mips", std::to_string(path_config.sky_mips_per_frame) },
+            { "width", std::to_string(desc.width) },
+            { "height", std::to_string(desc.height) },
+            { "images", std::to_string(desc.image_count) },
+            { "frames_in_flight", std::to_string(pacing.frames_in_flight) },
+            { "camera_path", options.camera_path.empty() ? "fly_through" : options.camera_path.string() }
+            });
+    }
+
     void exit()
     {
         r.reset();
@@ -46,13 +180,71 @@ public:
         cmd_center.reset();
     }
 
+private:
+    void init_scene(GLFWwindow* window)
+    {
+        if (stress)
+            s = std::make_unique<stressScene>(*stress);
+        else
+            s = std::make_unique<sponzaScene>();
+        s->start_scene(window);
+
+        auto device_context_ptr = cmd_center->get_device_context().lock();
+        auto frame_context_ptr = cmd_center->get_frame_context().lock();
+        r = std::make_unique<renderer>();
+        r->initialize(s.get(), device_context_ptr.get(), frame_context_ptr.get());
+        r->set_render_path(path_config);
+    }
+
+    benchmarkCounters counters() const
+    {
+        const auto device_context_ptr = cmd_center->get_device_context().lock();
+        return benchmarkCounters{
+            .memory = device_context_ptr ? device_context_ptr->get_memory_stats() : rhiMemoryStats{},
+            .uploaded_bytes = r->get_uploaded_bytes(),
+            .upload_count = r->get_upload_count()
+        };
+    }
+
+    void toggle_recording()
+    {
+        if (recording.has_value())
+        {
+            recording->save("cache/camera_path.txt");
+            recording.reset();
+            return;
+        }
+        recording.emplace();
+        record_time = 0.f;
+        std::cout << "[engine] recording camera path\n";
+    }
+
+    bool key_pressed(GLFWwindow* window, const i32 key)
+    {
+        const bool down = glfwGetKey(window, key) == GLFW_PRESS;
+        const bool pressed = down && !keys_down.contains(key);
+        if (down)
+            keys_down.insert(key);
+        else
+            keys_down.erase(key);
+        return pressed;
+    }
+
 private:
     rhi_type type;
+    renderPathConfig path_config;
+    rhiFramePacing pacing;
+    std::optional<stressSceneDesc> stress;
+    std::set<i32> keys_down;
+    std::optional<cameraPath> recording;
+    f32 record_time = 0.f;
+    bool minimized = false;
     std::unique_ptr<rhiCmdCenter> cmd_center;
     std::unique_ptr<scene> s;
     std::unique_ptr<renderer> r;
 };
 
+#if defined(_WIN32)
 static void append_text_winapi(const wchar_t* path, const char* data, DWORD len) 
 {
     HANDLE h = CreateFileW(path, FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -165,14 +357,67 @@ LONG WINAPI crash_dump(EXCEPTION_POINTERS* ex)
 
     return EXCEPTION_EXECUTE_HANDLER;
 }
+#endif
 
-int main() 
+int main(int argc, char** argv) 
 {
+#if defined(_WIN32)
     SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES | SYMOPT_FAIL_CRITICAL_ERRORS);
     SymInitialize(GetCurrentProcess(), nullptr, TRUE);
     SetUnhandledExceptionFilter(crash_dump);
+#endif
+
+    const std::vector<std::string_view> args(argv + 1, argv + argc);
+    CPU_THREAD_NAME("main");
+    // --rhi=null runs the whole frame loop without a gpu
+    const rhi_type backend = std::ranges::find(args, std::string_view("--rhi=null")) != args.end() ? rhi_type::null : rhi_type::vulkan;
+    // --stress replaces sponza with a generated grid, see stressSceneDesc
+    // --frames-in-flight=N --present=fifo|mailbox|immediate
+    const std::optional<stressSceneDesc> stress = stressSceneDesc::from_args(args);
+    // --sky-hdr=file overrides, cpu-only and stress runs don't need the sky asset to be installed
+    renderPathConfig path_config = renderPathConfig::from_args(args);
+    if (path_config.sky_hdr.empty() && (backend == rhi_type::null || stress))
+        path_config.sky_hdr = rhiTexture::procedural_sky;
+    engine* e = new engine(backend, path_config, rhiFramePacing::from_args(args), stress);
+
+    // fixed step, no window or swapchain, exits after the requested frames
+    const headlessOptions headless = headlessOptions::from_args(args);
+
+    // always headless, the exit code is the ci gate
+    const benchmarkOptions benchmark = benchmarkOptions::from_args(args);
+    if (benchmark.enabled)
+    {
+        benchmarkExit result = benchmarkExit::failed;
+        try
+        {
+            e->init_headless("App", headless.desc);
+            result = e->run_benchmark(benchmark, headless.desc);
+        }
+        catch (const std::exception& ex)
+        {
+            // a half initialized engine is not torn down, the process exits with the stable code instead of aborting
+            std::cout << std::format("[benchmark] failed : {}\n", ex.what());
+            return static_cast<i32>(benchmarkExit::failed);
+        }
+        e->exit();
+        delete e;
+        return static_cast<i32>(result);
+    }
 
-    engine* e = new engine(rhi_type::vulkan);
+    if (headless.enabled)
+    {
+        e->init_headless("App", headless.desc);
+        constexpr f32 delta_time = 1.f / 60.f;
+        for (u32 frame = 0; frame < headless.frames; ++frame)
+        {
+            CPU_ZONE("frame");
+            e->update(nullptr, delta_time);
+            e->render();
+        }
+        e->exit();
+        delete e;
+        return 0;
+    }
 
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -193,9 +438,14 @@ int main()
         const f32 delta_time = current_frame - last_frame;
         last_frame = current_frame;
 
+        CPU_ZONE("frame");
         e->update(window, delta_time);
         e->render();
-        glfwPollEvents();
+        // no frames while minimized, sleep until the window changes
+        if (e->is_minimized())
+            glfwWaitEvents();
+        else
+            glfwPollEvents();
     }
 
     e->exit();
@@ -83,6 +83,8 @@ struct glTFSubmesh
 		h = hash_combine(h, is_double_sided);
 		h = hash_combine(h, is_alpha_blend);
 		h = hash_combine(h, alpha_cutoff);
+		h = hash_combine(h, metalic_factor);
+		h = hash_combine(h, roughness_factor);
 		return h;
 	}
 };
@@ -95,11 +97,18 @@ struct glTFMaterial
 class glTFMesh
 {
 public:
+	static constexpr u32 meshlet_max_vertices = 64;
+	static constexpr u32 meshlet_max_triangles = 128; // note: in v0.25 or prior, max_triangles needs to be divisible by 4
+
 	glTFMesh() = default;
 	glTFMesh(const std::string_view path);
 
+	// walks every vertex once, actors sharing the asset reuse the result
 	u64 hash() const
 	{
+		if (cached_hash != 0)
+			return cached_hash;
+
 		u64 h = 1469598103934665603ull;
 
 		for (auto& v : vertices)
@@ -111,10 +120,19 @@ public:
 		for (auto& sm : submeshes)
 			h = sm.hash(h);
 
+		cached_hash = h;
 		return h;
 	}
+	// after editing vertices, indices or submeshes
+	void invalidate_hash() { cached_hash = 0; }
+
+	// sm must index into this mesh's vertices
+	void build_meshlets(glTFSubmesh& sm) const;
 
 	std::vector<glTFVertex> vertices;
 	std::vector<u32> indices;
 	std::vector<glTFSubmesh> submeshes;
+
+private:
+	mutable u64 cached_hash = 0;
 };
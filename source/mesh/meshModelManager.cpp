@@ -21,6 +21,13 @@ std::weak_ptr<glTFMesh> meshModelManager::get_or_create_asset(std::string_view a
 	return create_asset(asset_path);
 }
 
+std::weak_ptr<glTFMesh> meshModelManager::add_asset(std::string_view key, std::shared_ptr<glTFMesh> asset)
+{
+	const u64 hash = string_to_u64hash(key);
+	asset_cache[hash] = std::move(asset);
+	return asset_cache[hash];
+}
+
 std::weak_ptr<glTFMesh> meshModelManager::create_asset(std::string_view asset_path)
 {
 	std::shared_ptr<glTFMesh> asset = std::make_shared<glTFMesh>(asset_path);
@@ -23,6 +23,8 @@ class meshModelManager
 public:
     std::weak_ptr<glTFMesh> get_asset(std::string_view asset_path);
     std::weak_ptr<glTFMesh> get_or_create_asset(std::string_view asset_path);
+    // generated or derived meshes, later lookups by key resolve to it
+    std::weak_ptr<glTFMesh> add_asset(std::string_view key, std::shared_ptr<glTFMesh> asset);
 
 private:
     std::weak_ptr<glTFMesh> create_asset(std::string_view asset_path);
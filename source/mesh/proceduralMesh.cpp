@@ -0,0 +1,111 @@
+#include "proceduralMesh.h"
+#include "mesh/glTFMesh.h"
+
+namespace
+{
+    glTFSampler default_sampler()
+    {
+        return glTFSampler{
+            .mag_filter = gltfFilter::linear,
+            .min_filter = gltfFilter::linear,
+            .mipmap = gltfMipmap::linear,
+            .wrap_u = gltfWrap::repeat,
+            .wrap_v = gltfWrap::repeat
+        };
+    }
+
+    void finish(glTFMesh& mesh)
+    {
+        glTFSubmesh sm;
+        sm.firstIndex = 0;
+        sm.indexCount = static_cast<u32>(mesh.indices.size());
+        sm.base_sampler = default_sampler();
+        sm.norm_sampler = default_sampler();
+        sm.m_r_sampler = default_sampler();
+        sm.metalic_factor = 0.f;
+        sm.roughness_factor = 1.f;
+        sm.alpha_cutoff = 0.f;
+        sm.model = mat4(1.f);
+        mesh.build_meshlets(sm);
+        mesh.submeshes.push_back(std::move(sm));
+    }
+}
+
+namespace procedural
+{
+    std::shared_ptr<glTFMesh> make_box()
+    {
+        auto mesh = std::make_shared<glTFMesh>();
+        mesh->vertices.reserve(24);
+        mesh->indices.reserve(36);
+
+        const std::array<std::pair<vec3, vec3>, 6> faces = { {
+            { vec3(1, 0, 0), vec3(0, 0, -1) },
+            { vec3(-1, 0, 0), vec3(0, 0, 1) },
+            { vec3(0, 1, 0), vec3(1, 0, 0) },
+            { vec3(0, -1, 0), vec3(1, 0, 0) },
+            { vec3(0, 0, 1), vec3(1, 0, 0) },
+            { vec3(0, 0, -1), vec3(-1, 0, 0) },
+        } };
+        const std::array<vec2, 4> corners = { vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1) };
+
+        for (const auto& [n, t] : faces)
+        {
+            // cross(t, b) == n keeps every face ccw seen from outside
+            const vec3 b = glm::cross(n, t);
+            const u32 base = static_cast<u32>(mesh->vertices.size());
+            for (const vec2 c : corners)
+            {
+                mesh->vertices.push_back(glTFVertex{
+                    .position = n * 0.5f + t * (c.x - 0.5f) + b * (c.y - 0.5f),
+                    .normal = n,
+                    .uv = vec2(c.x, 1.f - c.y),
+                    .tangent = vec4(t, 1.f)
+                    });
+            }
+            mesh->indices.insert(mesh->indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+
+        finish(*mesh);
+        return mesh;
+    }
+
+    std::shared_ptr<glTFMesh> make_sphere(const u32 segments)
+    {
+        const u32 slices = std::max(segments, 3u);
+        const u32 rings = std::max(slices / 2, 2u);
+
+        auto mesh = std::make_shared<glTFMesh>();
+        mesh->vertices.reserve(static_cast<size_t>(rings + 1) * (slices + 1));
+        mesh->indices.reserve(static_cast<size_t>(rings) * slices * 6);
+
+        for (u32 i = 0; i <= rings; ++i)
+        {
+            const f32 theta = glm::pi<f32>() * static_cast<f32>(i) / static_cast<f32>(rings);
+            for (u32 j = 0; j <= slices; ++j)
+            {
+                const f32 phi = glm::two_pi<f32>() * static_cast<f32>(j) / static_cast<f32>(slices);
+                const vec3 n = vec3(glm::sin(theta) * glm::cos(phi), glm::cos(theta), glm::sin(theta) * glm::sin(phi));
+                mesh->vertices.push_back(glTFVertex{
+                    .position = n * 0.5f,
+                    .normal = n,
+                    .uv = vec2(static_cast<f32>(j) / static_cast<f32>(slices), static_cast<f32>(i) / static_cast<f32>(rings)),
+                    .tangent = vec4(-glm::sin(phi), 0.f, glm::cos(phi), 1.f)
+                    });
+            }
+        }
+
+        for (u32 i = 0; i < rings; ++i)
+        {
+            for (u32 j = 0; j < slices; ++j)
+            {
+                const u32 a = i * (slices + 1) + j;
+                const u32 b = a + slices + 1;
+                mesh->indices.insert(mesh->indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+            }
+        }
+
+        finish(*mesh);
+        return mesh;
+    }
+}
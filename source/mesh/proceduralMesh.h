@@ -0,0 +1,13 @@
+#pragma once
+
+#include "pch.h"
+
+class glTFMesh;
+
+// built-in unit-sized geometry with one untextured submesh, meshlets already built
+namespace procedural
+{
+	std::shared_ptr<glTFMesh> make_box();
+	// segments around the equator, half as many rings
+	std::shared_ptr<glTFMesh> make_sphere(const u32 segments);
+}
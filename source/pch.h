@@ -22,8 +22,13 @@
 
 #include <gtx/string_cast.hpp>
 #include <gtc/type_ptr.hpp>
+// the bundled glfw on windows, the system package (find_package(glfw3)) elsewhere
+#if defined(_WIN32)
 #include <glfw3.h>
 #include <glfw3native.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
 #include "enumHelper.h"
 #include "util/hash.h"
 #include <vk_mem_alloc.h>
@@ -36,16 +41,21 @@
 #define ENABLE_AFTERMATH 0
 #endif
 
-#ifdef ENABLE_AFTERMATH
+#if ENABLE_AFTERMATH
 #include "GFSDK_Aftermath_GpuCrashDump.h"
 #include "GFSDK_Aftermath_GpuCrashDumpDecoding.h"
 #endif
 
+#if defined(_WIN32)
 #include <windows.h>
 #include <DbgHelp.h>
 #pragma comment(lib, "DbgHelp.lib")
+#endif
 
 #define DISABLE_OIT 1
+// scoped cpu zones (util/cpuProfiler.h), 0 compiles them out
+#define CPU_PROFILER 1
+// default geometry path, switchable at runtime through renderPathConfig
 #define MESHLET 1
 
 using namespace glm;
@@ -53,7 +63,9 @@ using namespace glm;
 enum class rhi_type
 {
     vulkan,
-    dx12
+    dx12,
+    // cpu-only, counts commands instead of executing them
+    null
 };
 
 namespace
@@ -4,6 +4,7 @@
 #include "rhi/rhiDeviceContext.h"
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiFrameContext.h"
+#include "rhi/rhiSwapChain.h"
 
 void compositePass::initialize(const drawInitContext& context)
 {
@@ -28,26 +29,10 @@ void compositePass::draw(rhiCommandList* cmd)
     cmd->draw_fullscreen();
 }
 
-void compositePass::begin_barrier(rhiCommandList* cmd)
-{
-    if (is_first_frames[image_index.value()])
-    {
-        cmd->image_barrier(swapchain_views[image_index.value()].texture, rhiImageLayout::undefined, rhiImageLayout::color_attachment, 0, 1, 0, 1, true);
-        is_first_frames[image_index.value()] = false;
-    }
-    else
-        cmd->image_barrier(swapchain_views[image_index.value()].texture, rhiImageLayout::present, rhiImageLayout::color_attachment, 0, 1, 0, 1, true);
-}
-
-void compositePass::end_barrier(rhiCommandList* cmd)
-{
-    cmd->image_barrier(swapchain_views[image_index.value()].texture, rhiImageLayout::color_attachment, rhiImageLayout::present);
-}
-
 void compositePass::set_swapchain_views(const std::vector<rhiRenderTargetView>& views)
 {
 	swapchain_views = views;
-    is_first_frames.resize(views.size(), true);
+	swapchain_image = 0;
 }
 
 void compositePass::build_layouts(renderShared* rs)
@@ -80,11 +65,7 @@ void compositePass::build_layouts(renderShared* rs)
 
 void compositePass::build_pipeline(renderShared* rs)
 {
-    auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\fullscreen.vs.spv");
-    auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\composite.ps.spv");
     const rhiGraphicsPipelineDesc pipeline_desc{
-        .vs = vs,
-        .fs = fs,
         .color_formats = { rhiFormat::RGBA8_SRGB },
         .depth_format = std::nullopt,
         .samples = rhiSampleCount::x1,
@@ -92,10 +73,7 @@ void compositePass::build_pipeline(renderShared* rs)
         .depth_write = false
     };
 
-    pipeline = rs->context->create_graphics_pipeline(pipeline_desc, pipeline_layout);
-
-    shaderio::free_shader_binary(vs);
-    shaderio::free_shader_binary(fs);
+    rs->pipeline_compiler->request(pipeline, pipeline_desc, { .vs = "fullscreen.vs.spv", .fs = "composite.ps.spv" }, pipeline_layout);
 }
 
 void compositePass::update(renderShared* rs, rhiTexture* scene_color)
@@ -107,7 +85,7 @@ void compositePass::update(renderShared* rs, rhiTexture* scene_color)
 
 void compositePass::update_descriptors(renderShared* rs, rhiTexture* scene_color)
 {
-    rhiBuffer* constant_buf = composite_buffers[image_index.value()].get();
+    rhiBuffer* constant_buf = composite_buffers[frame_index.value()].get();
     const rhiDescriptorBufferInfo b{
         .buffer = constant_buf,
         .offset = 0,
@@ -115,7 +93,7 @@ void compositePass::update_descriptors(renderShared* rs, rhiTexture* scene_color
     };
 
     const rhiWriteDescriptor cb_write_desc{
-        .set = descriptor_sets[image_index.value()][0] ,
+        .set = descriptor_sets[frame_index.value()][0] ,
         .binding = 0,
         .array_index = 0,
         .count = 1,
@@ -124,7 +102,7 @@ void compositePass::update_descriptors(renderShared* rs, rhiTexture* scene_color
     };
 
     const rhiWriteDescriptor sc_write_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 1,
         .array_index = 0,
         .count = 1,
@@ -143,7 +121,7 @@ void compositePass::update_descriptors(renderShared* rs, rhiTexture* scene_color
         .sampler = rs->samplers.linear_clamp.get()
     };
     const rhiWriteDescriptor sampler_write_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 2,
         .array_index = 0,
         .count = 1,
@@ -156,11 +134,11 @@ void compositePass::update_descriptors(renderShared* rs, rhiTexture* scene_color
 
 void compositePass::update_renderinfo(renderShared* rs)
 {
-    render_info.color_formats = { swapchain_views[image_index.value()].texture->desc.format};
+    render_info.color_formats = { swapchain_views[swapchain_image].texture->desc.format};
     render_info.color_attachments =
     {
         rhiRenderingAttachment{
-            .view = swapchain_views[image_index.value()],
+            .view = swapchain_views[swapchain_image],
             .load_op = rhiLoadOp::clear,
             .store_op = rhiStoreOp::store,
             .clear = { {1,0,0,1}, 1.0f, 0 }
@@ -181,7 +159,7 @@ void compositePass::update_cbuffer(renderShared * rs)
         .exposure = 1.f,
         .pad = 0.f
     };
-    rs->buffer_barrier(composite_buffers[image_index.value()].get(), rhiBufferBarrierDescription{
+    rs->buffer_barrier(composite_buffers[frame_index.value()].get(), rhiBufferBarrierDescription{
         .src_stage = rhiPipelineStage::fragment_shader,
         .dst_stage = rhiPipelineStage::transfer,
         .src_access = rhiAccessFlags::uniform_read,
@@ -190,8 +168,8 @@ void compositePass::update_cbuffer(renderShared * rs)
         .src_queue = rs->context->get_queue_family_index(rhiQueueType::graphics),
         .dst_queue = rs->context->get_queue_family_index(rhiQueueType::transfer)
         });
-    rs->upload_to_device(composite_buffers[image_index.value()].get(), &ccb, sizeof(compositeCB));
-    rs->buffer_barrier(composite_buffers[image_index.value()].get(), rhiBufferBarrierDescription{
+    rs->upload_to_device(composite_buffers[frame_index.value()].get(), &ccb, sizeof(compositeCB));
+    rs->buffer_barrier(composite_buffers[frame_index.value()].get(), rhiBufferBarrierDescription{
         .src_stage = rhiPipelineStage::transfer,
         .dst_stage = rhiPipelineStage::fragment_shader,
         .src_access = rhiAccessFlags::transfer_write,
@@ -207,7 +185,7 @@ void compositePass::create_composite_cbuffer(renderShared* rs)
     if (composite_buffers.size() > 0)
         return;
 
-    composite_buffers.resize(swapchain_views.size());
+    composite_buffers.resize(rs->get_frame_size());
     std::ranges::for_each(composite_buffers, [&](std::unique_ptr<rhiBuffer>& buf)
         {
             rs->create_or_resize_buffer(buf, sizeof(compositeCB), rhiBufferUsage::uniform | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
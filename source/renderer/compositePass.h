@@ -30,17 +30,18 @@ public:
     void resize(renderShared* rs, u32 w, u32 h, u32 layers = 1) override;
     void shutdown() override;
     void update(renderShared* rs, rhiTexture* scene_color);
+    // the acquired image, per-frame data follows the frame slot instead
+    void set_swapchain_image(const u32 image_index) { swapchain_image = image_index; }
+    // the swapchain was recreated, the old views are gone
+    void set_swapchain_views(const std::vector<rhiRenderTargetView>& views);
 
 protected:
     void draw(rhiCommandList* cmd) override;
-    void begin_barrier(rhiCommandList* cmd) override;
-    void end_barrier(rhiCommandList* cmd) override;
     void build_layouts(renderShared* rs) override;
     void build_pipeline(renderShared* rs) override;
     void build_attachments(rhiDeviceContext* context) override;
 
 private:
-    void set_swapchain_views(const std::vector<rhiRenderTargetView>& views);
     void create_composite_cbuffer(renderShared* rs);
     void update_descriptors(renderShared* rs, rhiTexture* scene_color);
     void update_renderinfo(renderShared* rs);
@@ -48,9 +49,9 @@ private:
 
 private:
     std::vector<rhiRenderTargetView> swapchain_views;
+    u32 swapchain_image = 0;
     std::vector<std::unique_ptr<rhiBuffer>> composite_buffers;
 
     // full screen or compisite ( [0]=composite set )
     rhiDescriptorSetLayout set_composite;
-    std::vector<bool> is_first_frames;
 };
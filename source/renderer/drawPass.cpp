@@ -4,6 +4,7 @@
 #include "rhi/rhiFrameContext.h"
 #include "rhi/rhiCommandList.h"
 #include "rhi/rhiRenderpass.h"
+#include "util/cpuProfiler.h"
 
 drawPass::~drawPass()
 {
@@ -21,11 +22,12 @@ void drawPass::initialize(const drawInitContext& context)
     build_layouts(init_context->rs);
     build_attachments(init_context->rs->context);
     build_pipeline(init_context->rs);
+    initialized = true;
 }
 
-void drawPass::frame(const u32 image_index)
+void drawPass::frame(const u32 frame_index)
 {
-    this->image_index = image_index;
+    this->frame_index = frame_index;
 }
 
 void drawPass::resize(renderShared* rs, u32 w, u32 h, u32 layers)
@@ -45,29 +47,66 @@ void drawPass::shutdown()
 void drawPass::render(renderShared* rs)
 {
     auto cmd_list = rs->frame_context->get_command_list(main_job_queue);
+    gpuScope zone(rs->gpu_profiler.get(), cmd_list, render_info.renderpass_name, main_job_queue);
 
     begin(cmd_list);
     draw(cmd_list);
     end(cmd_list);
+}
 
-    is_first_frame = false;
+void drawPass::set_targets(std::initializer_list<rhiTexture*> colors, rhiTexture* depth)
+{
+    ASSERT(colors.size() == render_info.color_attachments.size());
+    u32 index = 0;
+    for (rhiTexture* color : colors)
+        render_info.color_attachments[index++].view->texture = color;
+    if (depth)
+        render_info.depth_attachment->view->texture = depth;
 }
 
 void drawPass::begin(rhiCommandList* cmd)
 {
-    begin_barrier(cmd);
-
     cmd->begin_render_pass(render_info);
-    cmd->bind_pipeline(pipeline.get());
-    cmd->bind_descriptor_sets(pipeline_layout, rhiPipelineType::graphics, descriptor_sets[image_index.value()], 0, dynamic_offsets);
+    bind(cmd);
+}
+
+void drawPass::bind(rhiCommandList* cmd)
+{
+    cmd->bind_pipeline(bound_pipeline());
+    cmd->bind_descriptor_sets(pipeline_layout, rhiPipelineType::graphics, descriptor_sets[frame_index.value()], 0, dynamic_offsets);
     cmd->set_viewport_scissor(vec2(init_context->w, init_context->h));
 }
 
 void drawPass::end(rhiCommandList* cmd)
 {
     cmd->end_render_pass();;
-    end_barrier(cmd);
-    image_index.reset();
+    frame_index.reset();
+}
+
+void drawPass::record_parallel(renderShared* rs, rhiCommandList* cmd, const u32 count, const u32 min_per_chunk, const recordRange& record)
+{
+    const u32 threads = rs->jobs ? rs->jobs->get_thread_count() : 1;
+    const u32 chunks = std::min(threads, count / std::max(min_per_chunk, 1u));
+    if (chunks <= 1)
+    {
+        cmd->begin_render_pass(render_info);
+        record(cmd, 0, count);
+        cmd->end_render_pass();
+        return;
+    }
+
+    const auto secondaries = rs->frame_context->acquire_secondary_command_lists(rs->context, chunks);
+    cmd->begin_render_pass(render_info, true);
+    rs->jobs->parallel_for(chunks, [&](const u32 chunk)
+        {
+            CPU_ZONE("drawPass::record_secondary");
+            rhiCommandList* secondary = secondaries[chunk];
+            secondary->begin_secondary(render_info);
+            record(secondary, count * chunk / chunks, count * (chunk + 1) / chunks);
+            secondary->end();
+        });
+    cmd->execute_secondaries(secondaries);
+    cmd->end_render_pass();
 }
 
 void drawPass::create_pipeline_layout(renderShared* rs, const std::vector<rhiDescriptorSetLayout>& layouts, const std::vector<rhiPushConstant>& push_constant_bytes)
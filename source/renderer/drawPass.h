@@ -3,6 +3,7 @@
 #include "rhi/rhiRenderpass.h"
 #include "rhi/rhiDescriptor.h"
 #include "rhi/rhiPipeline.h"
+#include <functional>
 
 class rhiCommandList;
 class renderShared;
@@ -34,28 +35,37 @@ public:
 
     virtual void initialize(const drawInitContext& context);
 
-    void frame(const u32 image_index);
+    void frame(const u32 frame_index);
     virtual void resize(renderShared* rs, u32 w, u32 h, u32 layers = 1);
     virtual void shutdown();
     virtual void update(drawUpdateContext* update_context) {};
     virtual void render(renderShared* rs);
+    // graph owned render targets, bound again every frame before render
+    void set_targets(std::initializer_list<rhiTexture*> colors, rhiTexture* depth = nullptr);
 
     const u32 get_width() const { return init_context->w; }
     const u32 get_height() const { return init_context->h; }
     rhiPipeline* get_pipeline() { return pipeline.get(); }
 
 protected:
+    // records [first, last) of the pass body, every list gets its own pipeline and descriptor state
+    using recordRange = std::function<void(rhiCommandList* cmd, const u32 first, const u32 last)>;
+
     virtual void begin(rhiCommandList* cmd);
+    // pipeline, descriptor sets and viewport, replayed into every secondary
+    virtual void bind(rhiCommandList* cmd);
+    virtual rhiPipeline* bound_pipeline() { return pipeline.get(); }
     virtual void end(rhiCommandList* cmd);
     virtual void draw(rhiCommandList* cmd) {};
-    virtual void begin_barrier(rhiCommandList* cmd) {};
-    virtual void end_barrier(rhiCommandList* cmd) {};
     virtual void build_layouts(renderShared* rs) {}
     virtual void build_attachments(rhiDeviceContext* context) {};
     virtual void build_pipeline(renderShared* rs) {};
 
     void create_pipeline_layout(renderShared* rs, const std::vector<rhiDescriptorSetLayout>& layouts, const std::vector<rhiPushConstant>& push_constant_bytes = {});
     void create_descriptor_sets(renderShared* rs, const std::vector<rhiDescriptorSetLayout>& layouts);
+    // splits [0, count) into chunks of at least min_per_chunk, records them on the job system into
+    // secondaries and executes those in order inside the render pass. one chunk records inline
+    void record_parallel(renderShared* rs, rhiCommandList* cmd, const u32 count, const u32 min_per_chunk, const recordRange& record);
 
 protected:
     std::unique_ptr<drawInitContext> init_context;
@@ -64,8 +74,7 @@ protected:
     rhiPipelineLayout pipeline_layout;
     std::vector<std::vector<rhiDescriptorSet>> descriptor_sets;
     std::vector<u32> dynamic_offsets;
-    std::optional<u32> image_index;
+    std::optional<u32> frame_index;
     rhiQueueType main_job_queue = rhiQueueType::graphics;
     bool initialized = false;
-    bool is_first_frame = true;
 };
\ No newline at end of file
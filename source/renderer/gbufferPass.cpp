@@ -6,52 +6,13 @@
 #include "rhi/rhiDeviceContext.h"
 #include "rhi/rhiBuffer.h"
 #include "rhi/rhiTextureBindlessTable.h"
+#include "rhi/rhiFrameContext.h"
 #include "mesh/glTFMesh.h"
 
-void gbufferPass::initialize(const drawInitContext& context)
+namespace
 {
-    rhiTextureDesc td_color
-    {
-        .width = context.w,
-        .height = context.h,
-        .layers = context.layers,
-        .mips = 1,
-        .format = rhiFormat::RGBA8_UNORM,
-        .samples = rhiSampleCount::x1,
-        .is_depth = false
-    };
-    // gbuffer A
-    {
-        auto tex = context.rs->context->create_texture(td_color);
-        gbuffer_a.reset(tex.release());
-    }
-    // gbuffer B
-    {
-        auto tex = context.rs->context->create_texture(td_color);
-        gbuffer_b.reset(tex.release());
-    }
-    // gbuffer C
-    {
-        auto tex = context.rs->context->create_texture(td_color);
-        gbuffer_c.reset(tex.release());
-    }
-    // Depth
-    const rhiTextureDesc td_depth
-    {
-        .width = context.w,
-        .height = context.h,
-        .layers = context.layers,
-        .mips = 1,
-        .format = rhiFormat::D32S8,
-        .samples = rhiSampleCount::x1,
-        .usage = rhiTextureUsage::ds,
-        .is_depth = true,
-        .is_separate_depth_stencil = true
-    };
-    auto tex = context.rs->context->create_texture(td_depth);
-    depth.reset(tex.release());
-
-    drawPass::initialize(context);
+    // below this a secondary costs more to begin and execute than its draws take to record
+    constexpr u32 min_groups_per_secondary = 64;
 }
 
 void gbufferPass::resize(renderShared* rs, u32 w, u32 h, u32 layers)
@@ -60,24 +21,31 @@ void gbufferPass::resize(renderShared* rs, u32 w, u32 h, u32 layers)
         return;
 
     drawPass::resize(rs, w, h, layers);
-    gbuffer_a.reset();
-    gbuffer_b.reset();
-    gbuffer_c.reset();
-    build_attachments(rs->context);
 }
 
 void gbufferPass::shutdown()
 {
     drawPass::shutdown();
-    gbuffer_a.reset();
-    gbuffer_b.reset();
-    gbuffer_c.reset();
     initialized = false;
 }
 
-void gbufferPass::begin(rhiCommandList* cmd)
+void gbufferPass::render(renderShared* rs)
 {
-    drawPass::begin(cmd);
+    auto cmd_list = rs->frame_context->get_command_list(main_job_queue);
+    gpuScope zone(rs->gpu_profiler.get(), cmd_list, render_info.renderpass_name, main_job_queue);
+
+    const u32 group_count = static_cast<u32>(group_records->at(static_cast<u8>(draw_type)).size());
+    record_parallel(rs, cmd_list, group_count, min_groups_per_secondary, [this](rhiCommandList* cmd, const u32 first, const u32 last)
+        {
+            bind(cmd);
+            draw_range(cmd, first, last);
+        });
+    frame_index.reset();
+}
+
+void gbufferPass::bind(rhiCommandList* cmd)
+{
+    drawPass::bind(cmd);
 
     auto ptr = static_cast<gbufferInitContext*>(init_context.get());
     ASSERT(ptr);
@@ -89,12 +57,18 @@ void gbufferPass::begin(rhiCommandList* cmd)
 
 void gbufferPass::draw(rhiCommandList* cmd)
 {
-    auto buffer_ptr = indirect_buffer->at(static_cast<u8>(draw_type));
-    auto group_record = group_records->at(static_cast<u8>(draw_type));
+    draw_range(cmd, 0, static_cast<u32>(group_records->at(static_cast<u8>(draw_type)).size()));
+}
+
+void gbufferPass::draw_range(rhiCommandList* cmd, const u32 first, const u32 last)
+{
+    // runs on job workers, only reads pass state
+    const auto& buffer_ptr = indirect_buffer->at(static_cast<u8>(draw_type));
+    const auto& group_record = group_records->at(static_cast<u8>(draw_type));
     cmd->bind_pipeline(pipeline.get());
 
     constexpr u32 stride = sizeof(rhiDrawIndexedIndirect);
-    for (const auto& g : group_record)
+    for (const auto& g : std::span(group_record).subspan(first, last - first))
     {
         push_constants(cmd, g);
         cmd->bind_vertex_buffer(const_cast<rhiBuffer*>(g.vbo), 0, 0);
@@ -142,37 +116,18 @@ void gbufferPass::build_attachments(rhiDeviceContext* context)
 {
     render_info.renderpass_name = "gbuffer";
     render_info.samples = rhiSampleCount::x1;
-    render_info.color_formats = { rhiFormat::RGBA8_UNORM, rhiFormat::RGBA8_UNORM, rhiFormat::RGBA8_UNORM };
-    render_info.depth_format = rhiFormat::D32S8;
+    render_info.color_formats.assign(gbuffer_color_count, gbuffer_color_format);
+    render_info.depth_format = gbuffer_depth_format;
 
-    // Color attachments
-    render_info.color_attachments.resize(3);
+    // Color attachments, the textures come from the render graph
+    render_info.color_attachments.resize(gbuffer_color_count);
+    for (u32 index = 0; index < gbuffer_color_count; ++index)
     {
-        rhiRenderTargetView rtview{
-            .texture = gbuffer_a.get(),
+        render_info.color_attachments[index].view = rhiRenderTargetView{
+            .texture = nullptr,
             .mip = 0,
             .layout = rhiImageLayout::color_attachment
         };
-        render_info.color_attachments[0].view = rtview;
-    }
-    {
-        rhiRenderTargetView rtview{
-            .texture = gbuffer_b.get(),
-            .mip = 0,
-            .layout = rhiImageLayout::color_attachment
-        };
-        render_info.color_attachments[1].view = rtview;
-    }
-    {
-        rhiRenderTargetView rtview{
-            .texture = gbuffer_c.get(),
-            .mip = 0,
-            .layout = rhiImageLayout::color_attachment
-        };
-        render_info.color_attachments[2].view = rtview;
-    }
-    for (u32 index = 0; index < 3; ++index)
-    {
         render_info.color_attachments[index].load_op = rhiLoadOp::clear;
         render_info.color_attachments[index].store_op = rhiStoreOp::store;
         render_info.color_attachments[index].clear = { {0,0,0,1},1.0f,0 };
@@ -180,7 +135,7 @@ void gbufferPass::build_attachments(rhiDeviceContext* context)
 
     // Depth
     rhiRenderTargetView d{
-        .texture = depth.get(),
+        .texture = nullptr,
         .mip = 0,
         .layout = rhiImageLayout::depth_stencil_attachment
     };
@@ -195,13 +150,9 @@ void gbufferPass::build_attachments(rhiDeviceContext* context)
 
 void gbufferPass::build_pipeline(renderShared* rs)
 {
-    auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\gbuffer.vs.spv");
-    auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\gbuffer.ps.spv");
     rhiGraphicsPipelineDesc desc{
-        .vs = vs,
-        .fs = fs,
-        .color_formats = {gbuffer_a->desc.format, gbuffer_b->desc.format, gbuffer_c->desc.format},
-        .depth_format = depth->desc.format,
+        .color_formats = { gbuffer_color_format, gbuffer_color_format, gbuffer_color_format },
+        .depth_format = gbuffer_depth_format,
         .samples = rhiSampleCount::x1,
         .depth_test = true,
         .depth_write = true,
@@ -216,37 +167,7 @@ void gbufferPass::build_pipeline(renderShared* rs)
                 rhiVertexAttributeDesc{ 3, 0, rhiFormat::RGBA32_SFLOAT, offsetof(glTFVertex, tangent) },
         }}
     };
-    pipeline = rs->context->create_graphics_pipeline(desc, pipeline_layout);
-
-    shaderio::free_shader_binary(vs);
-    shaderio::free_shader_binary(fs);
-}
-
-void gbufferPass::begin_barrier(rhiCommandList* cmd)
-{
-    if (is_first_frame)
-    {
-        cmd->image_barrier(gbuffer_a.get(), rhiImageLayout::undefined, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_a->desc.layers);
-        cmd->image_barrier(gbuffer_b.get(), rhiImageLayout::undefined, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_b->desc.layers);
-        cmd->image_barrier(gbuffer_c.get(), rhiImageLayout::undefined, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_c->desc.layers);
-        cmd->image_barrier(depth.get(), rhiImageLayout::undefined, rhiImageLayout::depth_stencil_attachment, 0, 1, 0, depth->desc.layers);
-        is_first_frame = false;
-    }
-    else
-    {
-        cmd->image_barrier(gbuffer_a.get(), rhiImageLayout::shader_readonly, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_a->desc.layers);
-        cmd->image_barrier(gbuffer_b.get(), rhiImageLayout::shader_readonly, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_b->desc.layers);
-        cmd->image_barrier(gbuffer_c.get(), rhiImageLayout::shader_readonly, rhiImageLayout::color_attachment, 0, 1, 0, gbuffer_c->desc.layers);
-        cmd->image_barrier(depth.get(), rhiImageLayout::shader_readonly, rhiImageLayout::depth_stencil_attachment, 0, 1, 0, depth->desc.layers);
-    }
-}
-
-void gbufferPass::end_barrier(rhiCommandList* cmd)
-{
-    cmd->image_barrier(gbuffer_a.get(), rhiImageLayout::color_attachment, rhiImageLayout::shader_readonly, 0, 1, 0, gbuffer_a->desc.layers);
-    cmd->image_barrier(gbuffer_b.get(), rhiImageLayout::color_attachment, rhiImageLayout::shader_readonly, 0, 1, 0, gbuffer_b->desc.layers);
-    cmd->image_barrier(gbuffer_c.get(), rhiImageLayout::color_attachment, rhiImageLayout::shader_readonly, 0, 1, 0, gbuffer_c->desc.layers);
-    cmd->image_barrier(depth.get(), rhiImageLayout::depth_stencil_attachment, rhiImageLayout::shader_readonly, 0, 1, 0, depth->desc.layers);
+    rs->pipeline_compiler->request(pipeline, desc, { .vs = "gbuffer.vs.spv", .fs = "gbuffer.ps.spv" }, pipeline_layout);
 }
 
 void gbufferPass::update(renderShared* rs, const rhiBuffer* global_buffer)
@@ -266,7 +187,7 @@ void gbufferPass::update_globals(renderShared* rs, const rhiBuffer* global_buffe
         .range = sizeof(globalsCB)
     };
     const rhiWriteDescriptor write_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 0,
         .array_index = 0,
         .count = 1,
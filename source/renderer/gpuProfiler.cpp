@@ -0,0 +1,221 @@
+﻿#include "gpuProfiler.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiCommandList.h"
+#include "rhi/rhiQuery.h"
+#include "util/text.h"
+
+namespace
+{
+	std::string_view queue_name(const rhiQueueType queue)
+	{
+		switch (queue)
+		{
+		case rhiQueueType::graphics:
+			return "graphics";
+		case rhiQueueType::compute:
+			return "compute";
+		case rhiQueueType::transfer:
+			return "transfer";
+		default:
+			return "unknown";
+		}
+	}
+}
+
+gpuProfiler::gpuProfiler(rhiDeviceContext* context, const u32 frame_count, const u32 max_zones, const u32 history)
+	: max_zones(max_zones), history(history), trace_capacity(max_zones * history)
+{
+	ASSERT(frame_count > 0 && max_zones > 0 && history > 0);
+	slots.resize(frame_count);
+	for (auto& slot : slots)
+	{
+		slot.pool = context->create_timestamp_pool(max_zones * 2);
+		slot.zones.reserve(max_zones);
+	}
+}
+
+gpuProfiler::~gpuProfiler()
+{
+	slots.clear();
+}
+
+void gpuProfiler::begin_frame(const u32 frame_slot)
+{
+	ASSERT(frame_slot < slots.size());
+	current_slot = frame_slot;
+	frameSlot& slot = slots[frame_slot];
+
+	const u32 zone_count = static_cast<u32>(slot.zones.size());
+	std::vector<u64> ticks;
+	if (zone_count > 0 && slot.pool->resolve(0, zone_count * 2, ticks))
+	{
+		for (u32 i = 0; i < zone_count; ++i)
+		{
+			const zoneRecord& zone = slot.zones[i];
+			const u64 begin = ticks[i * 2];
+			const u64 end = std::max(ticks[i * 2 + 1], begin);
+
+			zoneHistory& h = histories[zone.name_id];
+			h.last_ms = slot.pool->ticks_to_ms(end - begin);
+			if (h.samples.size() < history)
+				h.samples.push_back(h.last_ms);
+			else
+				h.samples[h.next] = h.last_ms;
+			h.next = (h.next + 1) % history;
+
+			trace.push_back(traceEvent{
+				.name_id = zone.name_id,
+				.queue = zone.queue,
+				.frame_number = slot.frame_number,
+				.begin_tick = begin,
+				.end_tick = end
+				});
+		}
+		while (trace.size() > trace_capacity)
+			trace.pop_front();
+	}
+
+	slot.zones.clear();
+	slot.frame_number = frame_number++;
+}
+
+u32 gpuProfiler::begin_zone(rhiCommandList* cmd, std::string_view name, const rhiQueueType queue)
+{
+	frameSlot& slot = slots[current_slot];
+	if (slot.zones.size() >= max_zones)
+		return invalid_zone;
+
+	const u32 zone = static_cast<u32>(slot.zones.size());
+	slot.zones.push_back(zoneRecord{ .name_id = intern(name), .queue = queue });
+
+	cmd->reset_timestamps(slot.pool.get(), zone * 2, 2);
+	cmd->write_timestamp(slot.pool.get(), zone * 2, rhiPipelineStage::top_of_pipe);
+	return zone;
+}
+
+void gpuProfiler::end_zone(rhiCommandList* cmd, const u32 zone)
+{
+	if (zone == invalid_zone)
+		return;
+	cmd->write_timestamp(slots[current_slot].pool.get(), zone * 2 + 1, rhiPipelineStage::bottom_of_pipe);
+}
+
+std::optional<gpuZoneStats> gpuProfiler::get_stats(std::string_view name) const
+{
+	const auto it = name_ids.find(std::string(name));
+	if (it == name_ids.end() || histories[it->second].samples.empty())
+		return std::nullopt;
+	return make_stats(histories[it->second]);
+}
+
+std::vector<std::pair<std::string, gpuZoneStats>> gpuProfiler::get_all_stats() const
+{
+	std::vector<std::pair<std::string, gpuZoneStats>> out;
+	out.reserve(names.size());
+	for (u32 i = 0; i < names.size(); ++i)
+	{
+		if (!histories[i].samples.empty())
+			out.emplace_back(names[i], make_stats(histories[i]));
+	}
+	return out;
+}
+
+f64 gpuProfiler::get_ms(std::string_view name) const
+{
+	const auto stats = get_stats(name);
+	return stats.has_value() ? stats->last_ms : 0.0;
+}
+
+void gpuProfiler::reset_stats(const u32 new_history)
+{
+	if (new_history > 0)
+	{
+		history = new_history;
+		trace_capacity = max_zones * history;
+	}
+	for (zoneHistory& h : histories)
+	{
+		h.samples.clear();
+		h.samples.reserve(history);
+		h.next = 0;
+		h.last_ms = 0.0;
+	}
+	trace.clear();
+}
+
+bool gpuProfiler::dump_chrome_trace(const std::filesystem::path& path) const
+{
+	std::error_code ec;
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out)
+	{
+		std::cout << std::format("[gpuProfiler] cannot write {}\n", path.string());
+		return false;
+	}
+
+	const u64 base = trace.empty() ? 0 : std::ranges::min(trace, {}, &traceEvent::begin_tick).begin_tick;
+	const rhiTimestampPool* pool = slots.front().pool.get();
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const rhiQueueType queue : { rhiQueueType::graphics, rhiQueueType::compute, rhiQueueType::transfer })
+	{
+		out << std::format("{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"gpu {}\"}}}}",
+			first ? "" : ",\n", static_cast<u32>(queue), queue_name(queue));
+		first = false;
+	}
+	for (const traceEvent& e : trace)
+	{
+		out << std::format(",\n{{\"name\":\"{}\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"frame\":{}}}}}",
+			json_escape(names[e.name_id]), static_cast<u32>(e.queue),
+			pool->ticks_to_ms(e.begin_tick - base) * 1000.0, pool->ticks_to_ms(e.end_tick - e.begin_tick) * 1000.0, e.frame_number);
+	}
+	out << "\n]}\n";
+
+	std::cout << std::format("[gpuProfiler] wrote {} zones to {}\n", trace.size(), path.string());
+	return static_cast<bool>(out);
+}
+
+void gpuProfiler::report() const
+{
+	for (const auto& [name, stats] : get_all_stats())
+	{
+		std::cout << std::format("[gpuProfiler] {:<24} avg {:.3f} ms, p50 {:.3f}, p95 {:.3f}, p99 {:.3f} ({} samples)\n",
+			name, stats.avg_ms, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.samples);
+	}
+}
+
+u32 gpuProfiler::intern(std::string_view name)
+{
+	const std::string key(name);
+	if (const auto it = name_ids.find(key); it != name_ids.end())
+		return it->second;
+
+	const u32 id = static_cast<u32>(names.size());
+	names.push_back(key);
+	histories.emplace_back().samples.reserve(history);
+	name_ids.emplace(key, id);
+	return id;
+}
+
+gpuZoneStats gpuProfiler::make_stats(const zoneHistory& h) const
+{
+	std::vector<f64> sorted = h.samples;
+	std::ranges::sort(sorted);
+
+	f64 sum = 0.0;
+	for (const f64 v : sorted)
+		sum += v;
+
+	return gpuZoneStats{
+		.last_ms = h.last_ms,
+		.avg_ms = sum / static_cast<f64>(sorted.size()),
+		.p50_ms = percentile(sorted, 0.50),
+		.p95_ms = percentile(sorted, 0.95),
+		.p99_ms = percentile(sorted, 0.99),
+		.samples = static_cast<u32>(sorted.size())
+	};
+}
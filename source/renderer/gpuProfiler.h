@@ -0,0 +1,116 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDefs.h"
+#include <deque>
+
+class rhiDeviceContext;
+class rhiCommandList;
+class rhiTimestampPool;
+
+struct gpuZoneStats
+{
+	f64 last_ms = 0.0;
+	f64 avg_ms = 0.0;
+	f64 p50_ms = 0.0;
+	f64 p95_ms = 0.0;
+	f64 p99_ms = 0.0;
+	u32 samples = 0;
+};
+
+// timestamp pairs per zone from a per-frame-in-flight pool ring.
+// a slot is read back only after its frame fence, so resolving never stalls.
+class gpuProfiler
+{
+public:
+	static constexpr u32 invalid_zone = ~0u;
+
+	gpuProfiler(rhiDeviceContext* context, const u32 frame_count, const u32 max_zones = 128, const u32 history = 256);
+	~gpuProfiler();
+
+public:
+	// after the fence wait of frame_slot, collects what that slot recorded frame_count frames ago
+	void begin_frame(const u32 frame_slot);
+	// must be recorded outside a render pass, the zone resets its own query pair
+	u32 begin_zone(rhiCommandList* cmd, std::string_view name, const rhiQueueType queue = rhiQueueType::graphics);
+	void end_zone(rhiCommandList* cmd, const u32 zone);
+
+	std::optional<gpuZoneStats> get_stats(std::string_view name) const;
+	std::vector<std::pair<std::string, gpuZoneStats>> get_all_stats() const;
+	f64 get_ms(std::string_view name) const;
+	// drops collected samples, a non-zero history also resizes the per-zone window
+	void reset_stats(const u32 new_history = 0);
+
+	// chrome://tracing / perfetto json of the retained frames
+	bool dump_chrome_trace(const std::filesystem::path& path) const;
+	void report() const;
+
+private:
+	struct zoneRecord
+	{
+		u32 name_id;
+		rhiQueueType queue;
+	};
+	struct frameSlot
+	{
+		std::unique_ptr<rhiTimestampPool> pool;
+		std::vector<zoneRecord> zones;
+		u64 frame_number = 0;
+	};
+	struct zoneHistory
+	{
+		std::vector<f64> samples; // ring
+		u32 next = 0;
+		f64 last_ms = 0.0;
+	};
+	struct traceEvent
+	{
+		u32 name_id;
+		rhiQueueType queue;
+		u64 frame_number;
+		u64 begin_tick;
+		u64 end_tick;
+	};
+
+	u32 intern(std::string_view name);
+	gpuZoneStats make_stats(const zoneHistory& h) const;
+
+private:
+	std::vector<frameSlot> slots;
+	u32 current_slot = 0;
+	u64 frame_number = 0;
+	u32 max_zones;
+	u32 history;
+
+	std::vector<std::string> names;
+	std::unordered_map<std::string, u32> name_ids;
+	std::vector<zoneHistory> histories;
+
+	// retained for trace export, oldest first
+	std::deque<traceEvent> trace;
+	u32 trace_capacity;
+};
+
+// scoped zone, no-op when the profiler is null
+class gpuScope
+{
+public:
+	gpuScope(gpuProfiler* profiler, rhiCommandList* cmd, std::string_view name, const rhiQueueType queue = rhiQueueType::graphics)
+		: profiler(profiler), cmd(cmd)
+	{
+		if (profiler)
+			zone = profiler->begin_zone(cmd, name, queue);
+	}
+	~gpuScope()
+	{
+		if (profiler)
+			profiler->end_zone(cmd, zone);
+	}
+	gpuScope(const gpuScope&) = delete;
+	gpuScope& operator=(const gpuScope&) = delete;
+
+private:
+	gpuProfiler* profiler;
+	rhiCommandList* cmd;
+	u32 zone = gpuProfiler::invalid_zone;
+};
@@ -22,7 +22,7 @@ void indirectDrawPass::update_instances(renderShared* rs, const u32 instancebuf_
         .range = instance_buf->size()
     };
     const rhiWriteDescriptor instance_write_desc{
-        .set = descriptor_sets[image_index.value()][instancebuf_desc_idx],
+        .set = descriptor_sets[frame_index.value()][instancebuf_desc_idx],
         .binding = 0,
         .array_index = 0,
         .count = 1,
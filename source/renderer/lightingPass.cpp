@@ -5,6 +5,18 @@
 #include "rhi/rhiCommandList.h"
 #include "scene/camera.h"
 
+std::vector<rhiSpecializationConstant> lightingPermutation::constants() const
+{
+	// cbuffer holds at most 4 cascades
+	ASSERT(cascade_count > 0 && cascade_count <= 4);
+	return {
+		{ 0, cascade_count },
+		{ 1, static_cast<u32>(shadow_filter) },
+		{ 2, shadows ? 1u : 0u },
+		{ 3, ibl ? 1u : 0u },
+	};
+}
+
 void lightingPass::initialize(const drawInitContext& context)
 {
 	drawPass::initialize(context);
@@ -28,7 +40,7 @@ void lightingPass::link_textures(textureContext& context)
 	texture_context.gbuf_c = context.gbuf_c;
 	texture_context.depth = context.depth;
 	texture_context.shadows = context.shadows;
-	texture_context.ibl_irradiance = context.ibl_irradiance;
+	texture_context.ibl_sh = context.ibl_sh;
 	texture_context.ibl_specular = context.ibl_specular;
 	texture_context.ibl_brdf_lut = context.ibl_brdf_lut;
 
@@ -51,15 +63,15 @@ void lightingPass::update_cbuffers(renderShared* rs, camera* camera, const vec3&
 		.inv_proj = glm::inverse(camera->proj(vec2(init_context->w, init_context->h))),
 		.inv_view = glm::inverse(camera->view()),
 		.near_far = vec2(camera->get_near(), camera->get_far()),
-#if MESHLET
 		.cascade_splits = vec4(0.f),
-#else
-		.cascade_splits = vec4(cascade_splits[0], cascade_splits[1], cascade_splits[2], cascade_splits[3]),
-#endif
 		.light_dir = light_dir,
 		.shadow_mapsize = vec2(shadow_resolution, shadow_resolution),
 	};
 
+	// the shader only reads the first cascade_count splits
+	for (u32 i = 0; i < std::min<u32>(static_cast<u32>(cascade_splits.size()), 4); ++i)
+		c.cascade_splits[i] = cascade_splits[i];
+
 	light l;
 	for (u32 i = 0; i < light_viewprojs.size(); ++i)
 		l.light_viewproj[i] = light_viewprojs[i];
@@ -71,29 +83,29 @@ void lightingPass::update_cbuffers(renderShared* rs, camera* camera, const vec3&
 	};
 
 	// camera cbuffer
-	rs->buffer_barrier(camera_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	rs->buffer_barrier(camera_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 		rhiPipelineStage::fragment_shader, rhiPipelineStage::copy, rhiAccessFlags::uniform_read, rhiAccessFlags::transfer_write, 0, sizeof(cam), 
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer)});
-	rs->upload_to_device(camera_cbuffer[image_index.value()].get(), &c, sizeof(cam));
-	rs->buffer_barrier(camera_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	rs->upload_to_device(camera_cbuffer[frame_index.value()].get(), &c, sizeof(cam));
+	rs->buffer_barrier(camera_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 		rhiPipelineStage::copy, rhiPipelineStage::fragment_shader, rhiAccessFlags::transfer_write, rhiAccessFlags::uniform_read, 0, sizeof(cam),
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer) });
 
 	// light cbuffer
-	rs->buffer_barrier(light_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{ 
+	rs->buffer_barrier(light_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{ 
 		rhiPipelineStage::fragment_shader, rhiPipelineStage::copy, rhiAccessFlags::uniform_read, rhiAccessFlags::transfer_write, 0, sizeof(light),
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer) });
-	rs->upload_to_device(light_cbuffer[image_index.value()].get(), &l, sizeof(light));
-	rs->buffer_barrier(light_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	rs->upload_to_device(light_cbuffer[frame_index.value()].get(), &l, sizeof(light));
+	rs->buffer_barrier(light_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 		rhiPipelineStage::copy, rhiPipelineStage::fragment_shader, rhiAccessFlags::transfer_write, rhiAccessFlags::uniform_read, 0, sizeof(light),
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer) });
 
 	// ibl cbuffer
-	rs->buffer_barrier(ibl_param_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{ 
+	rs->buffer_barrier(ibl_param_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{ 
 		rhiPipelineStage::fragment_shader, rhiPipelineStage::copy, rhiAccessFlags::uniform_read, rhiAccessFlags::transfer_write, 0, sizeof(iblParams),
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer) });
-	rs->upload_to_device(ibl_param_cbuffer[image_index.value()].get(), &ibl, sizeof(iblParams));
-	rs->buffer_barrier(ibl_param_cbuffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	rs->upload_to_device(ibl_param_cbuffer[frame_index.value()].get(), &ibl, sizeof(iblParams));
+	rs->buffer_barrier(ibl_param_cbuffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 		rhiPipelineStage::copy, rhiPipelineStage::fragment_shader, rhiAccessFlags::transfer_write, rhiAccessFlags::uniform_read, 0, sizeof(iblParams),
 		rs->context->get_queue_family_index(rhiQueueType::graphics), rs->context->get_queue_family_index(rhiQueueType::transfer) });
 }
@@ -164,7 +176,7 @@ void lightingPass::build_layouts(renderShared* rs)
 			},
 			rhiDescriptorSetLayoutBinding{
 				.binding = 10,
-				.type = rhiDescriptorType::sampled_image,
+				.type = rhiDescriptorType::uniform_buffer,
 				.count = 1,
 				.stage = rhiShaderStage::fragment
 			},
@@ -189,7 +201,7 @@ void lightingPass::build_attachments(rhiDeviceContext* context)
 {
 	render_info.renderpass_name = "lighting";
 	render_info.samples = rhiSampleCount::x1;
-	render_info.color_formats = { rhiFormat::RGBA8_UNORM };
+	render_info.color_formats = { scene_color_format };
 	render_info.depth_format = std::nullopt;
 	
 	render_info.color_attachments.resize(1);
@@ -200,33 +212,47 @@ void lightingPass::build_attachments(rhiDeviceContext* context)
 
 void lightingPass::build_pipeline(renderShared* rs)
 {
-	auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\fullscreen.vs.spv");
-	auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\lighting.ps.spv");
-	const rhiGraphicsPipelineDesc pipeline_desc{
-		.vs = vs,
-		.fs = fs,
-		.color_formats = { rhiFormat::RGBA8_UNORM },
+	auto ptr = static_cast<lightingInitContext*>(init_context.get());
+	ASSERT(ptr);
+
+	rhiGraphicsPipelineDesc pipeline_desc{
+		.color_formats = { scene_color_format },
 		.depth_format = std::nullopt,
 		.samples = rhiSampleCount::x1,
 		.depth_test = false,
-		.depth_write = false
+		.depth_write = false,
+		.specialization = ptr->permutation.constants()
 	};
+	rs->pipeline_compiler->request(pipeline, pipeline_desc, { .vs = "fullscreen.vs.spv", .fs = "lighting.ps.spv" }, pipeline_layout);
 
-	pipeline = rs->context->create_graphics_pipeline(pipeline_desc, pipeline_layout);
+	// shadows toggle at runtime, keep the unshadowed variant ready
+	lightingPermutation unshadowed = ptr->permutation;
+	unshadowed.shadows = false;
+	if (unshadowed == ptr->permutation)
+	{
+		unshadowed_pipeline.reset();
+		return;
+	}
+	pipeline_desc.specialization = unshadowed.constants();
+	rs->pipeline_compiler->request(unshadowed_pipeline, pipeline_desc, { .vs = "fullscreen.vs.spv", .fs = "lighting.ps.spv" }, pipeline_layout);
+}
 
-	shaderio::free_shader_binary(vs);
-	shaderio::free_shader_binary(fs);
+rhiPipeline* lightingPass::bound_pipeline()
+{
+	if (!shadows_enabled && unshadowed_pipeline)
+		return unshadowed_pipeline.get();
+	return pipeline.get();
 }
 
 void lightingPass::update_descriptors(renderShared* rs)
 {
 	const rhiDescriptorBufferInfo cam{
-		.buffer = camera_cbuffer[image_index.value()].get(),
+		.buffer = camera_cbuffer[frame_index.value()].get(),
 		.offset = 0,
 		.range = sizeof(lightingPass::cam)
 	};
 	const rhiWriteDescriptor cam_cb{
-		.set = descriptor_sets[image_index.value()][0] ,
+		.set = descriptor_sets[frame_index.value()][0] ,
 		.binding = 0,
 		.array_index = 0,
 		.count = 1,
@@ -235,12 +261,12 @@ void lightingPass::update_descriptors(renderShared* rs)
 	};
 
 	const rhiDescriptorBufferInfo light{
-		.buffer = light_cbuffer[image_index.value()].get(),
+		.buffer = light_cbuffer[frame_index.value()].get(),
 		.offset = 0,
 		.range = sizeof(lightingPass::light)
 	};
 	const rhiWriteDescriptor light_cb{
-		.set = descriptor_sets[image_index.value()][0] ,
+		.set = descriptor_sets[frame_index.value()][0] ,
 		.binding = 1,
 		.array_index = 0,
 		.count = 1,
@@ -249,12 +275,12 @@ void lightingPass::update_descriptors(renderShared* rs)
 	};
 
 	const rhiDescriptorBufferInfo ibl{
-		.buffer = ibl_param_cbuffer[image_index.value()].get(),
+		.buffer = ibl_param_cbuffer[frame_index.value()].get(),
 		.offset = 0,
 		.range = sizeof(lightingPass::light)
 	};
 	const rhiWriteDescriptor ibl_cb{
-		.set = descriptor_sets[image_index.value()][0] ,
+		.set = descriptor_sets[frame_index.value()][0] ,
 		.binding = 2,
 		.array_index = 0,
 		.count = 1,
@@ -275,7 +301,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		};
 
 	const rhiWriteDescriptor gbuf_a_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 3,
 		.array_index = 0,
 		.count = 1,
@@ -283,7 +309,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.image = { mk_img(texture_context.gbuf_a)}
 	};
 	const rhiWriteDescriptor gbuf_b_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 4,
 		.array_index = 0,
 		.count = 1,
@@ -291,7 +317,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.image = { mk_img(texture_context.gbuf_b)}
 	};
 	const rhiWriteDescriptor gbuf_c_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 5,
 		.array_index = 0,
 		.count = 1,
@@ -299,7 +325,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.image = { mk_img(texture_context.gbuf_c)}
 	};
 	const rhiWriteDescriptor depth_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 6,
 		.array_index = 0,
 		.count = 1,
@@ -320,7 +346,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.sampler = rs->samplers.linear_clamp.get()
 	};
 	const rhiWriteDescriptor sampler_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 7,
 		.array_index = 0,
 		.count = 1,
@@ -329,7 +355,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 	};
 
 	const rhiWriteDescriptor shadow_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 8,
 		.array_index = 0,
 		.count = 1,
@@ -349,7 +375,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.sampler = rs->samplers.point_clamp.get()
 	};
 	const rhiWriteDescriptor shadow_sampler_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 9,
 		.array_index = 0,
 		.count = 1,
@@ -357,23 +383,23 @@ void lightingPass::update_descriptors(renderShared* rs)
 		.image = { shadow_sampler_image_info }
 	};
 
-	const rhiWriteDescriptor ibl_irradiance_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+	const rhiWriteDescriptor ibl_sh_write_desc{
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 10,
 		.array_index = 0,
 		.count = 1,
-		.type = rhiDescriptorType::sampled_image,
-		.image = { 
-			rhiDescriptorImageInfo{
-				.texture_cubemap = texture_context.ibl_irradiance,
-				.layer_count = texture_context.ibl_irradiance->desc.layers,
-				.cubemap_viewtype = rhiCubemapViewType::cube,
+		.type = rhiDescriptorType::uniform_buffer,
+		.buffer = { 
+			rhiDescriptorBufferInfo{
+				.buffer = texture_context.ibl_sh,
+				.offset = 0,
+				.range = sizeof(vec4) * 9
 			}
 		}
 	};
 
 	const rhiWriteDescriptor ibl_specular_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 11,
 		.array_index = 0,
 		.count = 1,
@@ -388,7 +414,7 @@ void lightingPass::update_descriptors(renderShared* rs)
 	};
 
 	const rhiWriteDescriptor ibl_brdf_lut_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 12,
 		.array_index = 0,
 		.count = 1,
@@ -411,22 +437,12 @@ void lightingPass::update_descriptors(renderShared* rs)
 		sampler_write_desc,
 		shadow_write_desc,
 		shadow_sampler_write_desc,
-		ibl_irradiance_write_desc,
+		ibl_sh_write_desc,
 		ibl_specular_write_desc,
 		ibl_brdf_lut_write_desc
 		});
 }
 
-void lightingPass::begin_barrier(rhiCommandList* cmd)
-{
-	cmd->image_barrier(texture_context.scene_color, rhiImageLayout::color_attachment, rhiImageLayout::color_attachment);
-}
-
-void lightingPass::end_barrier(rhiCommandList* cmd)
-{
-	cmd->image_barrier(texture_context.scene_color, rhiImageLayout::color_attachment, rhiImageLayout::shader_readonly);
-}
-
 void lightingPass::draw(rhiCommandList* cmd)
 {
 	cmd->draw_fullscreen();
@@ -5,6 +5,34 @@
 class camera;
 class scene;
 
+enum class shadowFilter : u32
+{
+    hard = 0,
+    pcf3x3 = 1,
+};
+
+// specialization constants of lighting.ps.hlsl, one pipeline per used permutation
+struct lightingPermutation
+{
+    u32 cascade_count = 4;
+    shadowFilter shadow_filter = shadowFilter::pcf3x3;
+    bool shadows = true;
+    bool ibl = true;
+
+    std::vector<rhiSpecializationConstant> constants() const;
+    bool operator==(const lightingPermutation&) const = default;
+};
+
+struct lightingInitContext : public drawInitContext
+{
+    lightingPermutation permutation;
+
+    virtual std::unique_ptr<drawInitContext> clone() const
+    {
+        return std::make_unique<lightingInitContext>(*this);
+    }
+};
+
 class lightingPass final : public drawPass
 {
 public:
@@ -43,25 +71,26 @@ public:
         rhiTexture* gbuf_c;
         rhiTexture* depth;
         rhiTexture* shadows;
-        rhiTextureCubeMap* ibl_irradiance;
+        rhiBuffer* ibl_sh;
         rhiTextureCubeMap* ibl_specular;
         rhiTexture* ibl_brdf_lut;
     };
 
 public:
     void initialize(const drawInitContext& context) override;
-    void begin_barrier(rhiCommandList* cmd) override;
-    void end_barrier(rhiCommandList* cmd) override;
     void draw(rhiCommandList* cmd) override;
 
 public:
     void link_textures(textureContext& context);
+    // picks between the precompiled shadowed and unshadowed permutations
+    void set_shadows(const bool enable) { shadows_enabled = enable; }
     void update(renderShared* rs, camera* camera, const vec3& light_dir, const std::vector<mat4>& light_viewprojs, const std::vector<f32>& cascade_splits, const u32 shadow_resolution, const u32 cubemap_mipcount);
 
 protected:
     void build_layouts(renderShared* rs) override;
     void build_attachments(rhiDeviceContext* context) override;
     void build_pipeline(renderShared* rs) override;
+    rhiPipeline* bound_pipeline() override;
 
 private:
     void update_cbuffers(renderShared* rs, camera* camera, const vec3& light_dir, const std::vector<mat4>& light_viewprojs, const std::vector<f32>& cascade_splits, const u32 shadow_resolution, const u32 cubemap_mipcount);
@@ -77,5 +106,7 @@ private:
     std::vector<std::unique_ptr<rhiBuffer>> camera_cbuffer;
     std::vector<std::unique_ptr<rhiBuffer>> light_cbuffer;
     std::vector<std::unique_ptr<rhiBuffer>> ibl_param_cbuffer;
-    bool is_first_frame = true;
+
+    std::unique_ptr<rhiPipeline> unshadowed_pipeline;
+    bool shadows_enabled = true;
 };
\ No newline at end of file
@@ -95,7 +95,7 @@ void meshletDrawPass::update(drawUpdateContext* update_context)
 
     std::vector<rhiWriteDescriptor> write_descriptors;
     write_descriptors.push_back(rhiWriteDescriptor{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 0,
         .array_index = 0,
         .count = 1,
@@ -129,26 +129,26 @@ void meshletDrawPass::update(drawUpdateContext* update_context)
 
         auto& instance_buf = instance_buffer->at(static_cast<u8>(draw_type));
         if(instance_buf)
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index], 0, instance_buf.get(), static_cast<u32>(instance_buf->size())));
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index], 0, instance_buf.get(), static_cast<u32>(instance_buf->size())));
         auto& drawparam_buf = draw_params_buffer->at(static_cast<u8>(draw_type));
         if (drawparam_buf)
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index], 1, drawparam_buf.get(), static_cast<u32>(drawparam_buf->size())));
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index], 1, drawparam_buf.get(), static_cast<u32>(drawparam_buf->size())));
         if (ctx->meshlet_buf)
         {
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 2, ctx->meshlet_buf->pos.get(), static_cast<u32>(ctx->meshlet_buf->pos->size())));
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 3, ctx->meshlet_buf->norm.get(), static_cast<u32>(ctx->meshlet_buf->norm->size())));
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 4, ctx->meshlet_buf->uv.get(), static_cast<u32>(ctx->meshlet_buf->uv->size())));
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 5, ctx->meshlet_buf->tan.get(), static_cast<u32>(ctx->meshlet_buf->tan->size())));
 
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 6, ctx->meshlet_buf->header.get(), static_cast<u32>(ctx->meshlet_buf->header->size())));
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 7, ctx->meshlet_buf->vert_indices.get(), static_cast<u32>(ctx->meshlet_buf->vert_indices->size())));
-            write_descriptors.push_back(create_write_desc(descriptor_sets[image_index.value()][meshlet_layout_index],
+            write_descriptors.push_back(create_write_desc(descriptor_sets[frame_index.value()][meshlet_layout_index],
                 8, ctx->meshlet_buf->tri_bytes.get(), static_cast<u32>(ctx->meshlet_buf->tri_bytes->size())));
         }
     }
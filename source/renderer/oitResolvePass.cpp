@@ -25,19 +25,15 @@ void oitResolvePass::build_layouts(renderShared* rs)
 
 void oitResolvePass::build_attachments(rhiDeviceContext* context)
 {
-	auto ctx = static_cast<oitInitContext*>(init_context.get());
-	ASSERT(ctx);
-	auto sc = ctx->scene_color.lock();
-	ASSERT(sc);
-
 	render_info.renderpass_name = "oit resolve";
 	render_info.samples = rhiSampleCount::x1;
-	render_info.color_formats = { rhiFormat::RGBA8_UNORM };
+	render_info.color_formats = { scene_color_format };
 	render_info.depth_format = std::nullopt;
 
+	// scene color comes from the render graph
 	render_info.color_attachments.resize(1);
 	render_info.color_attachments[0].view = rhiRenderTargetView{
-		.texture = sc.get(),
+		.texture = nullptr,
 		.mip = 0,
 		.layout = rhiImageLayout::color_attachment
 	};
@@ -48,12 +44,8 @@ void oitResolvePass::build_attachments(rhiDeviceContext* context)
 
 void oitResolvePass::build_pipeline(renderShared* rs)
 {
-	auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\fullscreen.vs.spv");
-	auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\oit.ps.spv");
 	const rhiGraphicsPipelineDesc pipeline_desc{
-		.vs = vs,
-		.fs = fs,
-		.color_formats = { rhiFormat::RGBA8_UNORM },
+		.color_formats = { scene_color_format },
 		.depth_format = std::nullopt,
 		.blend_states = { rhiBlendState{
 			.src_color = rhiBlendFactor::one,
@@ -69,10 +61,7 @@ void oitResolvePass::build_pipeline(renderShared* rs)
 		.depth_write = false
 	};
 
-	pipeline = rs->context->create_graphics_pipeline(pipeline_desc, pipeline_layout);
-
-	shaderio::free_shader_binary(vs);
-	shaderio::free_shader_binary(fs);
+	rs->pipeline_compiler->request(pipeline, pipeline_desc, { .vs = "fullscreen.vs.spv", .fs = "oit.ps.spv" }, pipeline_layout);
 }
 
 void oitResolvePass::update(drawUpdateContext* update_context)
@@ -81,7 +70,7 @@ void oitResolvePass::update(drawUpdateContext* update_context)
 	ASSERT(ctx);
 	
 	const rhiWriteDescriptor accum_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 0,
 		.count = 1,
 		.type = rhiDescriptorType::sampled_image,
@@ -92,7 +81,7 @@ void oitResolvePass::update(drawUpdateContext* update_context)
 		}
 	};
 	const rhiWriteDescriptor reveal_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 1,
 		.count = 1,
 		.type = rhiDescriptorType::sampled_image,
@@ -103,7 +92,7 @@ void oitResolvePass::update(drawUpdateContext* update_context)
 		}
 	};
 	const rhiWriteDescriptor sampler_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 2,
 		.array_index = 0,
 		.count = 1,
@@ -120,38 +109,4 @@ void oitResolvePass::update(drawUpdateContext* update_context)
 void oitResolvePass::draw(rhiCommandList* cmd)
 {
 	cmd->draw_fullscreen();
-}
-
-void oitResolvePass::begin_barrier(rhiCommandList* cmd)
-{
-	auto context = static_cast<oitInitContext*>(init_context.get());
-	ASSERT(context);
-	auto scene_color = context->scene_color.lock();
-	ASSERT(scene_color);
-
-	cmd->image_barrier(scene_color.get(), rhiImageBarrierDescription{
-			.src_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-			.dst_stage = rhiPipelineStage::color_attachment_output,
-			.src_access = rhiAccessFlags::shader_sampled_read | rhiAccessFlags::shader_read,
-			.dst_access = rhiAccessFlags::color_attachment_read | rhiAccessFlags::color_attachment_write,
-			.old_layout = rhiImageLayout::shader_readonly,
-			.new_layout = rhiImageLayout::color_attachment
-		});
-}
-
-void oitResolvePass::end_barrier(rhiCommandList* cmd)
-{
-	auto context = static_cast<oitInitContext*>(init_context.get());
-	ASSERT(context);
-	auto scene_color = context->scene_color.lock();
-	ASSERT(scene_color);
-
-	cmd->image_barrier(scene_color.get(), rhiImageBarrierDescription{
-			.src_stage = rhiPipelineStage::color_attachment_output,
-			.dst_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-			.src_access = rhiAccessFlags::color_attachment_read | rhiAccessFlags::color_attachment_write,
-			.dst_access = rhiAccessFlags::shader_sampled_read | rhiAccessFlags::shader_read,
-			.old_layout = rhiImageLayout::color_attachment,
-			.new_layout = rhiImageLayout::shader_readonly
-		});
 }
\ No newline at end of file
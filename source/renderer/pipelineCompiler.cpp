@@ -0,0 +1,147 @@
+﻿#include "pipelineCompiler.h"
+#include "shaderLibrary.h"
+#include "rhi/rhiDeviceContext.h"
+#include "util/cpuProfiler.h"
+
+namespace
+{
+	f64 elapsed_ms(const std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	std::optional<rhiShaderBinary> load_optional(shaderLibrary* library, const std::optional<std::string>& name)
+	{
+		if (!name.has_value())
+			return std::nullopt;
+		return library->load(name.value());
+	}
+}
+
+pipelineCompiler::pipelineCompiler(rhiDeviceContext* context, shaderLibrary* library, u32 worker_count)
+	: context(context), library(library)
+{
+	// leave one core to the main thread which keeps loading the scene meanwhile
+	if (worker_count == 0)
+		worker_count = std::clamp(std::thread::hardware_concurrency(), 2u, 9u) - 1;
+
+	workers.reserve(worker_count);
+	for (u32 i = 0; i < worker_count; ++i)
+		workers.emplace_back([this](std::stop_token stop) { worker_loop(stop); });
+}
+
+pipelineCompiler::~pipelineCompiler()
+{
+	// workers finish the queued jobs before they observe the stop
+	for (auto& w : workers)
+		w.request_stop();
+	job_cv.notify_all();
+	workers.clear();
+}
+
+void pipelineCompiler::request(std::unique_ptr<rhiPipeline>& out, const rhiGraphicsPipelineDesc& desc, const pipelineShaderNames& shaders, const rhiPipelineLayout& layout)
+{
+	push([this, &out, desc, shaders, layout]() mutable
+		{
+			desc.vs = load_optional(library, shaders.vs);
+			desc.fs = load_optional(library, shaders.fs);
+			desc.ms = load_optional(library, shaders.ms);
+			out = context->create_graphics_pipeline(desc, layout);
+		});
+}
+
+void pipelineCompiler::request(std::unique_ptr<rhiPipeline>& out, const rhiComputePipelineDesc& desc, const std::string& cs, const rhiPipelineLayout& layout)
+{
+	push([this, &out, desc, cs, layout]() mutable
+		{
+			desc.cs = library->load(cs, desc.cs.entry);
+			out = context->create_compute_pipeline(desc, layout);
+		});
+}
+
+void pipelineCompiler::wait()
+{
+	CPU_ZONE("pipelineCompiler::wait");
+	std::unique_lock lock(mutex);
+	if (pending > 0)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		done_cv.wait(lock, [this]() { return pending == 0; });
+		stats.wait_ms += elapsed_ms(begin);
+	}
+	if (!reported)
+	{
+		reported = true;
+		stats.wall_ms = elapsed_ms(batch_begin);
+		report();
+		library->report();
+	}
+	if (error)
+		std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+bool pipelineCompiler::idle()
+{
+	std::scoped_lock lock(mutex);
+	return pending == 0;
+}
+
+void pipelineCompiler::report() const
+{
+	std::cout << std::format("[pipelineCompiler] {} pipelines on {} workers : wall {:.2f} ms / compile {:.2f} ms / main thread waited {:.2f} ms\n",
+		stats.compiled, workers.size(), stats.wall_ms, stats.compile_ms, stats.wait_ms);
+}
+
+void pipelineCompiler::push(std::function<void()>&& job)
+{
+	{
+		std::scoped_lock lock(mutex);
+		if (pending == 0 && reported)
+		{
+			batch_begin = std::chrono::steady_clock::now();
+			stats = {};
+			reported = false;
+		}
+		++pending;
+		jobs.push_back(std::move(job));
+	}
+	job_cv.notify_one();
+}
+
+void pipelineCompiler::worker_loop(std::stop_token stop)
+{
+	CPU_THREAD_NAME("pipeline compiler");
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mutex);
+			if (!job_cv.wait(lock, stop, [this]() { return !jobs.empty(); }))
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		const auto begin = std::chrono::steady_clock::now();
+		std::exception_ptr job_error;
+		try
+		{
+			job();
+		}
+		catch (...)
+		{
+			job_error = std::current_exception();
+		}
+		const f64 ms = elapsed_ms(begin);
+
+		{
+			std::scoped_lock lock(mutex);
+			if (job_error && !error)
+				error = job_error;
+			stats.compile_ms += ms;
+			++stats.compiled;
+			--pending;
+		}
+		done_cv.notify_all();
+	}
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiPipeline.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+class rhiDeviceContext;
+class shaderLibrary;
+
+// shader library names of a graphics pipeline, resolved on the worker
+struct pipelineShaderNames
+{
+	std::optional<std::string> vs;
+	std::optional<std::string> fs;
+	std::optional<std::string> ms;
+};
+
+struct pipelineCompilerStats
+{
+	u32 compiled = 0;
+	f64 compile_ms = 0.0; // sum over workers
+	f64 wall_ms = 0.0;    // first request to last completion
+	f64 wait_ms = 0.0;    // main thread blocked in wait()
+};
+
+// passes declare their pipelines during initialize, workers load shaders and create them concurrently.
+// the out pointer must stay untouched until wait() returns.
+class pipelineCompiler
+{
+public:
+	pipelineCompiler(rhiDeviceContext* context, shaderLibrary* library, u32 worker_count = 0);
+	~pipelineCompiler();
+
+public:
+	void request(std::unique_ptr<rhiPipeline>& out, const rhiGraphicsPipelineDesc& desc, const pipelineShaderNames& shaders, const rhiPipelineLayout& layout);
+	void request(std::unique_ptr<rhiPipeline>& out, const rhiComputePipelineDesc& desc, const std::string& cs, const rhiPipelineLayout& layout);
+	// blocks until every requested pipeline exists, rethrows the first compile error
+	void wait();
+	bool idle();
+	const pipelineCompilerStats& get_stats() const { return stats; }
+	void report() const;
+
+private:
+	void push(std::function<void()>&& job);
+	void worker_loop(std::stop_token stop);
+
+private:
+	rhiDeviceContext* context;
+	shaderLibrary* library;
+	std::vector<std::jthread> workers;
+
+	std::mutex mutex;
+	std::condition_variable_any job_cv;
+	std::condition_variable done_cv;
+	std::deque<std::function<void()>> jobs;
+	u32 pending = 0;
+	std::exception_ptr error;
+
+	std::chrono::steady_clock::time_point batch_begin;
+	pipelineCompilerStats stats;
+	bool reported = true;
+};
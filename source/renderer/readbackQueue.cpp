@@ -0,0 +1,255 @@
+﻿#include "readbackQueue.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiCommandList.h"
+#include "rhi/rhiSynchroize.h"
+#include "rhi/rhiBuffer.h"
+#include "util/cpuProfiler.h"
+#include <numeric>
+
+namespace
+{
+	u64 texel_bytes(const rhiFormat format, const rhiImageAspect aspect)
+	{
+		// depth and stencil are copied one aspect at a time
+		if (aspect == rhiImageAspect::stencil)
+			return 1;
+		if (aspect == rhiImageAspect::depth)
+			return 4;
+
+		switch (format)
+		{
+		case rhiFormat::RGBA8_UNORM:
+		case rhiFormat::RGBA8_SRGB:
+		case rhiFormat::BGRA8_UNORM:
+		case rhiFormat::BGRA8_SRGB:
+		case rhiFormat::RG16_SFLOAT:
+		case rhiFormat::D24S8:
+		case rhiFormat::D32F:
+			return 4;
+		case rhiFormat::RGBA16F:
+		case rhiFormat::RG32_SFLOAT:
+		case rhiFormat::D32S8:
+			return 8;
+		case rhiFormat::RGB32_SFLOAT:
+			return 12;
+		case rhiFormat::RGBA32_SFLOAT:
+			return 16;
+		}
+		return 4;
+	}
+
+	// the fence only orders device work, host reads of the mapped slice still need the copy made available
+	void make_host_visible(rhiCommandList* cmd, rhiBuffer* dst, const u64 offset, const u64 bytes)
+	{
+		cmd->buffer_barrier(dst, rhiBufferBarrierDescription{
+			.src_stage = rhiPipelineStage::copy,
+			.dst_stage = rhiPipelineStage::host,
+			.src_access = rhiAccessFlags::transfer_write,
+			.dst_access = rhiAccessFlags::host_read,
+			.offset = static_cast<u32>(offset),
+			.size = bytes
+			});
+	}
+
+	u64 align_up(const u64 v, const u64 a)
+	{
+		return (v + a - 1) / a * a;
+	}
+}
+
+readbackQueue::readbackQueue(rhiDeviceContext* context, const u32 frames_in_flight, const u64 slice_bytes)
+	: context(context), slice_bytes(std::max<u64>(slice_bytes, 256))
+{
+	// slices are allocated on first use, most frames read nothing back
+	slices.resize(std::max<u32>(frames_in_flight, 1));
+}
+
+readbackQueue::~readbackQueue()
+{
+	// callbacks of copies still in flight are dropped, their owners are going away with the renderer
+	slices.clear();
+	completed.clear();
+}
+
+void readbackQueue::begin_frame(const u32 frame_slot)
+{
+	CPU_ZONE("readbackQueue::begin_frame");
+	ASSERT(frame_slot < slices.size());
+	// everything recorded so far belongs to the frames before this one
+	slices[current].last_id = next_id;
+	current = frame_slot;
+	resolve(slices[current]);
+}
+
+void readbackQueue::resolve(slice& s)
+{
+	if (!s.requests.empty())
+	{
+		max_slice_bytes = std::max(max_slice_bytes, s.used);
+		if (s.used > 0)
+			s.buffer->invalidate(0, s.used);
+		const u8* ring = s.buffer ? static_cast<const u8*>(s.buffer->map()) : nullptr;
+
+		for (request& r : s.requests)
+		{
+			const u8* p = nullptr;
+			if (r.overflow)
+			{
+				r.overflow->invalidate(0, r.bytes);
+				p = static_cast<const u8*>(r.overflow->map());
+			}
+			else
+			{
+				p = ring + r.offset;
+			}
+
+			if (r.callback)
+				r.callback(std::span<const u8>(p, r.bytes));
+			else
+				completed[r.id].assign(p, p + r.bytes);
+		}
+		s.requests.clear();
+	}
+	s.used = 0;
+	resolved_id = std::max(resolved_id, s.last_id);
+}
+
+rhiBuffer* readbackQueue::reserve(request& r, const u64 bytes, const u64 alignment)
+{
+	slice& s = slices[current];
+	const u64 offset = align_up(s.used, alignment);
+	if (offset + bytes > slice_bytes)
+	{
+		// larger than what is left, e.g. a screenshot, gets its own buffer for one round trip
+		r.overflow = context->create_buffer(rhiBufferDesc
+			{
+				.size = bytes,
+				.usage = rhiBufferUsage::transfer_dst,
+				.memory = rhiMem::auto_readback
+			});
+		++overflow_count;
+		return r.overflow.get();
+	}
+
+	if (!s.buffer)
+	{
+		s.buffer = context->create_buffer(rhiBufferDesc
+			{
+				.size = slice_bytes,
+				.usage = rhiBufferUsage::transfer_dst,
+				.memory = rhiMem::auto_readback
+			});
+	}
+	r.offset = offset;
+	s.used = offset + bytes;
+	return s.buffer.get();
+}
+
+u64 readbackQueue::enqueue(rhiCommandList* cmd, rhiBuffer* src, const u64 src_offset, const u64 bytes, readbackCallback callback)
+{
+	CPU_ZONE("readbackQueue::enqueue");
+	ASSERT(cmd && src && bytes > 0);
+	ASSERT(src_offset + bytes <= src->size());
+
+	request r{
+		.bytes = bytes,
+		.callback = std::move(callback)
+	};
+	rhiBuffer* dst = reserve(r, bytes, 16);
+
+	cmd->buffer_barrier(src, rhiBufferBarrierDescription{
+		.src_stage = rhiPipelineStage::all_commands,
+		.dst_stage = rhiPipelineStage::copy,
+		.src_access = rhiAccessFlags::memory_write,
+		.dst_access = rhiAccessFlags::transfer_read,
+		.offset = static_cast<u32>(src_offset),
+		.size = bytes
+		});
+	cmd->copy_buffer(src, static_cast<u32>(src_offset), dst, static_cast<u32>(r.offset), bytes);
+	make_host_visible(cmd, dst, r.offset, bytes);
+
+	r.id = ++next_id;
+	slices[current].requests.push_back(std::move(r));
+	read_bytes += bytes;
+	++request_count;
+	return next_id;
+}
+
+u64 readbackQueue::enqueue(rhiCommandList* cmd, rhiTexture* src, const rhiImageLayout layout, const rhiBufferImageCopy& region, readbackCallback callback)
+{
+	CPU_ZONE("readbackQueue::enqueue");
+	ASSERT(cmd && src);
+	const rhiImageSubresourceLayers& sub = region.imageSubresource;
+	const u64 texel = texel_bytes(src->desc.format, sub.aspect);
+	const u64 bytes = static_cast<u64>(region.image_extent.x) * region.image_extent.y * region.image_extent.z * sub.layer_count * texel;
+	ASSERT(bytes > 0);
+
+	request r{
+		.bytes = bytes,
+		.callback = std::move(callback)
+	};
+	// buffer offsets of image copies are texel aligned, rgb32 is the only size 256 does not cover
+	rhiBuffer* dst = reserve(r, bytes, std::lcm<u64>(256, texel));
+
+	rhiBufferImageCopy copy = region;
+	copy.buffer_offset = r.offset;
+	copy.buffer_rowlength = 0;
+	copy.buffer_imageheight = 0;
+
+	// the last writer is unknown, e.g. a swapchain image already handed to present
+	cmd->image_barrier(src, rhiImageBarrierDescription{
+		.src_stage = rhiPipelineStage::all_commands,
+		.dst_stage = rhiPipelineStage::copy,
+		.src_access = rhiAccessFlags::memory_write,
+		.dst_access = rhiAccessFlags::transfer_read,
+		.old_layout = layout,
+		.new_layout = rhiImageLayout::transfer_src,
+		.base_mip = sub.mip_level,
+		.level_count = 1,
+		.base_layer = sub.base_array_layer,
+		.layer_count = sub.layer_count
+		});
+	cmd->copy_image_to_buffer(src, rhiImageLayout::transfer_src, dst, std::span<const rhiBufferImageCopy>(&copy, 1));
+	make_host_visible(cmd, dst, r.offset, bytes);
+	cmd->image_barrier(src, rhiImageBarrierDescription{
+		.src_stage = rhiPipelineStage::copy,
+		.dst_stage = rhiPipelineStage::all_commands,
+		.src_access = rhiAccessFlags::transfer_read,
+		.dst_access = rhiAccessFlags::memory_read | rhiAccessFlags::memory_write,
+		.old_layout = rhiImageLayout::transfer_src,
+		.new_layout = layout,
+		.base_mip = sub.mip_level,
+		.level_count = 1,
+		.base_layer = sub.base_array_layer,
+		.layer_count = sub.layer_count
+		});
+
+	r.id = ++next_id;
+	slices[current].requests.push_back(std::move(r));
+	read_bytes += bytes;
+	++request_count;
+	return next_id;
+}
+
+bool readbackQueue::poll(const u64 id, std::vector<u8>& out)
+{
+	if (!is_ready(id))
+		return false;
+
+	auto it = completed.find(id);
+	if (it == completed.end())
+		return false;
+	out = std::move(it->second);
+	completed.erase(it);
+	return true;
+}
+
+void readbackQueue::report() const
+{
+	if (request_count == 0)
+		return;
+
+	std::cout << std::format("[readbackQueue] {} reads, {:.2f} MB, {} over the {:.1f} MB slice, busiest slice {:.2f} MB, {} unpolled\n",
+		request_count, read_bytes / (1024.0 * 1024.0), overflow_count,
+		slice_bytes / (1024.0 * 1024.0), max_slice_bytes / (1024.0 * 1024.0), completed.size());
+}
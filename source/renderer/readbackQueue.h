@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDefs.h"
+#include "rhi/rhiTextureView.h"
+#include <functional>
+
+class rhiDeviceContext;
+class rhiCommandList;
+class rhiBuffer;
+class rhiTexture;
+
+// bytes are only valid during the call, copy what has to outlive it
+using readbackCallback = std::function<void(std::span<const u8> bytes)>;
+
+// gpu to cpu copies without a stall. every frame slot owns a host-cached slice, a copy recorded
+// into the frame's list lands there and is handed out once the slot comes around again,
+// i.e. frames_in_flight frames later, right after its fence has signaled
+class readbackQueue
+{
+public:
+	static constexpr u64 default_slice_bytes = 4ull << 20;
+
+	readbackQueue(rhiDeviceContext* context, const u32 frames_in_flight, const u64 slice_bytes = default_slice_bytes);
+	~readbackQueue();
+
+public:
+	// once per frame after the slot's fence wait, runs the callbacks of what the slot recorded last time
+	void begin_frame(const u32 frame_slot);
+
+	// src is made visible to the copy, whatever wrote it. returns the id is_ready() and poll() answer for
+	u64 enqueue(rhiCommandList* cmd, rhiBuffer* src, const u64 src_offset, const u64 bytes, readbackCallback callback = {});
+	// one region, tightly packed. the texture is back in layout once the copy is recorded
+	u64 enqueue(rhiCommandList* cmd, rhiTexture* src, const rhiImageLayout layout, const rhiBufferImageCopy& region, readbackCallback callback = {});
+
+	bool is_ready(const u64 id) const { return id <= resolved_id; }
+	// results without a callback are held until polled, false while the copy is in flight
+	bool poll(const u64 id, std::vector<u8>& out);
+
+	u64 get_read_bytes() const { return read_bytes; }
+	u64 get_request_count() const { return request_count; }
+	void report() const;
+
+private:
+	struct request
+	{
+		u64 id = 0;
+		u64 offset = 0;
+		u64 bytes = 0;
+		// set when the slice had no room left, lives as long as the slice's copies
+		std::unique_ptr<rhiBuffer> overflow;
+		readbackCallback callback;
+	};
+
+	struct slice
+	{
+		std::unique_ptr<rhiBuffer> buffer;
+		u64 used = 0;
+		// ids up to this one were recorded before the slot's frame ended
+		u64 last_id = 0;
+		std::vector<request> requests;
+	};
+
+	// the destination for bytes in the current slice, or a dedicated buffer when it does not fit
+	rhiBuffer* reserve(request& r, const u64 bytes, const u64 alignment);
+	void resolve(slice& s);
+
+private:
+	rhiDeviceContext* context = nullptr;
+	u64 slice_bytes = default_slice_bytes;
+
+	std::vector<slice> slices;
+	u32 current = 0;
+	u64 next_id = 0;
+	u64 resolved_id = 0;
+	std::unordered_map<u64, std::vector<u8>> completed;
+
+	u64 read_bytes = 0;
+	u64 request_count = 0;
+	u64 overflow_count = 0;
+	u64 max_slice_bytes = 0;
+};
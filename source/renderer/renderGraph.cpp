@@ -0,0 +1,574 @@
+﻿#include "renderGraph.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiCommandList.h"
+#include "rhi/rhiSynchroize.h"
+#include "util/cpuProfiler.h"
+#include <numeric>
+
+namespace
+{
+    constexpr u32 write_access_mask =
+        static_cast<u32>(rhiAccessFlags::shader_write) |
+        static_cast<u32>(rhiAccessFlags::color_attachment_write) |
+        static_cast<u32>(rhiAccessFlags::depthstencil_attachment_write) |
+        static_cast<u32>(rhiAccessFlags::transfer_write) |
+        static_cast<u32>(rhiAccessFlags::host_write) |
+        static_cast<u32>(rhiAccessFlags::memory_write) |
+        static_cast<u32>(rhiAccessFlags::shader_storage_write);
+
+    bool has_write(const rhiAccessFlags access)
+    {
+        return (static_cast<u32>(access) & write_access_mask) != 0;
+    }
+
+    rgState required_state(const rgAccess access, const bool write)
+    {
+        switch (access)
+        {
+        case rgAccess::color_attachment:
+            return { rhiImageLayout::color_attachment, rhiPipelineStage::color_attachment_output,
+                write ? rhiAccessFlags::color_attachment_read | rhiAccessFlags::color_attachment_write : rhiAccessFlags::color_attachment_read };
+        case rgAccess::depth_attachment:
+            return { write ? rhiImageLayout::depth_stencil_attachment : rhiImageLayout::depth_readonly, rhiPipelineStage::early_fragment_test | rhiPipelineStage::late_fragment_test,
+                write ? rhiAccessFlags::depthstencil_attachment_read | rhiAccessFlags::depthstencil_attachment_write : rhiAccessFlags::depthstencil_attachment_read };
+        case rgAccess::sampled:
+            return { rhiImageLayout::shader_readonly, rhiPipelineStage::fragment_shader | rhiPipelineStage::compute_shader,
+                rhiAccessFlags::shader_sampled_read | rhiAccessFlags::shader_read };
+        case rgAccess::storage:
+            return { rhiImageLayout::general, rhiPipelineStage::compute_shader,
+                write ? rhiAccessFlags::shader_storage_read | rhiAccessFlags::shader_storage_write : rhiAccessFlags::shader_storage_read };
+        }
+        return {};
+    }
+
+    bool same_desc(const rhiTextureDesc& a, const rhiTextureDesc& b)
+    {
+        return a.width == b.width && a.height == b.height && a.layers == b.layers && a.mips == b.mips
+            && a.format == b.format && a.samples == b.samples && a.usage == b.usage
+            && a.is_depth == b.is_depth && a.is_separate_depth_stencil == b.is_separate_depth_stencil;
+    }
+
+    u64 hash_desc(u64 h, const rhiTextureDesc& desc)
+    {
+        h = hash_combine(h, desc.width);
+        h = hash_combine(h, desc.height);
+        h = hash_combine(h, desc.layers);
+        h = hash_combine(h, desc.mips);
+        h = hash_combine(h, desc.format);
+        h = hash_combine(h, desc.samples);
+        h = hash_combine(h, desc.usage);
+        h = hash_combine(h, desc.is_depth);
+        h = hash_combine(h, desc.is_separate_depth_stencil);
+        return h;
+    }
+
+    u64 align_up(const u64 value, const u64 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+rgTexture renderGraph::builder::create(std::string_view name, const rhiTextureDesc& desc)
+{
+    return graph->create(name, desc);
+}
+
+rgTexture renderGraph::builder::read(const rgTexture texture, const rgAccess access)
+{
+    ASSERT(texture.valid());
+    graph->passes[pass_index].uses.push_back({ texture.index, access, false });
+    return texture;
+}
+
+rgTexture renderGraph::builder::write(const rgTexture texture, const rgAccess access)
+{
+    ASSERT(texture.valid());
+    graph->passes[pass_index].uses.push_back({ texture.index, access, true });
+    return texture;
+}
+
+void renderGraph::builder::side_effect()
+{
+    graph->passes[pass_index].side_effect = true;
+}
+
+void renderGraph::builder::async_compute()
+{
+    graph->passes[pass_index].async_compute = true;
+}
+
+void renderGraph::builder::wait_async_compute()
+{
+    graph->passes[pass_index].waits_async_compute = true;
+}
+
+renderGraph::renderGraph(rhiDeviceContext* context, const u32 frames_in_flight)
+    : context(context), frames_in_flight(frames_in_flight)
+{
+}
+
+renderGraph::~renderGraph()
+{
+    release_transients();
+    retired.clear();
+}
+
+void renderGraph::begin_frame()
+{
+    passes.clear();
+    textures.clear();
+    compiled = false;
+
+    // the gpu finished with these once the in-flight frames went around
+    std::erase_if(retired, [](retiredTransients& r) { return r.frames_left-- == 0; });
+}
+
+rgTexture renderGraph::create(std::string_view name, const rhiTextureDesc& desc)
+{
+    textures.push_back(virtualTexture{ .name = std::string(name), .desc = desc });
+    return rgTexture{ static_cast<u32>(textures.size() - 1) };
+}
+
+rgTexture renderGraph::import(std::string_view name, rhiTexture* texture, std::optional<rhiImageLayout> final_layout)
+{
+    ASSERT(texture);
+    // presented images come back through the acquire semaphore, which waits at color output
+    if (final_layout.has_value())
+        imported_states.try_emplace(texture, rgState{ .stage = rhiPipelineStage::color_attachment_output });
+    textures.push_back(virtualTexture{
+        .name = std::string(name),
+        .desc = texture->desc,
+        .imported = texture,
+        .final_layout = final_layout
+        });
+    return rgTexture{ static_cast<u32>(textures.size() - 1) };
+}
+
+void renderGraph::add_pass(const char* name, const std::function<void(builder&)>& setup, std::function<void(rhiCommandList*)> execute)
+{
+    passes.push_back(pass{ .name = name, .execute = std::move(execute) });
+    builder b(this, static_cast<u32>(passes.size() - 1));
+    setup(b);
+}
+
+void renderGraph::compile()
+{
+    CPU_ZONE("renderGraph::compile");
+    cull();
+
+    for (auto& t : textures)
+    {
+        t.first_pass = ~0u;
+        t.last_pass = 0;
+    }
+    for (u32 index = 0; index < passes.size(); ++index)
+    {
+        if (passes[index].culled)
+            continue;
+        for (const textureUse& use : passes[index].uses)
+        {
+            virtualTexture& t = textures[use.texture];
+            t.first_pass = std::min(t.first_pass, index);
+            t.last_pass = std::max(t.last_pass, index);
+        }
+    }
+
+    allocate_transients();
+    stats.passes = static_cast<u32>(passes.size());
+    stats.culled = static_cast<u32>(std::ranges::count_if(passes, [](const pass& p) { return p.culled; }));
+    compiled = true;
+}
+
+void renderGraph::cull()
+{
+    // a transient read before anything wrote it has no content, its reader goes
+    std::vector<bool> written(textures.size(), false);
+    for (pass& p : passes)
+    {
+        p.culled = std::ranges::any_of(p.uses, [&](const textureUse& use)
+            {
+                return !use.write && !textures[use.texture].imported && !written[use.texture];
+            });
+        if (p.culled)
+            continue;
+        for (const textureUse& use : p.uses)
+        {
+            if (use.write)
+                written[use.texture] = true;
+        }
+    }
+
+    // back to front : a pass stays if it has side effects, writes an imported texture or feeds a kept pass
+    std::vector<bool> needed(textures.size(), false);
+    for (auto it = passes.rbegin(); it != passes.rend(); ++it)
+    {
+        pass& p = *it;
+        if (p.culled)
+            continue;
+
+        const bool used = p.side_effect || std::ranges::any_of(p.uses, [&](const textureUse& use)
+            {
+                return use.write && (textures[use.texture].imported || needed[use.texture]);
+            });
+        if (!used)
+        {
+            p.culled = true;
+            continue;
+        }
+        // attachments may load, earlier writers of the same texture stay as well
+        for (const textureUse& use : p.uses)
+            needed[use.texture] = true;
+    }
+}
+
+void renderGraph::allocate_transients()
+{
+    std::vector<u32> transients;
+    u64 signature = 1469598103934665603ull;
+    for (u32 index = 0; index < textures.size(); ++index)
+    {
+        const virtualTexture& t = textures[index];
+        if (t.imported || t.first_pass == ~0u)
+            continue;
+        transients.push_back(index);
+        signature = hash_desc(signature, t.desc);
+        signature = hash_combine(signature, t.first_pass);
+        signature = hash_combine(signature, t.last_pass);
+    }
+
+    if (signature != transient_signature)
+    {
+        retire_transients();
+        transient_signature = signature;
+        transient_physicals.clear();
+        if (transients.empty())
+        {
+            stats.transients = 0;
+            stats.transient_bytes = 0;
+            stats.heap_bytes = 0;
+            return;
+        }
+
+        std::vector<rhiMemoryRequirements> requirements;
+        requirements.reserve(transients.size());
+        u32 type_bits = ~0u;
+        bool placeable = true;
+        for (const u32 index : transients)
+        {
+            requirements.push_back(context->get_memory_requirements(textures[index].desc));
+            type_bits &= requirements.back().type_bits;
+            placeable &= requirements.back().size > 0;
+        }
+        placeable &= type_bits != 0;
+
+        stats.transients = static_cast<u32>(transients.size());
+        stats.transient_bytes = 0;
+        stats.heap_bytes = 0;
+
+        if (placeable)
+        {
+            // largest first, each at the lowest offset free for its whole lifetime
+            std::vector<u32> order(transients.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::ranges::sort(order, [&](const u32 a, const u32 b) { return requirements[a].size > requirements[b].size; });
+
+            physicals.resize(transients.size());
+            u64 heap_size = 0;
+            u64 alignment = 1;
+            std::vector<u32> placed;
+            for (const u32 slot : order)
+            {
+                const virtualTexture& t = textures[transients[slot]];
+                const rhiMemoryRequirements& req = requirements[slot];
+
+                std::vector<const physicalTexture*> live;
+                for (const u32 other : placed)
+                {
+                    const physicalTexture& p = physicals[other];
+                    if (p.first_pass <= t.last_pass && t.first_pass <= p.last_pass)
+                        live.push_back(&p);
+                }
+                std::ranges::sort(live, {}, &physicalTexture::offset);
+
+                u64 offset = 0;
+                for (const physicalTexture* p : live)
+                {
+                    if (offset + req.size <= p->offset)
+                        break;
+                    offset = std::max(offset, align_up(p->offset + p->size, req.alignment));
+                }
+
+                physicals[slot] = physicalTexture{
+                    .desc = t.desc,
+                    .offset = offset,
+                    .size = req.size,
+                    .first_pass = t.first_pass,
+                    .last_pass = t.last_pass
+                };
+                placed.push_back(slot);
+                heap_size = std::max(heap_size, offset + req.size);
+                alignment = std::max(alignment, req.alignment);
+                stats.transient_bytes += req.size;
+            }
+
+            heap = context->create_memory_heap({ .size = heap_size, .alignment = alignment, .type_bits = type_bits });
+            for (physicalTexture& p : physicals)
+                p.texture = context->create_placed_texture(p.desc, heap.get(), p.offset);
+            for (u32 slot = 0; slot < transients.size(); ++slot)
+                textures[transients[slot]].physical = slot;
+            stats.heap_bytes = heap_size;
+        }
+        else
+        {
+            // no placement support : textures with the same desc and disjoint lifetimes share one allocation
+            for (const u32 index : transients)
+            {
+                virtualTexture& t = textures[index];
+                const u64 bytes = rhiTextureImage{ .desc = t.desc }.byte_size();
+                stats.transient_bytes += bytes;
+
+                auto it = std::ranges::find_if(physicals, [&](const physicalTexture& p)
+                    {
+                        return same_desc(p.desc, t.desc) && p.last_pass < t.first_pass;
+                    });
+                if (it == physicals.end())
+                {
+                    physicals.push_back(physicalTexture{
+                        .desc = t.desc,
+                        .texture = context->create_texture(t.desc),
+                        .size = bytes,
+                        .first_pass = t.first_pass
+                        });
+                    it = std::prev(physicals.end());
+                    stats.heap_bytes += bytes;
+                }
+                it->last_pass = t.last_pass;
+                t.physical = static_cast<u32>(std::distance(physicals.begin(), it));
+            }
+        }
+
+        std::cout << std::format("[renderGraph] {} passes ({} culled), {} transients {:.1f} MB in {:.1f} MB{}\n",
+            passes.size(), std::ranges::count_if(passes, [](const pass& p) { return p.culled; }),
+            stats.transients, stats.transient_bytes / (1024.0 * 1024.0), stats.heap_bytes / (1024.0 * 1024.0),
+            placeable ? " aliased" : "");
+        transient_physicals.reserve(transients.size());
+        for (const u32 index : transients)
+            transient_physicals.push_back(textures[index].physical);
+        return;
+    }
+
+    // same transients as last frame, the signature guarantees the same lifetimes : reuse the mapping as built.
+    // searching again could fold a short lifetime into a longer one that is still live
+    ASSERT(transient_physicals.size() == transients.size());
+    for (u32 slot = 0; slot < transients.size(); ++slot)
+        textures[transients[slot]].physical = transient_physicals[slot];
+}
+
+void renderGraph::execute(rhiCommandList* cmd, rhiCommandList* compute, const std::function<rhiCommandList*()>& join)
+{
+    CPU_ZONE("renderGraph::execute");
+    ASSERT(compiled);
+    stats.barriers = 0;
+    stats.async_passes = 0;
+
+    const bool split = compute && compute != cmd && join;
+    std::vector<bool> graphics_used(textures.size(), false);
+    // written on compute and not handed to graphics yet
+    std::vector<bool> on_compute(textures.size(), false);
+    bool async_pending = false;
+
+    for (u32 index = 0; index < passes.size(); ++index)
+    {
+        pass& p = passes[index];
+        if (p.culled)
+            continue;
+
+        const bool async = split && p.async_compute && can_run_async(p, graphics_used);
+        if (!async && async_pending)
+        {
+            const bool consumes = p.waits_async_compute || std::ranges::any_of(p.uses, [&](const textureUse& use) { return on_compute[use.texture]; });
+            if (consumes)
+            {
+                // everything recorded so far overlaps the compute work
+                cmd = join();
+                async_pending = false;
+            }
+        }
+
+        rhiCommandList* pass_cmd = async ? compute : cmd;
+        for (const textureUse& use : p.uses)
+        {
+            const virtualTexture& t = textures[use.texture];
+            // first use of a transient this frame : contents are discarded, wait on whoever used the memory last
+            if (!t.imported && t.first_pass == index)
+                physicals[t.physical].state = aliasing_state(t.physical);
+            if (on_compute[use.texture] && !async)
+            {
+                hand_over(compute, cmd, use.texture, required_state(use.access, use.write));
+                on_compute[use.texture] = false;
+            }
+            else
+                transition(pass_cmd, use.texture, required_state(use.access, use.write));
+
+            if (async)
+                on_compute[use.texture] = true;
+            else
+                graphics_used[use.texture] = true;
+        }
+        if (async)
+        {
+            async_pending = true;
+            ++stats.async_passes;
+        }
+
+        CPU_ZONE(p.name);
+        p.execute(pass_cmd);
+    }
+
+    for (u32 index = 0; index < textures.size(); ++index)
+    {
+        const virtualTexture& t = textures[index];
+        if (!t.imported || !t.final_layout.has_value())
+            continue;
+        transition(cmd, index, rgState{ .layout = t.final_layout.value() });
+        state_of(index).stage = rhiPipelineStage::color_attachment_output;
+    }
+}
+
+void renderGraph::release_transients()
+{
+    physicals.clear();
+    transient_physicals.clear();
+    heap.reset();
+    transient_signature = 0;
+}
+
+rhiTexture* renderGraph::get(const rgTexture texture) const
+{
+    ASSERT(texture.valid() && texture.index < textures.size());
+    const virtualTexture& t = textures[texture.index];
+    if (t.imported)
+        return t.imported;
+    return t.physical < physicals.size() ? physicals[t.physical].texture.get() : nullptr;
+}
+
+void renderGraph::transition(rhiCommandList* cmd, const u32 texture, const rgState& next)
+{
+    rgState& current = state_of(texture);
+    // read after read in the same layout, widen the stages the next writer waits on
+    if (current.layout == next.layout && !has_write(current.access) && !has_write(next.access))
+    {
+        current.stage = current.stage | next.stage;
+        current.access = current.access | next.access;
+        return;
+    }
+
+    cmd->image_barrier(get(rgTexture{ texture }), rhiImageBarrierDescription{
+        .src_stage = current.stage,
+        .dst_stage = next.stage,
+        .src_access = current.access,
+        .dst_access = next.access,
+        .old_layout = current.layout,
+        .new_layout = next.layout,
+        .level_count = 0,
+        .layer_count = 0
+        });
+    ++stats.barriers;
+    current = next;
+}
+
+void renderGraph::hand_over(rhiCommandList* compute, rhiCommandList* graphics, const u32 texture, const rgState& next)
+{
+    rgState& current = state_of(texture);
+    rhiTexture* tex = get(rgTexture{ texture });
+    const u32 compute_family = context->get_queue_family_index(rhiQueueType::compute);
+    const u32 graphics_family = context->get_queue_family_index(rhiQueueType::graphics);
+
+    // both halves carry the same layout change, it happens once
+    compute->image_barrier(tex, rhiImageBarrierDescription{
+        .src_stage = current.stage,
+        .dst_stage = rhiPipelineStage::none,
+        .src_access = current.access,
+        .dst_access = rhiAccessFlags::none,
+        .old_layout = current.layout,
+        .new_layout = next.layout,
+        .src_queue = compute_family,
+        .dst_queue = graphics_family,
+        .level_count = 0,
+        .layer_count = 0
+        });
+    graphics->image_barrier(tex, rhiImageBarrierDescription{
+        .src_stage = rhiPipelineStage::none,
+        .dst_stage = next.stage,
+        .src_access = rhiAccessFlags::none,
+        .dst_access = next.access,
+        .old_layout = current.layout,
+        .new_layout = next.layout,
+        .src_queue = compute_family,
+        .dst_queue = graphics_family,
+        .level_count = 0,
+        .layer_count = 0
+        });
+    stats.barriers += 2;
+    current = next;
+}
+
+bool renderGraph::can_run_async(const pass& p, const std::vector<bool>& graphics_used) const
+{
+    // imported and graphics-touched textures are owned by graphics, aliased memory may be in use by a
+    // graphics pass that runs at the same time on the other queue
+    return std::ranges::none_of(p.uses, [&](const textureUse& use)
+        {
+            const virtualTexture& t = textures[use.texture];
+            if (t.imported || graphics_used[use.texture])
+                return true;
+
+            const physicalTexture& self = physicals[t.physical];
+            for (u32 other = 0; other < physicals.size(); ++other)
+            {
+                const physicalTexture& o = physicals[other];
+                if (other == t.physical)
+                    continue;
+                if (heap && o.offset < self.offset + self.size && self.offset < o.offset + o.size)
+                    return true;
+            }
+            // without placement a physical is shared by textures with the same desc
+            return std::ranges::count(textures, t.physical, &virtualTexture::physical) > 1;
+        });
+}
+
+rgState& renderGraph::state_of(const u32 texture)
+{
+    const virtualTexture& t = textures[texture];
+    if (t.imported)
+        return imported_states[t.imported];
+    return physicals[t.physical].state;
+}
+
+rgState renderGraph::aliasing_state(const u32 physical) const
+{
+    const physicalTexture& self = physicals[physical];
+    rgState state{ .layout = rhiImageLayout::undefined };
+    for (const physicalTexture& p : physicals)
+    {
+        const bool overlaps = &p == &self || (heap && p.offset < self.offset + self.size && self.offset < p.offset + p.size);
+        if (!overlaps)
+            continue;
+        state.stage = state.stage | p.state.stage;
+        state.access = state.access | p.state.access;
+    }
+    return state;
+}
+
+void renderGraph::retire_transients()
+{
+    if (physicals.empty() && !heap)
+        return;
+    retired.push_back(retiredTransients{
+        .textures = std::move(physicals),
+        .heap = std::move(heap),
+        .frames_left = frames_in_flight
+        });
+    physicals.clear();
+    transient_signature = 0;
+}
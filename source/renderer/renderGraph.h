@@ -0,0 +1,176 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDefs.h"
+#include "rhi/rhiTextureView.h"
+#include <functional>
+
+class rhiDeviceContext;
+class rhiCommandList;
+class rhiMemoryHeap;
+
+// virtual texture, valid for the frame it was declared in
+struct rgTexture
+{
+	u32 index = ~0u;
+	bool valid() const { return index != ~0u; }
+};
+
+// how a pass touches a texture, picks the layout, stages and access of the barrier into the pass
+enum class rgAccess : u8
+{
+	color_attachment,
+	depth_attachment,
+	sampled,
+	storage
+};
+
+struct rgState
+{
+	rhiImageLayout layout = rhiImageLayout::undefined;
+	rhiPipelineStage stage = rhiPipelineStage::none;
+	rhiAccessFlags access = rhiAccessFlags::none;
+};
+
+struct renderGraphStats
+{
+	u32 passes = 0;
+	u32 culled = 0;
+	u32 async_passes = 0; // recorded on the compute family
+	u32 barriers = 0;
+	u32 transients = 0;
+	u64 transient_bytes = 0; // sum of the transient textures
+	u64 heap_bytes = 0; // after aliasing
+};
+
+// rebuilt every frame : passes declare what they read and write, compile culls unused passes and
+// places transient textures, execute records the passes in declaration order with the barriers between them
+class renderGraph
+{
+private:
+	struct textureUse
+	{
+		u32 texture;
+		rgAccess access;
+		bool write;
+	};
+
+	struct pass
+	{
+		const char* name; // string literal, also the cpu zone
+		std::vector<textureUse> uses;
+		std::function<void(rhiCommandList*)> execute;
+		bool side_effect = false;
+		bool culled = false;
+		bool async_compute = false;
+		bool waits_async_compute = false;
+	};
+
+	struct virtualTexture
+	{
+		std::string name;
+		rhiTextureDesc desc;
+		rhiTexture* imported = nullptr;
+		std::optional<rhiImageLayout> final_layout;
+		u32 physical = ~0u;
+		u32 first_pass = ~0u;
+		u32 last_pass = 0;
+	};
+
+	// transient storage, kept across frames while the declared transients stay the same
+	struct physicalTexture
+	{
+		rhiTextureDesc desc;
+		std::unique_ptr<rhiTexture> texture;
+		u64 offset = 0;
+		u64 size = 0;
+		u32 first_pass = 0;
+		u32 last_pass = 0;
+		rgState state;
+	};
+
+	struct retiredTransients
+	{
+		std::vector<physicalTexture> textures;
+		std::unique_ptr<rhiMemoryHeap> heap;
+		u32 frames_left;
+	};
+
+public:
+	class builder
+	{
+	public:
+		rgTexture create(std::string_view name, const rhiTextureDesc& desc);
+		rgTexture read(const rgTexture texture, const rgAccess access = rgAccess::sampled);
+		rgTexture write(const rgTexture texture, const rgAccess access);
+		// kept even when nothing reads its outputs
+		void side_effect();
+		// dispatch only pass that may run on the compute family, overlapping the graphics passes before its consumer.
+		// stays on graphics when it touches a texture graphics used this frame or an imported one
+		void async_compute();
+		// consumes async compute output the graph does not track, e.g. ibl maps
+		void wait_async_compute();
+
+	private:
+		friend class renderGraph;
+		builder(renderGraph* graph, const u32 pass_index) : graph(graph), pass_index(pass_index) {}
+
+		renderGraph* graph;
+		u32 pass_index;
+	};
+
+public:
+	renderGraph(rhiDeviceContext* context, const u32 frames_in_flight);
+	~renderGraph();
+
+public:
+	void begin_frame();
+	// transient texture, placed in memory shared with transients whose lifetimes do not overlap
+	rgTexture create(std::string_view name, const rhiTextureDesc& desc);
+	// external textures keep their state across frames, final_layout is applied after the last pass
+	rgTexture import(std::string_view name, rhiTexture* texture, std::optional<rhiImageLayout> final_layout = std::nullopt);
+	void add_pass(const char* name, const std::function<void(builder&)>& setup, std::function<void(rhiCommandList*)> execute);
+	void compile();
+	// async compute passes record on compute, graphics from their first consumer on records on what join returns.
+	// no compute list, or the graphics list itself when the families are shared : everything records on cmd
+	void execute(rhiCommandList* cmd, rhiCommandList* compute = nullptr, const std::function<rhiCommandList*()>& join = {});
+	// drops the transients, e.g. before a resize
+	void release_transients();
+	// imported textures were recreated, e.g. the swapchain after a resize
+	void forget_imports() { imported_states.clear(); }
+
+	// valid while the passes execute
+	rhiTexture* get(const rgTexture texture) const;
+	const renderGraphStats& get_stats() const { return stats; }
+
+private:
+	void cull();
+	void allocate_transients();
+	void transition(rhiCommandList* cmd, const u32 texture, const rgState& next);
+	// released on compute, acquired on graphics
+	void hand_over(rhiCommandList* compute, rhiCommandList* graphics, const u32 texture, const rgState& next);
+	bool can_run_async(const pass& p, const std::vector<bool>& graphics_used) const;
+	rgState& state_of(const u32 texture);
+	rgState aliasing_state(const u32 physical) const;
+	void retire_transients();
+
+private:
+	rhiDeviceContext* context;
+	u32 frames_in_flight;
+
+	std::vector<pass> passes;
+	std::vector<virtualTexture> textures;
+
+	std::vector<physicalTexture> physicals;
+	// physical slot of each transient in declaration order, as chosen when the layout was built
+	std::vector<u32> transient_physicals;
+	std::unique_ptr<rhiMemoryHeap> heap;
+	u64 transient_signature = 0;
+	std::vector<retiredTransients> retired;
+
+	// imported textures are tracked across frames
+	std::unordered_map<rhiTexture*, rgState> imported_states;
+
+	renderGraphStats stats;
+	bool compiled = false;
+};
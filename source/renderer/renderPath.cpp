@@ -0,0 +1,58 @@
+﻿#include "renderPath.h"
+#include "gbufferPass.h"
+#include "gbufferPass_meshlet.h"
+#include "rhi/rhiTextureView.h"
+#include "util/text.h"
+
+std::string_view to_string(const geometryPath path)
+{
+	switch (path)
+	{
+	case geometryPath::indexed:
+		return "indexed";
+	case geometryPath::meshlet:
+		return "meshlet";
+	}
+	return "unknown";
+}
+
+renderPathConfig renderPathConfig::from_args(const std::vector<std::string_view>& args)
+{
+	renderPathConfig config;
+	for (const std::string_view arg : args)
+	{
+		if (arg == "--geometry=indexed")
+			config.geometry = geometryPath::indexed;
+		else if (arg == "--geometry=meshlet")
+			config.geometry = geometryPath::meshlet;
+		else if (arg == "--shadows=on")
+			config.shadows = true;
+		else if (arg == "--shadows=off")
+			config.shadows = false;
+		else if (arg == "--sky-hdr=procedural")
+			config.sky_hdr = rhiTexture::procedural_sky;
+		else if (arg.starts_with("--sky-hdr="))
+			config.sky_hdr = arg.substr(std::string_view("--sky-hdr=").size());
+		else
+			read_arg(arg, "--dynamic-sky=", config.sky_mips_per_frame);
+	}
+	return config;
+}
+
+void indexedGeometry::render(renderShared* rs, rhiBuffer* global_buffer, const gbufferTargets& targets)
+{
+	pass->set_targets({ targets.a, targets.b, targets.c }, targets.depth);
+	pass->update(rs, global_buffer);
+	pass->render(rs);
+}
+
+void meshletGeometry::render(renderShared* rs, rhiBuffer* global_buffer, const gbufferTargets& targets)
+{
+	pass->set_targets({ targets.a, targets.b, targets.c }, targets.depth);
+	meshletDrawUpdateContext context{
+		.global_buf = global_buffer,
+		.meshlet_buf = meshlet_ssbo
+	};
+	pass->update(&context);
+	pass->render(rs);
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+
+#include "pch.h"
+
+class rhiBuffer;
+class rhiTexture;
+class renderShared;
+class gbufferPass;
+class gbufferPass_meshlet;
+struct meshletBuffer;
+
+enum class geometryPath : u8
+{
+	indexed = 0,
+	meshlet = 1,
+	count
+};
+constexpr u32 geometry_path_count = static_cast<u32>(geometryPath::count);
+std::string_view to_string(const geometryPath path);
+
+// render path toggles, switchable between frames
+struct renderPathConfig
+{
+	geometryPath geometry = MESHLET ? geometryPath::meshlet : geometryPath::indexed;
+	bool shadows = true;
+	// dynamic sky : the ibl is re-prefiltered over and over, this many specular mips per frame. 0 = static sky
+	u32 sky_mips_per_frame = 0;
+	// read once by the first frame. empty = the default sky under the asset root, rhiTexture::procedural_sky = generated
+	std::string sky_hdr;
+
+	// --geometry=indexed|meshlet --shadows=on|off --dynamic-sky=N --sky-hdr=file|procedural
+	static renderPathConfig from_args(const std::vector<std::string_view>& args);
+	bool operator==(const renderPathConfig&) const = default;
+};
+
+// per path accumulation for A/B runs on identical content, gpu time comes from the profiler zone
+struct renderPathStats
+{
+	u32 frames = 0;
+	f64 cpu_ms = 0.0;
+};
+
+// render graph transients, bound to the geometry pass every frame
+struct gbufferTargets
+{
+	rhiTexture* a;
+	rhiTexture* b;
+	rhiTexture* c;
+	rhiTexture* depth;
+};
+
+// g-buffer producer, both implementations stay alive so the path can change per frame
+class geometryStrategy
+{
+public:
+	virtual ~geometryStrategy() = default;
+
+	virtual geometryPath path() const = 0;
+	// gpu profiler zone of the g-buffer pass
+	virtual std::string_view gpu_zone() const = 0;
+	virtual void render(renderShared* rs, rhiBuffer* global_buffer, const gbufferTargets& targets) = 0;
+	// translucent and oit depth test against the indexed depth
+	virtual bool supports_translucent() const = 0;
+};
+
+class indexedGeometry final : public geometryStrategy
+{
+public:
+	indexedGeometry(gbufferPass* pass) : pass(pass) {}
+
+	geometryPath path() const override { return geometryPath::indexed; }
+	std::string_view gpu_zone() const override { return "gbuffer"; }
+	void render(renderShared* rs, rhiBuffer* global_buffer, const gbufferTargets& targets) override;
+	bool supports_translucent() const override { return true; }
+
+private:
+	gbufferPass* pass;
+};
+
+class meshletGeometry final : public geometryStrategy
+{
+public:
+	meshletGeometry(gbufferPass_meshlet* pass, meshletBuffer* meshlet_ssbo) : pass(pass), meshlet_ssbo(meshlet_ssbo) {}
+
+	geometryPath path() const override { return geometryPath::meshlet; }
+	std::string_view gpu_zone() const override { return "gbuffer_meshlet"; }
+	void render(renderShared* rs, rhiBuffer* global_buffer, const gbufferTargets& targets) override;
+	bool supports_translucent() const override { return false; }
+
+private:
+	gbufferPass_meshlet* pass;
+	meshletBuffer* meshlet_ssbo;
+};
@@ -6,28 +6,47 @@
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiCommandList.h"
 #include "rhi/rhiSampler.h"
+#include "util/cpuProfiler.h"
 #include "rhi/rhiBuffer.h"
 #include "rhi/rhiSwapChain.h"
 
 renderShared::~renderShared()
 {
+    readbacks.reset();
+    uploads.reset();
+    pipeline_compiler.reset();
+    jobs.reset();
+    gpu_profiler.reset();
     samplers.linear_clamp.reset();
     samplers.linear_wrap.reset();
     samplers.point_clamp.reset();
-    scene_color.reset();
 }
 
 void renderShared::Initialize(rhiDeviceContext* context, rhiFrameContext* frame_context)
 {
+    CPU_ZONE("renderShared::Initialize");
     this->context = context;
     this->frame_context = frame_context;
+    if (!shader_library)
+        shader_library = std::make_unique<shaderLibrary>();
+    if (!pipeline_compiler)
+        pipeline_compiler = std::make_unique<pipelineCompiler>(context, shader_library.get());
+    if (!gpu_profiler)
+        gpu_profiler = std::make_unique<gpuProfiler>(context, frame_context->get_frame_size());
+    if (!jobs)
+        jobs = std::make_unique<jobSystem>();
+    if (!uploads)
+        uploads = std::make_unique<uploadQueue>(context);
+    if (!readbacks)
+        readbacks = std::make_unique<readbackQueue>(context, frame_context->get_frame_size());
+    pending_staging_buffers.resize(get_frame_size());
     create_shared_samplers();
     create_descriptor_pools();
-    create_scene_color();
 }
 
 void renderShared::create_or_resize_buffer(std::shared_ptr<rhiBuffer>& buffer, const u32 bytes, const rhiBufferUsage usage, const rhiMem mem)
 {
+    CPU_ZONE("renderShared::create_or_resize_buffer");
     if (bytes == 0)
     {
         buffer.reset();
@@ -47,6 +66,7 @@ void renderShared::create_or_resize_buffer(std::shared_ptr<rhiBuffer>& buffer, c
 
 void renderShared::create_or_resize_buffer(std::unique_ptr<rhiBuffer>& buffer, const u32 bytes, const rhiBufferUsage usage, const rhiMem mem)
 {
+    CPU_ZONE("renderShared::create_or_resize_buffer");
     if (bytes == 0)
     {
         buffer.reset();
@@ -77,6 +97,7 @@ void renderShared::buffer_barrier(rhiBuffer* buffer, const rhiBufferBarrierDescr
 
 void renderShared::upload_to_device(rhiBuffer* buffer, const void* src, const u32 bytes, const u32 dst_offset)
 {
+    CPU_ZONE("renderShared::upload_to_device");
     ASSERT(dst_offset + bytes <= buffer->size());
     ASSERTF((dst_offset % 4) == 0 && (bytes % 4) == 0, "bytes : %d dst_offset : %d", bytes, dst_offset);
 
@@ -94,7 +115,9 @@ void renderShared::upload_to_device(rhiBuffer* buffer, const void* src, const u3
 
     auto transfer_cmd = frame_context->get_command_list(rhiQueueType::transfer);
     transfer_cmd->copy_buffer(staging_buffer.get(), 0, buffer, dst_offset, bytes);
-    pending_staging_buffers.push_back(std::move(staging_buffer));
+    pending_staging_buffers[frame_context->get_frame_index()].push_back(std::move(staging_buffer));
+    uploaded_bytes += bytes;
+    ++upload_count;
 }
 
 const u32 renderShared::get_frame_size() const
@@ -132,27 +155,11 @@ void renderShared::create_shared_samplers()
         });
 }
 
-void renderShared::create_scene_color()
-{
-    const u32 width = frame_context->swapchain->width();
-    const u32 height = frame_context->swapchain->height();
-    auto tex = context->create_texture(rhiTextureDesc{
-        .width = width,
-        .height = height,
-        .layers = 1,
-        .mips = 1,
-        .format = rhiFormat::RGBA8_UNORM,
-        .samples = rhiSampleCount::x1,
-        .is_depth = false
-        });
-
-    scene_color.reset(tex.release());
-}
-
 void renderShared::create_descriptor_pools()
 {
-    arena.pools.resize(frame_context->swapchain->get_swapchain_image_count());
-    for (u32 i = 0; i < frame_context->swapchain->get_swapchain_image_count(); i++)
+    // one pool per frame in flight, a slot's sets are rewritten only after its frame retired
+    arena.pools.resize(get_frame_size());
+    for (u32 i = 0; i < get_frame_size(); i++)
     {
         arena.pools[i] = context->create_descriptor_pool({
                 .pool_sizes = {
@@ -177,7 +184,9 @@ void renderShared::create_descriptor_pools()
     }
 }
 
-void renderShared::clear_staging_buffer()
+void renderShared::clear_staging_buffer(const u32 frame_index)
 {
-    pending_staging_buffers.clear();
+    CPU_ZONE("renderShared::clear_staging_buffer");
+    pending_staging_buffers[frame_index].clear();
+    context->collect_submits();
 }
\ No newline at end of file
@@ -3,6 +3,12 @@
 #include "rhi/rhiDefs.h"
 #include "rhi/rhiDescriptor.h"
 #include "meshlet/meshletDef.h"
+#include "renderer/shaderLibrary.h"
+#include "renderer/pipelineCompiler.h"
+#include "renderer/gpuProfiler.h"
+#include "renderer/uploadQueue.h"
+#include "renderer/readbackQueue.h"
+#include "util/jobSystem.h"
 
 class rhiTexture;
 class rhiSampler;
@@ -35,6 +41,13 @@ struct alignas(16) globalsCB
     vec4 cam_pos; // 16 (w = padding)
 };
 
+// g-buffer, scene color and oit targets are render graph transients, pipelines only see the formats
+constexpr u32 gbuffer_color_count = 3;
+constexpr rhiFormat gbuffer_color_format = rhiFormat::RGBA8_UNORM;
+constexpr rhiFormat gbuffer_depth_format = rhiFormat::D32S8;
+constexpr rhiFormat scene_color_format = rhiFormat::RGBA8_UNORM;
+constexpr rhiFormat oit_format = rhiFormat::RGBA16F;
+
 enum class drawType : u8
 {
     gbuffer = 0,
@@ -100,7 +113,6 @@ public:
 
 public:
     void Initialize(rhiDeviceContext* context, rhiFrameContext* frame_context);
-    void create_scene_color();
 
     void create_or_resize_buffer(std::shared_ptr<rhiBuffer>& buffer, const u32 bytes, const rhiBufferUsage usage, const rhiMem mem);
     void create_or_resize_buffer(std::unique_ptr<rhiBuffer>& buffer, const u32 bytes, const rhiBufferUsage usage, const rhiMem mem);
@@ -109,7 +121,8 @@ public:
     void buffer_barrier(rhiBuffer* buffer, const rhiBufferBarrierDescription& desc);
     void upload_to_device(rhiBuffer* buffer, const void* src, const u32 bytes, const u32 dst_offset = 0);
     const u32 get_frame_size() const;
-    void clear_staging_buffer();
+    // the slot's frame has retired, its copies are done reading
+    void clear_staging_buffer(const u32 frame_index);
 
 private:
     void create_shared_samplers();
@@ -121,8 +134,20 @@ public:
 
     sharedSamplers samplers;
     descriptorArena arena;
-
-    std::shared_ptr<rhiTexture> scene_color;
-    std::vector<std::unique_ptr<rhiBuffer>> pending_staging_buffers;
+    std::unique_ptr<shaderLibrary> shader_library;
+    std::unique_ptr<pipelineCompiler> pipeline_compiler;
+    std::unique_ptr<gpuProfiler> gpu_profiler;
+    // parallel command recording
+    std::unique_ptr<jobSystem> jobs;
+    // large content, streamed on the transfer family under a per-frame budget
+    std::unique_ptr<uploadQueue> uploads;
+    // gpu results handed back frames_in_flight frames later, never waited on
+    std::unique_ptr<readbackQueue> readbacks;
+
+    // small per-frame data rides the frame's transfer list, [frame in flight]
+    std::vector<std::vector<std::unique_ptr<rhiBuffer>>> pending_staging_buffers;
+    // cumulative, through upload_to_device
+    u64 uploaded_bytes = 0;
+    u64 upload_count = 0;
 };
 
@@ -19,18 +19,40 @@
 #include "mesh/meshModelManager.h"
 #include "mesh/glTFMesh.h"
 #include "util/packing.h"
+#include "util/cpuProfiler.h"
+#include <chrono>
 
 renderer::renderer()
 {
+    geometry[static_cast<u32>(geometryPath::indexed)] = std::make_unique<indexedGeometry>(&gbuffer_pass);
+    geometry[static_cast<u32>(geometryPath::meshlet)] = std::make_unique<meshletGeometry>(&gbuffer_meshlet_pass, &meshlet_ssbo);
 }
 
 renderer::~renderer()
 {
+    report_render_paths();
+    if (render_shared.gpu_profiler)
+        render_shared.gpu_profiler->report();
+    if (render_shared.uploads)
+        render_shared.uploads->report();
+    if (render_shared.readbacks)
+        render_shared.readbacks->report();
+    if (render_shared.frame_context)
+        render_shared.frame_context->report_latency();
+    if (render_shared.context)
+        render_shared.context->get_descriptor_cache().report();
+    // streamed copies still target the buffers below
+    render_shared.uploads.reset();
+    // workers write into the passes, joining drains the queue before the passes go away
+    render_shared.pipeline_compiler.reset();
     bindless_table.reset();
     for (u32 i = 0; i < draw_type_count; ++i)
     {
         instance_buffer[i].reset();
         indirect_buffer[i].reset();
+        meshlet_instance_buffer[i].reset();
+        meshlet_indirect_buffer[i].reset();
+        meshlet_draw_buffer[i].reset();
     }
     global_ringbuffer.clear();
     texture_cache->clear();
@@ -48,21 +70,21 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
 
     render_shared.Initialize(device_context, frame_context);
     {
-#if MESHLET
-        gbufferPass_meshletInitContext ctx{};
+        gbufferInitContext ctx{};
         ctx.rs = &render_shared;
         ctx.w = width;
         ctx.h = height;
         ctx.bindless_table = bindless_table;
         gbuffer_pass.initialize(ctx);
-#else
-        gbufferInitContext ctx{};
+    }
+
+    {
+        gbufferPass_meshletInitContext ctx{};
         ctx.rs = &render_shared;
         ctx.w = width;
         ctx.h = height;
         ctx.bindless_table = bindless_table;
-        gbuffer_pass.initialize(ctx);
-#endif
+        gbuffer_meshlet_pass.initialize(ctx);
     }
 
     {
@@ -70,7 +92,6 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
         ctx.rs = &render_shared;
         ctx.w = width;
         ctx.h = height;
-        ctx.scene_color = render_shared.scene_color;
         sky_pass.initialize(ctx);
     }
     
@@ -86,10 +107,11 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
     }
     
     {
-        drawInitContext ctx{};
+        lightingInitContext ctx{};
         ctx.rs = &render_shared;
         ctx.w = width;
         ctx.h = height;
+        ctx.permutation.cascade_count = static_cast<u32>(s->get_directional_light()->get_cascade_count());
         lighting_pass.initialize(ctx);
     }
 
@@ -99,10 +121,6 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
         ctx.w = width;
         ctx.h = height;
         ctx.bindless_table = bindless_table;
-        ctx.depth = gbuffer_pass.get_depth();
-#if DISABLE_OIT
-        ctx.scene_color = render_shared.scene_color;
-#endif
         translucent_pass.initialize(ctx);
     }
 
@@ -112,7 +130,6 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
         ctx.rs = &render_shared;
         ctx.w = width;
         ctx.h = height;
-        ctx.scene_color = render_shared.scene_color;
         oit_pass.initialize(ctx);
     }
 #endif
@@ -128,69 +145,130 @@ void renderer::initialize(scene* s, rhiDeviceContext* device_context, rhiFrameCo
     }
 
     create_ringbuffer(render_shared.get_frame_size());
+
+    render_graph = std::make_unique<renderGraph>(device_context, frame_context->get_frame_size());
+}
+
+void renderer::request_resize(const u32 width, const u32 height)
+{
+    if (width == 0 || height == 0)
+        return;
+    requested_size = { width, height };
 }
 
 void renderer::pre_render(scene* s)
 {
-    const u32 width = render_shared.frame_context->swapchain->width();
-    const u32 height = render_shared.frame_context->swapchain->height();
-    if (framebuffer_size.x != width || framebuffer_size.y != height)
+    CPU_ZONE("renderer::pre_render");
+    const bool size_changed = requested_size.x > 0 && requested_size != framebuffer_size;
+    if (swapchain_stale || size_changed)
     {
-        gbuffer_pass.shutdown();
-        shadow_pass.shutdown();
-        sky_pass.shutdown();
-        lighting_pass.shutdown();
-        composite_pass.shutdown();
-        initialize(s, render_shared.context, render_shared.frame_context);
+        const u32vec2 size = requested_size.x > 0 ? requested_size : framebuffer_size;
+        resize(size.x, size.y);
     }
 }
 
+void renderer::resize(const u32 width, const u32 height)
+{
+    CPU_ZONE("renderer::resize");
+    const auto begin = std::chrono::steady_clock::now();
+    rhiFrameContext* frame_context = render_shared.frame_context;
+
+    frame_context->recreate_swapchain(render_shared.context, width, height);
+    swapchain_stale = false;
+    // the surface clamps the extent, offscreen swapchains keep theirs
+    rhiSwapChain* swapchain = frame_context->swapchain;
+    const u32vec2 old_size = framebuffer_size;
+    framebuffer_size = { swapchain->width(), swapchain->height() };
+    requested_size = framebuffer_size;
+
+    // the g-buffer, scene color and oit targets come back at the new size once the passes declare them
+    render_graph->release_transients();
+    render_graph->forget_imports();
+
+    // the shadow map keeps its fixed resolution
+    const u32 w = framebuffer_size.x;
+    const u32 h = framebuffer_size.y;
+    gbuffer_pass.resize(&render_shared, w, h);
+    gbuffer_meshlet_pass.resize(&render_shared, w, h);
+    sky_pass.resize(&render_shared, w, h);
+    lighting_pass.resize(&render_shared, w, h);
+    translucent_pass.resize(&render_shared, w, h);
+#if !DISABLE_OIT
+    oit_pass.resize(&render_shared, w, h);
+#endif
+    composite_pass.resize(&render_shared, w, h);
+    composite_pass.set_swapchain_views(swapchain->views());
+
+    std::cout << std::format("[renderer] resized {}x{} -> {}x{}, {} swapchain images in {:.2f} ms\n",
+        old_size.x, old_size.y, w, h, swapchain->get_swapchain_image_count(),
+        std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count());
+}
+
 void renderer::render(scene* s)
 {
+    CPU_ZONE("renderer::render");
     auto device_context = render_shared.context;
     auto frame_context = render_shared.frame_context;
 
     frame_context->wait(device_context);
-    frame_context->reset(device_context);
+    const u32 frame_index = frame_context->get_frame_index();
+    render_shared.clear_staging_buffer(frame_index);
+    sky_pass.resolve_precompute();
+    const auto frame_begin = std::chrono::steady_clock::now();
 
     u32 img_index = 0;
-    frame_context->acquire_next_image(&img_index);
-    if (img_index == 0)
-        render_shared.clear_staging_buffer();
+    if (frame_context->acquire_next_image(&img_index) == rhiResult::out_of_date)
+    {
+        // nothing was acquired, the frame is skipped and the next pre_render recreates
+        swapchain_stale = true;
+        return;
+    }
+    // the slot's previous timestamps retired with the wait above
+    render_shared.gpu_profiler->begin_frame(frame_index);
+    // so did the slot's readback copies
+    render_shared.readbacks->begin_frame(frame_index);
 
-    notify_nextimage_index_to_drawpass(img_index);
+    // per-frame data follows the frame slot, only composite targets the acquired image
+    notify_frame_index_to_drawpass(frame_index);
+    composite_pass.set_swapchain_image(img_index);
 
     frame_context->command_begin();
 
     if(!initialized)
     {
-        sky_pass.precompile_dispatch();
+        CPU_ZONE("first frame load");
+        sky_pass.precompile_dispatch(path_config.sky_hdr);
         prepare(s);
-#if MESHLET
-        build_meshlet(s);
-#else
+        texture_cache->save_memo();
+        texture_cache->report();
+        // both geometry paths are built so the path can switch on any frame
         build(s, device_context);
-#endif
-        render_shared.image_barrier(frame_context->swapchain->views()[img_index].texture, rhiImageBarrierDescription{
-            .src_stage = rhiPipelineStage::color_attachment_output,
-            .dst_stage = rhiPipelineStage::none,
-            .src_access = rhiAccessFlags::color_attachment_write,
-            .dst_access = rhiAccessFlags::none,
-            .old_layout = rhiImageLayout::undefined,
-            .new_layout = rhiImageLayout::present,
-            });
+        build_meshlet(s);
+        // the load frame hitches anyway, everything it queued is handed over before the first draw
+        render_shared.uploads->flush(frame_context);
+        // nothing is drawn yet, the graph only hands the image to present
+        render_graph->begin_frame();
+        render_graph->import("swapchain", frame_context->swapchain->views()[img_index].texture, frame_context->swapchain->present_layout());
+        render_graph->compile();
+        render_graph->execute(frame_context->get_command_list(rhiQueueType::graphics));
     }
     else
     {
+        // pipelines were compiled on workers while the first frame loaded the scene
+        render_shared.pipeline_compiler->wait();
+        // content loaded mid-session streams in under the frame budget
+        render_shared.uploads->pump(frame_context);
+
         // build global view_proj
         {
+            CPU_ZONE("globals upload");
             globalsCB cb;
             cb.view = s->get_camera()->view();
             cb.proj = s->get_camera()->proj(framebuffer_size);
             cb.view_proj = cb.proj * cb.view;
             cb.cam_pos = vec4(s->get_camera()->get_position(), 0.f);
 
-            render_shared.buffer_barrier(global_ringbuffer[img_index].get(), rhiBufferBarrierDescription{
+            render_shared.buffer_barrier(global_ringbuffer[frame_index].get(), rhiBufferBarrierDescription{
                 .src_stage = rhiPipelineStage::vertex_shader | rhiPipelineStage::fragment_shader,
                 .dst_stage = rhiPipelineStage::copy,
                 .src_access = rhiAccessFlags::uniform_read,
@@ -199,8 +277,8 @@ void renderer::render(scene* s)
                 .src_queue = device_context->get_queue_family_index(rhiQueueType::transfer),
                 .dst_queue = device_context->get_queue_family_index(rhiQueueType::graphics)
                 });
-            render_shared.upload_to_device(global_ringbuffer[img_index].get(), &cb, sizeof(globalsCB));
-            render_shared.buffer_barrier(global_ringbuffer[img_index].get(), rhiBufferBarrierDescription{
+            render_shared.upload_to_device(global_ringbuffer[frame_index].get(), &cb, sizeof(globalsCB));
+            render_shared.buffer_barrier(global_ringbuffer[frame_index].get(), rhiBufferBarrierDescription{
                 .src_stage = rhiPipelineStage::copy,
                 .dst_stage = rhiPipelineStage::vertex_shader | rhiPipelineStage::fragment_shader,
                 .src_access = rhiAccessFlags::transfer_write,
@@ -211,50 +289,158 @@ void renderer::render(scene* s)
                 });
         }
 
-        // shadow pass
-#if !MESHLET
-        {
-            shadow_pass.update(&render_shared, s, framebuffer_size);
-            shadow_pass.render(&render_shared);
-        }
-#endif
+        // dynamic sky : the next refresh starts once the previous chain is done
+        if (path_config.sky_mips_per_frame > 0 && !sky_pass.is_prefiltering())
+            sky_pass.request_prefilter(path_config.sky_mips_per_frame);
 
-        // gbuffer pass
+        render_frame_graph(s, img_index);
+        if (screenshot_path)
+            record_screenshot(img_index);
+    }
+    frame_context->command_end();
+    // queue submit
+    frame_context->submit(device_context, img_index);
+
+    // present
+    if (frame_context->present(img_index) != rhiResult::ok)
+        swapchain_stale = true;
+    if (initialized)
+    {
+        renderPathStats& stats = path_stats[static_cast<u32>(path_config.geometry)];
+        stats.cpu_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - frame_begin).count();
+        ++stats.frames;
+    }
+    initialized = true;
+}
+
+void renderer::render_frame_graph(scene* s, const u32 image_index)
+{
+    rhiBuffer* global_buffer = global_ringbuffer[render_shared.frame_context->get_frame_index()].get();
+    geometryStrategy* active_geometry = geometry[static_cast<u32>(path_config.geometry)].get();
+    rhiSwapChain* swapchain = render_shared.frame_context->swapchain;
+
+    const rhiTextureDesc color_desc{
+        .width = framebuffer_size.x,
+        .height = framebuffer_size.y,
+        .format = gbuffer_color_format
+    };
+    const rhiTextureDesc depth_desc{
+        .width = framebuffer_size.x,
+        .height = framebuffer_size.y,
+        .format = gbuffer_depth_format,
+        .usage = rhiTextureUsage::ds,
+        .is_depth = true,
+        .is_separate_depth_stencil = true
+    };
+    const rhiTextureDesc scene_color_desc{
+        .width = framebuffer_size.x,
+        .height = framebuffer_size.y,
+        .format = scene_color_format
+    };
+
+    renderGraph& graph = *render_graph;
+    graph.begin_frame();
+    const rgTexture shadow_map = graph.import("shadow map", shadow_pass.get_shadow_texture());
+    const rgTexture backbuffer = graph.import("swapchain", swapchain->views()[image_index].texture, swapchain->present_layout());
+
+    // shadow pass
+    if (path_config.shadows || !shadow_primed)
+    {
+        graph.add_pass("shadow pass",
+            [&](renderGraph::builder& b)
+            {
+                b.write(shadow_map, rgAccess::depth_attachment);
+            },
+            [&](rhiCommandList*)
+            {
+                shadow_pass.update(&render_shared, s, framebuffer_size);
+                shadow_pass.render(&render_shared);
+                shadow_primed = true;
+            });
+    }
+
+    // gbuffer pass
+    rgTexture gbuf_a, gbuf_b, gbuf_c, depth;
+    graph.add_pass("gbuffer pass",
+        [&](renderGraph::builder& b)
         {
-#if MESHLET
-            meshletDrawUpdateContext context{
-                .global_buf = global_ringbuffer[img_index].get(),
-                .meshlet_buf = &meshlet_ssbo
-            };
-            gbuffer_pass.update(&context);
-            gbuffer_pass.render(&render_shared);
-#else
-            gbuffer_pass.update(&render_shared, global_ringbuffer[img_index].get());
-            gbuffer_pass.render(&render_shared);
-#endif
-        }
+            gbuf_a = b.write(b.create("gbuffer a", color_desc), rgAccess::color_attachment);
+            gbuf_b = b.write(b.create("gbuffer b", color_desc), rgAccess::color_attachment);
+            gbuf_c = b.write(b.create("gbuffer c", color_desc), rgAccess::color_attachment);
+            depth = b.write(b.create("gbuffer depth", depth_desc), rgAccess::depth_attachment);
+        },
+        [&](rhiCommandList*)
+        {
+            active_geometry->render(&render_shared, global_buffer, gbufferTargets{
+                .a = graph.get(gbuf_a),
+                .b = graph.get(gbuf_b),
+                .c = graph.get(gbuf_c),
+                .depth = graph.get(depth)
+                });
+        });
 
-        // sky pass
+    // sky pass
+    rgTexture scene_color;
+    graph.add_pass("sky pass",
+        [&](renderGraph::builder& b)
+        {
+            scene_color = b.write(b.create("scene color", scene_color_desc), rgAccess::color_attachment);
+        },
+        [&](rhiCommandList*)
         {
-            skyUpdateContext context{ global_ringbuffer[img_index].get() };
+            skyUpdateContext context{ global_buffer };
+            sky_pass.set_targets({ graph.get(scene_color) });
             sky_pass.update(&context);
             sky_pass.render(&render_shared);
-        }
+        });
+
+    // ibl refresh, overlaps shadow and g-buffer rasterization on a separate compute family
+    const bool ibl_refresh = sky_pass.is_prefiltering();
+    if (ibl_refresh)
+    {
+        graph.add_pass("ibl prefilter",
+            [&](renderGraph::builder& b)
+            {
+                b.async_compute();
+                b.side_effect();
+            },
+            [&](rhiCommandList*)
+            {
+                sky_pass.prefilter_slice();
+            });
+    }
 
-        // lighting pass
+    // lighting pass
+    graph.add_pass("lighting pass",
+        [&](renderGraph::builder& b)
         {
+            b.read(gbuf_a);
+            b.read(gbuf_b);
+            b.read(gbuf_c);
+            b.read(depth);
+            b.read(shadow_map);
+            b.write(scene_color, rgAccess::color_attachment);
+            if (ibl_refresh)
+                b.wait_async_compute();
+        },
+        [&](rhiCommandList* cmd)
+        {
+            // the slice's writes come over from the compute family
+            if (ibl_refresh)
+                sky_pass.acquire_prefiltered(cmd);
             lightingPass::textureContext ctx{
-                .scene_color = render_shared.scene_color.get(),
-                .gbuf_a = gbuffer_pass.get_gbuffer_a(),
-                .gbuf_b = gbuffer_pass.get_gbuffer_b(),
-                .gbuf_c = gbuffer_pass.get_gbuffer_c(),
-                .depth = gbuffer_pass.get_depth(),
-                .shadows = shadow_pass.get_shadow_texture(),
-                .ibl_irradiance = sky_pass.get_irradiance_map(),
+                .scene_color = graph.get(scene_color),
+                .gbuf_a = graph.get(gbuf_a),
+                .gbuf_b = graph.get(gbuf_b),
+                .gbuf_c = graph.get(gbuf_c),
+                .depth = graph.get(depth),
+                .shadows = graph.get(shadow_map),
+                .ibl_sh = sky_pass.get_sh_irradiance(),
                 .ibl_specular = sky_pass.get_specular_map(),
                 .ibl_brdf_lut = sky_pass.get_brdf_lut_map()
             };
             lighting_pass.link_textures(ctx);
+            lighting_pass.set_shadows(path_config.shadows);
             lighting_pass.update(
                 &render_shared,
                 s->get_camera(),
@@ -264,49 +450,87 @@ void renderer::render(scene* s)
                 shadow_pass.get_width(),
                 sky_pass.get_cubemap_mip_count());
             lighting_pass.render(&render_shared);
-        }
+        });
 
-        // translucent pass
-        {
-#if !MESHLET
-            translucentUpdateContext update_context{
-                .global_buffer = global_ringbuffer[img_index].get(),
-                .shadow_depth = shadow_pass.get_shadow_texture(),
-                .light_viewproj = shadow_pass.get_light_viewproj(),
-                .light_dir = vec4(s->get_directional_light()->get_direction(), 0.f),
-                .cascade_splits = shadow_pass.get_cascade_splits(),
-                .shadow_mapsize = static_cast<f32>(shadow_pass.get_width())
-            };
-            translucent_pass.update(&update_context);
-            translucent_pass.render(&render_shared);
+    // translucent pass, depth tested against the indexed g-buffer. without translucent draws
+    // nothing writes the oit targets and the resolve is culled
+    const bool has_translucent = active_geometry->supports_translucent() && !groups[static_cast<u8>(drawType::translucent)].empty();
+#if !DISABLE_OIT
+    const rgTexture accum = graph.create("oit accum", rhiTextureDesc{ .width = framebuffer_size.x, .height = framebuffer_size.y, .format = oit_format });
+    const rgTexture reveal = graph.create("oit reveal", rhiTextureDesc{ .width = framebuffer_size.x, .height = framebuffer_size.y, .format = oit_format });
 #endif
-        }
+    if (has_translucent)
+    {
+        graph.add_pass("translucent pass",
+            [&](renderGraph::builder& b)
+            {
+                b.read(depth, rgAccess::depth_attachment);
+                b.read(shadow_map);
+#if DISABLE_OIT
+                b.write(scene_color, rgAccess::color_attachment);
+#else
+                b.write(accum, rgAccess::color_attachment);
+                b.write(reveal, rgAccess::color_attachment);
+#endif
+            },
+            [&](rhiCommandList*)
+            {
+                translucentUpdateContext update_context{
+                    .global_buffer = global_buffer,
+                    .shadow_depth = graph.get(shadow_map),
+                    .light_viewproj = shadow_pass.get_light_viewproj(),
+                    .light_dir = vec4(s->get_directional_light()->get_direction(), 0.f),
+                    .cascade_splits = shadow_pass.get_cascade_splits(),
+                    .shadow_mapsize = static_cast<f32>(shadow_pass.get_width())
+                };
+#if DISABLE_OIT
+                translucent_pass.set_targets({ graph.get(scene_color) }, graph.get(depth));
+#else
+                translucent_pass.set_targets({ graph.get(accum), graph.get(reveal) }, graph.get(depth));
+#endif
+                translucent_pass.update(&update_context);
+                translucent_pass.render(&render_shared);
+            });
+    }
 
-        // oit pass
-#if !DISABLE_OIT && !MESHLET
+    // oit pass
+#if !DISABLE_OIT
+    graph.add_pass("oit pass",
+        [&](renderGraph::builder& b)
+        {
+            b.read(accum);
+            b.read(reveal);
+            b.write(scene_color, rgAccess::color_attachment);
+        },
+        [&](rhiCommandList*)
         {
             oitUpdateContext update_context{
-                .accum = translucent_pass.get_accum(),
-                .reveal = translucent_pass.get_reveal()
+                .accum = graph.get(accum),
+                .reveal = graph.get(reveal)
             };
+            oit_pass.set_targets({ graph.get(scene_color) });
             oit_pass.update(&update_context);
             oit_pass.render(&render_shared);
-        }
+        });
 #endif
 
-        // composite
+    // composite
+    graph.add_pass("composite pass",
+        [&](renderGraph::builder& b)
+        {
+            b.read(scene_color);
+            b.write(backbuffer, rgAccess::color_attachment);
+        },
+        [&](rhiCommandList*)
         {
-            composite_pass.update(&render_shared, render_shared.scene_color.get());
+            composite_pass.update(&render_shared, graph.get(scene_color));
             composite_pass.render(&render_shared);
-        }
-    }
-    frame_context->command_end();
-    // queue submit
-    frame_context->submit(device_context, img_index);
+        });
 
-    // present
-    frame_context->present(img_index);
-    initialized = true;
+    graph.compile();
+    rhiFrameContext* frame_context = render_shared.frame_context;
+    graph.execute(frame_context->get_command_list(rhiQueueType::graphics), frame_context->get_command_list(rhiQueueType::compute),
+        [frame_context]() { return frame_context->join_async_compute(); });
 }
 
 void renderer::post_render()
@@ -314,6 +538,80 @@ void renderer::post_render()
 
 }
 
+void renderer::set_render_path(const renderPathConfig& config)
+{
+    if (config == path_config)
+        return;
+
+    if (path_config.geometry != config.geometry)
+        report_render_paths();
+    path_config = config;
+    std::cout << std::format("[renderer] render path geometry={} shadows={} dynamic sky={} mips/frame\n",
+        to_string(path_config.geometry), path_config.shadows ? "on" : "off", path_config.sky_mips_per_frame);
+}
+
+void renderer::report_render_paths() const
+{
+    for (u32 i = 0; i < geometry_path_count; ++i)
+    {
+        const renderPathStats& stats = path_stats[i];
+        if (stats.frames == 0)
+            continue;
+
+        const auto gpu = render_shared.gpu_profiler ? render_shared.gpu_profiler->get_stats(geometry[i]->gpu_zone()) : std::nullopt;
+        std::cout << std::format("[renderer] {} path: {} frames, cpu {:.3f} ms/frame, gbuffer gpu avg {:.3f} ms p95 {:.3f} ms\n",
+            to_string(static_cast<geometryPath>(i)), stats.frames, stats.cpu_ms / stats.frames,
+            gpu.has_value() ? gpu->avg_ms : 0.0, gpu.has_value() ? gpu->p95_ms : 0.0);
+    }
+}
+
+bool renderer::dump_gpu_trace(const std::filesystem::path& path) const
+{
+    return render_shared.gpu_profiler && render_shared.gpu_profiler->dump_chrome_trace(path);
+}
+
+void renderer::record_screenshot(const u32 image_index)
+{
+    CPU_ZONE("renderer::record_screenshot");
+    rhiSwapChain* swapchain = render_shared.frame_context->swapchain;
+    rhiTexture* image = swapchain->views()[image_index].texture;
+    const bool bgra = swapchain->format() == rhiFormat::BGRA8_UNORM || swapchain->format() == rhiFormat::BGRA8_SRGB;
+    const u32 width = framebuffer_size.x;
+    const u32 height = framebuffer_size.y;
+
+    const rhiBufferImageCopy region{
+        .imageSubresource = { .aspect = rhiImageAspect::color },
+        .image_extent = { width, height, 1 }
+    };
+    // recorded after the graph, the image is already in its present layout
+    render_shared.readbacks->enqueue(render_shared.frame_context->get_command_list(rhiQueueType::graphics),
+        image, swapchain->present_layout(), region,
+        [path = *screenshot_path, width, height, bgra](std::span<const u8> bytes)
+        {
+            std::error_code ec;
+            if (path.has_parent_path())
+                std::filesystem::create_directories(path.parent_path(), ec);
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                std::cout << std::format("[renderer] cannot write {}\n", path.string());
+                return;
+            }
+            out << std::format("P6\n{} {}\n255\n", width, height);
+            std::vector<u8> rgb(static_cast<size_t>(width) * height * 3);
+            for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i)
+            {
+                rgb[i * 3 + 0] = bytes[i * 4 + (bgra ? 2 : 0)];
+                rgb[i * 3 + 1] = bytes[i * 4 + 1];
+                rgb[i * 3 + 2] = bytes[i * 4 + (bgra ? 0 : 2)];
+            }
+            out.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+            std::cout << std::format("[renderer] screenshot {}\n", path.string());
+        });
+    screenshot_path.reset();
+}
+
 std::shared_ptr<rhiRenderResource> renderer::get_or_create_resource(const std::shared_ptr<glTFMesh> raw_mesh)
 {
     if(cache.contains(raw_mesh->hash()))
@@ -321,11 +619,8 @@ std::shared_ptr<rhiRenderResource> renderer::get_or_create_resource(const std::s
 
     auto rhi_resource = std::make_shared<rhiRenderResource>(raw_mesh);
     ASSERT(rhi_resource);
-#if MESHLET
-    rhi_resource->make_meshlet_resource(texture_cache.get());
-#else
+    // upload also exposes the meshlet data, one resource serves both geometry paths
     rhi_resource->upload(&render_shared, texture_cache.get());
-#endif
     rhi_resource->set_hash(raw_mesh->hash());
     cache.emplace(raw_mesh->hash(), std::move(rhi_resource));
     return cache[raw_mesh->hash()];
@@ -333,6 +628,7 @@ std::shared_ptr<rhiRenderResource> renderer::get_or_create_resource(const std::s
 
 void renderer::prepare(scene* s)
 {
+    CPU_ZONE("renderer::prepare");
     for (auto& a : s->get_actors()) 
     {
         meshActor* mesh_actor = static_cast<meshActor*>(a.get());
@@ -352,9 +648,9 @@ void renderer::prepare(scene* s)
     }
 }
 
-#if MESHLET
 void renderer::build_meshlet(scene* s)
 {
+    CPU_ZONE("renderer::build_meshlet");
     meshlet::buildOut out;
     for (auto& a : s->get_actors())
     {
@@ -446,14 +742,14 @@ void renderer::build_meshlet_drawcommand(scene* s)
             continue;
 
         u32 running = 0;
-        groups[dt].reserve(buckets[dt].size());
+        meshlet_groups[dt].reserve(buckets[dt].size());
 
         for (auto& [key, insts] : buckets[dt])
         {
             const rhiRenderResource::subMesh& sm = submesh_buckets[dt][key];
 
-            const u32 first_instance = static_cast<u32>(instances[dt].size());
-            instances[dt].insert(instances[dt].end(), insts.begin(), insts.end());
+            const u32 first_instance = static_cast<u32>(meshlet_instances[dt].size());
+            meshlet_instances[dt].insert(meshlet_instances[dt].end(), insts.begin(), insts.end());
 
             meshletDrawParams param;
             param.first_meshlet = sm.first_meshlet;
@@ -483,7 +779,7 @@ void renderer::build_meshlet_drawcommand(scene* s)
                 .metalic_factor = key.metalic_factor,
                 .roughness_factor = key.roughness_factor
             };
-            groups[dt].push_back(rec);
+            meshlet_groups[dt].push_back(rec);
 
             if (type == drawType::gbuffer)
                 double_sided.emplace(running, key.is_double_sided);
@@ -491,12 +787,12 @@ void renderer::build_meshlet_drawcommand(scene* s)
             running += rec.cmd_count;
         }
 
-        const u32 instance_bytes = static_cast<u32>(instances[dt].size() * sizeof(instanceData));
+        const u32 instance_bytes = static_cast<u32>(meshlet_instances[dt].size() * sizeof(instanceData));
         if (instance_bytes)
         {
-            render_shared.create_or_resize_buffer(instance_buffer[dt], instance_bytes, rhiBufferUsage::storage | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
-            render_shared.upload_to_device(instance_buffer[dt].get(), instances[dt].data(), instance_bytes);
-            render_shared.buffer_barrier(instance_buffer[dt].get(), {
+            render_shared.create_or_resize_buffer(meshlet_instance_buffer[dt], instance_bytes, rhiBufferUsage::storage | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
+            render_shared.upload_to_device(meshlet_instance_buffer[dt].get(), meshlet_instances[dt].data(), instance_bytes);
+            render_shared.buffer_barrier(meshlet_instance_buffer[dt].get(), {
                 .src_stage = rhiPipelineStage::copy,
                 .dst_stage = rhiPipelineStage::mesh_shader,
                 .src_access = rhiAccessFlags::transfer_write,
@@ -508,7 +804,7 @@ void renderer::build_meshlet_drawcommand(scene* s)
         }
         else
         {
-            instance_buffer[dt].reset();
+            meshlet_instance_buffer[dt].reset();
         }
 
         const u32 params_bytes = static_cast<u32>(meshlet_draw_params[dt].size() * sizeof(meshletDrawParams));
@@ -534,9 +830,9 @@ void renderer::build_meshlet_drawcommand(scene* s)
         const u32 indirect_bytes = static_cast<u32>(meshlet_indirect_args[dt].size() * sizeof(rhiDrawMeshShaderIndirect));
         if (indirect_bytes)
         {
-            render_shared.create_or_resize_buffer(indirect_buffer[dt], indirect_bytes, rhiBufferUsage::indirect | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
-            render_shared.upload_to_device(indirect_buffer[dt].get(), meshlet_indirect_args[dt].data(), indirect_bytes);
-            render_shared.buffer_barrier(indirect_buffer[dt].get(), {
+            render_shared.create_or_resize_buffer(meshlet_indirect_buffer[dt], indirect_bytes, rhiBufferUsage::indirect | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
+            render_shared.upload_to_device(meshlet_indirect_buffer[dt].get(), meshlet_indirect_args[dt].data(), indirect_bytes);
+            render_shared.buffer_barrier(meshlet_indirect_buffer[dt].get(), {
                 .src_stage = rhiPipelineStage::copy,
                 .dst_stage = rhiPipelineStage::draw_indirect,
                 .src_access = rhiAccessFlags::transfer_write,
@@ -548,13 +844,12 @@ void renderer::build_meshlet_drawcommand(scene* s)
         }
         else
         {
-            indirect_buffer[dt].reset();
+            meshlet_indirect_buffer[dt].reset();
         }
     }
 
-    shadow_pass.update_elements(&groups, &instance_buffer, &indirect_buffer);
-    gbuffer_pass.update_elements(&groups, &instance_buffer, &meshlet_draw_buffer, &indirect_buffer);
-    translucent_pass.update_elements(&groups, &instance_buffer, &indirect_buffer);
+    // shadow and translucent draws come from the indexed build
+    gbuffer_meshlet_pass.update_elements(&meshlet_groups, &meshlet_instance_buffer, &meshlet_draw_buffer, &meshlet_indirect_buffer);
 }
 
 void renderer::build_meshlet_global_vertices(meshActor* actor, meshlet::buildOut& out)
@@ -627,16 +922,7 @@ void renderer::build_meshlet_ssbo(const meshlet::buildOut* out)
     auto upload = [&](std::unique_ptr<rhiBuffer>& buf, const void* src,  const u32 bytes)
         {
             render_shared.create_or_resize_buffer(buf, bytes, rhiBufferUsage::storage | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
-            render_shared.upload_to_device(buf.get(), src, bytes);
-            render_shared.buffer_barrier(buf.get(), {
-                .src_stage = rhiPipelineStage::copy,
-                .dst_stage = rhiPipelineStage::mesh_shader,
-                .src_access = rhiAccessFlags::transfer_write,
-                .dst_access = rhiAccessFlags::shader_read | rhiAccessFlags::shader_storage_read,
-                .offset = 0,
-                .size = bytes,
-                .src_queue = render_shared.context->get_queue_family_index(rhiQueueType::graphics),
-                .dst_queue = render_shared.context->get_queue_family_index(rhiQueueType::transfer) });
+            render_shared.uploads->enqueue(buf.get(), src, bytes, 0, rhiPipelineStage::mesh_shader, rhiAccessFlags::shader_read | rhiAccessFlags::shader_storage_read);
         };
     upload(meshlet_ssbo.pos, out->position.data(), static_cast<u32>(out->position.size()) * sizeof(vec4));
     upload(meshlet_ssbo.norm, out->normal.data(), static_cast<u32>(out->normal.size()) * sizeof(u32));
@@ -651,9 +937,9 @@ void renderer::build_meshlet_ssbo(const meshlet::buildOut* out)
     upload(meshlet_ssbo.tri_bytes, out->meshlet_tribytes.data(), sz);
 }
 
-#else
 void renderer::build(scene* s, rhiDeviceContext* context)
 {
+    CPU_ZONE("renderer::build");
     std::ranges::for_each(instances, [](std::vector<instanceData>& args)
         {
             args.clear();
@@ -831,7 +1117,6 @@ void renderer::build(scene* s, rhiDeviceContext* context)
     translucent_pass.update_elements(&groups, &instance_buffer, &indirect_buffer);
     gbuffer_pass.update_double_sided_info(double_sided);
 }
-#endif
 
 void renderer::create_ringbuffer(const u32 frame_size)
 {
@@ -842,13 +1127,14 @@ void renderer::create_ringbuffer(const u32 frame_size)
     }
 }
 
-void renderer::notify_nextimage_index_to_drawpass(const u32 image_index)
+void renderer::notify_frame_index_to_drawpass(const u32 frame_index)
 {
-    shadow_pass.frame(image_index);
-    gbuffer_pass.frame(image_index);
-    sky_pass.frame(image_index);
-    lighting_pass.frame(image_index);
-    translucent_pass.frame(image_index);
-    oit_pass.frame(image_index);
-    composite_pass.frame(image_index);
+    shadow_pass.frame(frame_index);
+    gbuffer_pass.frame(frame_index);
+    gbuffer_meshlet_pass.frame(frame_index);
+    sky_pass.frame(frame_index);
+    lighting_pass.frame(frame_index);
+    translucent_pass.frame(frame_index);
+    oit_pass.frame(frame_index);
+    composite_pass.frame(frame_index);
 }
\ No newline at end of file
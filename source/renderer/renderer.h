@@ -4,18 +4,17 @@
 #include "rhi/rhiDefs.h"
 #include "renderer/renderShared.h"
 #include "renderer/shadowPass.h"
-#if MESHLET
+#include "renderer/gbufferPass.h"
 #include "renderer/gbufferPass_meshlet.h"
 #include "meshlet/meshletDef.h"
 using namespace meshlet;
-#else
-#include "renderer/gbufferPass.h"
-#endif
 #include "renderer/skyPass.h"
 #include "renderer/lightingPass.h"
 #include "renderer/translucentPass.h"
 #include "renderer/oitResolvePass.h"
 #include "renderer/compositePass.h"
+#include "renderer/renderPath.h"
+#include "renderer/renderGraph.h"
 #include "textureCache.h"
 
 class scene;
@@ -40,6 +39,22 @@ public:
 	void pre_render(scene* s);
 	void render(scene* s);
 	void post_render();
+	// the framebuffer size the window reports, applied by the next pre_render. 0x0 (minimized) is ignored
+	void request_resize(const u32 width, const u32 height);
+
+	// takes effect on the next drawn frame, both geometry paths stay resident
+	void set_render_path(const renderPathConfig& config);
+	const renderPathConfig& get_render_path() const { return path_config; }
+	void report_render_paths() const;
+
+	gpuProfiler* get_gpu_profiler() const { return render_shared.gpu_profiler.get(); }
+	bool dump_gpu_trace(const std::filesystem::path& path = "cache/gpu_trace.json") const;
+	u64 get_uploaded_bytes() const { return render_shared.uploaded_bytes + render_shared.uploads->get_streamed_bytes(); }
+	u64 get_upload_count() const { return render_shared.upload_count + render_shared.uploads->get_request_count(); }
+	uploadQueue* get_upload_queue() const { return render_shared.uploads.get(); }
+	readbackQueue* get_readback_queue() const { return render_shared.readbacks.get(); }
+	// the next drawn frame's swapchain image, written as a binary ppm once the copy retires
+	void request_screenshot(const std::filesystem::path& path = "cache/screenshot.ppm") { screenshot_path = path; }
 
 private:
 	struct drawGroupKey 
@@ -105,17 +120,20 @@ private:
 	};
 
 	void prepare(scene* s);
-#if MESHLET
 	void build_meshlet(scene* s);
 	void build_meshlet_drawcommand(scene* s);
 	void build_meshlet_global_vertices(meshActor* a, meshlet::buildOut& out);
 	void build_meshlet_ssbo(const meshlet::buildOut* out);
-#else
 	void build(scene* s, rhiDeviceContext* context);
-#endif
-	void notify_nextimage_index_to_drawpass(const u32 image_index);
+	void notify_frame_index_to_drawpass(const u32 frame_index);
+	// declares this frame's passes, then compiles and records them
+	void render_frame_graph(scene* s, const u32 image_index);
 	std::shared_ptr<rhiRenderResource> get_or_create_resource(const std::shared_ptr<glTFMesh> raw_mesh);
 	void create_ringbuffer(const u32 frame_size);
+	void record_screenshot(const u32 image_index);
+	// drains the frames in flight, then replaces the swapchain and what is sized after it.
+	// pipelines, descriptor layouts, the scene and the caches are kept
+	void resize(const u32 width, const u32 height);
 
 private:
 	std::unordered_map<u64, std::shared_ptr<rhiRenderResource>> cache;
@@ -123,11 +141,8 @@ private:
 
 	renderShared render_shared;
 	shadowPass shadow_pass;
-#if MESHLET
-	gbufferPass_meshlet gbuffer_pass;
-#else
 	gbufferPass gbuffer_pass;
-#endif
+	gbufferPass_meshlet gbuffer_meshlet_pass;
 	skyPass sky_pass;
 	lightingPass lighting_pass;
 	translucentPass translucent_pass;
@@ -150,10 +165,31 @@ private:
 	std::shared_ptr<rhiTextureBindlessTable> bindless_table;
 	
 	// meshlet
+	instanceArray meshlet_instances;
+	groupRecordArray meshlet_groups;
+	drawTypeBuffers meshlet_instance_buffer;
+	drawTypeBuffers meshlet_indirect_buffer;
 	drawTypeBuffers meshlet_draw_buffer;
 	meshletBuffer meshlet_ssbo;
 	// end meshlet
 
+	// runtime render path
+	renderPathConfig path_config;
+	std::array<std::unique_ptr<geometryStrategy>, geometry_path_count> geometry;
+	std::array<renderPathStats, geometry_path_count> path_stats;
+	// translucent samples the shadow map even when shadows are off, it is drawn at least once
+	bool shadow_primed = false;
+	// end runtime render path
+
+	// rebuilt every frame, owns the g-buffer, scene color and oit targets
+	std::unique_ptr<renderGraph> render_graph;
+
+	// pending until a frame is drawn
+	std::optional<std::filesystem::path> screenshot_path;
+
 	bool initialized = false;
 	u32vec2 framebuffer_size = { 0, 0 };
+	u32vec2 requested_size = { 0, 0 };
+	// acquire or present reported out_of_date or suboptimal
+	bool swapchain_stale = false;
 };
\ No newline at end of file
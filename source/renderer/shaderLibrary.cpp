@@ -0,0 +1,192 @@
+﻿#include "shaderLibrary.h"
+#include "util/hash.h"
+#include <cstdlib>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct shaderLibrary::mappedShader
+{
+	~mappedShader()
+	{
+#if defined(_WIN32)
+		if (view)
+			UnmapViewOfFile(view);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+#else
+		if (view)
+			munmap(const_cast<void*>(view), size);
+		if (file >= 0)
+			close(file);
+#endif
+	}
+
+	// throws when the file cannot be mapped, the destructor releases what was opened
+	void map(const std::filesystem::path& path);
+
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int file = -1;
+#endif
+	const void* view = nullptr;
+	u32 size = 0;
+	u64 hash = 0;
+};
+
+void shaderLibrary::mappedShader::map(const std::filesystem::path& path)
+{
+#if defined(_WIN32)
+	file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to open file: " + path.string());
+
+	LARGE_INTEGER file_size{};
+	GetFileSizeEx(file, &file_size);
+	const i64 bytes = file_size.QuadPart;
+#else
+	file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		throw std::runtime_error("Failed to open file: " + path.string());
+
+	struct stat st{};
+	if (fstat(file, &st) != 0)
+		throw std::runtime_error("Failed to stat file: " + path.string());
+	const i64 bytes = static_cast<i64>(st.st_size);
+#endif
+	if (bytes <= 0)
+		throw std::runtime_error("File is empty: " + path.string());
+	if ((bytes % 4) != 0)
+		throw std::runtime_error("SPIR-V size must be multiple of 4: " + path.string());
+	size = static_cast<u32>(bytes);
+
+#if defined(_WIN32)
+	mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+		throw std::runtime_error("Failed to map file: " + path.string());
+	view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	view = mapped == MAP_FAILED ? nullptr : mapped;
+#endif
+	if (!view)
+		throw std::runtime_error("Failed to map file: " + path.string());
+	hash = fast_hash64(view, size);
+}
+
+namespace
+{
+	// the build writes spir-v next to the executable
+	std::filesystem::path executable_dir()
+	{
+#if defined(_WIN32)
+		std::wstring buffer(MAX_PATH, L'\0');
+		const DWORD length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()));
+		if (length == 0 || length == buffer.size())
+			return {};
+		buffer.resize(length);
+		const std::filesystem::path exe(buffer);
+#else
+		std::error_code ec;
+		const std::filesystem::path exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+		if (ec)
+			return {};
+#endif
+		return exe.parent_path();
+	}
+}
+
+shaderLibrary::shaderLibrary(const std::filesystem::path& root)
+	: root(root)
+{
+}
+
+shaderLibrary::~shaderLibrary()
+{
+	clear();
+}
+
+std::filesystem::path shaderLibrary::default_root()
+{
+#if defined(_MSC_VER)
+#pragma warning(suppress : 4996)
+#endif
+	if (const char* env = std::getenv("SH_SHADER_ROOT"); env && *env)
+		return env;
+
+	// <build>/shaders beside the executable, or one level up where multi-config generators put it in <build>/<Config>/,
+	// else relative to the working directory
+	std::error_code ec;
+	const std::filesystem::path exe_dir = executable_dir();
+	if (!exe_dir.empty())
+	{
+		for (const std::filesystem::path& candidate : { exe_dir / "shaders", exe_dir.parent_path() / "shaders" })
+		{
+			if (std::filesystem::is_directory(candidate, ec))
+				return candidate;
+		}
+	}
+	return std::filesystem::current_path(ec) / "shaders";
+}
+
+rhiShaderBinary shaderLibrary::load(std::string_view name, std::string_view entry)
+{
+	std::scoped_lock lock(mutex);
+	++stats.requests;
+
+	std::string key(name);
+	auto it = by_name.find(key);
+	if (it == by_name.end())
+	{
+		const std::filesystem::path path = root / name;
+		auto shader = std::make_shared<mappedShader>();
+		shader->map(path);
+		++stats.mapped_files;
+
+		// identical spir-v under another name shares the first mapping
+		auto [hash_it, inserted] = by_hash.try_emplace(shader->hash, shader);
+		if (inserted)
+		{
+			++stats.unique_binaries;
+			stats.mapped_bytes += shader->size;
+		}
+		it = by_name.emplace(std::move(key), hash_it->second).first;
+	}
+
+	const mappedShader& shader = *it->second;
+	return rhiShaderBinary{
+		.data = shader.view,
+		.size = shader.size,
+		.entry = std::string(entry),
+		.hash = shader.hash,
+		.owned = false
+	};
+}
+
+void shaderLibrary::set_root(const std::filesystem::path& new_root)
+{
+	std::scoped_lock lock(mutex);
+	root = new_root;
+	// names resolve against the new root from now on, mapped content stays valid for live pipelines
+	by_name.clear();
+}
+
+void shaderLibrary::report() const
+{
+	std::cout << std::format("[shaderLibrary] {} requests / {} files mapped / {} unique binaries / {:.1f} KB from {}\n",
+		stats.requests, stats.mapped_files, stats.unique_binaries, stats.mapped_bytes / 1024.0, root.string());
+}
+
+void shaderLibrary::clear()
+{
+	std::scoped_lock lock(mutex);
+	by_name.clear();
+	by_hash.clear();
+}
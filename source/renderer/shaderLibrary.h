@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiShader.h"
+#include <mutex>
+
+struct shaderLibraryStats
+{
+	u32 requests = 0;
+	u32 mapped_files = 0;
+	u32 unique_binaries = 0; // after content dedup
+	u64 mapped_bytes = 0;
+};
+
+// memory maps spir-v under a root directory and dedups it by content hash.
+// returned binaries are views owned by the library, they stay valid until clear()
+class shaderLibrary
+{
+public:
+	shaderLibrary(const std::filesystem::path& root = default_root());
+	~shaderLibrary();
+
+public:
+	// SH_SHADER_ROOT overrides <executable dir>/shaders, the build output. falls back to ./shaders
+	static std::filesystem::path default_root();
+
+	rhiShaderBinary load(std::string_view name, std::string_view entry = "main");
+	void set_root(const std::filesystem::path& new_root);
+	const std::filesystem::path& get_root() const { return root; }
+	const shaderLibraryStats& get_stats() const { return stats; }
+	void report() const;
+	void clear();
+
+private:
+	struct mappedShader;
+
+	std::filesystem::path root;
+	std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<mappedShader>> by_name;
+	std::unordered_map<u64, std::shared_ptr<mappedShader>> by_hash;
+	shaderLibraryStats stats;
+};
@@ -202,11 +202,7 @@ void shadowPass::build_pipeline(renderShared* rs)
 {
 	// default
 	{
-		auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\shadow.vs.spv");
-		auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\shadow.ps.spv");
 		const rhiGraphicsPipelineDesc desc{
-			.vs = vs,
-			.fs = fs,
 			.depth_format = shadow_depth->desc.format,
 			.samples = rhiSampleCount::x1,
 			.depth_test = true,
@@ -218,17 +214,11 @@ void shadowPass::build_pipeline(renderShared* rs)
 					rhiVertexAttributeDesc{ 0, 0, rhiFormat::RGB32_SFLOAT, offsetof(glTFVertex, position) }
 			}}
 		};
-		pipeline = rs->context->create_graphics_pipeline(desc, pipeline_layout);
-		shaderio::free_shader_binary(vs);
-		shaderio::free_shader_binary(fs);
+		rs->pipeline_compiler->request(pipeline, desc, { .vs = "shadow.vs.spv", .fs = "shadow.ps.spv" }, pipeline_layout);
 	}
 	// opacity
 	{
-		auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\shadow_opacity.vs.spv");
-		auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\shadow_opacity.ps.spv");
 		const rhiGraphicsPipelineDesc desc{
-			.vs = vs,
-			.fs = fs,
 			.depth_format = shadow_depth->desc.format,
 			.samples = rhiSampleCount::x1,
 			.depth_test = true,
@@ -241,9 +231,7 @@ void shadowPass::build_pipeline(renderShared* rs)
 					rhiVertexAttributeDesc{ 1, 0, rhiFormat::RG32_SFLOAT, offsetof(glTFVertex, uv) }
 			}}
 		};
-		opacity_pipeline = rs->context->create_graphics_pipeline(desc, opacity_pipe_layout);
-		shaderio::free_shader_binary(vs);
-		shaderio::free_shader_binary(fs);
+		rs->pipeline_compiler->request(opacity_pipeline, desc, { .vs = "shadow_opacity.vs.spv", .fs = "shadow_opacity.ps.spv" }, opacity_pipe_layout);
 	}
 }
 
@@ -260,7 +248,7 @@ void shadowPass::update_instances(renderShared* rs, const u32 instancebuf_desc_i
 			.range = buf->size()
 			};
 			const rhiWriteDescriptor write_desc{
-				.set = descriptor_sets[image_index.value()][instancebuf_desc_idx],
+				.set = descriptor_sets[frame_index.value()][instancebuf_desc_idx],
 				.binding = 0,
 				.array_index = 0,
 				.count = 1,
@@ -281,7 +269,7 @@ void shadowPass::update_instances(renderShared* rs, const u32 instancebuf_desc_i
 			.range = buf->size()
 			};
 			const rhiWriteDescriptor write_desc{
-				.set = opacity_descriptor_sets[image_index.value()][instancebuf_desc_idx],
+				.set = opacity_descriptor_sets[frame_index.value()][instancebuf_desc_idx],
 				.binding = 0,
 				.array_index = 0,
 				.count = 1,
@@ -295,22 +283,31 @@ void shadowPass::update_instances(renderShared* rs, const u32 instancebuf_desc_i
 
 void shadowPass::render(renderShared* rs)
 {
-	auto cmd = rs->frame_context->get_command_list(main_job_queue);
+	auto cmd_list = rs->frame_context->get_command_list(main_job_queue);
+	gpuScope zone(rs->gpu_profiler.get(), cmd_list, render_info.renderpass_name, main_job_queue);
 
-	begin_barrier(cmd);
-	cmd->begin_render_pass(render_info);
+	// cascades are independent layers of one attachment, each range records on its own worker
+	record_parallel(rs, cmd_list, cascade_count, 1, [this](rhiCommandList* cmd, const u32 first, const u32 last)
+		{
+			record_cascades(cmd, first, last);
+		});
+	frame_index.reset();
+}
+
+void shadowPass::record_cascades(rhiCommandList* cmd, const u32 first, const u32 last)
+{
 	cmd->set_viewport_scissor(vec2(init_context->w, init_context->h));
 	constexpr u32 stride = sizeof(rhiDrawIndexedIndirect);
 	// default
 	{
 		cmd->bind_pipeline(pipeline.get());
-		cmd->bind_descriptor_sets(pipeline_layout, rhiPipelineType::graphics, descriptor_sets[image_index.value()], 0, dynamic_offsets);
+		cmd->bind_descriptor_sets(pipeline_layout, rhiPipelineType::graphics, descriptor_sets[frame_index.value()], 0, dynamic_offsets);
 
-		auto buffer_ptr = indirect_buffer->at(static_cast<u8>(drawType::gbuffer));
-		for (u32 index = 0; index < cascade_count; ++index)
+		const auto& buffer_ptr = indirect_buffer->at(static_cast<u8>(drawType::gbuffer));
+		for (u32 index = first; index < last; ++index)
 		{
 			cmd->push_constants(pipeline_layout, rhiShaderStage::vertex, 0, sizeof(shadowCB), &light_vps[index]);
-			auto gbuffer_group = group_records->at(static_cast<u8>(drawType::gbuffer));
+			const auto& gbuffer_group = group_records->at(static_cast<u8>(drawType::gbuffer));
 			for (const auto& g : gbuffer_group)
 			{
 				cmd->bind_vertex_buffer(const_cast<rhiBuffer*>(g.vbo), 0, 0);
@@ -322,11 +319,11 @@ void shadowPass::render(renderShared* rs)
 	}
 	// opacity
 	{
-		auto buffer_ptr = indirect_buffer->at(static_cast<u8>(drawType::translucent));
+		const auto& buffer_ptr = indirect_buffer->at(static_cast<u8>(drawType::translucent));
 		if (buffer_ptr)
 		{
 			cmd->bind_pipeline(opacity_pipeline.get());
-			cmd->bind_descriptor_sets(opacity_pipe_layout, rhiPipelineType::graphics, opacity_descriptor_sets[image_index.value()], 0, dynamic_offsets);
+			cmd->bind_descriptor_sets(opacity_pipe_layout, rhiPipelineType::graphics, opacity_descriptor_sets[frame_index.value()], 0, dynamic_offsets);
 			auto ptr = static_cast<shadowInitContext*>(init_context.get());
 			ASSERT(ptr);
 		
@@ -334,10 +331,10 @@ void shadowPass::render(renderShared* rs)
 			ASSERT(table_ptr);
 			table_ptr->bind_once(cmd, opacity_pipe_layout, 1);
 		
-			for (u32 index = 0; index < cascade_count; ++index)
+			for (u32 index = first; index < last; ++index)
 			{
 				cmd->push_constants(opacity_pipe_layout, rhiShaderStage::vertex, 0, sizeof(shadowCB), &light_vps[index]);
-				auto gbuffer_group = group_records->at(static_cast<u8>(drawType::translucent));
+				const auto& gbuffer_group = group_records->at(static_cast<u8>(drawType::translucent));
 				for (const auto& g : gbuffer_group)
 				{
 					const shadowPass::materialPC mat{
@@ -353,29 +350,6 @@ void shadowPass::render(renderShared* rs)
 			}
 		}
 	}
-
-	cmd->end_render_pass();
-	end_barrier(cmd);
-	image_index.reset();
-}
-
-void shadowPass::begin_barrier(rhiCommandList* cmd)
-{
-	if (is_first_frame)
-	{
-		cmd->image_barrier(shadow_depth.get(), rhiImageLayout::undefined, rhiImageLayout::depth_stencil_attachment, 0, 1, 0, cascade_count);
-		is_first_frame = false;
-	}
-	else// SRV -> RTV
-	{
-		cmd->image_barrier(shadow_depth.get(), rhiImageLayout::shader_readonly, rhiImageLayout::depth_stencil_attachment, 0, 1, 0, cascade_count);
-	}
-}
-
-void shadowPass::end_barrier(rhiCommandList* cmd)
-{
-	// RTV -> SRV
-	cmd->image_barrier(shadow_depth.get(), rhiImageLayout::depth_stencil_attachment, rhiImageLayout::shader_readonly, 0, 1, 0, cascade_count);
 }
 
 const std::vector<mat4> shadowPass::get_light_viewproj()
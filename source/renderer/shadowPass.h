@@ -44,8 +44,6 @@ public:
 public:
 	void initialize(const drawInitContext& context) override;
 	void render(renderShared* rs) override;
-	void begin_barrier(rhiCommandList* cmd) override;
-	void end_barrier(rhiCommandList* cmd) override;
 	void update_instances(renderShared* rs, const u32 instancebuf_desc_idx) override;
 
 public:
@@ -62,6 +60,8 @@ protected:
 private:
 	void build(scene* s, const vec2 framebuffer_size);
 	void update_cascade(scene* s, const vec2 framebuffer_size);
+	// cascades [first, last), into the primary or a secondary
+	void record_cascades(rhiCommandList* cmd, const u32 first, const u32 last);
 
 private:
 	u32 cascade_count;
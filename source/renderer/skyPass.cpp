@@ -4,14 +4,150 @@
 #include "rhi/rhiDeviceContext.h"
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiFrameContext.h"
+#include "rhi/rhiBuffer.h"
+#include "rhi/rhiQuery.h"
 #include "scene/camera.h"
+#include "util/hash.h"
+#include "util/assetPath.h"
 
 namespace
 {
     constexpr i32 cube_resolution = 512;
-    constexpr i32 irradiance_cube_resolution = 32;
+    constexpr u32 sh_face_size = 64;
+    constexpr u32 sh_coeff_count = 9;
+    constexpr u32 sh_buffer_bytes = sizeof(vec4) * sh_coeff_count;
     constexpr u32 cube_face_count = 6;
     constexpr u32 dispatch_localgroupsize = 8;
+    constexpr u32 min_specular_samples = 32;
+    constexpr u32 max_specular_samples = 256;
+
+    // the pdf picked source mip removes most of the noise, so rough mips don't need thousands of samples
+    u32 specular_sample_count(const f32 roughness)
+    {
+        if (roughness <= 0.f)
+            return 1; // mirror : straight copy of the sky cube
+        return std::clamp(static_cast<u32>(max_specular_samples * roughness), min_specular_samples, max_specular_samples);
+    }
+
+    enum class iblStage : u32
+    {
+        equirect,
+        sh,
+        specular,
+        brdf,
+        count
+    };
+
+    f64 elapsed_ms(const std::chrono::steady_clock::time_point begin)
+    {
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    constexpr u32 ibl_cache_magic = 0x4C424949; // 'IIBL'
+    constexpr u32 ibl_cache_version = 3;
+    constexpr u32 rgba16f_bytes = 8;
+    constexpr u32 rg16f_bytes = 4;
+
+    struct iblCacheHeader
+    {
+        u32 magic;
+        u32 version;
+        u64 key;
+        u64 payload_bytes;
+    };
+
+    // payload order : sky mips, sh coeffs, specular mips, brdf lut
+    struct iblCacheLayout
+    {
+        std::vector<rhiBufferImageCopy> sky;
+        u64 sh_offset = 0;
+        std::vector<rhiBufferImageCopy> specular;
+        std::vector<rhiBufferImageCopy> brdf;
+        u64 bytes = 0;
+    };
+
+    std::vector<rhiBufferImageCopy> layout_regions(const u32 resolution, const u32 mips, const u32 layers, const u32 texel_bytes, u64& offset)
+    {
+        std::vector<rhiBufferImageCopy> regions;
+        regions.reserve(mips);
+        for (u32 mip = 0; mip < mips; ++mip)
+        {
+            const u32 size = std::max(1u, resolution >> mip);
+            regions.push_back(rhiBufferImageCopy{
+                .buffer_offset = offset,
+                .imageSubresource = {
+                    .aspect = rhiImageAspect::color,
+                    .mip_level = mip,
+                    .base_array_layer = 0,
+                    .layer_count = layers
+                },
+                .image_extent = { size, size, 1 }
+            });
+            offset += static_cast<u64>(size) * size * layers * texel_bytes;
+        }
+        return regions;
+    }
+
+    // content hash of the last hdr, reused while its path, size and write time are unchanged
+    struct hdrHashMemo
+    {
+        u32 magic;
+        u32 version;
+        u64 path_hash;
+        u64 file_size;
+        i64 write_time;
+        u64 content_hash;
+    };
+    constexpr u32 hdr_memo_magic = 0x4D524448; // 'HDRM'
+    constexpr u32 hdr_memo_version = 1;
+    const std::filesystem::path hdr_memo_path = "cache/ibl_hdr.memo";
+
+    u64 hdr_content_hash(const std::filesystem::path& hdr_path)
+    {
+        std::error_code ec;
+        const u64 file_size = std::filesystem::file_size(hdr_path, ec);
+        if (ec)
+            throw std::runtime_error("failed to open hdr");
+        const i64 write_time = std::filesystem::last_write_time(hdr_path, ec).time_since_epoch().count();
+        const std::string path = hdr_path.string();
+        const u64 path_hash = fnv1a64(path.data(), static_cast<u32>(path.size()));
+
+        hdrHashMemo memo{};
+        std::ifstream memo_file(hdr_memo_path, std::ios::binary);
+        if (memo_file.read(reinterpret_cast<char*>(&memo), sizeof(hdrHashMemo))
+            && memo.magic == hdr_memo_magic && memo.version == hdr_memo_version && !ec
+            && memo.path_hash == path_hash && memo.file_size == file_size && memo.write_time == write_time)
+        {
+            return memo.content_hash;
+        }
+
+        std::ifstream f(hdr_path, std::ios::binary);
+        if (!f)
+            throw std::runtime_error("failed to open hdr");
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+        memo = hdrHashMemo{
+            .magic = hdr_memo_magic,
+            .version = hdr_memo_version,
+            .path_hash = path_hash,
+            .file_size = file_size,
+            .write_time = write_time,
+            .content_hash = fast_hash64(bytes.data(), bytes.size())
+        };
+        save_binary(hdr_memo_path, &memo, sizeof(hdrHashMemo));
+        return memo.content_hash;
+    }
+
+    iblCacheLayout make_ibl_layout(const u32 cube_mip)
+    {
+        iblCacheLayout layout;
+        layout.sky = layout_regions(cube_resolution, cube_mip, cube_face_count, rgba16f_bytes, layout.bytes);
+        layout.sh_offset = layout.bytes;
+        layout.bytes += sh_buffer_bytes;
+        layout.specular = layout_regions(cube_resolution, cube_mip, cube_face_count, rgba16f_bytes, layout.bytes);
+        layout.brdf = layout_regions(cube_resolution, 1, 1, rg16f_bytes, layout.bytes);
+        return layout;
+    }
 }
 
 void skyPass::initialize(const drawInitContext& context)
@@ -19,16 +155,43 @@ void skyPass::initialize(const drawInitContext& context)
     drawPass::initialize(context);
 }
 
-void skyPass::precompile_dispatch()
+void skyPass::precompile_dispatch(const std::string& sky_hdr)
 {
     auto rs = init_context->rs;
     const u32 cube_mip = static_cast<u32>(std::floor(std::log2(cube_resolution))) + 1;
 
+    //std::string hdr_path = asset_path("kloofendal_28d_misty_puresky_4k.hdr").string();
+    //std::string hdr_path = asset_path("818-hdri-skies-com.hdr").string();
+    std::string hdr_path = sky_hdr.empty() ? asset_path("qwantani_moonrise_puresky_4k.hdr").string() : sky_hdr;
+    std::error_code ec;
+    if (hdr_path != rhiTexture::procedural_sky && !std::filesystem::is_regular_file(hdr_path, ec))
+    {
+        std::cout << std::format("[skyPass] sky hdr '{}' not found, using the procedural sky\n", hdr_path);
+        hdr_path = rhiTexture::procedural_sky;
+    }
+    create_ibl_targets();
+    ibl_timings = {};
+
+    // same hdr and parameters as the last run, skip the whole precompute
+    auto begin = std::chrono::steady_clock::now();
+    ibl_key = make_ibl_key(hdr_path);
+    ibl_cache_path = std::format("cache/ibl_{:016x}.bin", ibl_key);
+    ibl_timings.hash_ms = elapsed_ms(begin);
+
+    begin = std::chrono::steady_clock::now();
+    if (load_ibl_cache())
+    {
+        ibl_timings.cache_ms = elapsed_ms(begin);
+        report_ibl_timings(true);
+        return;
+    }
+
     // ************************************* create sky cube map *************************************
     // hdr to equirect
-    //equirect_tex = rs->context->create_texture_from_path("E:\\Sponza\\resource\\kloofendal_28d_misty_puresky_4k.hdr", true, false);
-    equirect_tex = rs->context->create_texture_from_path("E:\\Sponza\\resource\\qwantani_moonrise_puresky_4k.hdr", true, false);
-    //equirect_tex = rs->context->create_texture_from_path("E:\\Sponza\\resource\\818-hdri-skies-com.hdr", true, false);
+    begin = std::chrono::steady_clock::now();
+    equirect_tex = rs->context->create_texture_from_path(hdr_path, true, false);
+    ibl_timings.decode_ms = elapsed_ms(begin);
+    begin = std::chrono::steady_clock::now();
 
     // create compute pipeline layout
     auto cs_descriptor_layout1 = rs->context->create_descriptor_set_layout(
@@ -113,22 +276,12 @@ void skyPass::precompile_dispatch()
     rs->context->update_descriptors({ equirect_desc, sampler_write_desc });
 
     // create compute pipeline
-    auto cs = shaderio::load_shader_binary("E:\\Sponza\\Build\\shaders\\equirect_to_cube.cs.spv");
+    auto cs = rs->shader_library->load("equirect_to_cube.cs.spv");
     const rhiComputePipelineDesc cs_desc{
         .cs = cs
     };
     cs_pipeline = rs->context->create_compute_pipeline(cs_desc, cs_pipeline_layout);
 
-    // create cubemap
-    const rhiTextureDesc d{
-        .width = cube_resolution,
-        .height = cube_resolution,
-        .layers = cube_face_count,
-        .mips = cube_mip,
-        .format = rhiFormat::RGBA32_SFLOAT
-    };
-    sky_cubemap = init_context->rs->context->create_texture_cubemap(d);
-
     // compute pipeline
     std::vector<rhiDescriptorImageInfo> image_infos;
     image_infos.reserve(cube_mip);
@@ -152,7 +305,19 @@ void skyPass::precompile_dispatch()
     };
     rs->context->update_descriptors({ uav_desc });
 
-    auto cmd = rs->frame_context->get_command_list(rhiQueueType::compute);
+    // one-time, recorded on graphics like load_ibl_cache so the exclusive targets never change queue family
+    auto cmd = rs->frame_context->get_command_list(rhiQueueType::graphics);
+    gpuScope zone(rs->gpu_profiler.get(), cmd, "ibl_precompute", rhiQueueType::graphics);
+    constexpr u32 stage_count = static_cast<u32>(iblStage::count);
+    ibl_timestamps = rs->context->create_timestamp_pool(stage_count * 2);
+    cmd->reset_timestamps(ibl_timestamps.get(), 0, stage_count * 2);
+    auto stamp = [this, cmd](const iblStage stage, const bool end)
+        {
+            const u32 index = static_cast<u32>(stage) * 2 + (end ? 1 : 0);
+            cmd->write_timestamp(ibl_timestamps.get(), index, end ? rhiPipelineStage::bottom_of_pipe : rhiPipelineStage::top_of_pipe);
+        };
+
+    stamp(iblStage::equirect, false);
     cmd->bind_pipeline(cs_pipeline.get());
     cmd->bind_descriptor_sets(cs_pipeline_layout, rhiPipelineType::compute, { cs_descriptor_sets1 }, 0, {});
     cmd->bind_descriptor_sets(cs_pipeline_layout, rhiPipelineType::compute, { cs_descriptor_sets2 }, 1, {});
@@ -169,40 +334,120 @@ void skyPass::precompile_dispatch()
 
         cmd->image_barrier(sky_cubemap.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly, mip, 1, 0, cube_face_count);
     }
+    stamp(iblStage::equirect, true);
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // ************************************* create irradiance cubemap *************************************
-    auto irr_descriptor_layout = rs->context->create_descriptor_set_layout(
+    // ************************************* project sky to L2 sh irradiance *************************************
+    build_sh_projection();
+    stamp(iblStage::sh, false);
+    project_sh(cmd, false);
+    stamp(iblStage::sh, true);
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ************************************* create specular prefiltered cubemap *************************************
+    build_specular_prefilter();
+    stamp(iblStage::specular, false);
+    prefilter_specular(cmd, 0, cube_mip, rhiImageLayout::undefined, false);
+    stamp(iblStage::specular, true);
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // ************************************* create BRDF integration LUT *************************************
+    auto brdf_descriptor_layout = rs->context->create_descriptor_set_layout(
         {
             {
                 .binding = 0,
-                .type = rhiDescriptorType::sampled_image,
+                .type = rhiDescriptorType::storage_image,
                 .count = 1,
                 .stage = rhiShaderStage::compute
+            }
+        }
+    );
+    auto brdf_descriptor_pool = rs->context->create_descriptor_pool({
+            .pool_sizes = {
+                rhiDescriptorPoolSize{
+                    .type = rhiDescriptorType::storage_image,
+                    .count = 1,
+                },
+                rhiDescriptorPoolSize{
+                    .type = rhiDescriptorType::uniform_buffer,
+                    .count = 1,
+                },
             },
+        }, 4);
+
+    auto brdf_pipeline_layout = rs->context->create_pipeline_layout({ brdf_descriptor_layout }, { { rhiShaderStage::compute, sizeof(brdfCB) } }, nullptr);
+    auto brdf_descriptor_sets = rs->context->allocate_descriptor_sets(brdf_descriptor_pool, { brdf_descriptor_layout });
+
+    // compute pipeline
+    const rhiWriteDescriptor brdf_uav_desc{
+        .set = brdf_descriptor_sets[0],
+        .binding = 0,
+        .array_index = 0,
+        .count = 1,
+        .type = rhiDescriptorType::storage_image,
+        .image = {
+            rhiDescriptorImageInfo{
+                .texture = brdf_lut.get(),
+                .layout = rhiImageLayout::general
+            }
+        }
+    };
+    rs->context->update_descriptors({ brdf_uav_desc });
+
+    // create compute pipeline
+    auto brdf_cs = rs->shader_library->load("brdf_lut.cs.spv");
+    const rhiComputePipelineDesc brdf_cs_desc{
+        .cs = brdf_cs
+    };
+    brdf_cs_pipeline = rs->context->create_compute_pipeline(brdf_cs_desc, brdf_pipeline_layout);
+
+    // create brdf lut
+    stamp(iblStage::brdf, false);
+    cmd->bind_pipeline(brdf_cs_pipeline.get());
+    cmd->bind_descriptor_sets(brdf_pipeline_layout, rhiPipelineType::compute, brdf_descriptor_sets, 0, {});
+
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::undefined, rhiImageLayout::compute);
+
+    const brdfCB brdf_cb = { cube_resolution };
+    cmd->push_constants(brdf_pipeline_layout, rhiShaderStage::compute, 0, sizeof(brdfCB), &brdf_cb);
+    const u32 brdf_xy = static_cast<u32>(std::ceil(cube_resolution / dispatch_localgroupsize));
+    cmd->dispatch(brdf_xy, brdf_xy, 1);
+
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly);
+    stamp(iblStage::brdf, true);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    record_ibl_readback(cmd);
+    ibl_timings.record_ms = elapsed_ms(begin);
+}
+
+void skyPass::build_sh_projection()
+{
+    auto rs = init_context->rs;
+    auto sh_descriptor_layout = rs->context->create_descriptor_set_layout(
+        {
             {
-                .binding = 1,
-                .type = rhiDescriptorType::sampler,
+                .binding = 0,
+                .type = rhiDescriptorType::sampled_image,
                 .count = 1,
                 .stage = rhiShaderStage::compute
             },
             {
-                .binding = 2,
-                .type = rhiDescriptorType::storage_image,
+                .binding = 1,
+                .type = rhiDescriptorType::sampler,
                 .count = 1,
                 .stage = rhiShaderStage::compute
             },
             {
-                .binding = 3,
-                .type = rhiDescriptorType::uniform_buffer,
+                .binding = 2,
+                .type = rhiDescriptorType::storage_buffer,
                 .count = 1,
                 .stage = rhiShaderStage::compute
             }
         }
     );
-    auto irr_descriptor_pool = rs->context->create_descriptor_pool({
+    auto sh_descriptor_pool = rs->context->create_descriptor_pool({
             .pool_sizes = {
                 rhiDescriptorPoolSize{
-                    .type = rhiDescriptorType::storage_image,
+                    .type = rhiDescriptorType::storage_buffer,
                     .count = 1,
                 },
                 rhiDescriptorPoolSize{
@@ -213,18 +458,14 @@ void skyPass::precompile_dispatch()
                     .type = rhiDescriptorType::sampler,
                     .count = 1,
                 },
-                rhiDescriptorPoolSize{
-                    .type = rhiDescriptorType::uniform_buffer,
-                    .count = 1,
-                },
             },
-        }, 4);
+        }, 1);
 
-    auto irr_pipeline_layout = rs->context->create_pipeline_layout({ irr_descriptor_layout });
-    auto irr_descriptor_sets = rs->context->allocate_descriptor_sets(irr_descriptor_pool, { irr_descriptor_layout });
+    sh_pipeline_layout = rs->context->create_pipeline_layout({ sh_descriptor_layout }, { { rhiShaderStage::compute, sizeof(shProjectCB) } });
+    sh_descriptor_sets = rs->context->allocate_descriptor_sets(sh_descriptor_pool, { sh_descriptor_layout });
 
-    const rhiWriteDescriptor irr_sky_cubemap_desc{
-        .set = irr_descriptor_sets[0],
+    const rhiWriteDescriptor sh_sky_cubemap_desc{
+        .set = sh_descriptor_sets[0],
         .binding = 0,
         .count = 1,
         .type = rhiDescriptorType::sampled_image,
@@ -237,84 +478,89 @@ void skyPass::precompile_dispatch()
             .layout = rhiImageLayout::shader_readonly
         }}
     };
-    const rhiWriteDescriptor irr_sampler_write_desc{
-        .set = irr_descriptor_sets[0],
+    const rhiWriteDescriptor sh_sampler_write_desc{
+        .set = sh_descriptor_sets[0],
         .binding = 1,
         .array_index = 0,
         .count = 1,
         .type = rhiDescriptorType::sampler,
-        .image = { sampler_image_info }
-    };
-    const rhiTextureDesc irr_tex_desc{
-        .width = irradiance_cube_resolution,
-        .height = irradiance_cube_resolution,
-        .layers = cube_face_count,
-        .mips = 1,
-        .format = rhiFormat::RGBA16F,
+        .image = { rhiDescriptorImageInfo{ .sampler = rs->samplers.linear_clamp.get() } }
     };
-    irradiance_cubemap = init_context->rs->context->create_texture_cubemap(irr_tex_desc);
-
-    // compute pipeline
-    const rhiWriteDescriptor irr_uav_desc{
-        .set = irr_descriptor_sets[0],
+    const rhiWriteDescriptor sh_out_write_desc{
+        .set = sh_descriptor_sets[0],
         .binding = 2,
         .array_index = 0,
         .count = 1,
-        .type = rhiDescriptorType::storage_image,
-        .image = {
-            {
-                .texture_cubemap = irradiance_cubemap.get(),
-                .mip = 0,
-                .base_layer = 0,
-                .layer_count = cube_face_count,
-                .layout = rhiImageLayout::general
-            }
-        }
-    };
-
-    rs->create_or_resize_buffer(irradiance_cb, sizeof(irradianceCB), rhiBufferUsage::transfer_dst | rhiBufferUsage::uniform, rhiMem::auto_device);
-    const irradianceCB cb = { irradiance_cube_resolution, 128 };
-    rs->upload_to_device(irradiance_cb.get(), &cb, sizeof(irradianceCB));
-    rs->buffer_barrier(irradiance_cb.get(), rhiBufferBarrierDescription{
-        rhiPipelineStage::transfer, rhiPipelineStage::compute_shader, rhiAccessFlags::transfer_write, rhiAccessFlags::uniform_read, 0, sizeof(irradianceCB),
-        rs->context->get_queue_family_index(rhiQueueType::compute), rs->context->get_queue_family_index(rhiQueueType::transfer) });
-
-    const rhiDescriptorBufferInfo irr_buffer_info{
-       .buffer = irradiance_cb.get(),
-       .offset = 0,
-       .range = sizeof(irradianceCB)
-    };
-    const rhiWriteDescriptor irr_cb_write_desc{
-        .set = irr_descriptor_sets[0],
-        .binding = 3,
-        .array_index = 0,
-        .count = 1,
-        .type = rhiDescriptorType::uniform_buffer,
-        .buffer = { irr_buffer_info }
+        .type = rhiDescriptorType::storage_buffer,
+        .buffer = { rhiDescriptorBufferInfo{
+            .buffer = sh_buffer.get(),
+            .offset = 0,
+            .range = sh_buffer_bytes
+        }}
     };
-
-    rs->context->update_descriptors({ irr_sky_cubemap_desc, irr_sampler_write_desc, irr_uav_desc, irr_cb_write_desc });
+    rs->context->update_descriptors({ sh_sky_cubemap_desc, sh_sampler_write_desc, sh_out_write_desc });
 
     // create compute pipeline
-    auto irr_cs = shaderio::load_shader_binary("E:\\Sponza\\Build\\shaders\\irradiance_cube.cs.spv");
-    const rhiComputePipelineDesc irr_cs_desc{
-        .cs = irr_cs
+    auto sh_cs = rs->shader_library->load("sh_project.cs.spv");
+    const rhiComputePipelineDesc sh_cs_desc{
+        .cs = sh_cs
     };
-    irr_cs_pipeline = rs->context->create_compute_pipeline(irr_cs_desc, irr_pipeline_layout);
+    sh_cs_pipeline = rs->context->create_compute_pipeline(sh_cs_desc, sh_pipeline_layout);
+}
 
-    // create irradiance_cubemap
-    cmd->bind_pipeline(irr_cs_pipeline.get());
-    cmd->bind_descriptor_sets(irr_pipeline_layout, rhiPipelineType::compute, { irr_descriptor_sets }, 0, {});
+void skyPass::project_sh(rhiCommandList* cmd, const bool release_to_graphics)
+{
+    // previous frames may still read the coefficients.
+    // on the compute family the frame's semaphore wait on graphics covers it, the old contents are discarded
+    if (!release_to_graphics)
+    {
+        cmd->buffer_barrier(sh_buffer.get(), rhiBufferBarrierDescription{
+            .src_stage = rhiPipelineStage::fragment_shader,
+            .dst_stage = rhiPipelineStage::compute_shader,
+            .src_access = rhiAccessFlags::uniform_read,
+            .dst_access = rhiAccessFlags::shader_write,
+            .size = sh_buffer_bytes
+            });
+    }
 
-    cmd->image_barrier(irradiance_cubemap.get(), rhiImageLayout::undefined, rhiImageLayout::compute, 0, 1, 0, cube_face_count);
+    cmd->bind_pipeline(sh_cs_pipeline.get());
+    cmd->bind_descriptor_sets(sh_pipeline_layout, rhiPipelineType::compute, sh_descriptor_sets, 0, {});
+    const shProjectCB cb{
+        .face_size = sh_face_size,
+        .mip_level = static_cast<u32>(std::log2(cube_resolution / sh_face_size))
+    };
+    cmd->push_constants(sh_pipeline_layout, rhiShaderStage::compute, 0, sizeof(shProjectCB), &cb);
+    // single group reduction over the whole cube
+    cmd->dispatch(1, 1, 1);
 
-    const u32 xy = static_cast<u32>(std::ceil(irradiance_cube_resolution / dispatch_localgroupsize));
-    cmd->dispatch(xy, xy, cube_face_count);
+    if (release_to_graphics)
+    {
+        // acquired by acquire_prefiltered before lighting reads it
+        cmd->buffer_barrier(sh_buffer.get(), rhiBufferBarrierDescription{
+            .src_stage = rhiPipelineStage::compute_shader,
+            .dst_stage = rhiPipelineStage::none,
+            .src_access = rhiAccessFlags::shader_write,
+            .dst_access = rhiAccessFlags::none,
+            .size = sh_buffer_bytes,
+            .src_queue = compute_family(),
+            .dst_queue = graphics_family()
+            });
+        return;
+    }
+    cmd->buffer_barrier(sh_buffer.get(), rhiBufferBarrierDescription{
+        .src_stage = rhiPipelineStage::compute_shader,
+        .dst_stage = rhiPipelineStage::fragment_shader | rhiPipelineStage::copy,
+        .src_access = rhiAccessFlags::shader_write,
+        .dst_access = rhiAccessFlags::uniform_read | rhiAccessFlags::transfer_read,
+        .size = sh_buffer_bytes
+        });
+}
 
-    cmd->image_barrier(irradiance_cubemap.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly, 0, 1, 0, cube_face_count);
+void skyPass::build_specular_prefilter()
+{
+    auto rs = init_context->rs;
+    const u32 cube_mip = get_cubemap_mip_count();
 
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // ************************************* create specular prefiltered cubemap *************************************
     auto spec_descriptor_layout1 = rs->context->create_descriptor_set_layout(
         {
             {
@@ -365,9 +611,9 @@ void skyPass::precompile_dispatch()
             .create_flags = rhiDescriptorPoolCreateFlags::update_after_bind
         }, 4);
 
-    auto spec_pipeline_layout = rs->context->create_pipeline_layout({ spec_descriptor_layout1, spec_descriptor_layout2 }, { { rhiShaderStage::compute, sizeof(specularCB) } }, nullptr);
-    auto spec_descriptor_sets1 = rs->context->allocate_descriptor_sets(spec_descriptor_pool, { spec_descriptor_layout1 });
-    auto spec_descriptor_sets2 = rs->context->allocate_descriptor_indexing_sets(spec_descriptor_pool, { spec_descriptor_layout2 }, { cube_mip });
+    spec_pipeline_layout = rs->context->create_pipeline_layout({ spec_descriptor_layout1, spec_descriptor_layout2 }, { { rhiShaderStage::compute, sizeof(specularCB) } }, nullptr);
+    spec_descriptor_sets1 = rs->context->allocate_descriptor_sets(spec_descriptor_pool, { spec_descriptor_layout1 });
+    spec_descriptor_sets2 = rs->context->allocate_descriptor_indexing_sets(spec_descriptor_pool, { spec_descriptor_layout2 }, { cube_mip });
 
     const rhiWriteDescriptor spec_sky_cube_desc{
         .set = spec_descriptor_sets1[0],
@@ -389,27 +635,17 @@ void skyPass::precompile_dispatch()
         .array_index = 0,
         .count = 1,
         .type = rhiDescriptorType::sampler,
-        .image = { sampler_image_info }
+        .image = { rhiDescriptorImageInfo{ .sampler = rs->samplers.linear_clamp.get() } }
     };
     rs->context->update_descriptors({ spec_sky_cube_desc, spec_sampler_write_desc });
 
     // create compute pipeline
-    auto spec_cs = shaderio::load_shader_binary("E:\\Sponza\\Build\\shaders\\specular_cube.cs.spv");
+    auto spec_cs = rs->shader_library->load("specular_cube.cs.spv");
     const rhiComputePipelineDesc spec_cs_desc{
         .cs = spec_cs
     };
     spec_pipeline = rs->context->create_compute_pipeline(spec_cs_desc, spec_pipeline_layout);
 
-    // create cubemap
-    const rhiTextureDesc spec_desc{
-        .width = cube_resolution,
-        .height = cube_resolution,
-        .layers = cube_face_count,
-        .mips = cube_mip,
-        .format = rhiFormat::RGBA16F
-    };
-    specular_cubemap = init_context->rs->context->create_texture_cubemap(spec_desc);
-
     // compute pipeline
     std::vector<rhiDescriptorImageInfo> spec_image_infos;
     spec_image_infos.reserve(cube_mip);
@@ -432,53 +668,164 @@ void skyPass::precompile_dispatch()
         .image = spec_image_infos
     };
     rs->context->update_descriptors({ spec_uav_desc });
+}
+
+void skyPass::prefilter_specular(rhiCommandList* cmd, const u32 first_mip, const u32 mip_count, const rhiImageLayout old_layout, const bool release_to_graphics)
+{
+    const u32 cube_mip = get_cubemap_mip_count();
     cmd->bind_pipeline(spec_pipeline.get());
     cmd->bind_descriptor_sets(spec_pipeline_layout, rhiPipelineType::compute, { spec_descriptor_sets1 }, 0, {});
     cmd->bind_descriptor_sets(spec_pipeline_layout, rhiPipelineType::compute, { spec_descriptor_sets2 }, 1, {});
 
-    for (u32 mip = 0; mip < cube_mip; ++mip)
+    for (u32 mip = first_mip; mip < first_mip + mip_count; ++mip)
     {
         const u32 size = cube_resolution >> mip;
-        cmd->image_barrier(specular_cubemap.get(), rhiImageLayout::undefined, rhiImageLayout::compute, mip, 1, 0, cube_face_count);
+        cmd->image_barrier(specular_cubemap.get(), old_layout, rhiImageLayout::compute, mip, 1, 0, cube_face_count);
 
+        const f32 roughness = static_cast<f32>(mip) / (cube_mip - 1);
         const specularCB cb{
             .mip_level = mip,
-            .num_samples = (mip == 0) ? cube_resolution : std::max(1u, cube_resolution / (1u << mip)),
-            .roughness = static_cast<f32>(mip) / (cube_mip - 1),
+            .num_samples = specular_sample_count(roughness),
+            .roughness = roughness,
         };
         cmd->push_constants(spec_pipeline_layout, rhiShaderStage::compute, 0, sizeof(specularCB), &cb);
         const u32 xy = (size + (dispatch_localgroupsize - 1)) / dispatch_localgroupsize;
         cmd->dispatch(xy, xy, cube_face_count);
 
-        cmd->image_barrier(specular_cubemap.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly, mip, 1, 0, cube_face_count);
-    }
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // ************************************* create BRDF integration LUT *************************************
-    auto brdf_descriptor_layout = rs->context->create_descriptor_set_layout(
+        if (!release_to_graphics)
         {
-            {
-                .binding = 0,
-                .type = rhiDescriptorType::storage_image,
-                .count = 1,
-                .stage = rhiShaderStage::compute
-            }
+            cmd->image_barrier(specular_cubemap.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly, mip, 1, 0, cube_face_count);
+            continue;
         }
-    );
-    auto brdf_descriptor_pool = rs->context->create_descriptor_pool({
-            .pool_sizes = {
-                rhiDescriptorPoolSize{
-                    .type = rhiDescriptorType::storage_image,
-                    .count = 1,
-                },
-                rhiDescriptorPoolSize{
-                    .type = rhiDescriptorType::uniform_buffer,
-                    .count = 1,
-                },
-            },
-        }, 4);
+        // release half, acquire_prefiltered records the matching acquire with the same layout change
+        cmd->image_barrier(specular_cubemap.get(), rhiImageBarrierDescription{
+            .src_stage = rhiPipelineStage::compute_shader,
+            .dst_stage = rhiPipelineStage::none,
+            .src_access = rhiAccessFlags::shader_write,
+            .dst_access = rhiAccessFlags::none,
+            .old_layout = rhiImageLayout::compute,
+            .new_layout = rhiImageLayout::shader_readonly,
+            .src_queue = compute_family(),
+            .dst_queue = graphics_family(),
+            .base_mip = mip,
+            .level_count = 1,
+            .base_layer = 0,
+            .layer_count = cube_face_count
+            });
+    }
+}
 
-    auto brdf_pipeline_layout = rs->context->create_pipeline_layout({ brdf_descriptor_layout }, { { rhiShaderStage::compute, sizeof(brdfCB) } }, nullptr);
-    auto brdf_descriptor_sets = rs->context->allocate_descriptor_sets(brdf_descriptor_pool, { brdf_descriptor_layout });
+void skyPass::request_prefilter(const u32 mips_per_frame)
+{
+    if (!sh_cs_pipeline)
+        build_sh_projection();
+    if (!spec_pipeline)
+        build_specular_prefilter();
+
+    const u32 cube_mip = get_cubemap_mip_count();
+    prefilter_next_mip = 0;
+    prefilter_mips_per_frame = (mips_per_frame == 0) ? cube_mip : std::min(mips_per_frame, cube_mip);
+}
+
+void skyPass::prefilter_slice()
+{
+    const u32 cube_mip = get_cubemap_mip_count();
+    if (prefilter_next_mip >= cube_mip)
+        return;
+
+    // previous mips stay valid while the rest of the chain is refreshed
+    const u32 count = std::min(prefilter_mips_per_frame, cube_mip - prefilter_next_mip);
+    auto cmd = init_context->rs->frame_context->get_command_list(rhiQueueType::compute);
+    gpuScope zone(init_context->rs->gpu_profiler.get(), cmd, "ibl_prefilter", rhiQueueType::compute);
+
+    // on a separate family the slice's mips and the coefficients are owned by graphics, each one is rewritten
+    // whole so nothing is acquired first, undefined discards the old contents
+    const bool async = compute_family() != graphics_family();
+    if (prefilter_next_mip == 0)
+        project_sh(cmd, async);
+    prefilter_specular(cmd, prefilter_next_mip, count, async ? rhiImageLayout::undefined : rhiImageLayout::shader_readonly, async);
+    if (async)
+    {
+        pending_acquire = prefilterAcquire{
+            .first_mip = prefilter_next_mip,
+            .mip_count = count,
+            .sh = prefilter_next_mip == 0
+        };
+    }
+    prefilter_next_mip += count;
+}
+
+void skyPass::acquire_prefiltered(rhiCommandList* cmd)
+{
+    if (!pending_acquire.has_value())
+        return;
+
+    const prefilterAcquire acquire = pending_acquire.value();
+    pending_acquire.reset();
+    if (acquire.sh)
+    {
+        cmd->buffer_barrier(sh_buffer.get(), rhiBufferBarrierDescription{
+            .src_stage = rhiPipelineStage::none,
+            .dst_stage = rhiPipelineStage::fragment_shader,
+            .src_access = rhiAccessFlags::none,
+            .dst_access = rhiAccessFlags::uniform_read,
+            .size = sh_buffer_bytes,
+            .src_queue = compute_family(),
+            .dst_queue = graphics_family()
+            });
+    }
+    cmd->image_barrier(specular_cubemap.get(), rhiImageBarrierDescription{
+        .src_stage = rhiPipelineStage::none,
+        .dst_stage = rhiPipelineStage::fragment_shader,
+        .src_access = rhiAccessFlags::none,
+        .dst_access = rhiAccessFlags::shader_sampled_read,
+        .old_layout = rhiImageLayout::compute,
+        .new_layout = rhiImageLayout::shader_readonly,
+        .src_queue = compute_family(),
+        .dst_queue = graphics_family(),
+        .base_mip = acquire.first_mip,
+        .level_count = acquire.mip_count,
+        .base_layer = 0,
+        .layer_count = cube_face_count
+        });
+}
+
+u32 skyPass::compute_family() const
+{
+    return init_context->rs->context->get_queue_family_index(rhiQueueType::compute);
+}
+
+u32 skyPass::graphics_family() const
+{
+    return init_context->rs->context->get_queue_family_index(rhiQueueType::graphics);
+}
+
+void skyPass::create_ibl_targets()
+{
+    auto context = init_context->rs->context;
+    const u32 cube_mip = get_cubemap_mip_count();
+
+    const rhiTextureDesc sky_desc{
+        .width = cube_resolution,
+        .height = cube_resolution,
+        .layers = cube_face_count,
+        .mips = cube_mip,
+        .format = rhiFormat::RGBA16F,
+        // the sky pass samples it on graphics while a dynamic sky refresh reads it on compute
+        .shared_queues = true
+    };
+    sky_cubemap = context->create_texture_cubemap(sky_desc);
+
+    init_context->rs->create_or_resize_buffer(sh_buffer, sh_buffer_bytes, rhiBufferUsage::storage | rhiBufferUsage::uniform | rhiBufferUsage::transfer_src | rhiBufferUsage::transfer_dst, rhiMem::auto_device);
+
+    const rhiTextureDesc spec_desc{
+        .width = cube_resolution,
+        .height = cube_resolution,
+        .layers = cube_face_count,
+        .mips = cube_mip,
+        .format = rhiFormat::RGBA16F
+    };
+    specular_cubemap = context->create_texture_cubemap(spec_desc);
 
     const rhiTextureDesc brdf_tex_desc{
         .width = cube_resolution,
@@ -486,47 +833,144 @@ void skyPass::precompile_dispatch()
         .layers = 1,
         .mips = 1,
         .format = rhiFormat::RG16_SFLOAT,
-        .usage = rhiTextureUsage::storage | rhiTextureUsage::sampled
+        .usage = rhiTextureUsage::storage | rhiTextureUsage::sampled | rhiTextureUsage::transfer_src | rhiTextureUsage::transfer_dst
     };
-    brdf_lut = init_context->rs->context->create_texture(brdf_tex_desc);
+    brdf_lut = context->create_texture(brdf_tex_desc);
+}
 
-    // compute pipeline
-    const rhiWriteDescriptor brdf_uav_desc{
-        .set = brdf_descriptor_sets[0],
-        .binding = 0,
-        .array_index = 0,
-        .count = 1,
-        .type = rhiDescriptorType::storage_image,
-        .image = {
-            rhiDescriptorImageInfo{
-                .texture = brdf_lut.get(),
-                .layout = rhiImageLayout::general
-            }
-        }
-    };
-    rs->context->update_descriptors({ brdf_uav_desc });
+u64 skyPass::make_ibl_key(const std::string& hdr_path) const
+{
+    // a touched but identical hdr is re-read once and still hits the ibl cache
+    u64 key = hdr_path == rhiTexture::procedural_sky
+        ? fnv1a64(hdr_path.data(), static_cast<u32>(hdr_path.size()))
+        : hdr_content_hash(hdr_path);
+    key = hash_combine(key, ibl_cache_version);
+    key = hash_combine(key, cube_resolution);
+    key = hash_combine(key, sh_face_size);
+    key = hash_combine(key, get_cubemap_mip_count());
+    key = hash_combine(key, min_specular_samples);
+    key = hash_combine(key, max_specular_samples);
+    return key;
+}
 
-    // create compute pipeline
-    auto brdf_cs = shaderio::load_shader_binary("E:\\Sponza\\Build\\shaders\\brdf_lut.cs.spv");
-    const rhiComputePipelineDesc brdf_cs_desc{
-        .cs = brdf_cs
-    };
-    brdf_cs_pipeline = rs->context->create_compute_pipeline(brdf_cs_desc, brdf_pipeline_layout);
+bool skyPass::load_ibl_cache()
+{
+    std::ifstream f(ibl_cache_path, std::ios::binary);
+    if (!f)
+        return false;
 
-    // create brdf lut
-    cmd->bind_pipeline(brdf_cs_pipeline.get());
-    cmd->bind_descriptor_sets(brdf_pipeline_layout, rhiPipelineType::compute, brdf_descriptor_sets, 0, {});
+    const iblCacheLayout layout = make_ibl_layout(get_cubemap_mip_count());
+    iblCacheHeader header{};
+    f.read(reinterpret_cast<char*>(&header), sizeof(iblCacheHeader));
+    if (!f || header.magic != ibl_cache_magic || header.version != ibl_cache_version || header.key != ibl_key || header.payload_bytes != layout.bytes)
+        return false;
 
-    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::undefined, rhiImageLayout::compute);
+    auto context = init_context->rs->context;
+    auto staging = context->create_buffer(rhiBufferDesc{
+        .size = layout.bytes,
+        .usage = rhiBufferUsage::transfer_src,
+        .memory = rhiMem::auto_host
+        });
+    f.read(static_cast<char*>(staging->map()), layout.bytes);
+    if (!f)
+        return false;
+    staging->flush(0, layout.bytes);
+    staging->unmap();
 
-    const brdfCB brdf_cb = { cube_resolution };
-    cmd->push_constants(spec_pipeline_layout, rhiShaderStage::compute, 0, sizeof(brdfCB), &brdf_cb);
-    const u32 brdf_xy = static_cast<u32>(std::ceil(cube_resolution / dispatch_localgroupsize));
-    cmd->dispatch(brdf_xy, brdf_xy, 1);
+    auto cmd = context->begin_onetime_commands();
+    auto upload_cube = [&cmd, &staging](rhiTextureCubeMap* cube, const std::vector<rhiBufferImageCopy>& regions)
+        {
+            cmd->image_barrier(cube, rhiImageLayout::undefined, rhiImageLayout::transfer_dst, 0, cube->desc.mips, 0, cube_face_count);
+            cmd->copy_buffer_to_image(staging.get(), cube, rhiImageLayout::transfer_dst, regions);
+            cmd->image_barrier(cube, rhiImageLayout::transfer_dst, rhiImageLayout::shader_readonly, 0, cube->desc.mips, 0, cube_face_count);
+        };
+    upload_cube(sky_cubemap.get(), layout.sky);
+    upload_cube(specular_cubemap.get(), layout.specular);
 
-    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::compute, rhiImageLayout::shader_readonly);
+    cmd->copy_buffer(staging.get(), static_cast<u32>(layout.sh_offset), sh_buffer.get(), 0, sh_buffer_bytes);
+    cmd->buffer_barrier(sh_buffer.get(), rhiBufferBarrierDescription{
+        .src_stage = rhiPipelineStage::copy,
+        .dst_stage = rhiPipelineStage::fragment_shader,
+        .src_access = rhiAccessFlags::transfer_write,
+        .dst_access = rhiAccessFlags::uniform_read,
+        .size = sh_buffer_bytes
+        });
 
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::undefined, rhiImageLayout::transfer_dst);
+    cmd->copy_buffer_to_image(staging.get(), brdf_lut.get(), rhiImageLayout::transfer_dst, layout.brdf);
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::transfer_dst, rhiImageLayout::shader_readonly);
+    // frames are submitted to the same queue after this, the barriers above order them
+    std::vector<std::unique_ptr<rhiBuffer>> keep_alive;
+    keep_alive.push_back(std::move(staging));
+    context->submit_async(cmd, rhiQueueType::graphics, std::move(keep_alive));
+    return true;
+}
+
+void skyPass::record_ibl_readback(rhiCommandList* cmd)
+{
+    auto rs = init_context->rs;
+    const iblCacheLayout layout = make_ibl_layout(get_cubemap_mip_count());
+    ibl_readback = rs->context->create_buffer(rhiBufferDesc{
+        .size = layout.bytes,
+        .usage = rhiBufferUsage::transfer_dst,
+        .memory = rhiMem::auto_readback
+        });
+
+    auto readback_cube = [this, cmd](rhiTextureCubeMap* cube, const std::vector<rhiBufferImageCopy>& regions)
+        {
+            cmd->image_barrier(cube, rhiImageLayout::shader_readonly, rhiImageLayout::transfer_src, 0, cube->desc.mips, 0, cube_face_count);
+            cmd->copy_image_to_buffer(cube, rhiImageLayout::transfer_src, ibl_readback.get(), regions);
+            cmd->image_barrier(cube, rhiImageLayout::transfer_src, rhiImageLayout::shader_readonly, 0, cube->desc.mips, 0, cube_face_count);
+        };
+    readback_cube(sky_cubemap.get(), layout.sky);
+    readback_cube(specular_cubemap.get(), layout.specular);
+    cmd->copy_buffer(sh_buffer.get(), 0, ibl_readback.get(), static_cast<u32>(layout.sh_offset), sh_buffer_bytes);
+
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::shader_readonly, rhiImageLayout::transfer_src);
+    cmd->copy_image_to_buffer(brdf_lut.get(), rhiImageLayout::transfer_src, ibl_readback.get(), layout.brdf);
+    cmd->image_barrier(brdf_lut.get(), rhiImageLayout::transfer_src, rhiImageLayout::shader_readonly);
+    // the frame fence only orders device work, resolve_precompute maps the copies from the host
+    cmd->buffer_barrier(ibl_readback.get(), rhiBufferBarrierDescription{
+        .src_stage = rhiPipelineStage::copy,
+        .dst_stage = rhiPipelineStage::host,
+        .src_access = rhiAccessFlags::transfer_write,
+        .dst_access = rhiAccessFlags::host_read,
+        .size = layout.bytes
+        });
+
+    // written once the frame that recorded the copies has retired
+    ibl_readback_countdown = rs->frame_context->get_frame_size();
+}
+
+void skyPass::resolve_precompute()
+{
+    if (!ibl_readback || --ibl_readback_countdown > 0)
+        return;
+
+    std::vector<u64> ticks;
+    if (ibl_timestamps && ibl_timestamps->resolve(0, ibl_timestamps->capacity(), ticks))
+    {
+        for (u32 i = 0; i < static_cast<u32>(iblStage::count); ++i)
+            ibl_timings.gpu_ms[i] = ibl_timestamps->ticks_to_ms(ticks[i * 2 + 1] - ticks[i * 2]);
+    }
+    ibl_timestamps.reset();
+    report_ibl_timings(false);
+
+    const u64 bytes = ibl_readback->size();
+    ibl_readback->invalidate(0, bytes);
+    const iblCacheHeader header{
+        .magic = ibl_cache_magic,
+        .version = ibl_cache_version,
+        .key = ibl_key,
+        .payload_bytes = bytes
+    };
+    std::vector<u8> blob(sizeof(iblCacheHeader) + bytes);
+    std::memcpy(blob.data(), &header, sizeof(iblCacheHeader));
+    std::memcpy(blob.data() + sizeof(iblCacheHeader), ibl_readback->map(), bytes);
+    save_binary(ibl_cache_path, blob.data(), static_cast<u32>(blob.size()));
+
+    ibl_readback.reset();
+    equirect_tex.reset();
 }
 
 void skyPass::build_layouts(renderShared* rs)
@@ -561,54 +1005,32 @@ void skyPass::build_attachments(rhiDeviceContext* context)
 {
     render_info.renderpass_name = "sky";
     render_info.samples = rhiSampleCount::x1;
-    render_info.color_formats = { rhiFormat::RGBA8_UNORM };
+    render_info.color_formats = { scene_color_format };
     render_info.depth_format = std::nullopt;
 
+    // scene color comes from the render graph
     render_info.color_attachments.resize(1);
+    render_info.color_attachments[0].view = rhiRenderTargetView{
+        .texture = nullptr,
+        .mip = 0,
+        .layout = rhiImageLayout::color_attachment
+    };
     render_info.color_attachments[0].load_op = rhiLoadOp::clear;
     render_info.color_attachments[0].store_op = rhiStoreOp::store;
     render_info.color_attachments[0].clear = { {0,0,0,1},1.0f,0 };
-
-    const rhiTextureDesc td_color
-    {
-        .width = init_context->w,
-        .height = init_context->h,
-        .layers = 1,
-        .mips = 1,
-        .format = rhiFormat::RGBA8_UNORM,
-        .samples = rhiSampleCount::x1,
-        .is_depth = false
-    };
-    {
-        const auto sky_context = static_cast<skyInitContext*>(init_context.get());
-        const auto scene_color = sky_context->scene_color.lock();
-        rhiRenderTargetView rtview{
-            .texture = scene_color.get(),
-            .mip = 0,
-            .layout = rhiImageLayout::color_attachment
-        };
-        render_info.color_attachments[0].view = rtview;
-    }
 }
 
 void skyPass::build_pipeline(renderShared* rs)
 {
-    auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\fullscreen.vs.spv");
-    auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\skybox.ps.spv");
     const rhiGraphicsPipelineDesc pipeline_desc{
-        .vs = vs,
-        .fs = fs,
-        .color_formats = { rhiFormat::RGBA8_UNORM },
+        .color_formats = { scene_color_format },
         .depth_format = std::nullopt,
         .samples = rhiSampleCount::x1,
         .depth_test = false,
         .depth_write = false
     };
 
-    pipeline = rs->context->create_graphics_pipeline(pipeline_desc, pipeline_layout);
-
-    shaderio::free_shader_binary(vs);
-    shaderio::free_shader_binary(fs);
+    rs->pipeline_compiler->request(pipeline, pipeline_desc, { .vs = "fullscreen.vs.spv", .fs = "skybox.ps.spv" }, pipeline_layout);
 }
 
 void skyPass::update(drawUpdateContext* update_context)
@@ -622,7 +1044,7 @@ void skyPass::update(drawUpdateContext* update_context)
         .range = sizeof(globalsCB)
     };
     const rhiWriteDescriptor write_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 0,
         .array_index = 0,
         .count = 1,
@@ -631,7 +1053,7 @@ void skyPass::update(drawUpdateContext* update_context)
     };
 
     const rhiWriteDescriptor cube_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 1,
         .array_index = 0,
         .count = 1,
@@ -650,7 +1072,7 @@ void skyPass::update(drawUpdateContext* update_context)
         .sampler = init_context->rs->samplers.linear_clamp.get()
     };
     const rhiWriteDescriptor cube_sampler_write_desc{
-        .set = descriptor_sets[image_index.value()][0],
+        .set = descriptor_sets[frame_index.value()][0],
         .binding = 2,
         .array_index = 0,
         .count = 1,
@@ -665,21 +1087,16 @@ void skyPass::draw(rhiCommandList* cmd)
     cmd->draw_fullscreen();
 }
 
-void skyPass::begin_barrier(rhiCommandList* cmd)
+void skyPass::report_ibl_timings(const bool cache_hit) const
 {
-    const auto sky_context = static_cast<skyInitContext*>(init_context.get());
-    const auto scene_color = sky_context->scene_color.lock();
-    if (is_first_frame)
+    if (cache_hit)
     {
-        cmd->image_barrier(scene_color.get(), rhiImageLayout::undefined, rhiImageLayout::color_attachment);
-        is_first_frame = false;
+        std::cout << std::format("[skyPass] ibl cache hit : hash {:.2f} ms / load {:.2f} ms\n", ibl_timings.hash_ms, ibl_timings.cache_ms);
+        return;
     }
-    else
-        cmd->image_barrier(scene_color.get(), rhiImageLayout::shader_readonly, rhiImageLayout::color_attachment);
-}
-
-void skyPass::end_barrier(rhiCommandList* cmd)
-{
+    std::cout << std::format("[skyPass] ibl precompute : hash {:.2f} ms / decode {:.2f} ms / record {:.2f} ms / gpu equirect {:.3f} ms, sh {:.3f} ms, specular {:.3f} ms, brdf {:.3f} ms\n",
+        ibl_timings.hash_ms, ibl_timings.decode_ms, ibl_timings.record_ms,
+        ibl_timings.gpu_ms[0], ibl_timings.gpu_ms[1], ibl_timings.gpu_ms[2], ibl_timings.gpu_ms[3]);
 }
 
 const u32 skyPass::get_cubemap_mip_count() const
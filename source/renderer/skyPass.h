@@ -2,9 +2,10 @@
 
 #include "drawPass.h"
 
+class rhiTimestampPool;
+
 struct skyInitContext : public drawInitContext
 {
-    std::weak_ptr<rhiTexture> scene_color;
     virtual std::unique_ptr<drawInitContext> clone() const
     {
         return std::make_unique<skyInitContext>(*this);
@@ -28,10 +29,10 @@ public:
         u32 mip_level;
     };
 
-    struct alignas(16) irradianceCB
+    struct alignas(16) shProjectCB
     {
-        u32 out_size;        // out cube face resolution (32) 
-        u32 num_samples;     // irradiance samples (256~1024)
+        u32 face_size;       // sampled face resolution
+        u32 mip_level;       // sky cube mip with face_size texels
     };
 
     struct alignas(16) specularCB
@@ -47,38 +48,90 @@ public:
         u32 num_samples;
     };
 
+    struct iblTimings
+    {
+        f64 hash_ms = 0.0;
+        f64 cache_ms = 0.0;
+        f64 decode_ms = 0.0;
+        f64 record_ms = 0.0;
+        std::array<f64, 4> gpu_ms{}; // equirect, sh, specular, brdf
+    };
+
 public:
     void initialize(const drawInitContext& context) override;
     void update(drawUpdateContext* update_context) override;
 
 public:
-    void precompile_dispatch();
-    rhiTextureCubeMap* get_irradiance_map() { return irradiance_cubemap.get(); }
+    void precompile_dispatch(const std::string& sky_hdr);
+    void resolve_precompute();
+    // re-project sh and prefilter the specular chain, mips_per_frame 0 = whole chain in one frame
+    void request_prefilter(const u32 mips_per_frame = 0);
+    // records on the compute list, on a separate family what it wrote is released to graphics
+    void prefilter_slice();
+    // graphics half of the last slice's ownership transfer, before anything samples the ibl
+    void acquire_prefiltered(rhiCommandList* cmd);
+    bool is_prefiltering() const { return prefilter_next_mip < get_cubemap_mip_count(); }
+    const iblTimings& get_ibl_timings() const { return ibl_timings; }
+    rhiBuffer* get_sh_irradiance() { return sh_buffer.get(); }
     rhiTextureCubeMap* get_specular_map() { return specular_cubemap.get(); }
     rhiTexture* get_brdf_lut_map() { return brdf_lut.get(); }
     const u32 get_cubemap_mip_count() const;
 
 protected:
     void draw(rhiCommandList* cmd) override;
-    void begin_barrier(rhiCommandList* cmd) override;
-    void end_barrier(rhiCommandList* cmd) override;
     void build_layouts(renderShared* rs) override;
     void build_attachments(rhiDeviceContext* context) override;
     void build_pipeline(renderShared* rs) override;
 
+private:
+    void create_ibl_targets();
+    u64 make_ibl_key(const std::string& hdr_path) const;
+    bool load_ibl_cache();
+    void record_ibl_readback(rhiCommandList* cmd);
+    void build_sh_projection();
+    void project_sh(rhiCommandList* cmd, const bool release_to_graphics);
+    void build_specular_prefilter();
+    void prefilter_specular(rhiCommandList* cmd, const u32 first_mip, const u32 mip_count, const rhiImageLayout old_layout, const bool release_to_graphics);
+    u32 compute_family() const;
+    u32 graphics_family() const;
+    void report_ibl_timings(const bool cache_hit) const;
+
 private:
     std::unique_ptr<rhiTexture> equirect_tex;
     std::shared_ptr<rhiTextureCubeMap> sky_cubemap;
-    std::shared_ptr<rhiTextureCubeMap> irradiance_cubemap;
     std::shared_ptr<rhiTextureCubeMap> specular_cubemap;
     std::shared_ptr<rhiTexture> brdf_lut;
-    std::unique_ptr<rhiBuffer> irradiance_cb;
+    std::unique_ptr<rhiBuffer> sh_buffer;
+
+    // ibl disk cache
+    std::unique_ptr<rhiBuffer> ibl_readback;
+    std::filesystem::path ibl_cache_path;
+    u64 ibl_key = 0;
+    u32 ibl_readback_countdown = 0;
+    std::unique_ptr<rhiTimestampPool> ibl_timestamps;
+    iblTimings ibl_timings;
+
+    // sh projection and specular prefilter, kept for time sliced refresh
+    rhiPipelineLayout sh_pipeline_layout;
+    std::vector<rhiDescriptorSet> sh_descriptor_sets;
+    rhiPipelineLayout spec_pipeline_layout;
+    std::vector<rhiDescriptorSet> spec_descriptor_sets1;
+    std::vector<rhiDescriptorSet> spec_descriptor_sets2;
+    u32 prefilter_next_mip = ~0u;
+    u32 prefilter_mips_per_frame = 1;
+    // released by the compute slice, acquired on graphics in the same frame
+    struct prefilterAcquire
+    {
+        u32 first_mip = 0;
+        u32 mip_count = 0;
+        bool sh = false;
+    };
+    std::optional<prefilterAcquire> pending_acquire;
     
     std::unique_ptr<rhiPipeline> cs_pipeline;
-    std::unique_ptr<rhiPipeline> irr_cs_pipeline;
+    std::unique_ptr<rhiPipeline> sh_cs_pipeline;
     std::unique_ptr<rhiPipeline> spec_pipeline;
     std::unique_ptr<rhiPipeline> brdf_cs_pipeline;
 
     rhiDescriptorSetLayout set_fragment_layout;
-    bool is_first_frame = true;
 };
@@ -2,6 +2,64 @@
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiDeviceContext.h"
 #include "util/hash.h"
+#include <charconv>
+
+namespace
+{
+	constexpr u32 memo_magic = 0x4d485854; // 'TXHM'
+	constexpr u32 memo_version = 2;
+
+	bool file_stamp(const std::string& path, u64& size, i64& write_time)
+	{
+		std::error_code ec;
+		size = std::filesystem::file_size(path, ec);
+		if (ec)
+			return false;
+		write_time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+		return !ec;
+	}
+
+	u64 texture_bytes(const rhiTextureDesc& desc)
+	{
+		const rhiTextureImage image{ .desc = desc };
+		return image.byte_size();
+	}
+
+	rhiTextureImage make_solid_image(std::string_view hex, bool srgb)
+	{
+		u32 rgba = 0xff00ffff;
+		std::from_chars(hex.data(), hex.data() + hex.size(), rgba, 16);
+
+		constexpr u32 size = 4;
+		const u8 texel[4] = { u8(rgba >> 24), u8(rgba >> 16), u8(rgba >> 8), u8(rgba) };
+		// released through stbi_image_free like a decoded file
+		auto* pixels = static_cast<stbi_uc*>(std::malloc(size * size * 4));
+		for (u32 i = 0; i < size * size; ++i)
+			std::memcpy(pixels + i * 4, texel, 4);
+
+		rhiTextureImage image{
+			.desc = rhiTextureDesc{
+				.width = size,
+				.height = size,
+				.layers = 1,
+				.mips = 3,
+				.format = srgb ? rhiFormat::RGBA8_SRGB : rhiFormat::RGBA8_UNORM,
+				.samples = rhiSampleCount::x1,
+				.usage = rhiTextureUsage::from_file,
+				.is_depth = false
+			},
+			.pixels = pixels
+		};
+		image.pixel_hash = fast_hash64(pixels, size * size * 4);
+		return image;
+	}
+}
+
+textureCache::textureCache(rhiDeviceContext* context, const std::filesystem::path& cache_dir)
+	: context(context), memo_path(cache_dir / "texture_hash.memo")
+{
+	load_memo();
+}
 
 std::shared_ptr<rhiTexture> textureCache::get_or_create(std::string_view path, bool srgb)
 {
@@ -13,12 +71,69 @@ std::shared_ptr<rhiTexture> textureCache::get_or_create(std::string_view path, b
 	if (auto it = cache.find(key); it != cache.end())
 		return it->second;
 
-	auto texture = context->create_texture_from_path(path, false, srgb);
+	const rhiFormat format = srgb ? rhiFormat::RGBA8_SRGB : rhiFormat::RGBA8_UNORM;
+	u64 file_size = 0;
+	i64 write_time = 0;
+	const bool has_stamp = file_stamp(key, file_size, write_time);
+
+	// memo hit : same file already hashed in a previous run, skip decoding if the content is resident
+	if (has_stamp)
+	{
+		if (auto it = memo.find(key); it != memo.end() && it->second.file_size == file_size && it->second.write_time == write_time)
+		{
+			const textureHashMemo& m = it->second;
+			const rhiTextureDesc desc{ .width = m.width, .height = m.height, .mips = m.mips, .format = format };
+			if (auto sp = find_duplicate(rhiTextureImage::content_key(m.pixel_hash, desc), desc))
+			{
+				++stats.memo_hits;
+				cache.emplace(std::move(key), sp);
+				return sp;
+			}
+		}
+	}
+
+	rhiTextureImage image = key.starts_with(procedural_prefix)
+		? make_solid_image(std::string_view(key).substr(procedural_prefix.size()), srgb)
+		: rhiTexture::load_image(key, srgb);
+	if (has_stamp)
+	{
+		memo[key] = textureHashMemo{ image.pixel_hash, file_size, write_time, image.desc.width, image.desc.height, image.desc.mips, 0 };
+		memo_dirty = true;
+	}
+
+	const u64 content_hash = image.content_hash();
+	if (auto sp = find_duplicate(content_hash, image.desc))
+	{
+		image.release();
+		cache.emplace(std::move(key), sp);
+		return sp;
+	}
+
+	auto texture = context->create_texture_from_image(std::move(image));
 	std::shared_ptr<rhiTexture> sp = std::move(texture);
+	// a colliding key keeps its first texture, this one just isn't shared
+	content_textures.emplace(content_hash, sp);
+	++stats.unique_textures;
 	cache.emplace(std::move(key), sp);
 	return sp;
 }
 
+std::shared_ptr<rhiTexture> textureCache::find_duplicate(const u64 content_hash, const rhiTextureDesc& desc)
+{
+	auto it = content_textures.find(content_hash);
+	if (it == content_textures.end())
+		return {};
+
+	// pixels are gone after upload, so verify the shape the hash was taken over before sharing
+	const rhiTextureDesc& resident = it->second->desc;
+	if (resident.width != desc.width || resident.height != desc.height || resident.mips != desc.mips || resident.format != desc.format)
+		return {};
+
+	++stats.deduplicated;
+	stats.bytes_saved += texture_bytes(desc);
+	return it->second;
+}
+
 std::shared_ptr<rhiSampler> textureCache::get_or_create(const rhiSamplerDesc& desc)
 {
 	const rhiSamplerKey key = desc;
@@ -31,9 +146,76 @@ std::shared_ptr<rhiSampler> textureCache::get_or_create(const rhiSamplerDesc& de
 	return samplers[key];
 }
 
+void textureCache::report() const
+{
+	std::cout << std::format("[textureCache] unique {} / deduplicated {} (memo hits {}) / saved {:.2f} MB\n",
+		stats.unique_textures, stats.deduplicated, stats.memo_hits, static_cast<f64>(stats.bytes_saved) / (1024.0 * 1024.0));
+}
+
+void textureCache::load_memo()
+{
+	std::ifstream f(memo_path, std::ios::binary);
+	if (!f)
+		return;
+
+	u32 magic = 0;
+	u32 version = 0;
+	u32 count = 0;
+	f.read(reinterpret_cast<char*>(&magic), sizeof(u32));
+	f.read(reinterpret_cast<char*>(&version), sizeof(u32));
+	f.read(reinterpret_cast<char*>(&count), sizeof(u32));
+	if (!f || magic != memo_magic || version != memo_version)
+		return;
+
+	memo.reserve(count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		u32 len = 0;
+		f.read(reinterpret_cast<char*>(&len), sizeof(u32));
+		std::string path(len, '\0');
+		f.read(path.data(), len);
+		textureHashMemo m{};
+		f.read(reinterpret_cast<char*>(&m), sizeof(textureHashMemo));
+		if (!f)
+		{
+			memo.clear();
+			return;
+		}
+		memo.emplace(std::move(path), m);
+	}
+}
+
+void textureCache::save_memo()
+{
+	if (!memo_dirty)
+		return;
+
+	std::vector<u8> blob;
+	auto write = [&blob](const void* src, const size_t bytes)
+		{
+			const auto* p = static_cast<const u8*>(src);
+			blob.insert(blob.end(), p, p + bytes);
+		};
+	const u32 count = static_cast<u32>(memo.size());
+	write(&memo_magic, sizeof(u32));
+	write(&memo_version, sizeof(u32));
+	write(&count, sizeof(u32));
+	for (const auto& [path, m] : memo)
+	{
+		const u32 len = static_cast<u32>(path.size());
+		write(&len, sizeof(u32));
+		write(path.data(), len);
+		write(&m, sizeof(textureHashMemo));
+	}
+	save_binary(memo_path, blob.data(), static_cast<u32>(blob.size()));
+	memo_dirty = false;
+}
+
 void textureCache::clear()
 {
+	save_memo();
 	srgb_textures.clear();
 	linear_textures.clear();
+	content_textures.clear();
 	samplers.clear();
 }
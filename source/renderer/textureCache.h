@@ -4,20 +4,61 @@
 #include "rhi/rhiSampler.h"
 
 class rhiTexture;
+struct rhiTextureDesc;
 class rhiDeviceContext;
+
+struct textureHashMemo
+{
+	u64 pixel_hash;
+	u64 file_size;
+	i64 write_time;
+	u32 width;
+	u32 height;
+	u32 mips;
+	u32 pad;
+};
+
+struct textureCacheStats
+{
+	u32 unique_textures = 0;
+	u32 deduplicated = 0;
+	u32 memo_hits = 0;
+	u64 bytes_saved = 0;
+};
+
 class textureCache
 {
 public:
-	textureCache(rhiDeviceContext* context) : context(context) {}
+	// "procedural:rrggbbaa" resolves to a solid colour generated in memory
+	static constexpr std::string_view procedural_prefix = "procedural:";
+	static std::string procedural_color(const u32 rgba) { return std::format("{}{:08x}", procedural_prefix, rgba); }
+
+	textureCache(rhiDeviceContext* context, const std::filesystem::path& cache_dir = "cache");
 
 public:
 	std::shared_ptr<rhiTexture> get_or_create(std::string_view path, bool srgb = true);
 	std::shared_ptr<rhiSampler> get_or_create(const rhiSamplerDesc& desc);
+	const textureCacheStats& get_stats() const { return stats; }
+	void report() const;
+	void save_memo();
 	void clear();
 
+private:
+	void load_memo();
+	std::shared_ptr<rhiTexture> find_duplicate(const u64 content_hash, const rhiTextureDesc& desc);
+
 public:
 	rhiDeviceContext* context;
 	std::unordered_map<std::string, std::shared_ptr<rhiTexture>> srgb_textures;
 	std::unordered_map<std::string, std::shared_ptr<rhiTexture>> linear_textures;
 	std::unordered_map<rhiSamplerKey, std::shared_ptr<rhiSampler>, rhiSamplerKeyHash> samplers;
+
+	// content hash(pixels + format + extent + mips) -> texture, shared across paths
+	std::unordered_map<u64, std::shared_ptr<rhiTexture>> content_textures;
+
+private:
+	std::filesystem::path memo_path;
+	std::unordered_map<std::string, textureHashMemo> memo;
+	textureCacheStats stats;
+	bool memo_dirty = false;
 };
\ No newline at end of file
@@ -8,22 +8,6 @@
 
 void translucentPass::initialize(const drawInitContext& context)
 {
-#if !DISABLE_OIT
-	accumulate_color_alpha = context.rs->context->create_texture({
-		.width = context.w,
-		.height = context.h,
-		.layers = context.layers,
-		.mips = 1,
-		.format = rhiFormat::RGBA16F,
-		});
-	revealage = context.rs->context->create_texture({
-		.width = context.w,
-		.height = context.h,
-		.layers = context.layers,
-		.mips = 1,
-		.format = rhiFormat::RGBA16F
-		});
-#endif
 	draw_type = drawType::translucent;
 	
 	drawPass::initialize(context);
@@ -64,103 +48,6 @@ void translucentPass::draw(rhiCommandList* cmd)
 	}
 }
 
-void translucentPass::begin_barrier(rhiCommandList* cmd)
-{
-	auto ptr = static_cast<translucentInitContext*>(init_context.get());
-	ASSERT(ptr);
-#if DISABLE_OIT
-	auto scene_color = ptr->scene_color.lock();
-	ASSERT(scene_color);
-
-	cmd->image_barrier(scene_color.get(), rhiImageBarrierDescription{
-			.src_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-			.dst_stage = rhiPipelineStage::color_attachment_output,
-			.src_access = rhiAccessFlags::shader_sampled_read | rhiAccessFlags::shader_read,
-			.dst_access = rhiAccessFlags::color_attachment_read | rhiAccessFlags::color_attachment_write,
-			.old_layout = rhiImageLayout::shader_readonly,
-			.new_layout = rhiImageLayout::color_attachment
-		});
-#else
-	if (is_first_frame)
-	{
-		rhiImageBarrierDescription common_desc{
-			.src_stage = rhiPipelineStage::none,
-			.dst_stage = rhiPipelineStage::color_attachment_output,
-			.src_access = rhiAccessFlags::none,
-			.dst_access = rhiAccessFlags::color_attachment_write,
-			.old_layout = rhiImageLayout::undefined,
-			.new_layout = rhiImageLayout::color_attachment
-		};
-		cmd->image_barrier(accumulate_color_alpha.get(), common_desc);
-		cmd->image_barrier(revealage.get(), common_desc);
-		is_first_frame = false;
-	}
-	else
-	{
-		rhiImageBarrierDescription common_desc{
-			.src_stage = rhiPipelineStage::fragment_shader,
-			.dst_stage = rhiPipelineStage::color_attachment_output,
-			.src_access = rhiAccessFlags::shader_read,
-			.dst_access = rhiAccessFlags::color_attachment_write,
-			.old_layout = rhiImageLayout::shader_readonly,
-			.new_layout = rhiImageLayout::color_attachment
-		};
-		cmd->image_barrier(accumulate_color_alpha.get(), common_desc);
-		cmd->image_barrier(revealage.get(), common_desc);
-	}
-#endif
-	cmd->image_barrier(ptr->depth, rhiImageBarrierDescription{
-		.src_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-		.dst_stage = rhiPipelineStage::early_fragment_test | rhiPipelineStage::late_fragment_test,
-		.src_access = rhiAccessFlags::shader_read | rhiAccessFlags::shader_sampled_read,
-		.dst_access = rhiAccessFlags::depthstencil_attachment_read | rhiAccessFlags::depthstencil_attachment_write,
-		.old_layout = rhiImageLayout::shader_readonly,
-		.new_layout = rhiImageLayout::depth_stencil_attachment,
-		.layer_count = ptr->depth->desc.layers
-		});
-}
-
-void translucentPass::end_barrier(rhiCommandList* cmd)
-{
-	auto ptr = static_cast<translucentInitContext*>(init_context.get());
-	ASSERT(ptr);
-
-#if DISABLE_OIT
-	auto scene_color = ptr->scene_color.lock();
-	ASSERT(scene_color);
-
-	cmd->image_barrier(scene_color.get(), rhiImageBarrierDescription{
-			.src_stage = rhiPipelineStage::color_attachment_output,
-			.dst_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-			.src_access = rhiAccessFlags::color_attachment_read | rhiAccessFlags::color_attachment_write,
-			.dst_access = rhiAccessFlags::shader_sampled_read | rhiAccessFlags::shader_read,
-			.old_layout = rhiImageLayout::color_attachment,
-			.new_layout = rhiImageLayout::shader_readonly
-});
-#else
-	rhiImageBarrierDescription common_desc{
-		.src_stage = rhiPipelineStage::color_attachment_output,
-		.dst_stage = rhiPipelineStage::fragment_shader,
-		.src_access = rhiAccessFlags::color_attachment_write,
-		.dst_access = rhiAccessFlags::shader_read,
-		.old_layout = rhiImageLayout::color_attachment,
-		.new_layout = rhiImageLayout::shader_readonly
-	};
-	cmd->image_barrier(accumulate_color_alpha.get(), common_desc);
-	cmd->image_barrier(revealage.get(), common_desc);
-#endif
-
-	cmd->image_barrier(ptr->depth, rhiImageBarrierDescription{
-		.src_stage = rhiPipelineStage::early_fragment_test | rhiPipelineStage::late_fragment_test,
-		.dst_stage = rhiPipelineStage::compute_shader | rhiPipelineStage::fragment_shader,
-		.src_access = rhiAccessFlags::depthstencil_attachment_read | rhiAccessFlags::depthstencil_attachment_write,
-		.dst_access = rhiAccessFlags::shader_read | rhiAccessFlags::shader_sampled_read,
-		.old_layout = rhiImageLayout::depth_stencil_attachment,
-		.new_layout = rhiImageLayout::shader_readonly,
-		.layer_count = ptr->depth->desc.layers
-		});
-}
-
 void translucentPass::build_layouts(renderShared* rs)
 {
 	set_globals = rs->context->create_descriptor_set_layout({
@@ -213,25 +100,17 @@ void translucentPass::build_layouts(renderShared* rs)
 
 void translucentPass::build_attachments(rhiDeviceContext* context)
 {
-	auto ptr = static_cast<translucentInitContext*>(init_context.get());
-	ASSERT(ptr);
-
-	auto depth = ptr->depth;
-	ASSERT(depth);
-
 	render_info.renderpass_name = "translucent";
 	render_info.samples = rhiSampleCount::x1;
-	render_info.depth_format = rhiFormat::D32S8;
+	render_info.depth_format = gbuffer_depth_format;
 
+	// targets and depth come from the render graph
 #if DISABLE_OIT
-	auto sc = ptr->scene_color.lock();
-	ASSERT(depth);
-
-	render_info.color_formats = { rhiFormat::RGBA8_UNORM };
+	render_info.color_formats = { scene_color_format };
 	render_info.color_attachments.resize(1);
 
 	rhiRenderTargetView rt1{
-		.texture = sc.get(),
+		.texture = nullptr,
 		.layout = rhiImageLayout::color_attachment
 	};
 	render_info.color_attachments[0].view = rt1;
@@ -239,17 +118,17 @@ void translucentPass::build_attachments(rhiDeviceContext* context)
 	render_info.color_attachments[0].load_op = rhiLoadOp::load;
 	render_info.color_attachments[0].store_op = rhiStoreOp::store;
 #else
-	render_info.color_formats = { rhiFormat::RGBA16F, rhiFormat::RGBA16F };
+	render_info.color_formats = { oit_format, oit_format };
 	render_info.color_attachments.resize(2);
 	
 	rhiRenderTargetView rt1{
-		.texture = accumulate_color_alpha.get(),
+		.texture = nullptr,
 		.layout = rhiImageLayout::color_attachment
 	};
 	render_info.color_attachments[0].view = rt1;
 	render_info.color_attachments[0].clear = { {0,0,0,0},1.0f, 0 };
 	rhiRenderTargetView rt2{
-		.texture = revealage.get(),
+		.texture = nullptr,
 		.layout = rhiImageLayout::color_attachment
 	};
 	render_info.color_attachments[1].view = rt2;
@@ -261,7 +140,7 @@ void translucentPass::build_attachments(rhiDeviceContext* context)
 	}
 #endif
 	rhiRenderTargetView d{
-		.texture = depth,
+		.texture = nullptr,
 		.layout = rhiImageLayout::depth_readonly
 	};
 	rhiRenderingAttachment depth_attachment;
@@ -273,22 +152,14 @@ void translucentPass::build_attachments(rhiDeviceContext* context)
 
 void translucentPass::build_pipeline(renderShared* rs)
 {
-	auto ptr = static_cast<translucentInitContext*>(init_context.get());
-	ASSERT(ptr);
-
-	auto depth = ptr->depth;
-	ASSERT(depth);
-
 	rhiGraphicsPipelineDesc desc;
+	pipelineShaderNames shaders{ .vs = "translucent.vs.spv" };
 
-	auto vs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\translucent.vs.spv");
 #if DISABLE_OIT
-	auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\translucent_disable_oit.ps.spv");
+	shaders.fs = "translucent_disable_oit.ps.spv";
 	desc = rhiGraphicsPipelineDesc{
-		.vs = vs,
-		.fs = fs,
-		.color_formats = {rhiFormat::RGBA8_UNORM},
-		.depth_format = depth->desc.format,
+		.color_formats = { scene_color_format },
+		.depth_format = gbuffer_depth_format,
 		.blend_states = {
 			rhiBlendState{
 				.src_color = rhiBlendFactor::one,
@@ -316,12 +187,10 @@ void translucentPass::build_pipeline(renderShared* rs)
 			}}
 	};
 #else
-	auto fs = shaderio::load_shader_binary("E:\\Sponza\\build\\shaders\\translucent.ps.spv");
+	shaders.fs = "translucent.ps.spv";
 	desc = rhiGraphicsPipelineDesc{
-		.vs = vs,
-		.fs = fs,
-		.color_formats = {accumulate_color_alpha->desc.format, revealage->desc.format},
-		.depth_format = depth->desc.format,
+		.color_formats = { oit_format, oit_format },
+		.depth_format = gbuffer_depth_format,
 		.blend_states = {
 			// accumulate
 			rhiBlendState{
@@ -360,10 +229,7 @@ void translucentPass::build_pipeline(renderShared* rs)
 		}}
 	};
 #endif
-	pipeline = rs->context->create_graphics_pipeline(desc, pipeline_layout);
-
-	shaderio::free_shader_binary(vs);
-	shaderio::free_shader_binary(fs);
+	rs->pipeline_compiler->request(pipeline, desc, shaders, pipeline_layout);
 }
 
 void translucentPass::update(drawUpdateContext* update_context)
@@ -379,7 +245,7 @@ void translucentPass::update(drawUpdateContext* update_context)
 		.range = sizeof(globalsCB)
 	};
 	const rhiWriteDescriptor global_write_desc{
-		.set = descriptor_sets[image_index.value()][0],
+		.set = descriptor_sets[frame_index.value()][0],
 		.binding = 0,
 		.array_index = 0,
 		.count = 1,
@@ -387,19 +253,19 @@ void translucentPass::update(drawUpdateContext* update_context)
 		.buffer = { global_buffer_info }
 	};
 	const rhiDescriptorBufferInfo light_buffer_info{
-		.buffer = light_ring_buffer[image_index.value()].get(),
+		.buffer = light_ring_buffer[frame_index.value()].get(),
 		.offset = 0,
 		.range = sizeof(translucentPass::lightCB)
 	};
 	const rhiWriteDescriptor light_write_desc{
-		.set = descriptor_sets[image_index.value()][2],
+		.set = descriptor_sets[frame_index.value()][2],
 		.binding = 0,
 		.count = 1,
 		.type = rhiDescriptorType::uniform_buffer,
 		.buffer = { light_buffer_info }
 	};
 	const rhiWriteDescriptor shadow_write_desc{
-		.set = descriptor_sets[image_index.value()][2],
+		.set = descriptor_sets[frame_index.value()][2],
 		.binding = 1,
 		.count = 1,
 		.type = rhiDescriptorType::sampled_image,
@@ -413,7 +279,7 @@ void translucentPass::update(drawUpdateContext* update_context)
 		}
 	};
 	const rhiWriteDescriptor shadow_sampler_write_desc{
-		.set = descriptor_sets[image_index.value()][2],
+		.set = descriptor_sets[frame_index.value()][2],
 		.binding = 2,
 		.count = 1,
 		.type = rhiDescriptorType::sampler,
@@ -438,7 +304,7 @@ void translucentPass::update_buffer(translucentUpdateContext* update_context)
 		cb.light_viewproj[index] = update_context->light_viewproj[index];
 	}
 	auto device_context = init_context->rs->context;
-	init_context->rs->buffer_barrier(light_ring_buffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	init_context->rs->buffer_barrier(light_ring_buffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 				.src_stage = rhiPipelineStage::fragment_shader,
 				.dst_stage = rhiPipelineStage::copy,
 				.src_access = rhiAccessFlags::uniform_read,
@@ -447,8 +313,8 @@ void translucentPass::update_buffer(translucentUpdateContext* update_context)
 				.src_queue = device_context->get_queue_family_index(rhiQueueType::transfer),
 				.dst_queue = device_context->get_queue_family_index(rhiQueueType::graphics)
 		});
-	init_context->rs->upload_to_device(light_ring_buffer[image_index.value()].get(), &cb, sizeof(translucentPass::lightCB));
-	init_context->rs->buffer_barrier(light_ring_buffer[image_index.value()].get(), rhiBufferBarrierDescription{
+	init_context->rs->upload_to_device(light_ring_buffer[frame_index.value()].get(), &cb, sizeof(translucentPass::lightCB));
+	init_context->rs->buffer_barrier(light_ring_buffer[frame_index.value()].get(), rhiBufferBarrierDescription{
 				.src_stage = rhiPipelineStage::copy,
 				.dst_stage = rhiPipelineStage::vertex_shader | rhiPipelineStage::fragment_shader,
 				.src_access = rhiAccessFlags::transfer_write,
@@ -6,10 +6,6 @@ class rhiTextureBindlessTable;
 struct translucentInitContext : public drawInitContext
 {
     std::weak_ptr<rhiTextureBindlessTable> bindless_table;
-    rhiTexture* depth;
-#if DISABLE_OIT
-    std::weak_ptr<rhiTexture> scene_color;
-#endif
     std::unique_ptr<drawInitContext> clone() const override
     {
         return std::make_unique<translucentInitContext>(*this);
@@ -45,23 +41,15 @@ public:
 protected:
     void begin(rhiCommandList* cmd) override;
     void draw(rhiCommandList* cmd) override;
-    void begin_barrier(rhiCommandList* cmd) override;
-    void end_barrier(rhiCommandList* cmd) override;
     void build_layouts(renderShared* rs) override;
     void build_attachments(rhiDeviceContext* context) override;
     void build_pipeline(renderShared* rs) override;
 
-public:
-    rhiTexture* get_accum() { return accumulate_color_alpha.get(); }
-    rhiTexture* get_reveal() { return revealage.get(); }
-
 private:
     void update_buffer(translucentUpdateContext* update_context);
     void push_constants(rhiCommandList* cmd, const groupRecord& g);
 
 private:
-    std::unique_ptr<rhiTexture> accumulate_color_alpha;
-    std::unique_ptr<rhiTexture> revealage;
     std::vector<std::unique_ptr<rhiBuffer>> light_ring_buffer;
     rhiDescriptorSetLayout set_globals;
     rhiDescriptorSetLayout set_instances;
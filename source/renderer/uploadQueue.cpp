@@ -0,0 +1,241 @@
+﻿#include "uploadQueue.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiFrameContext.h"
+#include "rhi/rhiCommandList.h"
+#include "rhi/rhiSynchroize.h"
+#include "rhi/rhiBuffer.h"
+#include "util/cpuProfiler.h"
+
+uploadQueue::uploadQueue(rhiDeviceContext* context, const u64 frame_budget)
+	: context(context), frame_budget(std::max<u64>(frame_budget, 1))
+{
+}
+
+uploadQueue::~uploadQueue()
+{
+	// finished staging belongs to the device's one-time submits, a split buffer's is still read from here
+	std::scoped_lock lock(mutex);
+	context->wait(last_ticket);
+	pending.clear();
+}
+
+std::unique_ptr<rhiBuffer> uploadQueue::create_staging(const void* src, const u64 bytes)
+{
+	auto staging = context->create_buffer(rhiBufferDesc
+		{
+			.size = bytes,
+			.usage = rhiBufferUsage::transfer_src,
+			.memory = rhiMem::auto_host
+		});
+
+	void* p = staging->map();
+	std::memcpy(p, src, bytes);
+	staging->flush(0, bytes);
+	staging->unmap();
+	return staging;
+}
+
+u64 uploadQueue::enqueue(rhiBuffer* dst, const void* src, const u64 bytes, const u64 dst_offset, const rhiPipelineStage dst_stage, const rhiAccessFlags dst_access)
+{
+	CPU_ZONE("uploadQueue::enqueue");
+	ASSERT(dst && src && bytes > 0);
+	ASSERT(dst_offset + bytes <= dst->size());
+
+	request r{
+		.dst_buffer = dst,
+		.dst_offset = dst_offset,
+		.bytes = bytes,
+		.dst_stage = dst_stage,
+		.dst_access = dst_access,
+		.staging = create_staging(src, bytes)
+	};
+
+	std::scoped_lock lock(mutex);
+	r.id = ++next_id;
+	pending.push_back(std::move(r));
+	++request_count;
+	return next_id;
+}
+
+u64 uploadQueue::enqueue(rhiTexture* dst, const void* src, const u64 bytes, std::span<const rhiBufferImageCopy> regions, const rhiPipelineStage dst_stage)
+{
+	CPU_ZONE("uploadQueue::enqueue");
+	ASSERT(dst && src && bytes > 0 && !regions.empty());
+
+	request r{
+		.dst_texture = dst,
+		.bytes = bytes,
+		.regions = { regions.begin(), regions.end() },
+		.dst_stage = dst_stage,
+		.dst_access = rhiAccessFlags::shader_sampled_read,
+		.staging = create_staging(src, bytes)
+	};
+
+	std::scoped_lock lock(mutex);
+	r.id = ++next_id;
+	pending.push_back(std::move(r));
+	++request_count;
+	return next_id;
+}
+
+void uploadQueue::pump(rhiFrameContext* frame_context)
+{
+	CPU_ZONE("uploadQueue::pump");
+	submit(frame_context, frame_budget);
+}
+
+void uploadQueue::flush(rhiFrameContext* frame_context)
+{
+	CPU_ZONE("uploadQueue::flush");
+	submit(frame_context, std::numeric_limits<u64>::max());
+}
+
+bool uploadQueue::is_idle() const
+{
+	std::scoped_lock lock(mutex);
+	return pending.empty();
+}
+
+u64 uploadQueue::get_pending_bytes() const
+{
+	std::scoped_lock lock(mutex);
+	u64 bytes = 0;
+	for (const request& r : pending)
+		bytes += r.bytes - r.cursor;
+	return bytes;
+}
+
+void uploadQueue::submit(rhiFrameContext* frame_context, const u64 budget)
+{
+	std::scoped_lock lock(mutex);
+	if (pending.empty())
+		return;
+
+	const u32 transfer_family = context->get_queue_family_index(rhiQueueType::transfer);
+	const u32 graphics_family = context->get_queue_family_index(rhiQueueType::graphics);
+	// a dedicated transfer family hands every range over : released here, acquired on graphics
+	const bool ownership = transfer_family != graphics_family;
+
+	auto transfer_cmd = context->begin_onetime_commands(rhiQueueType::transfer);
+	rhiCommandList* graphics_cmd = frame_context->get_command_list(rhiQueueType::graphics);
+
+	std::vector<std::unique_ptr<rhiBuffer>> keep_alive;
+	rhiPipelineStage wait_stage = rhiPipelineStage::none;
+	u64 spent = 0;
+	u64 last_done = 0;
+	while (!pending.empty() && spent < budget)
+	{
+		request& r = pending.front();
+		if (r.dst_texture)
+		{
+			// an oversized texture still goes out alone, otherwise it would never fit
+			if (spent > 0 && r.bytes > budget - spent)
+				break;
+
+			rhiTexture* tex = r.dst_texture;
+			const rhiImageBarrierDescription to_copy{
+				.src_stage = rhiPipelineStage::none,
+				.dst_stage = rhiPipelineStage::copy,
+				.src_access = rhiAccessFlags::none,
+				.dst_access = rhiAccessFlags::transfer_write,
+				.old_layout = rhiImageLayout::undefined,
+				.new_layout = rhiImageLayout::transfer_dst,
+				.src_queue = transfer_family,
+				.dst_queue = transfer_family,
+				.level_count = tex->desc.mips,
+				.layer_count = tex->desc.layers
+			};
+			transfer_cmd->image_barrier(tex, to_copy);
+			transfer_cmd->copy_buffer_to_image(r.staging.get(), tex, rhiImageLayout::transfer_dst, r.regions);
+
+			rhiImageBarrierDescription release{
+				.src_stage = rhiPipelineStage::copy,
+				.dst_stage = rhiPipelineStage::none,
+				.src_access = rhiAccessFlags::transfer_write,
+				.dst_access = rhiAccessFlags::none,
+				.old_layout = rhiImageLayout::transfer_dst,
+				.new_layout = rhiImageLayout::shader_readonly,
+				.src_queue = transfer_family,
+				.dst_queue = graphics_family,
+				.level_count = tex->desc.mips,
+				.layer_count = tex->desc.layers
+			};
+			transfer_cmd->image_barrier(tex, release);
+			if (ownership)
+			{
+				release.src_stage = rhiPipelineStage::none;
+				release.dst_stage = r.dst_stage;
+				release.src_access = rhiAccessFlags::none;
+				release.dst_access = r.dst_access;
+				graphics_cmd->image_barrier(tex, release);
+			}
+			spent += r.bytes;
+			r.cursor = r.bytes;
+		}
+		else
+		{
+			const u64 chunk = std::min(r.bytes - r.cursor, budget - spent);
+			const u64 dst_offset = r.dst_offset + r.cursor;
+			transfer_cmd->copy_buffer(r.staging.get(), static_cast<u32>(r.cursor), r.dst_buffer, static_cast<u32>(dst_offset), chunk);
+			if (ownership)
+			{
+				rhiBufferBarrierDescription release{
+					.src_stage = rhiPipelineStage::copy,
+					.dst_stage = rhiPipelineStage::none,
+					.src_access = rhiAccessFlags::transfer_write,
+					.dst_access = rhiAccessFlags::none,
+					.offset = static_cast<u32>(dst_offset),
+					.size = chunk,
+					.src_queue = transfer_family,
+					.dst_queue = graphics_family
+				};
+				transfer_cmd->buffer_barrier(r.dst_buffer, release);
+
+				release.src_stage = rhiPipelineStage::none;
+				release.dst_stage = r.dst_stage;
+				release.src_access = rhiAccessFlags::none;
+				release.dst_access = r.dst_access;
+				graphics_cmd->buffer_barrier(r.dst_buffer, release);
+			}
+			spent += chunk;
+			r.cursor += chunk;
+		}
+
+		wait_stage = wait_stage | r.dst_stage;
+		// the rest of a split buffer streams next frame
+		if (r.cursor < r.bytes)
+			break;
+
+		last_done = r.id;
+		keep_alive.push_back(std::move(r.staging));
+		pending.pop_front();
+	}
+
+	// partially streamed staging stays with its request until the last chunk's batch retires
+	last_ticket = context->submit_async(transfer_cmd, rhiQueueType::transfer, std::move(keep_alive));
+	if (rhiSemaphore* timeline = context->get_submit_timeline(rhiQueueType::transfer))
+	{
+		frame_context->wait_before_graphics(rhiSemaphoreSubmitInfo{
+			.semaphore = timeline,
+			.value = last_ticket.value,
+			.stage = wait_stage
+			});
+	}
+
+	if (last_done != 0)
+		ready_id.store(last_done, std::memory_order_release);
+	streamed_bytes += spent;
+	max_batch_bytes = std::max(max_batch_bytes, spent);
+	++batch_count;
+}
+
+void uploadQueue::report() const
+{
+	std::scoped_lock lock(mutex);
+	u64 backlog = 0;
+	for (const request& r : pending)
+		backlog += r.bytes - r.cursor;
+	std::cout << std::format("[uploadQueue] {} requests in {} batches, {:.2f} MB streamed, largest batch {:.2f} MB (budget {:.2f} MB), {:.2f} MB pending\n",
+		request_count, batch_count, streamed_bytes / (1024.0 * 1024.0), max_batch_bytes / (1024.0 * 1024.0),
+		frame_budget / (1024.0 * 1024.0), backlog / (1024.0 * 1024.0));
+}
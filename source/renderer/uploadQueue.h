@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDefs.h"
+#include "rhi/rhiTextureView.h"
+#include "rhi/rhiSubmitInfo.h"
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+class rhiDeviceContext;
+class rhiFrameContext;
+class rhiBuffer;
+class rhiTexture;
+
+// streams large buffers and textures on the transfer family over as many frames as it takes.
+// every pump submits at most the frame budget, the frame's graphics list acquires what landed
+// and the graphics submit waits on the batch's timeline value, so loading never blocks the cpu
+class uploadQueue
+{
+public:
+	static constexpr u64 default_frame_budget = 16ull << 20;
+
+	uploadQueue(rhiDeviceContext* context, const u64 frame_budget = default_frame_budget);
+	~uploadQueue();
+
+public:
+	// src is copied into staging before returning, any thread. returns the id is_ready() answers for
+	u64 enqueue(rhiBuffer* dst, const void* src, const u64 bytes, const u64 dst_offset, const rhiPipelineStage dst_stage, const rhiAccessFlags dst_access);
+	// the whole texture ends up in shader_readonly, textures are never split across frames
+	u64 enqueue(rhiTexture* dst, const void* src, const u64 bytes, std::span<const rhiBufferImageCopy> regions, const rhiPipelineStage dst_stage = rhiPipelineStage::fragment_shader);
+
+	// once per frame after command_begin, before anything reads the streamed resources
+	void pump(rhiFrameContext* frame_context);
+	// the whole backlog at once, for load frames that hitch anyway
+	void flush(rhiFrameContext* frame_context);
+
+	// the resource may be used by graphics work recorded after the pump that submitted it
+	bool is_ready(const u64 id) const { return id <= ready_id.load(std::memory_order_acquire); }
+	bool is_idle() const;
+	void set_frame_budget(const u64 bytes) { frame_budget = std::max<u64>(bytes, 1); }
+	u64 get_frame_budget() const { return frame_budget; }
+	u64 get_pending_bytes() const;
+	u64 get_streamed_bytes() const { return streamed_bytes; }
+	u64 get_request_count() const { return request_count; }
+	void report() const;
+
+private:
+	struct request
+	{
+		u64 id = 0;
+		rhiBuffer* dst_buffer = nullptr;
+		rhiTexture* dst_texture = nullptr;
+		u64 dst_offset = 0;
+		u64 bytes = 0;
+		// buffers go out in budget sized chunks, bytes before the cursor are submitted
+		u64 cursor = 0;
+		std::vector<rhiBufferImageCopy> regions;
+		rhiPipelineStage dst_stage = rhiPipelineStage::all_commands;
+		rhiAccessFlags dst_access = rhiAccessFlags::memory_read;
+		std::unique_ptr<rhiBuffer> staging;
+	};
+
+	std::unique_ptr<rhiBuffer> create_staging(const void* src, const u64 bytes);
+	void submit(rhiFrameContext* frame_context, const u64 budget);
+
+private:
+	rhiDeviceContext* context = nullptr;
+	u64 frame_budget = default_frame_budget;
+
+	mutable std::mutex mutex;
+	std::deque<request> pending;
+	u64 next_id = 0;
+	std::atomic<u64> ready_id = 0;
+	rhiSubmitTicket last_ticket;
+
+	u64 streamed_bytes = 0;
+	u64 request_count = 0;
+	u64 batch_count = 0;
+	u64 max_batch_bytes = 0;
+};
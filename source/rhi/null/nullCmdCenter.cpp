@@ -0,0 +1,39 @@
+﻿#include "nullCmdCenter.h"
+#include "nullDeviceContext.h"
+#include "nullFrameContext.h"
+#include "nullSwapchain.h"
+
+nullCmdCenter::nullCmdCenter()
+{
+	device_context = std::make_shared<nullDeviceContext>();
+	frame_context = std::make_shared<nullFrameContext>();
+}
+
+nullCmdCenter::~nullCmdCenter()
+{
+	swapchain.reset();
+	clear();
+}
+
+bool nullCmdCenter::initialize(std::string_view application_name, GLFWwindow* window, const u32 width, const u32 height)
+{
+	// the window only drives input, nothing is presented to it
+	std::static_pointer_cast<nullDeviceContext>(device_context)->create_queues();
+	constexpr u32 window_image_count = 3;
+	return create_swapchain(width, height, std::max(window_image_count, pacing.frames_in_flight + 1), rhiFormat::BGRA8_UNORM);
+}
+
+bool nullCmdCenter::initialize_headless(std::string_view application_name, const rhiHeadlessDesc& desc)
+{
+	std::static_pointer_cast<nullDeviceContext>(device_context)->create_queues();
+	return create_swapchain(desc.width, desc.height, desc.image_count, desc.format);
+}
+
+bool nullCmdCenter::create_swapchain(const u32 width, const u32 height, const u32 image_count, const rhiFormat format)
+{
+	ASSERT(swapchain == nullptr);
+	swapchain = std::make_unique<nullSwapchain>(device_context.get(), width, height, image_count, format);
+	frame_context->swapchain = swapchain.get();
+	frame_context->update_inflight(device_context.get(), pacing.frames_in_flight);
+	return true;
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiCmdCenter.h"
+
+class nullSwapchain;
+
+// rhi_type::null, no driver, instance or window system involved
+class nullCmdCenter final : public rhiCmdCenter
+{
+public:
+	nullCmdCenter();
+	virtual ~nullCmdCenter();
+
+public:
+	bool initialize(std::string_view application_name, GLFWwindow* window, const u32 width, const u32 height) final override;
+	bool initialize_headless(std::string_view application_name, const rhiHeadlessDesc& desc) final override;
+
+private:
+	bool create_swapchain(const u32 width, const u32 height, const u32 image_count, const rhiFormat format);
+
+private:
+	std::unique_ptr<nullSwapchain> swapchain;
+};
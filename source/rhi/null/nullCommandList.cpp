@@ -0,0 +1,207 @@
+﻿#include "nullCommandList.h"
+#include "rhi/rhiBuffer.h"
+#include "rhi/rhiTextureView.h"
+#include "rhi/rhiPipeline.h"
+#include "rhi/rhiDescriptor.h"
+
+void nullCommandList::begin(u32 flags)
+{
+	recording = true;
+}
+
+void nullCommandList::end()
+{
+	// a secondary lives entirely inside its primary's render pass
+	ASSERT(!in_render_pass || secondary);
+	recording = false;
+	in_render_pass = false;
+}
+
+void nullCommandList::reset()
+{
+	stats = {};
+	recording = false;
+	in_render_pass = false;
+}
+
+void nullCommandList::begin_render_pass(const rhiRenderingInfo& info, const bool secondary_contents)
+{
+	ASSERT(!in_render_pass);
+	in_render_pass = true;
+	++stats.commands;
+	++stats.render_passes;
+}
+
+void nullCommandList::end_render_pass()
+{
+	ASSERT(in_render_pass);
+	in_render_pass = false;
+	++stats.commands;
+}
+
+void nullCommandList::set_viewport_scissor(const vec2 vp_size)
+{
+	stats.commands += 2;
+}
+
+void nullCommandList::copy_buffer(rhiBuffer* src, const u32 src_offset, rhiBuffer* dst, const u32 dst_offset, const u64 bytes)
+{
+	ASSERT(src && dst);
+	ASSERT(src_offset + bytes <= src->size() && dst_offset + bytes <= dst->size());
+	std::memcpy(static_cast<u8*>(dst->native()) + dst_offset, static_cast<const u8*>(src->native()) + src_offset, bytes);
+	++stats.commands;
+	++stats.copies;
+	stats.copy_bytes += bytes;
+}
+
+void nullCommandList::copy_buffer_to_image(rhiBuffer* src_buf, rhiTexture* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions)
+{
+	++stats.commands;
+	stats.copies += regions.size();
+}
+
+void nullCommandList::copy_buffer_to_image(rhiBuffer* src_buf, rhiTextureCubeMap* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions)
+{
+	++stats.commands;
+	stats.copies += regions.size();
+}
+
+void nullCommandList::copy_image_to_buffer(rhiTexture* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions)
+{
+	++stats.commands;
+	stats.copies += regions.size();
+}
+
+void nullCommandList::copy_image_to_buffer(rhiTextureCubeMap* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions)
+{
+	++stats.commands;
+	stats.copies += regions.size();
+}
+
+void nullCommandList::image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip, u32 level_count, u32 base_layer, u32 layer_count, bool is_same_stage)
+{
+	++stats.commands;
+	++stats.barriers;
+}
+
+void nullCommandList::image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip, u32 level_count, u32 base_layer, u32 layer_count, bool is_same_stage)
+{
+	++stats.commands;
+	++stats.barriers;
+}
+
+void nullCommandList::image_barrier(rhiTexture* tex, const rhiImageBarrierDescription& desc)
+{
+	++stats.commands;
+	++stats.barriers;
+}
+
+void nullCommandList::image_barrier(rhiTextureCubeMap* tex, const rhiImageBarrierDescription& desc)
+{
+	++stats.commands;
+	++stats.barriers;
+}
+
+void nullCommandList::buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescription& desc)
+{
+	++stats.commands;
+	++stats.barriers;
+}
+
+void nullCommandList::generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc)
+{
+	// one blit and one barrier per level on the real backend
+	const u64 levels = desc.mip_count > 0 ? desc.mip_count - 1 : 0;
+	stats.commands += levels * 2 + 1;
+	stats.barriers += levels + 1;
+}
+
+void nullCommandList::bind_pipeline(rhiPipeline* p)
+{
+	++stats.commands;
+	++stats.pipeline_binds;
+}
+
+void nullCommandList::bind_vertex_buffer(rhiBuffer* vbo, const u32 slot, const u32 offset)
+{
+	++stats.commands;
+}
+
+void nullCommandList::bind_index_buffer(rhiBuffer* ibo, const u32 offset)
+{
+	++stats.commands;
+}
+
+void nullCommandList::bind_descriptor_sets(rhiPipelineLayout layout, rhiPipelineType pipeline, const std::vector<rhiDescriptorSet>& sets, const u32 first_set, const std::vector<u32>& dynamic_offsets)
+{
+	++stats.commands;
+	stats.descriptor_binds += sets.size();
+}
+
+void nullCommandList::push_constants(const rhiPipelineLayout layout, rhiShaderStage stages, u32 offset, u32 size, const void* data)
+{
+	++stats.commands;
+	++stats.push_constants;
+}
+
+void nullCommandList::set_cullmode(const rhiCullMode cull_mode)
+{
+	++stats.commands;
+}
+
+void nullCommandList::draw_indexed_indirect(rhiBuffer* indirect_buffer, const u32 offset, const u32 draw_count, const u32 stride)
+{
+	ASSERT(in_render_pass);
+	++stats.commands;
+	++stats.draws;
+	stats.indirect_records += draw_count;
+}
+
+void nullCommandList::draw_mesh_tasks_indirect(rhiBuffer* indirect_buffer, const u32 offset, const u32 draw_count, const u32 stride)
+{
+	ASSERT(in_render_pass);
+	++stats.commands;
+	++stats.draws;
+	stats.indirect_records += draw_count;
+}
+
+void nullCommandList::draw_fullscreen()
+{
+	ASSERT(in_render_pass);
+	++stats.commands;
+	++stats.draws;
+}
+
+void nullCommandList::dispatch(const u32 x, const u32 y, const u32 z)
+{
+	ASSERT(!in_render_pass);
+	++stats.commands;
+	++stats.dispatches;
+}
+
+void nullCommandList::reset_timestamps(rhiTimestampPool* pool, const u32 first, const u32 count)
+{
+	++stats.commands;
+}
+
+void nullCommandList::write_timestamp(rhiTimestampPool* pool, const u32 index, rhiPipelineStage stage)
+{
+	++stats.commands;
+}
+
+void nullCommandList::begin_secondary(const rhiRenderingInfo& info)
+{
+	// secondaries are never reset by the frame context, each recording starts clean
+	stats = {};
+	recording = true;
+	in_render_pass = true;
+	secondary = true;
+}
+
+void nullCommandList::execute_secondaries(std::span<rhiCommandList* const> secondaries)
+{
+	ASSERT(in_render_pass);
+	++stats.commands;
+	for (rhiCommandList* s : secondaries)
+		stats += static_cast<nullCommandList*>(s)->get_stats();
+}
\ No newline at end of file
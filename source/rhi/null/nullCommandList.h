@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiCommandList.h"
+
+// what a command list would have sent to the gpu
+struct nullCommandStats
+{
+	u64 commands = 0;
+	u64 render_passes = 0;
+	u64 draws = 0; // indirect/fullscreen draw calls
+	u64 indirect_records = 0; // draw_count summed over indirect calls
+	u64 dispatches = 0;
+	u64 barriers = 0;
+	u64 copies = 0;
+	u64 copy_bytes = 0;
+	u64 pipeline_binds = 0;
+	u64 descriptor_binds = 0;
+	u64 push_constants = 0;
+
+	nullCommandStats& operator+=(const nullCommandStats& o)
+	{
+		commands += o.commands;
+		render_passes += o.render_passes;
+		draws += o.draws;
+		indirect_records += o.indirect_records;
+		dispatches += o.dispatches;
+		barriers += o.barriers;
+		copies += o.copies;
+		copy_bytes += o.copy_bytes;
+		pipeline_binds += o.pipeline_binds;
+		descriptor_binds += o.descriptor_binds;
+		push_constants += o.push_constants;
+		return *this;
+	}
+};
+
+// records nothing, only counts. buffer copies are done on the cpu at record time
+class nullCommandList final : public rhiCommandList
+{
+public:
+	explicit nullCommandList(const rhiQueueType queue) : queue(queue) {}
+
+public:
+	void begin(u32 flags = 0) override;
+	void end() override;
+	void reset() override;
+	void begin_render_pass(const rhiRenderingInfo& info, const bool secondary_contents = false) override;
+	void end_render_pass() override;
+	void set_viewport_scissor(const vec2 vp_size) override;
+
+	void copy_buffer(rhiBuffer* src, const u32 src_offset, rhiBuffer* dst, const u32 dst_offset, const u64 bytes) override;
+	void copy_buffer_to_image(rhiBuffer* src_buf, rhiTexture* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) override;
+	void copy_buffer_to_image(rhiBuffer* src_buf, rhiTextureCubeMap* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) override;
+	void copy_image_to_buffer(rhiTexture* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) override;
+	void copy_image_to_buffer(rhiTextureCubeMap* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) override;
+	void image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) override;
+	void image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) override;
+	void image_barrier(rhiTexture* tex, const rhiImageBarrierDescription& desc) override;
+	void image_barrier(rhiTextureCubeMap* tex, const rhiImageBarrierDescription& desc) override;
+	void buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescription& desc) override;
+
+	void generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc) override;
+
+	void bind_pipeline(rhiPipeline* p) override;
+	void bind_vertex_buffer(rhiBuffer* vbo, const u32 slot, const u32 offset) override;
+	void bind_index_buffer(rhiBuffer* ibo, const u32 offset) override;
+	void bind_descriptor_sets(rhiPipelineLayout layout, rhiPipelineType pipeline, const std::vector<rhiDescriptorSet>& sets, const u32 first_set, const std::vector<u32>& dynamic_offsets) override;
+
+	void push_constants(const rhiPipelineLayout layout, rhiShaderStage stages, u32 offset, u32 size, const void* data) override;
+	void set_cullmode(const rhiCullMode cull_mode) override;
+
+	void draw_indexed_indirect(rhiBuffer* indirect_buffer, const u32 offset, const u32 draw_count, const u32 stride) override;
+	void draw_mesh_tasks_indirect(rhiBuffer* indirect_buffer, const u32 offset, const u32 draw_count, const u32 stride) override;
+	void draw_fullscreen() override;
+
+	void dispatch(const u32 x, const u32 y, const u32 z) override;
+
+	void reset_timestamps(rhiTimestampPool* pool, const u32 first, const u32 count) override;
+	void write_timestamp(rhiTimestampPool* pool, const u32 index, rhiPipelineStage stage = rhiPipelineStage::bottom_of_pipe) override;
+
+	void begin_secondary(const rhiRenderingInfo& info) override;
+	void execute_secondaries(std::span<rhiCommandList* const> secondaries) override;
+
+	const nullCommandStats& get_stats() const { return stats; }
+	rhiQueueType get_queue() const { return queue; }
+	bool is_recording() const { return recording; }
+
+private:
+	rhiQueueType queue;
+	nullCommandStats stats;
+	bool recording = false;
+	bool in_render_pass = false;
+	bool secondary = false;
+};
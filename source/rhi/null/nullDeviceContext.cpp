@@ -0,0 +1,267 @@
+﻿#include "nullDeviceContext.h"
+#include "nullResources.h"
+#include "rhi/rhiDescriptor.h"
+#include "rhi/rhiSubmitInfo.h"
+#include "util/cpuProfiler.h"
+
+nullDeviceContext::nullDeviceContext()
+{
+}
+
+nullDeviceContext::~nullDeviceContext()
+{
+	report();
+}
+
+void nullDeviceContext::create_queues()
+{
+	queue[rhiQueueType::graphics] = std::make_shared<nullQueue>(rhiQueueType::graphics, 0);
+	queue[rhiQueueType::compute] = std::make_shared<nullQueue>(rhiQueueType::compute, 1);
+	queue[rhiQueueType::transfer] = std::make_shared<nullQueue>(rhiQueueType::transfer, 2);
+	queue[rhiQueueType::present] = std::make_shared<nullQueue>(rhiQueueType::present, 0);
+}
+
+std::unique_ptr<rhiCommandList> nullDeviceContext::create_commandlist(u32 queue_family)
+{
+	return std::make_unique<nullCommandList>(get_queue_type(queue_family));
+}
+
+std::unique_ptr<rhiCommandList> nullDeviceContext::create_secondary_commandlist(u32 queue_family)
+{
+	return std::make_unique<nullCommandList>(get_queue_type(queue_family));
+}
+
+std::unique_ptr<rhiTextureBindlessTable> nullDeviceContext::create_bindless_table(const rhiTextureBindlessDesc& desc, const u32 set_index)
+{
+	return std::make_unique<nullTextureBindlessTable>(
+		rhiDescriptorSetLayout{ .native = make_handle(), .set_index = set_index },
+		rhiDescriptorSet{ .native = make_handle(), .set_index = set_index });
+}
+
+std::unique_ptr<rhiBuffer> nullDeviceContext::create_buffer(const rhiBufferDesc& desc)
+{
+	allocations_made.fetch_add(1, std::memory_order_relaxed);
+	return std::make_unique<nullBuffer>(this, desc);
+}
+
+std::unique_ptr<rhiTexture> nullDeviceContext::create_texture(const rhiTextureDesc& desc)
+{
+	allocations_made.fetch_add(1, std::memory_order_relaxed);
+	return std::make_unique<nullTexture>(desc);
+}
+
+std::unique_ptr<rhiTexture> nullDeviceContext::create_texture_from_path(std::string_view path, bool is_hdr, bool srgb)
+{
+	allocations_made.fetch_add(1, std::memory_order_relaxed);
+	return std::make_unique<nullTexture>(this, path, is_hdr, srgb);
+}
+
+std::unique_ptr<rhiTexture> nullDeviceContext::create_texture_from_image(rhiTextureImage&& image)
+{
+	allocations_made.fetch_add(1, std::memory_order_relaxed);
+	return std::make_unique<nullTexture>(this, std::move(image));
+}
+
+std::shared_ptr<rhiTextureCubeMap> nullDeviceContext::create_texture_cubemap(const rhiTextureDesc& desc)
+{
+	allocations_made.fetch_add(1, std::memory_order_relaxed);
+	return std::make_shared<nullTextureCubemap>(desc);
+}
+
+std::unique_ptr<rhiSampler> nullDeviceContext::create_sampler(const rhiSamplerDesc& desc)
+{
+	return std::make_unique<nullSampler>(desc);
+}
+
+std::unique_ptr<rhiSemaphore> nullDeviceContext::create_semaphore(const bool timeline)
+{
+	return std::make_unique<nullSemaphore>();
+}
+
+std::unique_ptr<rhiFence> nullDeviceContext::create_fence(bool signaled)
+{
+	return std::make_unique<nullFence>(signaled);
+}
+
+std::unique_ptr<rhiTimestampPool> nullDeviceContext::create_timestamp_pool(const u32 count)
+{
+	return std::make_unique<nullTimestampPool>(count);
+}
+
+rhiDescriptorSetLayout nullDeviceContext::create_descriptor_set_layout(const std::vector<rhiDescriptorSetLayoutBinding>& bindings, u32 set_index)
+{
+	return rhiDescriptorSetLayout{ .native = make_handle(), .set_index = set_index };
+}
+
+rhiDescriptorPool nullDeviceContext::create_descriptor_pool(const rhiDescriptorPoolCreateInfo& create_info, u32 max_sets)
+{
+	return rhiDescriptorPool{ .native = make_handle() };
+}
+
+std::vector<rhiDescriptorSet> nullDeviceContext::allocate_descriptor_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts)
+{
+	CPU_ZONE("null::allocate_descriptor_sets");
+	ASSERT(pool.native);
+	std::vector<rhiDescriptorSet> sets;
+	sets.reserve(layouts.size());
+	for (const rhiDescriptorSetLayout& layout : layouts)
+		sets.push_back(rhiDescriptorSet{ .native = make_handle(), .set_index = layout.set_index });
+	return sets;
+}
+
+std::vector<rhiDescriptorSet> nullDeviceContext::allocate_descriptor_indexing_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts, const std::vector<u32>& counts)
+{
+	return allocate_descriptor_sets(pool, layouts);
+}
+
+void nullDeviceContext::update_descriptors(const std::vector<rhiWriteDescriptor>& writes)
+{
+	CPU_ZONE("null::update_descriptors");
+	// handles are never reused, nothing to forget on allocation
+	const u64 dirty = static_cast<u64>(std::ranges::count_if(writes, [this](const rhiWriteDescriptor& w) { return descriptor_cache.changed(w); }));
+	if (dirty == 0)
+		return;
+	descriptor_cache.count_update();
+	std::lock_guard lock(stats_mutex);
+	stats.descriptor_writes += dirty;
+}
+
+rhiDescriptorSetLayout nullDeviceContext::create_descriptor_indexing_set_layout(const rhiDescriptorIndexing& desc, const u32 set_index)
+{
+	return rhiDescriptorSetLayout{ .native = make_handle(), .set_index = set_index };
+}
+
+rhiPipelineLayout nullDeviceContext::create_pipeline_layout(std::vector<rhiDescriptorSetLayout> set_layouts, std::vector<rhiPushConstant> push_constant_bytes, void** keep_alive_out)
+{
+	return rhiPipelineLayout{ .native = make_handle() };
+}
+
+std::unique_ptr<rhiPipeline> nullDeviceContext::create_graphics_pipeline(const rhiGraphicsPipelineDesc& desc, const rhiPipelineLayout& layout)
+{
+	CPU_ZONE("null::create_graphics_pipeline");
+	return std::make_unique<nullPipeline>(desc);
+}
+
+std::unique_ptr<rhiPipeline> nullDeviceContext::create_compute_pipeline(const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout)
+{
+	CPU_ZONE("null::create_compute_pipeline");
+	return std::make_unique<nullPipeline>(desc);
+}
+
+std::shared_ptr<rhiCommandList> nullDeviceContext::begin_onetime_commands(rhiQueueType t)
+{
+	ASSERT(queue.contains(t));
+	auto cmd = std::make_shared<nullCommandList>(t);
+	cmd->begin();
+	return cmd;
+}
+
+void nullDeviceContext::submit_and_wait(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t)
+{
+	CPU_ZONE("null::submit_and_wait");
+	ASSERT(queue.contains(t));
+	auto null_cmd = std::static_pointer_cast<nullCommandList>(cmd);
+	if (null_cmd->is_recording())
+		null_cmd->end();
+
+	std::lock_guard lock(stats_mutex);
+	accumulate(null_cmd.get());
+	++stats.submits;
+}
+
+rhiSubmitTicket nullDeviceContext::submit_async(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t, std::vector<std::unique_ptr<rhiBuffer>> keep_alive)
+{
+	// retires immediately, keep_alive dies with this call
+	submit_and_wait(std::move(cmd), t);
+	return rhiSubmitTicket{ .queue = t, .value = ++async_submits };
+}
+
+void nullDeviceContext::submit(rhiQueueType type, const rhiSubmitInfo& info)
+{
+	CPU_ZONE("null::submit");
+	ASSERT(queue.contains(type));
+	{
+		std::lock_guard lock(stats_mutex);
+		for (rhiCommandList* cmd : info.cmd_lists)
+			accumulate(cmd);
+		++stats.submits;
+	}
+	// retires immediately
+	for (const rhiSemaphoreSubmitInfo& signal : info.signals)
+	{
+		auto* semaphore = static_cast<nullSemaphore*>(signal.semaphore);
+		semaphore->value = std::max(semaphore->value, signal.value);
+	}
+	if (info.fence)
+		static_cast<nullFence*>(info.fence)->signaled = true;
+}
+
+void nullDeviceContext::wait(rhiFence* f)
+{
+	ASSERT(f);
+}
+
+void nullDeviceContext::reset(rhiFence* f)
+{
+	ASSERT(f);
+	static_cast<nullFence*>(f)->signaled = false;
+}
+
+void nullDeviceContext::wait(rhiSemaphore* timeline, const u64 value)
+{
+	ASSERT(timeline);
+	ASSERT(static_cast<nullSemaphore*>(timeline)->value >= value);
+}
+
+u64 nullDeviceContext::get_completed_value(rhiSemaphore* timeline)
+{
+	ASSERT(timeline);
+	return static_cast<nullSemaphore*>(timeline)->value;
+}
+
+rhiMemoryStats nullDeviceContext::get_memory_stats() const
+{
+	const u64 bytes = live_bytes.load(std::memory_order_relaxed);
+	return rhiMemoryStats{
+		.allocation_count = live_buffers.load(std::memory_order_relaxed),
+		.allocation_bytes = bytes,
+		.block_count = live_buffers.load(std::memory_order_relaxed),
+		.block_bytes = bytes,
+		.allocations_made = allocations_made.load(std::memory_order_relaxed)
+	};
+}
+
+nullDeviceStats nullDeviceContext::get_stats() const
+{
+	std::lock_guard lock(stats_mutex);
+	return stats;
+}
+
+void nullDeviceContext::report() const
+{
+	const nullDeviceStats s = get_stats();
+	std::cout << std::format("[nullDevice] {} submits, {} command lists, {} commands ({} render passes, {} draws, {} indirect records, {} dispatches, {} barriers, {} copies / {} bytes)\n",
+		s.submits, s.command_lists, s.commands.commands, s.commands.render_passes, s.commands.draws, s.commands.indirect_records,
+		s.commands.dispatches, s.commands.barriers, s.commands.copies, s.commands.copy_bytes);
+	std::cout << std::format("[nullDevice] {} pipeline binds, {} descriptor binds, {} push constants, {} descriptor writes\n",
+		s.commands.pipeline_binds, s.commands.descriptor_binds, s.commands.push_constants, s.descriptor_writes);
+}
+
+void nullDeviceContext::on_allocate(const u64 bytes)
+{
+	live_buffers.fetch_add(1, std::memory_order_relaxed);
+	live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void nullDeviceContext::on_free(const u64 bytes)
+{
+	live_buffers.fetch_sub(1, std::memory_order_relaxed);
+	live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void nullDeviceContext::accumulate(rhiCommandList* cmd)
+{
+	ASSERT(cmd);
+	stats.commands += static_cast<nullCommandList*>(cmd)->get_stats();
+	++stats.command_lists;
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDeviceContext.h"
+#include "nullCommandList.h"
+#include <atomic>
+#include <mutex>
+
+struct nullDeviceStats
+{
+	u64 submits = 0;
+	u64 command_lists = 0;
+	u64 descriptor_writes = 0;
+	nullCommandStats commands;
+};
+
+// cpu-only device: buffers live in host memory, submits retire immediately.
+// lets the renderer's cpu side run and be profiled without a gpu or driver
+class nullDeviceContext final : public rhiDeviceContext
+{
+public:
+	nullDeviceContext();
+	virtual ~nullDeviceContext();
+
+	std::unique_ptr<rhiCommandList> create_commandlist(u32 queue_family) override;
+	std::unique_ptr<rhiCommandList> create_secondary_commandlist(u32 queue_family) override;
+	std::unique_ptr<rhiTextureBindlessTable> create_bindless_table(const rhiTextureBindlessDesc& desc, const u32 set_index = 0) override;
+	std::unique_ptr<rhiBuffer> create_buffer(const rhiBufferDesc& desc) override;
+	std::unique_ptr<rhiTexture> create_texture(const rhiTextureDesc& desc) override;
+	std::unique_ptr<rhiTexture> create_texture_from_path(std::string_view path, bool is_hdr = false, bool srgb = true) override;
+	std::unique_ptr<rhiTexture> create_texture_from_image(rhiTextureImage&& image) override;
+	std::shared_ptr<rhiTextureCubeMap> create_texture_cubemap(const rhiTextureDesc& desc) override;
+	std::unique_ptr<rhiSampler> create_sampler(const rhiSamplerDesc& desc) override;
+	std::unique_ptr<rhiSemaphore> create_semaphore(const bool timeline = false) override;
+	std::unique_ptr<rhiFence> create_fence(bool signaled) override;
+	std::unique_ptr<rhiTimestampPool> create_timestamp_pool(const u32 count) override;
+
+	rhiDescriptorSetLayout create_descriptor_set_layout(const std::vector<rhiDescriptorSetLayoutBinding>& bindings, u32 set_index = 0) override;
+	rhiDescriptorPool create_descriptor_pool(const rhiDescriptorPoolCreateInfo& create_info, u32 max_sets) override;
+	std::vector<rhiDescriptorSet> allocate_descriptor_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts) override;
+	std::vector<rhiDescriptorSet> allocate_descriptor_indexing_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts, const std::vector<u32>& counts) override;
+	void update_descriptors(const std::vector<rhiWriteDescriptor>& writes) override;
+	rhiDescriptorSetLayout create_descriptor_indexing_set_layout(const rhiDescriptorIndexing& desc, const u32 set_index) override;
+
+	rhiPipelineLayout create_pipeline_layout(std::vector<rhiDescriptorSetLayout> set_layouts, std::vector<rhiPushConstant> push_constant_bytes = {}, void** keep_alive_out = nullptr) override;
+	std::unique_ptr<rhiPipeline> create_graphics_pipeline(const rhiGraphicsPipelineDesc& desc, const rhiPipelineLayout& layout) override;
+	std::unique_ptr<rhiPipeline> create_compute_pipeline(const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout) override;
+
+	std::shared_ptr<rhiCommandList> begin_onetime_commands(rhiQueueType t = rhiQueueType::graphics) override;
+	void submit_and_wait(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics) override;
+	rhiSubmitTicket submit_async(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics, std::vector<std::unique_ptr<rhiBuffer>> keep_alive = {}) override;
+	bool is_complete(const rhiSubmitTicket& ticket) override { return true; }
+	void wait(const rhiSubmitTicket& ticket) override {}
+	void submit(rhiQueueType type, const rhiSubmitInfo& info) override;
+	void wait(class rhiFence* f) override;
+	void reset(class rhiFence* f) override;
+	void wait(rhiSemaphore* timeline, const u64 value) override;
+	u64 get_completed_value(rhiSemaphore* timeline) override;
+
+	rhiMemoryStats get_memory_stats() const override;
+
+	// separate graphics, compute and transfer families like a discrete gpu, present aliases graphics
+	void create_queues();
+	nullDeviceStats get_stats() const;
+	void report() const;
+
+	void on_allocate(const u64 bytes);
+	void on_free(const u64 bytes);
+
+private:
+	// opaque non-null handles, never dereferenced
+	void* make_handle() { return reinterpret_cast<void*>(next_handle.fetch_add(1, std::memory_order_relaxed)); }
+	void accumulate(rhiCommandList* cmd);
+
+private:
+	std::atomic<uintptr_t> next_handle = 1;
+
+	// one-time submits may come from loader threads
+	mutable std::mutex stats_mutex;
+	nullDeviceStats stats;
+
+	std::atomic<u64> allocations_made = 0;
+	std::atomic<u64> live_buffers = 0;
+	std::atomic<u64> live_bytes = 0;
+	std::atomic<u64> async_submits = 0;
+};
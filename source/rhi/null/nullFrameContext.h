@@ -0,0 +1,8 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiFrameContext.h"
+
+struct nullFrameContext final : rhiFrameContext
+{
+};
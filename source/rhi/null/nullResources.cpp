@@ -0,0 +1,39 @@
+﻿#include "nullResources.h"
+#include "nullDeviceContext.h"
+#include "rhi/rhiCommandList.h"
+
+nullQueue::nullQueue(rhiQueueType t, const u32 queue_family_index)
+	: rhiQueue(t)
+{
+	native = nullptr;
+	family_index = queue_family_index;
+}
+
+nullBuffer::nullBuffer(nullDeviceContext* context, const rhiBufferDesc& desc)
+	: context(context), desc(desc), storage(std::make_unique_for_overwrite<u8[]>(std::max<u64>(desc.size, 1)))
+{
+	context->on_allocate(desc.size);
+}
+
+nullBuffer::~nullBuffer()
+{
+	context->on_free(desc.size);
+}
+
+nullTexture::nullTexture(nullDeviceContext* context, std::string_view path, bool is_hdr, bool srgb)
+	: rhiTexture(context, path, is_hdr, srgb)
+{
+	if (!is_hdr)
+		generate_mips(context);
+}
+
+nullTexture::nullTexture(nullDeviceContext* context, rhiTextureImage&& image)
+	: rhiTexture(std::move(image))
+{
+	generate_mips(context);
+}
+
+void nullTextureBindlessTable::bind_once(rhiCommandList* cmd, rhiPipelineLayout layout, u32 set_index)
+{
+	cmd->bind_descriptor_sets(layout, rhiPipelineType::graphics, { set }, set_index, {});
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiBuffer.h"
+#include "rhi/rhiTextureView.h"
+#include "rhi/rhiSampler.h"
+#include "rhi/rhiSynchroize.h"
+#include "rhi/rhiPipeline.h"
+#include "rhi/rhiDescriptor.h"
+#include "rhi/rhiQuery.h"
+#include "rhi/rhiQueue.h"
+#include "rhi/rhiTextureBindlessTable.h"
+
+class nullDeviceContext;
+
+class nullQueue final : public rhiQueue
+{
+public:
+	nullQueue(rhiQueueType t, const u32 queue_family_index);
+};
+
+// host memory stands in for every memory type, map is always valid
+class nullBuffer final : public rhiBuffer
+{
+public:
+	nullBuffer(nullDeviceContext* context, const rhiBufferDesc& desc);
+	~nullBuffer();
+
+public:
+	void* map() override { return storage.get(); }
+	void flush(const u64 offset, const u64 bytes) override {}
+	void invalidate(const u64 offset, const u64 bytes) override {}
+	void unmap() override {}
+	u64 size() const override { return desc.size; }
+	void* native() override { return storage.get(); }
+
+private:
+	nullDeviceContext* context;
+	rhiBufferDesc desc;
+	std::unique_ptr<u8[]> storage;
+};
+
+// descriptor only, texels are decoded and dropped like after a real upload
+class nullTexture final : public rhiTexture
+{
+public:
+	nullTexture(const rhiTextureDesc& desc) : rhiTexture(desc) {}
+	nullTexture(nullDeviceContext* context, std::string_view path, bool is_hdr, bool srgb);
+	nullTexture(nullDeviceContext* context, rhiTextureImage&& image);
+};
+
+class nullTextureCubemap final : public rhiTextureCubeMap
+{
+public:
+	nullTextureCubemap(const rhiTextureDesc& desc) : rhiTextureCubeMap(desc) {}
+};
+
+class nullSampler final : public rhiSampler
+{
+public:
+	nullSampler(const rhiSamplerDesc& sampler_desc) { desc = sampler_desc; }
+};
+
+class nullSemaphore final : public rhiSemaphore
+{
+public:
+	// timelines reach the signaled value at submit
+	u64 value = 0;
+};
+
+class nullFence final : public rhiFence
+{
+public:
+	explicit nullFence(bool signaled) : signaled(signaled) {}
+	bool signaled;
+};
+
+class nullPipeline final : public rhiPipeline
+{
+public:
+	nullPipeline(const rhiGraphicsPipelineDesc& desc) : rhiPipeline(desc, rhiPipelineType::graphics) {}
+	nullPipeline(const rhiComputePipelineDesc& desc) : rhiPipeline(desc, rhiPipelineType::compute) {}
+};
+
+// there is no gpu clock, every range stays unresolved
+class nullTimestampPool final : public rhiTimestampPool
+{
+public:
+	explicit nullTimestampPool(const u32 count) : count(count) {}
+
+public:
+	bool resolve(const u32 first, const u32 count, std::vector<u64>& ticks) override { return false; }
+	f64 ticks_to_ms(const u64 ticks) const override { return 0.0; }
+	u32 capacity() const override { return count; }
+
+private:
+	u32 count;
+};
+
+class nullTextureBindlessTable final : public rhiTextureBindlessTable
+{
+public:
+	nullTextureBindlessTable(const rhiDescriptorSetLayout& set_layout, const rhiDescriptorSet& set) : set_layout(set_layout), set(set) {}
+
+public:
+	void create_sampled_image(rhiTexture* tex, u32 base_mip = 0) override {}
+	void create_sampler(rhiSampler* sampler) override {}
+	void update_sampled_image(rhiBindlessHandle h, rhiTexture* tex, u32 base_mip = 0) override {}
+
+	void bind_once(rhiCommandList* cmd, rhiPipelineLayout layout, u32 set_index) override;
+	rhiDescriptorSetLayout get_set_layout() override { return set_layout; }
+
+private:
+	rhiDescriptorSetLayout set_layout;
+	rhiDescriptorSet set;
+};
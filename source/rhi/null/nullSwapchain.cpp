@@ -0,0 +1,47 @@
+﻿#include "nullSwapchain.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiTextureView.h"
+
+nullSwapchain::nullSwapchain(rhiDeviceContext* context, const u32 width, const u32 height, const u32 count, const rhiFormat format)
+	: rhiSwapChain(width, height), image_format(format)
+{
+	ASSERT(count > 0);
+	image_count = count;
+	// nothing is shown, no vblank to wait for
+	present_mode = rhiPresentMode::immediate;
+
+	textures.reserve(image_count);
+	rt_views.reserve(image_count);
+	for (u32 i = 0; i < image_count; ++i)
+	{
+		textures.push_back(context->create_texture(rhiTextureDesc{
+			.width = width,
+			.height = height,
+			.layers = 1,
+			.mips = 1,
+			.format = format,
+			.usage = rhiTextureUsage::color_attachment | rhiTextureUsage::transfer_src | rhiTextureUsage::sampled
+			}));
+
+		rt_views.push_back(rhiRenderTargetView{
+			.texture = textures[i].get(),
+			.mip = 0,
+			.base_layer = 0,
+			.layer_count = 1,
+			.layout = rhiImageLayout::color_attachment
+			});
+	}
+}
+
+nullSwapchain::~nullSwapchain()
+{
+	rt_views.clear();
+	textures.clear();
+}
+
+rhiResult nullSwapchain::acquire_next_image(u32* outIndex, rhiSemaphore* signal)
+{
+	*outIndex = next_image;
+	next_image = (next_image + 1) % image_count;
+	return rhiResult::ok;
+}
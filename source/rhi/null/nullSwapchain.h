@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiSwapChain.h"
+
+class rhiDeviceContext;
+class rhiTexture;
+
+// texture ring with nothing behind it, acquire hands out images round robin
+class nullSwapchain : public rhiSwapChain
+{
+public:
+	nullSwapchain(rhiDeviceContext* context, const u32 width, const u32 height, const u32 image_count, const rhiFormat format);
+	~nullSwapchain();
+
+public:
+	rhiResult acquire_next_image(u32* outIndex, class rhiSemaphore* signal) override;
+	rhiResult present(u32 imageIndex, class rhiSemaphore* wait) override { return rhiResult::ok; }
+
+	rhiFormat format() const override { return image_format; }
+	const std::vector<rhiRenderTargetView>& views() const override { return rt_views; }
+
+private:
+	rhiFormat image_format;
+	u32 next_image = 0;
+
+	std::vector<std::unique_ptr<rhiTexture>> textures;
+	std::vector<rhiRenderTargetView> rt_views;
+};
@@ -14,7 +14,12 @@ public:
     virtual ~rhiBuffer() = default;
     virtual void* map() = 0;
     virtual void flush(const u64 offset, const u64 bytes) = 0;
+    virtual void invalidate(const u64 offset, const u64 bytes) = 0;
     virtual void  unmap() = 0;
     virtual u64 size() const = 0;
     virtual void* native() = 0;
+    u64 get_generation() const { return generation; }
+
+private:
+    u64 generation = next_resource_generation();
 };
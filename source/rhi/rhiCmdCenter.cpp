@@ -1,11 +1,49 @@
 ﻿#include "rhiCmdCenter.h"
 #include "vulkan/vkCmdCenter.h"
+#include "null/nullCmdCenter.h"
+#include <charconv>
+
+std::string_view to_string(const rhiPresentMode mode)
+{
+    switch (mode)
+    {
+    case rhiPresentMode::fifo:
+        return "fifo";
+    case rhiPresentMode::mailbox:
+        return "mailbox";
+    case rhiPresentMode::immediate:
+        return "immediate";
+    }
+    return "unknown";
+}
+
+rhiFramePacing rhiFramePacing::from_args(const std::vector<std::string_view>& args)
+{
+    rhiFramePacing pacing;
+    for (std::string_view arg : args)
+    {
+        if (arg == "--present=fifo")
+            pacing.present_mode = rhiPresentMode::fifo;
+        else if (arg == "--present=mailbox")
+            pacing.present_mode = rhiPresentMode::mailbox;
+        else if (arg == "--present=immediate")
+            pacing.present_mode = rhiPresentMode::immediate;
+        else if (arg.starts_with("--frames-in-flight="))
+        {
+            arg.remove_prefix(std::string_view("--frames-in-flight=").size());
+            std::from_chars(arg.data(), arg.data() + arg.size(), pacing.frames_in_flight);
+        }
+    }
+    pacing.frames_in_flight = std::clamp(pacing.frames_in_flight, 1u, 4u);
+    return pacing;
+}
 
 std::unique_ptr<rhiCmdCenter> rhiCmdCenter::create_cmd_center(rhi_type backend)
 {
     switch (backend) 
     {
     case rhi_type::vulkan: return std::make_unique<vkCmdCenter>();
+    case rhi_type::null: return std::make_unique<nullCmdCenter>();
     //case rhi_type::dx12:  return std::make_unique<dxCmdCenter>();
     }
     return {};
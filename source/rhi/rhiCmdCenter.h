@@ -1,8 +1,29 @@
 ﻿#pragma once
 #include "pch.h"
+#include "rhi/rhiDefs.h"
 
 class rhiFrameContext;
 class rhiDeviceContext;
+
+// offscreen frame ring instead of a window swapchain
+struct rhiHeadlessDesc
+{
+	u32 width = 1920;
+	u32 height = 1080;
+	u32 image_count = 3;
+	rhiFormat format = rhiFormat::RGBA8_UNORM;
+};
+
+// frames the cpu records ahead of the gpu, independent of the swapchain image count
+struct rhiFramePacing
+{
+	u32 frames_in_flight = 2;
+	rhiPresentMode present_mode = rhiPresentMode::mailbox;
+
+	// --frames-in-flight=N --present=fifo|mailbox|immediate
+	static rhiFramePacing from_args(const std::vector<std::string_view>& args);
+};
+
 class rhiCmdCenter
 {
 public:
@@ -15,6 +36,27 @@ public:
 	}
 
 	virtual bool initialize(std::string_view application_name, GLFWwindow* window, const u32 width, const u32 height) 
+	{
+		enable_gpu_crash_dumps();
+		return true; 
+	}
+
+	// no window, surface or present engine
+	virtual bool initialize_headless(std::string_view application_name, const rhiHeadlessDesc& desc)
+	{
+		enable_gpu_crash_dumps();
+		return true;
+	}
+
+	// before initialize, the swapchain and frame context are created with it
+	void set_frame_pacing(const rhiFramePacing& p) { pacing = p; }
+	const rhiFramePacing& get_frame_pacing() const { return pacing; }
+
+	std::weak_ptr<rhiDeviceContext> get_device_context() { return device_context; }
+	std::weak_ptr<rhiFrameContext> get_frame_context() { return frame_context; }
+
+private:
+	void enable_gpu_crash_dumps()
 	{
 #if ENABLE_AFTERMATH
 		GFSDK_Aftermath_EnableGpuCrashDumps(
@@ -26,13 +68,8 @@ public:
 			&rhiCmdCenter::on_description,
 			&rhiCmdCenter::on_resolve_marker, this);
 #endif
-		return true; 
 	}
 
-	std::weak_ptr<rhiDeviceContext> get_device_context() { return device_context; }
-	std::weak_ptr<rhiFrameContext> get_frame_context() { return frame_context; }
-
-private:
 #if ENABLE_AFTERMATH
 	static void on_gpu_crash_dump(const void* data, const u32 size, void* user);
 	static void on_shader_debug_info(const void* data, const u32 size, void* user);
@@ -45,4 +82,5 @@ private:
 protected:
 	std::shared_ptr<rhiDeviceContext> device_context;
 	std::shared_ptr<rhiFrameContext> frame_context;
+	rhiFramePacing pacing;
 };
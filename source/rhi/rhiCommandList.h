@@ -14,6 +14,7 @@ struct rhiBufferImageCopy;
 struct rhiGenMipsDesc;
 struct rhiImageBarrierDescription;
 struct rhiBufferBarrierDescription;
+class rhiTimestampPool;
 class rhiCommandList 
 {
 public:
@@ -21,15 +22,20 @@ public:
     virtual void begin(u32 flags = 0) = 0;
     virtual void end() = 0;
     virtual void reset() = 0;
-    virtual void begin_render_pass(const rhiRenderingInfo& info) = 0;
+    // secondary_contents: the pass body comes from execute_secondaries only
+    virtual void begin_render_pass(const rhiRenderingInfo& info, const bool secondary_contents = false) = 0;
     virtual void end_render_pass() = 0;
     virtual void set_viewport_scissor(const vec2 vp_size) = 0;
 
     virtual void copy_buffer(rhiBuffer* src, const u32 src_offset, rhiBuffer* dst, const u32 dst_offset, const u64 bytes) = 0;
     virtual void copy_buffer_to_image(rhiBuffer* src_buf, rhiTexture* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) = 0;
+    virtual void copy_buffer_to_image(rhiBuffer* src_buf, rhiTextureCubeMap* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) = 0;
+    virtual void copy_image_to_buffer(rhiTexture* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) = 0;
+    virtual void copy_image_to_buffer(rhiTextureCubeMap* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) = 0;
     virtual void image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) = 0;
     virtual void image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) = 0;
     virtual void image_barrier(rhiTexture* tex, const rhiImageBarrierDescription& desc) = 0;
+    virtual void image_barrier(rhiTextureCubeMap* tex, const rhiImageBarrierDescription& desc) = 0;
     virtual void buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescription& desc) = 0;
 
     virtual void generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc) = 0;
@@ -47,4 +53,11 @@ public:
     virtual void draw_fullscreen() = 0;
 
     virtual void dispatch(const u32 x, const u32 y, const u32 z) = 0;
+
+    virtual void reset_timestamps(rhiTimestampPool* pool, const u32 first, const u32 count) = 0;
+    virtual void write_timestamp(rhiTimestampPool* pool, const u32 index, rhiPipelineStage stage = rhiPipelineStage::bottom_of_pipe) = 0;
+
+    // secondary lists, recorded on any thread and replayed in order inside the primary's render pass
+    virtual void begin_secondary(const rhiRenderingInfo& info) = 0;
+    virtual void execute_secondaries(std::span<rhiCommandList* const> secondaries) = 0;
 };
\ No newline at end of file
@@ -64,6 +64,7 @@ enum class rhiMem : u8
 {
     auto_device,
     auto_host,
+    auto_readback,
 };
 
 enum class rhiFormat : u32
@@ -99,6 +100,18 @@ enum class rhiSampleCount : u8
     x4 = 4 
 };
 
+// fifo never tears and paces the cpu to vblank, mailbox replaces the queued image, immediate tears
+enum class rhiPresentMode : u8
+{
+    fifo,
+    mailbox,
+    immediate
+};
+std::string_view to_string(const rhiPresentMode mode);
+
+// unique per created resource, a resource recreated at a reused address still gets a new one
+u64 next_resource_generation();
+
 enum class rhiResult
 {
     ok,
@@ -123,6 +136,7 @@ enum class rhiPipelineStage : u32
     all_commands = 1u << 12,
     early_fragment_test = 1u << 13,
     late_fragment_test = 1u << 14,
+    host = 1u << 15,
     bottom_of_pipe = 1u << 31,
 };
 
@@ -249,7 +263,7 @@ enum class rhiAccessFlags : u32
 };
 inline rhiAccessFlags operator|(rhiAccessFlags a, rhiAccessFlags b)
 {
-    return static_cast<rhiAccessFlags>(static_cast<u16>(a) | static_cast<u16>(b));
+    return static_cast<rhiAccessFlags>(static_cast<u32>(a) | static_cast<u32>(b));
 }
 
 enum class rhiMipsMethod { auto_select, linear_blit, compute };
@@ -0,0 +1,83 @@
+﻿#include "rhiDescriptorCache.h"
+#include "rhi/rhiBuffer.h"
+#include "rhi/rhiTextureView.h"
+#include "rhi/rhiSampler.h"
+#include "util/hash.h"
+#include <atomic>
+
+u64 next_resource_generation()
+{
+    static std::atomic<u64> generation = 0;
+    return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+u64 rhiDescriptorCache::hash(const rhiWriteDescriptor& write)
+{
+    u64 h = hash_combine(0ull, write.type);
+    h = hash_combine(h, write.count);
+    // generations, not addresses : a recreated buffer may land where the old one was
+    for (const rhiDescriptorImageInfo& image : write.image)
+    {
+        h = hash_combine(h, image.sampler ? image.sampler->get_generation() : 0ull);
+        h = hash_combine(h, image.texture ? image.texture->get_generation() : 0ull);
+        h = hash_combine(h, image.texture_cubemap ? image.texture_cubemap->get_generation() : 0ull);
+        h = hash_combine(h, image.mip);
+        h = hash_combine(h, image.base_layer);
+        h = hash_combine(h, image.layer_count);
+        h = hash_combine(h, image.is_separate_depth_view);
+        h = hash_combine(h, image.cubemap_viewtype);
+        h = hash_combine(h, image.layout);
+    }
+    for (const rhiDescriptorBufferInfo& buffer : write.buffer)
+    {
+        h = hash_combine(h, buffer.buffer ? buffer.buffer->get_generation() : 0ull);
+        h = hash_combine(h, buffer.offset);
+        h = hash_combine(h, buffer.range);
+    }
+    return h;
+}
+
+bool rhiDescriptorCache::changed(const rhiWriteDescriptor& write)
+{
+    const u64 h = hash(write);
+    std::lock_guard lock(mutex);
+    auto& bindings = sets[write.set.native];
+    auto it = std::ranges::find_if(bindings, [&](const binding& b) { return b.binding == write.binding && b.array_index == write.array_index; });
+    if (it == bindings.end())
+    {
+        bindings.push_back({ .binding = write.binding, .array_index = write.array_index, .hash = h });
+        ++stats.writes;
+        return true;
+    }
+    if (it->hash == h)
+    {
+        ++stats.skipped;
+        return false;
+    }
+    it->hash = h;
+    ++stats.writes;
+    return true;
+}
+
+void rhiDescriptorCache::forget(const rhiDescriptorSet& set)
+{
+    std::lock_guard lock(mutex);
+    sets.erase(set.native);
+}
+
+rhiDescriptorCacheStats rhiDescriptorCache::get_stats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+void rhiDescriptorCache::report() const
+{
+    std::lock_guard lock(mutex);
+    const rhiDescriptorCacheStats& s = stats;
+    const u64 total = s.writes + s.skipped;
+    if (total == 0)
+        return;
+    std::cout << std::format("[descriptorCache] {} sets, {} writes issued in {} updates, {} skipped unchanged ({:.1f}%)\n",
+        sets.size(), s.writes, s.updates, s.skipped, 100.0 * static_cast<f64>(s.skipped) / static_cast<f64>(total));
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDescriptor.h"
+#include <mutex>
+
+struct rhiDescriptorCacheStats
+{
+    u64 writes = 0;    // issued to the backend
+    u64 skipped = 0;   // the binding already held the same resources
+    u64 updates = 0;   // backend calls with at least one write left
+};
+
+// what each descriptor set binding was last written with, hashed by resource generation.
+// a write naming the same resources again is dropped before it reaches the driver
+class rhiDescriptorCache
+{
+public:
+    // false : the binding already holds it. true : recorded, the caller writes it
+    bool changed(const rhiWriteDescriptor& write);
+    // newly allocated sets start undefined, their handle may be a freed set's
+    void forget(const rhiDescriptorSet& set);
+    void count_update() { std::lock_guard lock(mutex); ++stats.updates; }
+
+    rhiDescriptorCacheStats get_stats() const;
+    void report() const;
+
+private:
+    static u64 hash(const rhiWriteDescriptor& write);
+
+private:
+    struct binding
+    {
+        u32 binding = 0;
+        u32 array_index = 0;
+        u64 hash = 0;
+    };
+    // passes write from the render thread and from pipeline compile workers
+    mutable std::mutex mutex;
+    std::unordered_map<const void*, std::vector<binding>> sets;
+    rhiDescriptorCacheStats stats;
+};
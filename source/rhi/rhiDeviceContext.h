@@ -5,14 +5,43 @@
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiSampler.h"
 #include "rhi/rhiDescriptor.h"
+#include "rhi/rhiDescriptorCache.h"
 #include "rhi/rhiPipeline.h"
 #include "rhi/rhiTextureBindlessTable.h"
+#include "rhi/rhiSubmitInfo.h"
 
 class rhiCommandList;
 class rhiFence;
 class rhiSemaphore;
 class rhiQueue;
-struct rhiSubmitInfo;
+class rhiTimestampPool;
+
+struct rhiMemoryStats
+{
+    u64 allocation_count = 0; // live
+    u64 allocation_bytes = 0;
+    u64 block_count = 0;
+    u64 block_bytes = 0;
+    u64 allocations_made = 0; // cumulative resource creations
+};
+
+struct rhiMemoryRequirements
+{
+    u64 size = 0; // 0 : the backend cannot place textures
+    u64 alignment = 1;
+    u32 type_bits = ~0u;
+};
+
+// device memory that placed textures alias into, freed with the object
+class rhiMemoryHeap
+{
+public:
+    explicit rhiMemoryHeap(const u64 size) : size(size) {}
+    virtual ~rhiMemoryHeap() = default;
+
+public:
+    const u64 size;
+};
 
 class rhiDeviceContext 
 {
@@ -20,19 +49,25 @@ public:
     virtual ~rhiDeviceContext() = default;
 
     virtual std::unique_ptr<rhiCommandList> create_commandlist(u32 queue_family) = 0;
+    // own pool per list, so each one can be recorded on a different thread
+    virtual std::unique_ptr<rhiCommandList> create_secondary_commandlist(u32 queue_family) = 0;
     virtual std::unique_ptr<rhiTextureBindlessTable> create_bindless_table(const rhiTextureBindlessDesc& desc, const u32 set_index = 0) = 0;
     virtual std::unique_ptr<rhiBuffer> create_buffer(const rhiBufferDesc& desc) = 0;
     virtual std::unique_ptr<rhiTexture> create_texture(const rhiTextureDesc& desc) = 0;
     virtual std::unique_ptr<rhiTexture> create_texture_from_path(std::string_view path, bool is_hdr = false, bool srgb = true) = 0;
+    virtual std::unique_ptr<rhiTexture> create_texture_from_image(rhiTextureImage&& image) = 0;
     virtual std::shared_ptr<rhiTextureCubeMap> create_texture_cubemap(const rhiTextureDesc& desc) = 0;
     virtual std::unique_ptr<rhiSampler> create_sampler(const rhiSamplerDesc& desc) = 0;
-    virtual std::unique_ptr<rhiSemaphore> create_semaphore() = 0;
+    // timeline semaphores are waited and signaled with values, binary ones with 0
+    virtual std::unique_ptr<rhiSemaphore> create_semaphore(const bool timeline = false) = 0;
     virtual std::unique_ptr<rhiFence> create_fence(bool signaled) = 0;
+    virtual std::unique_ptr<rhiTimestampPool> create_timestamp_pool(const u32 count) = 0;
 
     virtual rhiDescriptorSetLayout create_descriptor_set_layout(const std::vector<rhiDescriptorSetLayoutBinding>& bindings, u32 set_index = 0) = 0;
     virtual rhiDescriptorPool create_descriptor_pool(const rhiDescriptorPoolCreateInfo& create_info, u32 max_sets) = 0;
     virtual std::vector<rhiDescriptorSet> allocate_descriptor_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts) = 0;
     virtual std::vector<rhiDescriptorSet> allocate_descriptor_indexing_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts, const std::vector<u32>& counts) = 0;
+    // unchanged bindings are skipped, see descriptor_cache
     virtual void update_descriptors(const std::vector<rhiWriteDescriptor>& writes) = 0;
     virtual rhiDescriptorSetLayout create_descriptor_indexing_set_layout(const rhiDescriptorIndexing& desc, const u32 set_index) = 0;
 
@@ -41,18 +76,40 @@ public:
     virtual std::unique_ptr<rhiPipeline> create_compute_pipeline(const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout) = 0;
     virtual std::shared_ptr<rhiCommandList> begin_onetime_commands(rhiQueueType t = rhiQueueType::graphics) = 0;
     virtual void submit_and_wait(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics) = 0;
+    // returns right after the submit, keep_alive (staging) is released once the gpu finished
+    virtual rhiSubmitTicket submit_async(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics, std::vector<std::unique_ptr<rhiBuffer>> keep_alive = {}) = 0;
+    virtual bool is_complete(const rhiSubmitTicket& ticket) = 0;
+    virtual void wait(const rhiSubmitTicket& ticket) = 0;
+    // recycles retired one-time submits, called once per frame
+    virtual void collect_submits() {}
+    // timeline a queue's one-time submits signal, a ticket's value can be waited on from a frame submit.
+    // nullptr : submits retire before submit_async returns
+    virtual rhiSemaphore* get_submit_timeline(rhiQueueType t) { return nullptr; }
     virtual void submit(rhiQueueType type, const rhiSubmitInfo& info) = 0;
     virtual void wait(class rhiFence* f) = 0;
     virtual void reset(class rhiFence* f) = 0;
+    // host side of a timeline semaphore
+    virtual void wait(rhiSemaphore* timeline, const u64 value) = 0;
+    virtual u64 get_completed_value(rhiSemaphore* timeline) = 0;
+
+    virtual rhiMemoryStats get_memory_stats() const { return {}; }
+
+    // transient aliasing : textures with disjoint lifetimes share one heap at different or equal offsets
+    virtual rhiMemoryRequirements get_memory_requirements(const rhiTextureDesc& desc) const { return {}; }
+    virtual std::unique_ptr<rhiMemoryHeap> create_memory_heap(const rhiMemoryRequirements& requirements) { return nullptr; }
+    virtual std::unique_ptr<rhiTexture> create_placed_texture(const rhiTextureDesc& desc, rhiMemoryHeap* heap, const u64 offset) { return create_texture(desc); }
 
     const u32 get_queue_family_index(rhiQueueType type) const;
     rhiQueue* get_queue(rhiQueueType type) const;
     rhiQueueType get_queue_type(const u32 q_family_idx);
     const std::unordered_map<rhiQueueType, std::shared_ptr<rhiQueue>>& get_queues() const { return queue; }
+    const rhiDescriptorCache& get_descriptor_cache() const { return descriptor_cache; }
 
 public:
     glm::vec2 viewport_size;
 
 protected:
     std::unordered_map<rhiQueueType, std::shared_ptr<rhiQueue>> queue;
+    // update_descriptors drops writes whose binding already holds the same resources
+    rhiDescriptorCache descriptor_cache;
 };
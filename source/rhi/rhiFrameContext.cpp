@@ -3,14 +3,17 @@
 #include "rhi/rhiSubmitInfo.h"
 #include "rhi/rhiSwapChain.h"
 #include "rhi/rhiQueue.h"
+#include "util/cpuProfiler.h"
 
 rhiFrameContext::~rhiFrameContext()
 {
     queue_frame.clear();
 }
 
-void rhiFrameContext::update_inflight(rhiDeviceContext* context, const u32 frame_count)
+void rhiFrameContext::update_inflight(rhiDeviceContext* context, const u32 frames_in_flight)
 {
+    ASSERT(swapchain && frames_in_flight > 0);
+    const u32 frame_count = frames_in_flight;
     const auto& queue_families = context->get_queues();
     auto values = queue_families | std::views::values;
     for (auto& qptr : values)
@@ -31,35 +34,120 @@ void rhiFrameContext::update_inflight(rhiDeviceContext* context, const u32 frame
         queue_frame.emplace(q_type, std::ref(*it->second));
     }
 
-    frame_sync.resize(frame_count);
-    for (u32 i = 0; i < frame_count; ++i)
+    graphics_family = context->get_queue_family_index(rhiQueueType::graphics);
+    compute_family = context->get_queue_family_index(rhiQueueType::compute);
+    transfer_family = context->get_queue_family_index(rhiQueueType::transfer);
+    if (has_async_compute())
     {
-        frame_sync[i].image_available = context->create_semaphore();
-        frame_sync[i].present_ready = context->create_semaphore();
-        frame_sync[i].in_flight = context->create_fence(true);
+        graphics_late.resize(frame_count);
+        for (u32 i = 0; i < frame_count; ++i)
+            graphics_late[i] = context->create_commandlist(graphics_family);
     }
 
-    device_sync = context->create_semaphore();
+    secondary_frames.resize(frame_count);
+    frame_sync.resize(frame_count);
+    create_image_semaphores(context);
+
+    // families hand their frame work to each other by value
+    for (const u32 family : frames_by_index | std::views::keys)
+        queue_sync[family].timeline = context->create_semaphore(true);
 }
 
-void rhiFrameContext::acquire_next_image(u32* next_image)
+void rhiFrameContext::create_image_semaphores(rhiDeviceContext* context)
+{
+    for (auto& sync : frame_sync)
+        sync.image_available = context->create_semaphore();
+    // an image is acquired again only after its present consumed the wait
+    present_ready.resize(swapchain->get_swapchain_image_count());
+    for (auto& semaphore : present_ready)
+        semaphore = context->create_semaphore();
+}
+
+rhiResult rhiFrameContext::acquire_next_image(u32* next_image)
 {
     // because last submit is graphics queue
-    swapchain->acquire_next_image(next_image, frame_sync[frame_index].image_available.get());
+    return swapchain->acquire_next_image(next_image, frame_sync[frame_index].image_available.get());
+}
+
+void rhiFrameContext::drain(rhiDeviceContext* context)
+{
+    CPU_ZONE("frame_context::drain");
+    for (const auto& sync : queue_sync | std::views::values)
+    {
+        if (sync.value > 0)
+            context->wait(sync.timeline.get(), sync.value);
+    }
+    retire_latency(context->get_completed_value(queue_sync.at(graphics_family).timeline.get()));
+}
+
+void rhiFrameContext::recreate_swapchain(rhiDeviceContext* context, const u32 width, const u32 height)
+{
+    CPU_ZONE("frame_context::recreate_swapchain");
+    drain(context);
+    swapchain->recreate(width, height);
+    // a failed acquire may have left image_available pending, the image count may have changed
+    create_image_semaphores(context);
 }
 
 void rhiFrameContext::wait(rhiDeviceContext* context)
 {
-    context->wait(frame_sync[frame_index].in_flight.get());
+    CPU_ZONE("frame_context::wait");
+    rhiQueueSync& graphics_sync = queue_sync.at(graphics_family);
+    const u64 value = frame_sync[frame_index].retire_value;
+    if (value > 0)
+        context->wait(graphics_sync.timeline.get(), value);
+    // newer frames may have retired as well
+    if (!latency_pending.empty())
+        retire_latency(context->get_completed_value(graphics_sync.timeline.get()));
+}
+
+void rhiFrameContext::mark_input()
+{
+    input_ns = profiler::now_ns();
 }
 
-void rhiFrameContext::reset(rhiDeviceContext* context)
+void rhiFrameContext::retire_latency(const u64 completed)
 {
-    context->reset(frame_sync[frame_index].in_flight.get());
+    const u64 now = profiler::now_ns();
+    while (!latency_pending.empty() && latency_pending.front().value <= completed)
+    {
+        const pendingLatency& p = latency_pending.front();
+        const rhiFrameLatency latency{
+            .present_ms = static_cast<f64>(p.present_ns - p.input_ns) * 1e-6,
+            .complete_ms = static_cast<f64>(now - p.input_ns) * 1e-6
+        };
+        latency_pending.pop_front();
+
+        ++latency_frames;
+        latency_present_total += latency.present_ms;
+        latency_complete_total += latency.complete_ms;
+        latency_complete_max = std::max(latency_complete_max, latency.complete_ms);
+        // nobody may be taking them, the oldest go first
+        if (latency_retired.size() == max_retired_latency)
+            latency_retired.erase(latency_retired.begin());
+        latency_retired.push_back(latency);
+    }
+}
+
+std::vector<rhiFrameLatency> rhiFrameContext::take_latency()
+{
+    return std::exchange(latency_retired, {});
+}
+
+void rhiFrameContext::report_latency() const
+{
+    if (latency_frames == 0)
+        return;
+
+    const f64 frames = static_cast<f64>(latency_frames);
+    std::cout << std::format("[frameContext] {} frames in flight, {} images, present {}, input latency avg {:.2f} ms to present, {:.2f} ms to gpu done (max {:.2f}) over {} frames\n",
+        frame_sync.size(), present_ready.size(), to_string(swapchain->get_present_mode()),
+        latency_present_total / frames, latency_complete_total / frames, latency_complete_max, latency_frames);
 }
 
 void rhiFrameContext::command_begin()
 {
+    CPU_ZONE("frame_context::command_begin");
     for (auto& [idx, frames_ptr] : frames_by_index) 
     {
         auto& frames = *frames_ptr;
@@ -67,6 +155,8 @@ void rhiFrameContext::command_begin()
         cmd->reset();
         cmd->begin();
     }
+    secondary_used = 0;
+    joined = false;
 }
 
 void rhiFrameContext::command_end()
@@ -77,117 +167,161 @@ void rhiFrameContext::command_end()
         auto& cmd = frames[frame_index];
         cmd->end();
     }
+    if (joined)
+        graphics_late[frame_index]->end();
 }
 
-void rhiFrameContext::submit(rhiDeviceContext* context, const u32 image_index)
+rhiCommandList* rhiFrameContext::join_async_compute()
 {
-    u64& v = device_timeline_value;
+    if (!has_async_compute() || joined)
+        return get_command_list(rhiQueueType::graphics);
+
+    CPU_ZONE("frame_context::join_async_compute");
+    auto& late = graphics_late[frame_index];
+    late->reset();
+    late->begin();
+    joined = true;
+    return late.get();
+}
 
-    auto common_wait_submitinfo = rhiSemaphoreSubmitInfo{
+void rhiFrameContext::wait_before_graphics(const rhiSemaphoreSubmitInfo& wait)
+{
+    ASSERT(wait.semaphore);
+    auto it = std::ranges::find(graphics_waits, wait.semaphore, &rhiSemaphoreSubmitInfo::semaphore);
+    if (it == graphics_waits.end())
+    {
+        graphics_waits.push_back(wait);
+        return;
+    }
+    it->value = std::max(it->value, wait.value);
+    it->stage = it->stage | wait.stage;
+}
+
+rhiSemaphoreSubmitInfo rhiFrameContext::signal_next(const u32 family, const rhiPipelineStage stage)
+{
+    rhiQueueSync& sync = queue_sync.at(family);
+    return rhiSemaphoreSubmitInfo{
+        .semaphore = sync.timeline.get(),
+        .value = ++sync.value,
+        .stage = stage
+    };
+}
+
+void rhiFrameContext::submit(rhiDeviceContext* context, const u32 image_index)
+{
+    CPU_ZONE("frame_context::submit");
+    const auto common_wait_submitinfo = rhiSemaphoreSubmitInfo{
         .semaphore = frame_sync[frame_index].image_available.get(),
         .value = 0,
         .stage = rhiPipelineStage::color_attachment_output
     };
-    auto common_signal_submitinfo = rhiSemaphoreSubmitInfo{
-        .semaphore = frame_sync[frame_index].present_ready.get(),
+    const auto common_signal_submitinfo = rhiSemaphoreSubmitInfo{
+        .semaphore = present_ready[image_index].get(),
         .value = 0,
         .stage = rhiPipelineStage::all_commands
     };
 
-    for (auto& [idx, frames_ptr] : frames_by_index)
+    // graphics up to the async join waits for uploads only, the rest also for the frame's compute
+    std::vector<rhiSemaphoreSubmitInfo> early_waits = graphics_waits;
+    std::optional<rhiSemaphoreSubmitInfo> compute_done;
+    rhiQueueSync& graphics_sync = queue_sync.at(graphics_family);
+
+    // T
+    if (transfer_family != graphics_family)
     {
-        rhiQueueType type = context->get_queue_type(idx);
-        // G C T
-        if ((type & (rhiQueueType::graphics | rhiQueueType::compute | rhiQueueType::transfer)) == (rhiQueueType::graphics | rhiQueueType::compute | rhiQueueType::transfer))
-        {
-            const auto& frame = queue_frame.at(rhiQueueType::graphics).get();
-            rhiSubmitInfo submit_info{
-                .cmd_lists = { frame[frame_index].get()},
-                .waits = { common_wait_submitinfo },
-                .signals = { common_signal_submitinfo },
-                .fence = frame_sync[frame_index].in_flight.get()
-            };
-            context->submit(rhiQueueType::graphics, submit_info);
-        }
-        // G C,
-        else if ((type & (rhiQueueType::graphics | rhiQueueType::compute)) == (rhiQueueType::graphics | rhiQueueType::compute))
-        {
-            rhiSemaphoreSubmitInfo timeline_wait{
-                .semaphore = device_sync.get(),
-                .value = v,
-                .stage = rhiPipelineStage::all_commands
-            };
-            const auto& frame = queue_frame.at(rhiQueueType::graphics).get();
-            rhiSubmitInfo submit_info{
-                .cmd_lists = { frame[frame_index].get()},
-                .waits = { timeline_wait, common_wait_submitinfo },
-                .signals = { common_signal_submitinfo },
-                .fence = frame_sync[frame_index].in_flight.get()
-            };
-            context->submit(rhiQueueType::graphics, submit_info);
-        }
-        // T
-        else if ((type & rhiQueueType::transfer) == rhiQueueType::transfer)
-        {
-            const auto& cur_frame = queue_frame.at(rhiQueueType::transfer).get();
-            rhiSubmitInfo submit_info{
-                .cmd_lists = { cur_frame[frame_index].get() },
-                .signals = { rhiSemaphoreSubmitInfo{
-                    .semaphore = device_sync.get(),
-                    .value = ++v,
-                    .stage = rhiPipelineStage::copy
-                }}
-            };
-            context->submit(rhiQueueType::transfer, submit_info);
-        }
-        // C
-        else if ((type & rhiQueueType::compute) == rhiQueueType::compute)
-        {
-            const auto& cur_frame = queue_frame.at(rhiQueueType::compute).get();
-            rhiSubmitInfo submit_info{
-                .cmd_lists = { cur_frame[frame_index].get() },
-                .waits = { rhiSemaphoreSubmitInfo{
-                    .semaphore = device_sync.get(),
-                    .value = v,
-                    .stage = rhiPipelineStage::compute_shader
-                }},
-                .signals = { rhiSemaphoreSubmitInfo{
-                    .semaphore = device_sync.get(),
-                    .value = ++v,
-                    .stage = rhiPipelineStage::compute_shader
-                }}
-            };
-            context->submit(rhiQueueType::compute, submit_info);
-        }
-        // G
-        else if ((type & rhiQueueType::graphics) == rhiQueueType::graphics)
+        std::vector<rhiSemaphoreSubmitInfo> waits;
+        // compute sharing the transfer family overwrites what earlier graphics frames may still read
+        if (compute_family == transfer_family && graphics_sync.value > 0)
+            waits.push_back({ graphics_sync.timeline.get(), graphics_sync.value, rhiPipelineStage::all_commands });
+
+        const rhiSubmitInfo submit_info{
+            .cmd_lists = { get_command_list(transfer_family) },
+            .waits = std::move(waits),
+            .signals = { signal_next(transfer_family, rhiPipelineStage::all_commands) }
+        };
+        context->submit(rhiQueueType::transfer, submit_info);
+
+        auto done = submit_info.signals.front();
+        done.stage = rhiPipelineStage::all_commands;
+        early_waits.push_back(done);
+    }
+    // C, overlaps graphics up to the join
+    if (compute_family != graphics_family && compute_family != transfer_family)
+    {
+        std::vector<rhiSemaphoreSubmitInfo> waits;
+        if (transfer_family != graphics_family)
         {
-            const auto& cur_frame = queue_frame.at(rhiQueueType::graphics).get();
-            rhiSubmitInfo submit_info{
-                .cmd_lists = { cur_frame[frame_index].get() },
-                .waits = { rhiSemaphoreSubmitInfo{
-                    .semaphore = device_sync.get(),
-                    .value = v,
-                    .stage = rhiPipelineStage::all_graphics
-                }, common_wait_submitinfo },
-                .signals = { common_signal_submitinfo },
-                .fence = frame_sync[frame_index].in_flight.get()
-            };
-            context->submit(rhiQueueType::graphics, submit_info);
+            const rhiQueueSync& transfer_sync = queue_sync.at(transfer_family);
+            waits.push_back({ transfer_sync.timeline.get(), transfer_sync.value, rhiPipelineStage::compute_shader });
         }
+        // the previous frames' graphics may still sample what this compute overwrites
+        if (graphics_sync.value > 0)
+            waits.push_back({ graphics_sync.timeline.get(), graphics_sync.value, rhiPipelineStage::compute_shader });
+
+        const rhiSubmitInfo submit_info{
+            .cmd_lists = { get_command_list(compute_family) },
+            .waits = std::move(waits),
+            .signals = { signal_next(compute_family, rhiPipelineStage::compute_shader) }
+        };
+        context->submit(rhiQueueType::compute, submit_info);
+
+        compute_done = submit_info.signals.front();
+        compute_done->stage = rhiPipelineStage::all_commands;
+    }
+
+    // G, its timeline value retires the frame slot
+    const rhiSemaphoreSubmitInfo graphics_done = signal_next(graphics_family, rhiPipelineStage::all_commands);
+    frame_sync[frame_index].retire_value = graphics_done.value;
+    if (input_ns > 0)
+        latency_pending.push_back({ .value = graphics_done.value, .input_ns = std::exchange(input_ns, 0) });
+    auto& graphics_frames = *frames_by_index.at(graphics_family);
+    std::vector<rhiSemaphoreSubmitInfo> late_waits = early_waits;
+    if (compute_done.has_value())
+        late_waits.push_back(compute_done.value());
+    late_waits.push_back(common_wait_submitinfo);
+    if (joined)
+    {
+        const rhiSubmitInfo early_info{
+            .cmd_lists = { graphics_frames[frame_index].get() },
+            .waits = std::move(early_waits)
+        };
+        context->submit(rhiQueueType::graphics, early_info);
+
+        const rhiSubmitInfo late_info{
+            .cmd_lists = { graphics_late[frame_index].get() },
+            .waits = std::move(late_waits),
+            .signals = { common_signal_submitinfo, graphics_done }
+        };
+        context->submit(rhiQueueType::graphics, late_info);
+    }
+    else
+    {
+        const rhiSubmitInfo submit_info{
+            .cmd_lists = { graphics_frames[frame_index].get() },
+            .waits = std::move(late_waits),
+            .signals = { common_signal_submitinfo, graphics_done }
+        };
+        context->submit(rhiQueueType::graphics, submit_info);
     }
+    graphics_waits.clear();
 }
 
-void rhiFrameContext::present(const u32 image_index)
+rhiResult rhiFrameContext::present(const u32 image_index)
 {
-    auto& frame = queue_frame.at(rhiQueueType::graphics).get();
-    swapchain->present(image_index, frame_sync[image_index].present_ready.get());
-    frame_index = (frame_index + 1) % static_cast<u32>(frame.size());
+    CPU_ZONE("frame_context::present");
+    // the frame was submitted either way, out_of_date only means it is not shown
+    const rhiResult result = swapchain->present(image_index, present_ready[image_index].get());
+    if (!latency_pending.empty() && latency_pending.back().present_ns == 0)
+        latency_pending.back().present_ns = profiler::now_ns();
+    frame_index = (frame_index + 1) % static_cast<u32>(frame_sync.size());
+    return result;
 }
 
 rhiCommandList* rhiFrameContext::get_command_list(u32 q_family_idx)
 {
     ASSERT(frames_by_index.contains(q_family_idx));
+    if (joined && q_family_idx == graphics_family)
+        return graphics_late[frame_index].get();
     auto frames = frames_by_index[q_family_idx].get();
     return (*frames)[frame_index].get();
 }
@@ -195,13 +329,29 @@ rhiCommandList* rhiFrameContext::get_command_list(u32 q_family_idx)
 rhiCommandList* rhiFrameContext::get_command_list(rhiQueueType type)
 {
     ASSERT(queue_frame.contains(type));
+    if (joined && (type == rhiQueueType::graphics || type == rhiQueueType::present))
+        return graphics_late[frame_index].get();
 
     auto& frames = queue_frame.at(type).get();
     return frames[frame_index].get();
 }
 
+std::vector<rhiCommandList*> rhiFrameContext::acquire_secondary_command_lists(rhiDeviceContext* context, const u32 count)
+{
+    auto& slots = secondary_frames[frame_index];
+    const u32 family = context->get_queue(rhiQueueType::graphics)->q_index();
+    while (slots.size() < secondary_used + count)
+        slots.push_back(context->create_secondary_commandlist(family));
+
+    std::vector<rhiCommandList*> lists;
+    lists.reserve(count);
+    for (u32 index = 0; index < count; ++index)
+        lists.push_back(slots[secondary_used + index].get());
+    secondary_used += count;
+    return lists;
+}
+
 const u32 rhiFrameContext::get_frame_size() 
 { 
-    auto& frame = queue_frame.at(rhiQueueType::graphics).get();
-    return static_cast<u32>(frame.size());
+    return static_cast<u32>(frame_sync.size());
 }
\ No newline at end of file
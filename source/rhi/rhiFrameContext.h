@@ -4,15 +4,34 @@
 #include "rhi/rhiGraphicsQueue.h"
 #include "rhi/rhiSynchroize.h"
 #include "rhi/rhiCommandList.h"
+#include "rhi/rhiSubmitInfo.h"
+#include <deque>
 
 class rhiDeviceContext;
 class rhiSwapChain;
 
+// per frame in flight, present_ready lives per swapchain image instead
 struct rhiFrameSync
 {
     std::unique_ptr<rhiSemaphore> image_available;
-    std::unique_ptr<rhiSemaphore> present_ready;
-    std::unique_ptr<rhiFence> in_flight;
+    // graphics timeline value the slot's last submit signals, 0 before its first frame
+    u64 retire_value = 0;
+};
+
+// one retired frame, from the input it reacted to
+struct rhiFrameLatency
+{
+    // input sampled -> present queued, the cpu side
+    f64 present_ms = 0.0;
+    // input sampled -> the frame's graphics work retired, observed at the next frame wait
+    f64 complete_ms = 0.0;
+};
+
+// one timeline per queue family, each family signals its own values in submit order
+struct rhiQueueSync
+{
+    std::unique_ptr<rhiSemaphore> timeline;
+    u64 value = 0;
 };
 
 class rhiFrameContext 
@@ -22,18 +41,39 @@ public:
 
 public:
     void submit(rhiDeviceContext* context, const u32 image_index);
-    void update_inflight(rhiDeviceContext* context, const u32 frame_count);
-    void acquire_next_image(u32* next_image);
+    // frames in flight are independent of the swapchain image count, the swapchain is set before
+    void update_inflight(rhiDeviceContext* context, const u32 frames_in_flight);
+    // out_of_date leaves the frame slot as it is, nothing waits on its image_available
+    rhiResult acquire_next_image(u32* next_image);
+    // blocks until the graphics timeline retired the slot's previous frame
     void wait(rhiDeviceContext* context);
-    void reset(rhiDeviceContext* context);
-    void present(const u32 image_index);
+    rhiResult present(const u32 image_index);
+    // blocks until every queue retired what was submitted so far
+    void drain(rhiDeviceContext* context);
+    // drains, then rebuilds the swapchain and the binary semaphores tied to its images
+    void recreate_swapchain(rhiDeviceContext* context, const u32 width, const u32 height);
+
+    // the frame recorded next reacts to input sampled now
+    void mark_input();
+    // frames retired since the last call, oldest first
+    std::vector<rhiFrameLatency> take_latency();
+    void report_latency() const;
 
     void command_begin();
     void command_end();
+    // this frame's graphics submit also waits on the value, e.g. a streamed upload's ticket
+    void wait_before_graphics(const rhiSemaphoreSubmitInfo& wait);
+    // graphics recorded so far overlaps the frame's compute list, what is recorded after waits for it.
+    // returns the graphics list to continue on, the same one when compute shares the graphics family
+    rhiCommandList* join_async_compute();
+    bool has_async_compute() const { return compute_family != graphics_family; }
 
     rhiCommandList* get_command_list(u32 q_family_idx);
     rhiCommandList* get_command_list(rhiQueueType type);
+    // graphics secondaries of the current frame, each call hands out lists no one else records this frame
+    std::vector<rhiCommandList*> acquire_secondary_command_lists(rhiDeviceContext* context, const u32 count);
     const u32 get_frame_size();
+    const u32 get_frame_index() const { return frame_index; }
 
 public:
     rhiSwapChain* swapchain = nullptr;
@@ -43,11 +83,42 @@ protected:
     std::map<u32, std::unique_ptr<frames>, std::greater<>> frames_by_index;
     std::unordered_map<rhiQueueType, std::reference_wrapper<frames>> queue_frame;
     std::vector<rhiFrameSync> frame_sync;
-    std::unique_ptr<rhiSemaphore> device_sync;
+    // signaled by the graphics submit, waited by present of the same image
+    std::vector<std::unique_ptr<rhiSemaphore>> present_ready;
+    std::unordered_map<u32, rhiQueueSync> queue_sync;
+    // second graphics list per frame, begun once async compute is joined
+    std::vector<std::unique_ptr<rhiCommandList>> graphics_late;
+    bool joined = false;
+    // [frame][slot], reused once the frame's fence has signaled
+    std::vector<std::vector<std::unique_ptr<rhiCommandList>>> secondary_frames;
+    u32 secondary_used = 0;
+    // one entry per semaphore, the highest value wins
+    std::vector<rhiSemaphoreSubmitInfo> graphics_waits;
 
     u32 frame_index = 0;
     u32 cur_image_index = 0;
-   
+    u32 graphics_family = 0;
+    u32 compute_family = 0;
+    u32 transfer_family = 0;
+
+    // latency, keyed by the graphics timeline value of the frame
+    struct pendingLatency
+    {
+        u64 value = 0;
+        u64 input_ns = 0;
+        u64 present_ns = 0;
+    };
+    static constexpr size_t max_retired_latency = 1024;
+    u64 input_ns = 0;
+    std::deque<pendingLatency> latency_pending;
+    std::vector<rhiFrameLatency> latency_retired;
+    u64 latency_frames = 0;
+    f64 latency_present_total = 0.0;
+    f64 latency_complete_total = 0.0;
+    f64 latency_complete_max = 0.0;
+
 private:
-    u64 device_timeline_value = 0;
+    rhiSemaphoreSubmitInfo signal_next(const u32 family, const rhiPipelineStage stage);
+    void create_image_semaphores(rhiDeviceContext* context);
+    void retire_latency(const u64 completed);
 }; 
\ No newline at end of file
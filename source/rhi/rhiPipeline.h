@@ -41,6 +41,13 @@ struct rhiRasterState
     rhiFrontFace front_face = rhiFrontFace::ccw;
 };
 
+// 32 bit scalar specialization constant, bools are 0/1
+struct rhiSpecializationConstant
+{
+    u32 id;
+    u32 value;
+};
+
 struct rhiGraphicsPipelineDesc 
 {
     std::optional<rhiShaderBinary> vs;
@@ -57,11 +64,14 @@ struct rhiGraphicsPipelineDesc
     bool use_dynamic_cullmode = false;
 
     std::optional<rhiVertexAttribute> vertex_layout;
+    // applied to every stage, ids a stage does not declare are ignored
+    std::vector<rhiSpecializationConstant> specialization;
 };
 
 struct rhiComputePipelineDesc 
 {
     rhiShaderBinary cs;
+    std::vector<rhiSpecializationConstant> specialization;
 };
 
 class rhiPipeline 
@@ -0,0 +1,15 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDefs.h"
+
+class rhiTimestampPool
+{
+public:
+    virtual ~rhiTimestampPool() = default;
+
+    // false while any query in the range is still in flight
+    virtual bool resolve(const u32 first, const u32 count, std::vector<u64>& ticks) = 0;
+    virtual f64 ticks_to_ms(const u64 ticks) const = 0;
+    virtual u32 capacity() const = 0;
+};
@@ -7,6 +7,7 @@
 #include "rhi/rhiBuffer.h"
 #include "rhi/rhiCommandList.h"
 #include "rhi/rhiSynchroize.h"
+#include "renderer/uploadQueue.h"
 
 namespace
 {
@@ -76,26 +77,9 @@ void rhiRenderResource::upload(renderShared* rs, textureCache* tex_cache)
 	vbo = rs->context->create_buffer(vb_desc);
 	ibo = rs->context->create_buffer(ib_desc);
 
-	rs->upload_to_device(vbo.get(), raw_data_ptr->vertices.data(), static_cast<u32>(vb_bytes), 0);
-	rs->upload_to_device(ibo.get(), raw_data_ptr->indices.data(), static_cast<u32>(ib_bytes), 0);
-	rs->buffer_barrier(vbo.get(), {
-			.src_stage = rhiPipelineStage::copy,
-			.dst_stage = rhiPipelineStage::vertex_input,
-			.src_access = rhiAccessFlags::transfer_write,
-			.dst_access = rhiAccessFlags::vertex_attribute_read,
-			.offset = 0,
-			.size = vb_bytes,
-			.src_queue = rs->context->get_queue_family_index(rhiQueueType::graphics),
-			.dst_queue = rs->context->get_queue_family_index(rhiQueueType::transfer) });
-	rs->buffer_barrier(ibo.get(), {
-			.src_stage = rhiPipelineStage::copy,
-			.dst_stage = rhiPipelineStage::vertex_input,
-			.src_access = rhiAccessFlags::transfer_write,
-			.dst_access = rhiAccessFlags::index_read,
-			.offset = 0,
-			.size = ib_bytes,
-			.src_queue = rs->context->get_queue_family_index(rhiQueueType::graphics),
-			.dst_queue = rs->context->get_queue_family_index(rhiQueueType::transfer) });
+	// streamed, the ibo is queued last so its id covers both
+	rs->uploads->enqueue(vbo.get(), raw_data_ptr->vertices.data(), vb_bytes, 0, rhiPipelineStage::vertex_input, rhiAccessFlags::vertex_attribute_read);
+	upload_id = rs->uploads->enqueue(ibo.get(), raw_data_ptr->indices.data(), ib_bytes, 0, rhiPipelineStage::vertex_input, rhiAccessFlags::index_read);
 
 	rebuild_submeshes(tex_cache, raw_data_ptr.get());
 }
@@ -183,6 +167,11 @@ rhiBuffer* rhiRenderResource::get_ibo() const
 	return ibo.get();
 }
 
+bool rhiRenderResource::is_streamed(const uploadQueue* uploads) const
+{
+	return is_uploaded() && uploads->is_ready(upload_id);
+}
+
 const rhiRenderResource::material& rhiRenderResource::get_material(const i32 slot_index)
 {
 	if (slot_index >= materials.size())
@@ -10,6 +10,7 @@ class rhiSampler;
 class glTFMesh;
 class renderShared;
 class textureCache;
+class uploadQueue;
 class rhiRenderResource : public rhiResource
 {
 public:
@@ -73,6 +74,8 @@ public:
     void make_meshlet_resource(textureCache* tex_cache);
     rhiBuffer* get_vbo() const;
     rhiBuffer* get_ibo() const;
+    // vbo and ibo may be drawn from once their upload was handed to graphics
+    bool is_streamed(const uploadQueue* uploads) const;
     const material& get_material(const i32 slot_index);
     glTFMesh* get_raw_data() { auto ptr = raw_data.lock();  return ptr.get(); }
     const std::vector<subMesh>& get_submeshes() const { return submeshes; }
@@ -86,6 +89,7 @@ private:
     std::weak_ptr<glTFMesh> raw_data;
     std::unique_ptr<rhiBuffer> vbo;
     std::unique_ptr<rhiBuffer> ibo;
+    u64 upload_id = 0;
     std::vector<subMesh> submeshes;
     std::vector<material> materials;
 };
\ No newline at end of file
@@ -71,5 +71,9 @@ class rhiSampler
 {
 public:
     virtual ~rhiSampler() = default;
+    u64 get_generation() const { return generation; }
     rhiSamplerDesc desc;
+
+private:
+    u64 generation = next_resource_generation();
 };
\ No newline at end of file
@@ -7,6 +7,8 @@ struct rhiShaderBinary
     const void* data = nullptr;
     u32 size = 0;
     std::string entry = "main";
+    u64 hash = 0;       // spir-v content hash, non zero lets the device share one module
+    bool owned = true;  // false for views into the shader library
 };
 
 namespace shaderio
@@ -59,7 +61,7 @@ namespace shaderio
 
     inline void free_shader_binary(rhiShaderBinary& bin)
     {
-        if (bin.data) 
+        if (bin.data && bin.owned) 
         {
             delete[] reinterpret_cast<const uint8_t*>(bin.data);
             bin.data = nullptr;
@@ -20,4 +20,13 @@ struct rhiSubmitInfo
     std::vector<rhiSemaphoreSubmitInfo> waits;
     std::vector<rhiSemaphoreSubmitInfo> signals;
     rhiFence* fence = nullptr;
+};
+
+// waitable handle of a one-time submit, a value on the queue's own timeline
+struct rhiSubmitTicket
+{
+    rhiQueueType queue = rhiQueueType::none;
+    u64 value = 0;
+
+    bool valid() const { return value != 0; }
 };
\ No newline at end of file
@@ -3,8 +3,6 @@
 #include "pch.h"
 #include "rhi/rhiDefs.h"
 
-constexpr int kMaxFramesInFlight = 3;
-
 struct rhiRenderTargetView;
 class rhiSwapChain
 {
@@ -12,16 +10,25 @@ public:
     rhiSwapChain(u32 width, u32 height) : _width(width), _height(height) {}
 
 public:
-    virtual void acquire_next_image(u32* outIndex, class rhiSemaphore* signal) = 0;
-    virtual void present(u32 imageIndex, class rhiSemaphore* wait) = 0;
+    // out_of_date : nothing was acquired or presented, suboptimal : it was, recreate soon
+    virtual rhiResult acquire_next_image(u32* outIndex, class rhiSemaphore* signal) = 0;
+    virtual rhiResult present(u32 imageIndex, class rhiSemaphore* wait) = 0;
+    // the gpu is drained by the caller, views() hands out the new images afterwards.
+    // offscreen rings keep their size
+    virtual void recreate(const u32 width, const u32 height) {}
 
     virtual u32 width() const { return _width; }
     virtual u32 height() const { return _height; }
     virtual rhiFormat format() const = 0;
     virtual const std::vector<rhiRenderTargetView>& views() const = 0;
+    // layout the frame leaves the image in after composite
+    virtual rhiImageLayout present_layout() const { return rhiImageLayout::present; }
     u32 get_swapchain_image_count() const { return image_count; }
+    // what the surface granted, may differ from the requested mode
+    rhiPresentMode get_present_mode() const { return present_mode; }
 
 protected:
     u32 _width, _height;
     u32 image_count = 0;
+    rhiPresentMode present_mode = rhiPresentMode::fifo;
 };
\ No newline at end of file
@@ -1,38 +1,79 @@
 ﻿#include "rhiTextureView.h"
 #include "rhi/rhiDeviceContext.h"
 #include "rhi/rhiCommandList.h"
+#include "util/packing.h"
 
-rhiTexture::rhiTexture(rhiDeviceContext* context, std::string_view path, bool is_hdr, bool srgb)
+namespace
 {
-    if (is_hdr)
+    u32 calc_mip_count(const u32 width, const u32 height)
     {
-        generate_equirect(path);
-        return;
+        u32 mip_count = 1;
+        while ((width | height) >> mip_count)
+            ++mip_count;
+        return mip_count;
     }
+}
 
+u64 rhiTextureImage::byte_size() const
+{
+    // full mip chain
+    u64 bytes = 0;
+    for (u32 mip = 0; mip < desc.mips; ++mip)
+        bytes += static_cast<u64>(std::max(1u, desc.width >> mip)) * std::max(1u, desc.height >> mip) * 4;
+    return bytes;
+}
+
+void rhiTextureImage::release()
+{
+    if (pixels)
+        stbi_image_free(pixels);
+    pixels = nullptr;
+}
+
+rhiTextureImage rhiTexture::load_image(std::string_view path, bool srgb)
+{
     i32 width = 0;
     i32 height = 0;
     i32 channels = 0;
-    pixels = stbi_load(path.data(), &width, &height, &channels, STBI_rgb_alpha);
+    stbi_uc* pixels = stbi_load(path.data(), &width, &height, &channels, STBI_rgb_alpha);
     if (!pixels)
         throw std::runtime_error("failed to load png");
 
-    auto calc_mip_count = [](const u32 width, const u32 height) -> u32
-        {
-            u32 mip_count = 1;
-            while ((width | height) >> mip_count)
-                ++mip_count;
-            return mip_count;
-        };
+    rhiTextureImage image{
+        .desc = rhiTextureDesc{
+            .width = static_cast<u32>(width),
+            .height = static_cast<u32>(height),
+            .layers = 1,
+            .mips = calc_mip_count(width, height),
+            .format = srgb ? rhiFormat::RGBA8_SRGB : rhiFormat::RGBA8_UNORM,
+            .samples = rhiSampleCount::x1,
+            .usage = rhiTextureUsage::from_file,
+            .is_depth = false
+        },
+        .pixels = pixels
+    };
+    image.pixel_hash = fast_hash64(pixels, static_cast<size_t>(width) * height * 4);
+    return image;
+}
 
-    desc.width = static_cast<u32>(width);
-    desc.height = static_cast<u32>(height);
-    desc.layers = 1;
-    desc.mips = calc_mip_count(width, height);
-    desc.format = srgb ? rhiFormat::RGBA8_SRGB : rhiFormat::RGBA8_UNORM;
-    desc.samples = rhiSampleCount::x1;
-    desc.usage = rhiTextureUsage::from_file;
-    desc.is_depth = false;
+rhiTexture::rhiTexture(rhiDeviceContext* context, std::string_view path, bool is_hdr, bool srgb)
+{
+    if (is_hdr)
+    {
+        generate_equirect(path);
+        return;
+    }
+
+    rhiTextureImage image = load_image(path, srgb);
+    desc = image.desc;
+    pixels = image.pixels;
+    content_hash = image.content_hash();
+}
+
+rhiTexture::rhiTexture(rhiTextureImage&& image)
+    : desc(image.desc), pixels(image.pixels), content_hash(image.content_hash())
+{
+    image.pixels = nullptr;
 }
 
 void rhiTexture::generate_mips(rhiDeviceContext* context)
@@ -81,12 +122,21 @@ void rhiTexture::generate_mips(rhiDeviceContext* context)
     {
         cmd_lst->image_barrier(this, rhiImageLayout::transfer_src, rhiImageLayout::shader_readonly, 0, 1, 0, desc.layers);
     }
-    context->submit_and_wait(cmd_lst);
+    // the staging copy is all the gpu still needs, the upload retires in the background
+    std::vector<std::unique_ptr<rhiBuffer>> keep_alive;
+    keep_alive.push_back(std::move(staging));
+    context->submit_async(cmd_lst, rhiQueueType::graphics, std::move(keep_alive));
     stbi_image_free(pixels);
 }
 
 void rhiTexture::generate_equirect(std::string_view path)
 {
+    if (path == procedural_sky)
+    {
+        generate_procedural_sky();
+        return;
+    }
+
     i32 width = 0;
     i32 height = 0;
     i32 channels = 0;
@@ -95,22 +145,61 @@ void rhiTexture::generate_equirect(std::string_view path)
     if (!f_pixels)
         throw std::runtime_error("failed to load hdr");
 
-    rgba.resize(width * height * 4);
+    // half is enough for sampling radiance, clamp so the sun doesn't turn into inf
+    constexpr f32 half_max = 65504.f;
+    rgba16f.resize(width * height * 4);
     for (i32 i = 0; i < width * height; ++i)
     {
-        rgba[i * 4 + 0] = f_pixels[i * 3 + 0];
-        rgba[i * 4 + 1] = f_pixels[i * 3 + 1];
-        rgba[i * 4 + 2] = f_pixels[i * 3 + 2];
-        rgba[i * 4 + 3] = 1.f;
+        rgba16f[i * 4 + 0] = float_to_half(std::min(f_pixels[i * 3 + 0], half_max));
+        rgba16f[i * 4 + 1] = float_to_half(std::min(f_pixels[i * 3 + 1], half_max));
+        rgba16f[i * 4 + 2] = float_to_half(std::min(f_pixels[i * 3 + 2], half_max));
+        rgba16f[i * 4 + 3] = float_to_half(1.f);
     }
 
     desc.width = static_cast<u32>(width);
     desc.height = static_cast<u32>(height);
     desc.layers = 1;
     desc.mips = 1;
-    desc.format = rhiFormat::RGBA32_SFLOAT;
+    desc.format = rhiFormat::RGBA16F;
     desc.samples = rhiSampleCount::x1;
     desc.usage = rhiTextureUsage::from_file;
     desc.is_depth = false;
     stbi_image_free(f_pixels);
 }
+
+void rhiTexture::generate_procedural_sky()
+{
+    // zenith to horizon gradient over a flat ground, low frequency so a small equirect is enough
+    constexpr u32 width = 256;
+    constexpr u32 height = 128;
+    const vec3 zenith(0.15f, 0.35f, 0.85f);
+    const vec3 horizon(0.85f, 0.9f, 1.f);
+    const vec3 ground(0.25f, 0.22f, 0.2f);
+
+    rgba16f.resize(width * height * 4);
+    for (u32 y = 0; y < height; ++y)
+    {
+        // +1 at the top row, -1 at the bottom
+        const f32 elevation = 1.f - 2.f * (static_cast<f32>(y) + 0.5f) / static_cast<f32>(height);
+        const vec3 color = elevation >= 0.f
+            ? glm::mix(horizon, zenith, std::sqrt(elevation))
+            : glm::mix(horizon, ground, std::min(1.f, -elevation * 8.f));
+        for (u32 x = 0; x < width; ++x)
+        {
+            u16* texel = &rgba16f[(y * width + x) * 4];
+            texel[0] = float_to_half(color.r);
+            texel[1] = float_to_half(color.g);
+            texel[2] = float_to_half(color.b);
+            texel[3] = float_to_half(1.f);
+        }
+    }
+
+    desc.width = width;
+    desc.height = height;
+    desc.layers = 1;
+    desc.mips = 1;
+    desc.format = rhiFormat::RGBA16F;
+    desc.samples = rhiSampleCount::x1;
+    desc.usage = rhiTextureUsage::from_file;
+    desc.is_depth = false;
+}
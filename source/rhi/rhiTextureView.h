@@ -44,6 +44,28 @@ struct rhiTextureDesc
     rhiTextureUsage usage = rhiTextureUsage::normal;
     bool is_depth = false;
     bool is_separate_depth_stencil = false;
+    // concurrent across the queue families instead of owned by one, cubemaps only
+    bool shared_queues = false;
+};
+
+// decoded rgba8 pixels, owned until handed to a texture
+struct rhiTextureImage
+{
+    rhiTextureDesc desc;
+    stbi_uc* pixels = nullptr;
+    u64 pixel_hash = 0;
+
+    // same bytes reshaped to another extent must not collide
+    static u64 content_key(const u64 pixel_hash, const rhiTextureDesc& desc)
+    {
+        u64 h = hash_combine(pixel_hash, desc.format);
+        h = hash_combine(h, desc.width);
+        h = hash_combine(h, desc.height);
+        return hash_combine(h, desc.mips);
+    }
+    u64 content_hash() const { return content_key(pixel_hash, desc); }
+    u64 byte_size() const;
+    void release();
 };
 
 class rhiTexture 
@@ -51,20 +73,33 @@ class rhiTexture
 public:
     rhiTexture(const rhiTextureDesc& desc) : desc(desc) {}
     rhiTexture(class rhiDeviceContext* context, std::string_view path, bool is_hdr = false, bool srgb = true);
+    rhiTexture(rhiTextureImage&& image);
     virtual ~rhiTexture() = default;
 
+public:
+    // hdr path that resolves to a generated gradient sky, for runs without the sky asset
+    static constexpr std::string_view procedural_sky = "procedural:sky";
+    static rhiTextureImage load_image(std::string_view path, bool srgb = true);
+    const u64 get_content_hash() const { return content_hash; }
+    u64 get_generation() const { return generation; }
+
 protected:
     void generate_mips(rhiDeviceContext* context);
 
 private:
     void generate_equirect(std::string_view path);
+    void generate_procedural_sky();
 
 public:
     rhiTextureDesc desc;
 
 protected:
     stbi_uc* pixels = nullptr;
-    std::vector<f32> rgba;
+    std::vector<u16> rgba16f;
+    u64 content_hash = 0;
+
+private:
+    u64 generation = next_resource_generation();
 };
 
 class rhiTextureCubeMap
@@ -72,9 +107,13 @@ class rhiTextureCubeMap
 public:
     rhiTextureCubeMap(const rhiTextureDesc& desc) : desc(desc) {}
     virtual ~rhiTextureCubeMap() = default;
+    u64 get_generation() const { return generation; }
 
 public:
     rhiTextureDesc desc;
+
+private:
+    u64 generation = next_resource_generation();
 };
 
 struct rhiRenderTargetView 
@@ -21,6 +21,11 @@ vkBuffer::vkBuffer(vkDeviceContext* context, const rhiBufferDesc& desc)
         vma_alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
         vma_alloc_create_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
     }
+    else if (desc.memory == rhiMem::auto_readback)
+    {
+        vma_alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+        vma_alloc_create_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
     else 
     {
         vma_alloc_create_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
@@ -28,7 +33,7 @@ vkBuffer::vkBuffer(vkDeviceContext* context, const rhiBufferDesc& desc)
 
     VmaAllocationInfo alloc_info;
     VK_CHECK_ERROR(vmaCreateBuffer(context->allocator, &create_info, &vma_alloc_create_info, &buffer, &alloc, &alloc_info));
-    if (desc.memory == rhiMem::auto_host)
+    if (desc.memory == rhiMem::auto_host || desc.memory == rhiMem::auto_readback)
     {
         mapped = alloc_info.pMappedData;
     }
@@ -54,6 +59,11 @@ void vkBuffer::flush(const u64 offset, const u64 bytes)
     VK_CHECK_ERROR(vmaFlushAllocation(allocator, alloc, offset, bytes));
 }
 
+void vkBuffer::invalidate(const u64 offset, const u64 bytes)
+{
+    VK_CHECK_ERROR(vmaInvalidateAllocation(allocator, alloc, offset, bytes));
+}
+
 void vkBuffer::unmap()
 {
     if (!mapped)
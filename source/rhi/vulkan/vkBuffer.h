@@ -11,6 +11,7 @@ public:
 	virtual ~vkBuffer();
 	virtual void* map() final override;
 	virtual void flush(const u64 offset, const u64 bytes) final override;
+	virtual void invalidate(const u64 offset, const u64 bytes) final override;
 	virtual void  unmap() final override;
 	virtual void* native() final override { return reinterpret_cast<void*>(buffer); }
 	virtual u64 size() const final override;
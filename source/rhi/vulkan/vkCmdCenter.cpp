@@ -5,6 +5,7 @@
 #include "vkSurface.h"
 #include "vkQueue.h"
 #include "vkSwapchain.h"
+#include "vkHeadlessSwapchain.h"
 
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL debug_callback
@@ -28,6 +29,8 @@ vkCmdCenter::vkCmdCenter()
 
 vkCmdCenter::~vkCmdCenter()
 {
+    // offscreen images are device allocations, release them while the device lives
+    headless_swapchain.reset();
     clear();
 	if (instance != VK_NULL_HANDLE)
 	{
@@ -58,6 +61,22 @@ bool vkCmdCenter::initialize(std::string_view application_name, GLFWwindow* wind
     return ret;
 }
 
+bool vkCmdCenter::initialize_headless(std::string_view application_name, const rhiHeadlessDesc& desc)
+{
+    bool ret = rhiCmdCenter::initialize_headless(application_name, desc);
+    headless = true;
+    volk_init();
+    create_instance(application_name);
+    if (!create_physical_device())
+        return false;
+    if (!create_logical_device())
+        return false;
+    if (!create_headless_swapchain(desc))
+        return false;
+
+    return ret;
+}
+
 void vkCmdCenter::volk_init()
 {
     VK_CHECK_ERROR(volkInitialize());
@@ -135,10 +154,13 @@ void vkCmdCenter::create_instance(std::string_view application_name)
 
 std::vector<const char*> vkCmdCenter::get_required_extensions()
 {
-    u32 glfw_extension_count = 0;
-    const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
-
-    std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+    std::vector<const char*> extensions;
+    if (!headless)
+    {
+        u32 glfw_extension_count = 0;
+        const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+    }
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
     return extensions;
@@ -228,8 +250,12 @@ vkQueueFamilyIndices vkCmdCenter::find_queue_families(VkPhysicalDevice device)
         if (queue_families[i].queueFlags & VK_QUEUE_TRANSFER_BIT)
             indices.families[static_cast<u32>(vkQueueFamilyIndices::queue_family_type::transfer)] = i;
 
+        // headless frames never reach a present engine, the graphics queue stands in
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface->get_surface(), &presentSupport);
+        if (headless)
+            presentSupport = (queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface->get_surface(), &presentSupport);
         if (presentSupport) 
             indices.families[static_cast<u32>(vkQueueFamilyIndices::queue_family_type::present)] = i;
 
@@ -288,13 +314,14 @@ bool vkCmdCenter::create_logical_device()
     }
 
     std::vector<const char*> device_extension_names = { 
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_EXT_MESH_SHADER_EXTENSION_NAME,
 #if ENABLE_AFTERMATH 
         VK_NV_DEVICE_DIAGNOSTICS_CONFIG_EXTENSION_NAME,
         VK_NV_DEVICE_DIAGNOSTIC_CHECKPOINTS_EXTENSION_NAME,
 #endif
     };
+    if (!headless)
+        device_extension_names.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     VkPhysicalDeviceFeatures device_features{};
     VkDeviceCreateInfo device_create_info
     {
@@ -336,6 +363,7 @@ bool vkCmdCenter::create_logical_device()
     vkGetPhysicalDeviceFeatures2(vk_context->phys_device, &device_features2);
     v13.dynamicRendering = VK_TRUE;
     v13.synchronization2 = VK_TRUE;
+    v12.timelineSemaphore = VK_TRUE;
     v12.descriptorIndexing = VK_TRUE;
     v12.runtimeDescriptorArray = VK_TRUE;
     v12.descriptorBindingPartiallyBound = VK_TRUE;
@@ -374,7 +402,9 @@ bool vkCmdCenter::create_logical_device()
 
     volkLoadDevice(vk_context->device);
     vk_context->create_imageview_cache();
+    vk_context->create_onetime_submitter();
     vk_context->create_vma_allocator(instance);
+    vk_context->create_pipeline_cache();
     std::unordered_map<rhiQueueType, u32> queue_family;
     for (auto type : enum_range_to_sentinel<vkQueueFamilyIndices::queue_family_type, vkQueueFamilyIndices::queue_family_type::count>())
     {
@@ -418,15 +448,38 @@ bool vkCmdCenter::create_swapchain(const u32 width, const u32 height)
         .present_family = present_queue_findex,
         .present_queue = reinterpret_cast<VkQueue>(present_queue->handle()),
         .width = width,
-        .height = height
+        .height = height,
+        .present_mode = pacing.present_mode,
+        // one image on screen while every frame in flight owns another
+        .min_image_count = pacing.frames_in_flight + 1
     };
     swapchain = std::make_unique<vkSwapchain>(std::move(desc));
-    init_frame_context();
+    init_frame_context(swapchain.get());
+    return true;
+}
+
+bool vkCmdCenter::create_headless_swapchain(const rhiHeadlessDesc& desc)
+{
+    ASSERT(headless_swapchain == nullptr);
+
+    auto vk_device_context = std::static_pointer_cast<vkDeviceContext>(device_context);
+    ASSERT(vk_device_context);
+
+    auto gfx_queue = vk_device_context->get_queue(rhiQueueType::graphics);
+    headless_swapchain = std::make_unique<vkHeadlessSwapchain>(vkHeadlessSwapchainCreateDesc{
+        .context = vk_device_context.get(),
+        .queue = reinterpret_cast<VkQueue>(gfx_queue->handle()),
+        .width = desc.width,
+        .height = desc.height,
+        .image_count = desc.image_count,
+        .format = desc.format
+        });
+    init_frame_context(headless_swapchain.get());
     return true;
 }
 
-void vkCmdCenter::init_frame_context()
+void vkCmdCenter::init_frame_context(rhiSwapChain* chain)
 {
-    frame_context->swapchain = swapchain.get();
-    frame_context->update_inflight(device_context.get(), swapchain->get_swapchain_image_count());
+    frame_context->swapchain = chain;
+    frame_context->update_inflight(device_context.get(), pacing.frames_in_flight);
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 struct GLFWwindow;
 class vkSurface;
 class vkSwapchain;
+class vkHeadlessSwapchain;
+class rhiSwapChain;
 class vkQueue;
 
 struct vkQueueFamilyIndices
@@ -40,6 +42,7 @@ public:
 
 public:
 	bool initialize(std::string_view application_name, GLFWwindow* window, const u32 width, const u32 height) final override;
+	bool initialize_headless(std::string_view application_name, const rhiHeadlessDesc& desc) final override;
 
 private:
 	void volk_init();
@@ -55,8 +58,9 @@ private:
 
 	bool create_logical_device();
 	bool create_swapchain(const u32 width, const u32 height);
+	bool create_headless_swapchain(const rhiHeadlessDesc& desc);
 
-	void init_frame_context();
+	void init_frame_context(rhiSwapChain* chain);
 
 private:
 	VkInstance instance = VK_NULL_HANDLE;
@@ -64,4 +68,8 @@ private:
 	vkQueueFamilyIndices queue_family_indices;
 	std::unique_ptr<vkSurface> surface;
 	std::unique_ptr<vkSwapchain> swapchain;
+
+	// headless: no surface extensions, present family aliases graphics
+	bool headless = false;
+	std::unique_ptr<vkHeadlessSwapchain> headless_swapchain;
 };
@@ -10,6 +10,71 @@
 #include "rhi/rhiBuffer.h"
 #include "rhi/rhiSynchroize.h"
 #include "vkBuffer.h"
+#include "vkQuery.h"
+
+namespace
+{
+    std::vector<VkBufferImageCopy> vk_buffer_image_copies(std::span<const rhiBufferImageCopy> regions)
+    {
+        std::vector<VkBufferImageCopy> vk_regions;
+        vk_regions.reserve(regions.size());
+        for (const auto& r : regions)
+        {
+            VkBufferImageCopy c{
+                .bufferOffset = r.buffer_offset,
+                .bufferRowLength = r.buffer_rowlength,
+                .bufferImageHeight = r.buffer_imageheight,
+                .imageSubresource = VkImageSubresourceLayers{
+                    .aspectMask = vk_aspect(r.imageSubresource.aspect),
+                    .mipLevel = r.imageSubresource.mip_level,
+                    .baseArrayLayer = r.imageSubresource.base_array_layer,
+                    .layerCount = r.imageSubresource.layer_count
+                },
+                .imageOffset = { r.image_offset.x, r.image_offset.y, r.image_offset.z },
+                .imageExtent = { r.image_extent.x, r.image_extent.y, r.image_extent.z }
+            };
+            vk_regions.push_back(c);
+        }
+        return vk_regions;
+    }
+
+    constexpr VkAccessFlags2 write_access_mask = VK_ACCESS_2_SHADER_WRITE_BIT
+        | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+        | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+        | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+        | VK_ACCESS_2_TRANSFER_WRITE_BIT
+        | VK_ACCESS_2_HOST_WRITE_BIT
+        | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    bool has_write(const VkAccessFlags2 access)
+    {
+        return (access & write_access_mask) != 0;
+    }
+
+    bool ranges_overlap(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b)
+    {
+        return a.baseMipLevel < b.baseMipLevel + b.levelCount && b.baseMipLevel < a.baseMipLevel + a.levelCount
+            && a.baseArrayLayer < b.baseArrayLayer + b.layerCount && b.baseArrayLayer < a.baseArrayLayer + a.layerCount;
+    }
+
+    bool same_range(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b)
+    {
+        return a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount
+            && a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount;
+    }
+
+    bool ranges_overlap(const VkBufferMemoryBarrier2& a, const VkBufferMemoryBarrier2& b)
+    {
+        const VkDeviceSize a_end = a.size == VK_WHOLE_SIZE ? ~0ull : a.offset + a.size;
+        const VkDeviceSize b_end = b.size == VK_WHOLE_SIZE ? ~0ull : b.offset + b.size;
+        return a.offset < b_end && b.offset < a_end;
+    }
+
+    bool is_ownership_transfer(const u32 src_queue, const u32 dst_queue)
+    {
+        return src_queue != dst_queue;
+    }
+}
 
 vkCommandList::vkCommandList(vkDeviceContext* context, VkCommandPool pool, VkCommandBuffer cmd_buffer, bool is_transient)
     : device(context->device),
@@ -21,7 +86,9 @@ vkCommandList::vkCommandList(vkDeviceContext* context, VkCommandPool pool, VkCom
 
 vkCommandList::~vkCommandList()
 {
-    vkDestroyCommandPool(device, cmd_pool, nullptr);
+    // one-time pools go back to the submitter for reuse
+    if (!is_transient)
+        vkDestroyCommandPool(device, cmd_pool, nullptr);
 }
 
 void vkCommandList::allocate()
@@ -46,11 +113,14 @@ void vkCommandList::begin(u32 flags)
 		begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 	VK_CHECK_ERROR(vkBeginCommandBuffer(cmd_buffer, &begin_info));
+    clear_tracking();
 }
 
 void vkCommandList::end()
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    // the last transitions (present, shader read) have no command after them
+    flush_barriers();
 	VK_CHECK_ERROR(vkEndCommandBuffer(cmd_buffer));
 }
 
@@ -58,9 +128,175 @@ void vkCommandList::reset()
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
 	VK_CHECK_ERROR(vkResetCommandBuffer(cmd_buffer, 0));
+    clear_tracking();
+}
+
+void vkCommandList::clear_tracking()
+{
+    pending_images.clear();
+    pending_buffers.clear();
+    tracked_images.clear();
 }
 
-void vkCommandList::begin_render_pass(const rhiRenderingInfo& info)
+void vkCommandList::flush_barriers()
+{
+    if (pending_images.empty() && pending_buffers.empty())
+        return;
+
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    const VkDependencyInfo dependency{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = static_cast<u32>(pending_buffers.size()),
+        .pBufferMemoryBarriers = pending_buffers.empty() ? nullptr : pending_buffers.data(),
+        .imageMemoryBarrierCount = static_cast<u32>(pending_images.size()),
+        .pImageMemoryBarriers = pending_images.empty() ? nullptr : pending_images.data()
+    };
+    vkCmdPipelineBarrier2(cmd_buffer, &dependency);
+
+    pending_images.clear();
+    pending_buffers.clear();
+}
+
+vkCommandList::trackedImage& vkCommandList::get_tracked(VkImage image, const VkImageSubresourceRange& range, const u32 mips, const u32 layers)
+{
+    auto& t = tracked_images[image];
+    const u32 need_mips = std::max({ t.mips, mips, range.baseMipLevel + range.levelCount });
+    const u32 need_layers = std::max({ t.layers, layers, range.baseArrayLayer + range.layerCount });
+    if (need_mips != t.mips || need_layers != t.layers)
+    {
+        std::vector<subresourceState> states(need_mips * need_layers);
+        for (u32 m = 0; m < t.mips; ++m)
+        {
+            for (u32 l = 0; l < t.layers; ++l)
+                states[m * need_layers + l] = t.states[m * t.layers + l];
+        }
+        t.mips = need_mips;
+        t.layers = need_layers;
+        t.states = std::move(states);
+    }
+    return t;
+}
+
+void vkCommandList::queue_image_barrier(VkImageMemoryBarrier2 barrier, const u32 mips, const u32 layers)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    const auto& range = barrier.subresourceRange;
+    const bool ownership = is_ownership_transfer(barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex);
+    auto& tracked = get_tracked(barrier.image, range, mips, layers);
+
+    auto for_each_state = [&](auto&& fn) {
+        for (u32 m = range.baseMipLevel; m < range.baseMipLevel + range.levelCount; ++m)
+        {
+            for (u32 l = range.baseArrayLayer; l < range.baseArrayLayer + range.layerCount; ++l)
+                fn(tracked.states[m * tracked.layers + l]);
+        }
+    };
+    auto track = [&](const VkImageMemoryBarrier2& b) {
+        for_each_state([&](subresourceState& s) {
+            s = subresourceState{
+                .layout = b.newLayout,
+                .stage = b.dstStageMask,
+                .access = b.dstAccessMask,
+                .known = !ownership
+            };
+        });
+    };
+
+    // nothing was recorded since the pending barrier, so both collapse into one transition
+    for (auto it = pending_images.begin(); it != pending_images.end(); ++it)
+    {
+        if (it->image != barrier.image || !ranges_overlap(it->subresourceRange, range))
+            continue;
+
+        if (ownership || is_ownership_transfer(it->srcQueueFamilyIndex, it->dstQueueFamilyIndex) || !same_range(it->subresourceRange, range))
+        {
+            flush_barriers();
+            break;
+        }
+
+        if (barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+            barrier.oldLayout = it->oldLayout;
+        barrier.srcStageMask = it->srcStageMask;
+        barrier.srcAccessMask = it->srcAccessMask;
+        pending_images.erase(it);
+
+        track(barrier);
+        if (barrier.oldLayout != barrier.newLayout || has_write(barrier.srcAccessMask | barrier.dstAccessMask))
+            pending_images.push_back(barrier);
+        return;
+    }
+
+    if (!ownership)
+    {
+        // read to read in the same layout has no hazard
+        if (barrier.oldLayout == barrier.newLayout && !has_write(barrier.srcAccessMask | barrier.dstAccessMask))
+            return;
+
+        bool all_known = true;
+        bool already_there = true;
+        std::optional<VkImageLayout> current;
+        for_each_state([&](const subresourceState& s) {
+            all_known &= s.known;
+            if (!s.known)
+                return;
+            if (!current)
+                current = s.layout;
+            else if (*current != s.layout)
+                current = VK_IMAGE_LAYOUT_MAX_ENUM;
+            already_there &= s.layout == barrier.newLayout
+                && !has_write(s.access)
+                && (barrier.dstStageMask & ~s.stage) == 0
+                && (barrier.dstAccessMask & ~s.access) == 0;
+        });
+
+        // the last barrier already made these subresources visible to the same readers,
+        // unless the caller declares a write (e.g. a storage/attachment write) the tracker never saw
+        if (all_known && already_there && !has_write(barrier.srcAccessMask))
+            return;
+
+        // callers that guess the old layout get the one this recording actually left
+        if (all_known && current && *current != VK_IMAGE_LAYOUT_MAX_ENUM
+            && barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED && barrier.oldLayout != *current)
+        {
+            barrier.oldLayout = *current;
+        }
+    }
+
+    track(barrier);
+    pending_images.push_back(barrier);
+}
+
+void vkCommandList::queue_buffer_barrier(const VkBufferMemoryBarrier2& barrier)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    const bool ownership = is_ownership_transfer(barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex);
+
+    for (auto it = pending_buffers.begin(); it != pending_buffers.end(); ++it)
+    {
+        if (it->buffer != barrier.buffer || !ranges_overlap(*it, barrier))
+            continue;
+
+        if (ownership || is_ownership_transfer(it->srcQueueFamilyIndex, it->dstQueueFamilyIndex)
+            || it->offset != barrier.offset || it->size != barrier.size)
+        {
+            flush_barriers();
+            break;
+        }
+
+        it->dstStageMask = barrier.dstStageMask;
+        it->dstAccessMask = barrier.dstAccessMask;
+        if (!has_write(it->srcAccessMask | it->dstAccessMask))
+            pending_buffers.erase(it);
+        return;
+    }
+
+    if (!ownership && !has_write(barrier.srcAccessMask | barrier.dstAccessMask))
+        return;
+
+    pending_buffers.push_back(barrier);
+}
+
+void vkCommandList::begin_render_pass(const rhiRenderingInfo& info, const bool secondary_contents)
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
     VkDebugUtilsLabelEXT label{
@@ -118,6 +354,7 @@ void vkCommandList::begin_render_pass(const rhiRenderingInfo& info)
 
     const VkRenderingInfo render_info{
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .flags = secondary_contents ? VkRenderingFlags(VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT) : VkRenderingFlags(0),
         .renderArea = VkRect2D{
             .offset = VkOffset2D{
                 .x = static_cast<i32>(info.render_area.x),
@@ -134,6 +371,7 @@ void vkCommandList::begin_render_pass(const rhiRenderingInfo& info)
         .pDepthAttachment = info.depth_attachment.has_value() ? &depth_attachment_info : nullptr,
         .pStencilAttachment = info.stencil_attachment.has_value() ? &stencil_attachment_info : nullptr
     };
+    flush_barriers();
     vkCmdBeginRendering(cmd_buffer, &render_info);
 }
 
@@ -175,6 +413,7 @@ void vkCommandList::copy_buffer(rhiBuffer* src, const u32 src_offset, rhiBuffer*
         .dstOffset = dst_offset,
         .size = bytes
     };
+    flush_barriers();
     vkCmdCopyBuffer(cmd_buffer, vk_src, vk_dst, 1, &copy);
 }
 
@@ -184,29 +423,44 @@ void vkCommandList::copy_buffer_to_image(rhiBuffer* src_buf, rhiTexture* dst_tex
     auto vk_src = static_cast<vkBuffer*>(src_buf);
     auto vk_dst = static_cast<vkTexture*>(dst_tex);
 
-    std::vector<VkBufferImageCopy> vk_regions;
-    vk_regions.reserve(regions.size());
-    for (const auto& r : regions) 
-    {
-        VkBufferImageCopy c{
-            .bufferOffset = r.buffer_offset,
-            .bufferRowLength = r.buffer_rowlength,
-            .bufferImageHeight = r.buffer_imageheight,
-            .imageSubresource = VkImageSubresourceLayers{
-                .aspectMask = vk_aspect(r.imageSubresource.aspect),
-                .mipLevel = r.imageSubresource.mip_level,
-                .baseArrayLayer = r.imageSubresource.base_array_layer,
-                .layerCount = r.imageSubresource.layer_count
-            },
-            .imageOffset = { r.image_offset.x, r.image_offset.y, r.image_offset.z },
-            .imageExtent = { r.image_extent.x, r.image_extent.y, r.image_extent.z }
-        };
-        vk_regions.push_back(c);
-    }
+    const auto vk_regions = vk_buffer_image_copies(regions);
+    flush_barriers();
+    vkCmdCopyBufferToImage(cmd_buffer, vk_src->handle(), vk_dst->get_image(), vk_layout(layout), static_cast<u32>(vk_regions.size()), vk_regions.data());
+}
 
+void vkCommandList::copy_buffer_to_image(rhiBuffer* src_buf, rhiTextureCubeMap* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    auto vk_src = static_cast<vkBuffer*>(src_buf);
+    auto vk_dst = static_cast<vkTextureCubemap*>(dst_tex);
+
+    const auto vk_regions = vk_buffer_image_copies(regions);
+    flush_barriers();
     vkCmdCopyBufferToImage(cmd_buffer, vk_src->handle(), vk_dst->get_image(), vk_layout(layout), static_cast<u32>(vk_regions.size()), vk_regions.data());
 }
 
+void vkCommandList::copy_image_to_buffer(rhiTexture* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    auto vk_src = static_cast<vkTexture*>(src_tex);
+    auto vk_dst = static_cast<vkBuffer*>(dst_buf);
+
+    const auto vk_regions = vk_buffer_image_copies(regions);
+    flush_barriers();
+    vkCmdCopyImageToBuffer(cmd_buffer, vk_src->get_image(), vk_layout(layout), vk_dst->handle(), static_cast<u32>(vk_regions.size()), vk_regions.data());
+}
+
+void vkCommandList::copy_image_to_buffer(rhiTextureCubeMap* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    auto vk_src = static_cast<vkTextureCubemap*>(src_tex);
+    auto vk_dst = static_cast<vkBuffer*>(dst_buf);
+
+    const auto vk_regions = vk_buffer_image_copies(regions);
+    flush_barriers();
+    vkCmdCopyImageToBuffer(cmd_buffer, vk_src->get_image(), vk_layout(layout), vk_dst->handle(), static_cast<u32>(vk_regions.size()), vk_regions.data());
+}
+
 void vkCommandList::generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc)
 {
     auto vk_tex = static_cast<vkTexture*>(tex);
@@ -269,6 +523,7 @@ void vkCommandList::generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc)
                 }
             };
 
+            flush_barriers();
             vkCmdBlitImage(cmd_buffer, img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
 
             image_barrier(tex, rhiImageLayout::transfer_dst, rhiImageLayout::transfer_src, dst_mip, 1, arr, 1);
@@ -315,12 +570,41 @@ void vkCommandList::image_barrier(rhiTexture* tex, const rhiImageBarrierDescript
        }
     };
 
-    const VkDependencyInfo dependency{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
+    queue_image_barrier(barrier, tex->desc.mips, tex->desc.layers);
+}
+
+void vkCommandList::image_barrier(rhiTextureCubeMap* tex, const rhiImageBarrierDescription& desc)
+{
+    auto vk_tex = static_cast<vkTextureCubemap*>(tex);
+
+    u32 level_count = desc.level_count;
+    u32 layer_count = desc.layer_count;
+    if (level_count == 0)
+        level_count = tex->desc.mips;
+    if (layer_count == 0)
+        layer_count = tex->desc.layers;
+
+    const VkImageMemoryBarrier2 barrier{
+       .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+       .srcStageMask = vk_pipeline_stage2(desc.src_stage),
+       .srcAccessMask = vk_access_flags2(desc.src_access),
+       .dstStageMask = vk_pipeline_stage2(desc.dst_stage),
+       .dstAccessMask = vk_access_flags2(desc.dst_access),
+       .oldLayout = vk_layout(desc.old_layout),
+       .newLayout = vk_layout(desc.new_layout),
+       .srcQueueFamilyIndex = desc.src_queue == desc.dst_queue ? VK_QUEUE_FAMILY_IGNORED : desc.src_queue,
+       .dstQueueFamilyIndex = desc.src_queue == desc.dst_queue ? VK_QUEUE_FAMILY_IGNORED : desc.dst_queue,
+       .image = vk_tex->get_image(),
+       .subresourceRange = {
+           .aspectMask = vk_aspect_from_format(vk_tex->desc.format),
+           .baseMipLevel = desc.base_mip,
+           .levelCount = level_count,
+           .baseArrayLayer = desc.base_layer,
+           .layerCount = layer_count
+       }
     };
-    vkCmdPipelineBarrier2(cmd_buffer, &dependency);
+
+    queue_image_barrier(barrier, tex->desc.mips, tex->desc.layers);
 }
 
 void vkCommandList::image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip, u32 level_count, u32 base_layer, u32 layer_count, bool is_same_stage)
@@ -360,12 +644,7 @@ void vkCommandList::image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rh
         }
     };
 
-    const VkDependencyInfo dependency{ 
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
-    };
-    vkCmdPipelineBarrier2(cmd_buffer, &dependency);
+    queue_image_barrier(barrier, tex->desc.mips, tex->desc.layers);
 }
 
 void vkCommandList::image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip, u32 level_count, u32 base_layer, u32 layer_count, bool is_same_stage)
@@ -405,12 +684,7 @@ void vkCommandList::image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_lay
         }
     };
 
-    const VkDependencyInfo dependency{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
-    };
-    vkCmdPipelineBarrier2(cmd_buffer, &dependency);
+    queue_image_barrier(barrier, tex->desc.mips, tex->desc.layers);
 }
 
 void vkCommandList::buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescription& desc)
@@ -434,12 +708,7 @@ void vkCommandList::buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescrip
         .size = static_cast<VkDeviceSize>(desc.size),
     };
 
-    const VkDependencyInfo dependency{
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &barrier
-    };
-    vkCmdPipelineBarrier2(cmd_buffer, &dependency);
+    queue_buffer_barrier(barrier);
 }
 
 void vkCommandList::bind_pipeline(rhiPipeline* p)
@@ -501,6 +770,7 @@ void vkCommandList::draw_indexed_indirect(rhiBuffer* indirect_buffer, const u32
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
     VkBuffer buf = reinterpret_cast<VkBuffer>(indirect_buffer->native());
+    flush_barriers();
     vkCmdDrawIndexedIndirect(cmd_buffer, buf, VkDeviceSize(offset), draw_count, stride);
 }
 
@@ -508,17 +778,79 @@ void vkCommandList::draw_mesh_tasks_indirect(rhiBuffer* indirect_buffer, const u
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
     VkBuffer buf = reinterpret_cast<VkBuffer>(indirect_buffer->native());
+    flush_barriers();
     vkCmdDrawMeshTasksIndirectEXT(cmd_buffer, buf, VkDeviceSize(offset), draw_count, stride);
 }
 
 void vkCommandList::draw_fullscreen()
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    flush_barriers();
     vkCmdDraw(cmd_buffer, 3, 1, 0, 0);
 }
 
 void vkCommandList::dispatch(const u32 x, const u32 y, const u32 z)
 {
     ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    flush_barriers();
     vkCmdDispatch(cmd_buffer, x, y, z);
 }
+
+void vkCommandList::reset_timestamps(rhiTimestampPool* pool, const u32 first, const u32 count)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    vkCmdResetQueryPool(cmd_buffer, static_cast<vkTimestampPool*>(pool)->handle(), first, count);
+}
+
+void vkCommandList::write_timestamp(rhiTimestampPool* pool, const u32 index, rhiPipelineStage stage)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    vkCmdWriteTimestamp2(cmd_buffer, vk_pipeline_stage2(stage), static_cast<vkTimestampPool*>(pool)->handle(), index);
+}
+
+void vkCommandList::begin_secondary(const rhiRenderingInfo& info)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    std::vector<VkFormat> color_formats;
+    color_formats.reserve(info.color_attachments.size());
+    for (u32 index = 0; index < info.color_attachments.size(); ++index)
+        color_formats.push_back(index < info.color_formats.size() ? vk_format(info.color_formats[index]) : VK_FORMAT_UNDEFINED);
+
+    // must describe exactly what the primary's vkCmdBeginRendering attached
+    const VkFormat depth_format = info.depth_attachment.has_value() && info.depth_format.has_value() ? vk_format(info.depth_format.value()) : VK_FORMAT_UNDEFINED;
+    const VkFormat stencil_format = info.stencil_attachment.has_value() && info.depth_format.has_value() ? vk_format(info.depth_format.value()) : VK_FORMAT_UNDEFINED;
+    const VkCommandBufferInheritanceRenderingInfo rendering_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .colorAttachmentCount = static_cast<u32>(color_formats.size()),
+        .pColorAttachmentFormats = color_formats.empty() ? nullptr : color_formats.data(),
+        .depthAttachmentFormat = depth_format,
+        .stencilAttachmentFormat = stencil_format,
+        .rasterizationSamples = vk_sample(info.samples)
+    };
+    const VkCommandBufferInheritanceInfo inheritance{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &rendering_info
+    };
+    const VkCommandBufferBeginInfo begin_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance
+    };
+    VK_CHECK_ERROR(vkBeginCommandBuffer(cmd_buffer, &begin_info));
+    clear_tracking();
+}
+
+void vkCommandList::execute_secondaries(std::span<rhiCommandList* const> secondaries)
+{
+    ASSERT(cmd_buffer != VK_NULL_HANDLE);
+    if (secondaries.empty())
+        return;
+
+    std::vector<VkCommandBuffer> buffers;
+    buffers.reserve(secondaries.size());
+    for (rhiCommandList* s : secondaries)
+        buffers.push_back(static_cast<vkCommandList*>(s)->get_cmd_buffer());
+
+    flush_barriers();
+    vkCmdExecuteCommands(cmd_buffer, static_cast<u32>(buffers.size()), buffers.data());
+}
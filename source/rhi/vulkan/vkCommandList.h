@@ -16,15 +16,19 @@ public:
     void begin(u32 flags = 0) override;
     void end() override;
     void reset() override;
-    void begin_render_pass(const rhiRenderingInfo& info) override;
+    void begin_render_pass(const rhiRenderingInfo& info, const bool secondary_contents = false) override;
     void end_render_pass() override;
     void set_viewport_scissor(const vec2 vp_size) override;
 
     void copy_buffer(rhiBuffer* src, const u32 src_offset, rhiBuffer* dst, const u32 dst_offset, const u64 bytes) override;
     void copy_buffer_to_image(rhiBuffer* src_buf, rhiTexture* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) override;
+    void copy_buffer_to_image(rhiBuffer* src_buf, rhiTextureCubeMap* dst_tex, rhiImageLayout layout, std::span<const rhiBufferImageCopy> regions) override;
+    void copy_image_to_buffer(rhiTexture* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) override;
+    void copy_image_to_buffer(rhiTextureCubeMap* src_tex, rhiImageLayout layout, rhiBuffer* dst_buf, std::span<const rhiBufferImageCopy> regions) override;
     void image_barrier(rhiTexture* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) override;
     void image_barrier(rhiTextureCubeMap* tex, rhiImageLayout old_layout, rhiImageLayout new_layout, u32 base_mip = 0, u32 level_count = 1, u32 base_layer = 0, u32 layer_count = 1, bool is_same_stage = false) override;
     void image_barrier(rhiTexture* tex, const rhiImageBarrierDescription& desc) override;
+    void image_barrier(rhiTextureCubeMap* tex, const rhiImageBarrierDescription& desc) override;
     void buffer_barrier(rhiBuffer* buf, const rhiBufferBarrierDescription& desc) override;
 
     void generate_mips(rhiTexture* tex, const rhiGenMipsDesc& desc) override;
@@ -43,13 +47,41 @@ public:
 
     void dispatch(const u32 x, const u32 y, const u32 z) override;
 
+    void reset_timestamps(rhiTimestampPool* pool, const u32 first, const u32 count) override;
+    void write_timestamp(rhiTimestampPool* pool, const u32 index, rhiPipelineStage stage = rhiPipelineStage::bottom_of_pipe) override;
+
+    void begin_secondary(const rhiRenderingInfo& info) override;
+    void execute_secondaries(std::span<rhiCommandList* const> secondaries) override;
+
     VkCommandBuffer get_cmd_buffer() const { return cmd_buffer; }
     VkCommandPool get_cmd_pool() const { return cmd_pool; }
     bool is_transient_() const { return is_transient; }
 
+    // records every queued barrier as one vkCmdPipelineBarrier2
+    void flush_barriers();
+
 private:
+    struct subresourceState
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 access = VK_ACCESS_2_NONE;
+        bool known = false;
+    };
+    struct trackedImage
+    {
+        u32 mips = 0;
+        u32 layers = 0;
+        // mip * layers + layer
+        std::vector<subresourceState> states;
+    };
+
     void allocate();
     void generate_mips_compute(rhiTexture* tex, const rhiGenMipsDesc& desc);
+    void queue_image_barrier(VkImageMemoryBarrier2 barrier, const u32 mips, const u32 layers);
+    void queue_buffer_barrier(const VkBufferMemoryBarrier2& barrier);
+    trackedImage& get_tracked(VkImage image, const VkImageSubresourceRange& range, const u32 mips, const u32 layers);
+    void clear_tracking();
 
 private:
     VkDevice device = VK_NULL_HANDLE;
@@ -58,4 +90,10 @@ private:
     VkCommandBuffer cmd_buffer;
     VkCommandPool cmd_pool;
     bool is_transient = false;
+
+    // barriers wait here until the next draw, dispatch, copy or render pass
+    std::vector<VkImageMemoryBarrier2> pending_images;
+    std::vector<VkBufferMemoryBarrier2> pending_buffers;
+    // layout and access each subresource was left in by this recording
+    std::unordered_map<VkImage, trackedImage> tracked_images;
 };
\ No newline at end of file
@@ -382,6 +382,8 @@ inline VkPipelineStageFlags2 vk_pipeline_stage2(rhiPipelineStage stage)
         vk_flags |= VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
     if (has_<rhiPipelineStage>(stage, rhiPipelineStage::mesh_shader))
         vk_flags |= VK_PIPELINE_STAGE_2_MESH_SHADER_BIT_EXT;
+    if (has_<rhiPipelineStage>(stage, rhiPipelineStage::host))
+        vk_flags |= VK_PIPELINE_STAGE_2_HOST_BIT;
 
     return vk_flags;    
 }
@@ -2,10 +2,13 @@
 #include "vkCommon.h"
 #include "vkQueue.h"
 #include "vkTexture.h"
+#include "vkMemory.h"
 #include "vkTextureCubemap.h"
 #include "vkBuffer.h"
 #include "vkSampler.h"
 #include "vkSynchronize.h"
+#include "util/cpuProfiler.h"
+#include "vkQuery.h"
 #include "vkDescriptor.h"
 #include "vkPipeline.h"
 #include "vkCommandList.h"
@@ -53,58 +56,79 @@ namespace
         return { .native = keep_alive->layout };
     }
 
-    static VkShaderModule vk_create_shader(VkDevice dev, const rhiShaderBinary& bin) 
+    // map entries point straight into the rhi constants, no packing copy
+    struct vkSpecialization
     {
-        const VkShaderModuleCreateInfo create_info
+        std::vector<VkSpecializationMapEntry> entries;
+        VkSpecializationInfo info{};
+
+        const VkSpecializationInfo* get() const { return entries.empty() ? nullptr : &info; }
+    };
+
+    void vk_specialization(const std::vector<rhiSpecializationConstant>& constants, vkSpecialization& out)
+    {
+        out.entries.reserve(constants.size());
+        for (u32 index = 0; index < constants.size(); ++index)
         {
-            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .codeSize = bin.size,
-            .pCode = reinterpret_cast<const uint32_t*>(bin.data)
+            out.entries.push_back(VkSpecializationMapEntry{
+                .constantID = constants[index].id,
+                .offset = static_cast<u32>(index * sizeof(rhiSpecializationConstant) + offsetof(rhiSpecializationConstant, value)),
+                .size = sizeof(u32)
+                });
+        }
+        out.info = VkSpecializationInfo{
+            .mapEntryCount = static_cast<u32>(out.entries.size()),
+            .pMapEntries = out.entries.data(),
+            .dataSize = constants.size() * sizeof(rhiSpecializationConstant),
+            .pData = constants.data()
         };
-        VkShaderModule m = VK_NULL_HANDLE;
-        VK_CHECK_ERROR(vkCreateShaderModule(dev, &create_info, nullptr, &m));
-        return m;
     }
 
-    std::unique_ptr<rhiPipeline> vk_create_graphics_pipeline(VkDevice device, const rhiGraphicsPipelineDesc& desc, const rhiPipelineLayout& layout)
+    std::unique_ptr<rhiPipeline> vk_create_graphics_pipeline(VkDevice device, VkPipelineCache cache, vkShaderModuleCache& modules, const rhiGraphicsPipelineDesc& desc, const rhiPipelineLayout& layout)
     {
         auto p = std::make_unique<vkPipeline>(device, desc, rhiPipelineType::graphics);
 
+        vkSpecialization spec;
+        vk_specialization(desc.specialization, spec);
+
         std::vector<VkPipelineShaderStageCreateInfo> stages;
         // vs
         VkShaderModule vs = VK_NULL_HANDLE, fs = VK_NULL_HANDLE, ms = VK_NULL_HANDLE;
         if (desc.vs.has_value())
         {
-            vs = vk_create_shader(device, desc.vs.value());
+            vs = modules.acquire(device, desc.vs.value());
             stages.push_back(VkPipelineShaderStageCreateInfo{
                     .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                     .stage = VK_SHADER_STAGE_VERTEX_BIT,
                     .module = vs,
-                    .pName = desc.vs.value().entry.length() > 0 ? desc.vs.value().entry.c_str() : "main"
+                    .pName = desc.vs.value().entry.length() > 0 ? desc.vs.value().entry.c_str() : "main",
+                    .pSpecializationInfo = spec.get()
                 });
         }
 
         // ms
         if (desc.ms.has_value())
         {
-            ms = vk_create_shader(device, desc.ms.value());
+            ms = modules.acquire(device, desc.ms.value());
             stages.push_back(VkPipelineShaderStageCreateInfo{
                     .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                     .stage = VK_SHADER_STAGE_MESH_BIT_EXT,
                     .module = ms,
-                    .pName = desc.ms.value().entry.length() > 0 ? desc.ms.value().entry.c_str() : "main"
+                    .pName = desc.ms.value().entry.length() > 0 ? desc.ms.value().entry.c_str() : "main",
+                    .pSpecializationInfo = spec.get()
                 });
         }
 
         // ps
         if (desc.fs.has_value())
         {
-            fs = vk_create_shader(device, desc.fs.value());
+            fs = modules.acquire(device, desc.fs.value());
             stages.push_back(VkPipelineShaderStageCreateInfo{
                     .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                     .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
                     .module = fs,
-                    .pName = desc.fs.value().entry.length() > 0 ? desc.fs.value().entry.c_str() : "main"
+                    .pName = desc.fs.value().entry.length() > 0 ? desc.fs.value().entry.c_str() : "main",
+                    .pSpecializationInfo = spec.get()
                 });
         }
 
@@ -245,25 +269,30 @@ namespace
         };
         // renderPass=nullptr, subpass=0  (Dynamic Rendering)
 
-        VK_CHECK_ERROR(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_create_info, nullptr, &p->handle));
-        if(vs != VK_NULL_HANDLE)
-            vkDestroyShaderModule(device, vs, nullptr);
-        if(fs != VK_NULL_HANDLE)
-            vkDestroyShaderModule(device, fs, nullptr);
+        VK_CHECK_ERROR(vkCreateGraphicsPipelines(device, cache, 1, &pipeline_create_info, nullptr, &p->handle));
+        if (desc.vs.has_value())
+            modules.release(device, desc.vs.value(), vs);
+        if (desc.ms.has_value())
+            modules.release(device, desc.ms.value(), ms);
+        if (desc.fs.has_value())
+            modules.release(device, desc.fs.value(), fs);
 
         return p;
     }
 
-    std::unique_ptr<rhiPipeline> vk_create_compute_pipeline(VkDevice device, const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout)
+    std::unique_ptr<rhiPipeline> vk_create_compute_pipeline(VkDevice device, VkPipelineCache cache, vkShaderModuleCache& modules, const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout)
     {
         auto p = std::make_unique<vkPipeline>(device, desc, rhiPipelineType::compute);
-        VkShaderModule cs = vk_create_shader(device, desc.cs);
+        VkShaderModule cs = modules.acquire(device, desc.cs);
+        vkSpecialization spec;
+        vk_specialization(desc.specialization, spec);
 
         const VkPipelineShaderStageCreateInfo pipeline_stage_ci{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_COMPUTE_BIT,
             .module = cs,
             .pName = desc.cs.entry.length() > 0 ? desc.cs.entry.c_str() : "main",
+            .pSpecializationInfo = spec.get()
         };
         const VkComputePipelineCreateInfo compute_ci{
             .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
@@ -271,21 +300,95 @@ namespace
             .layout = reinterpret_cast<VkPipelineLayout>(layout.native)
         };
 
-        VK_CHECK_ERROR(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &compute_ci, nullptr, &p->handle));
-        vkDestroyShaderModule(device, cs, nullptr);
+        VK_CHECK_ERROR(vkCreateComputePipelines(device, cache, 1, &compute_ci, nullptr, &p->handle));
+        modules.release(device, desc.cs, cs);
         return p;
     }
+
+    // our own prefix in front of the driver blob, the driver header alone does not carry the driver version
+    struct pipelineCacheHeader
+    {
+        u32 magic;
+        u32 vendor_id;
+        u32 device_id;
+        u32 driver_version;
+        u8 uuid[VK_UUID_SIZE];
+        u64 data_bytes;
+    };
+    constexpr u32 pipeline_cache_magic = 0x4C505043; // 'CPPL'
+    const std::filesystem::path pipeline_cache_path = "cache/pipeline.cache";
+
+    f64 elapsed_ms(const std::chrono::steady_clock::time_point begin)
+    {
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // returns the driver blob when the file was written by this exact device and driver
+    std::vector<u8> load_pipeline_cache_blob(const VkPhysicalDeviceProperties& props)
+    {
+        std::ifstream f(pipeline_cache_path, std::ios::binary);
+        if (!f)
+            return {};
+
+        pipelineCacheHeader header{};
+        if (!f.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return {};
+        if (header.magic != pipeline_cache_magic
+            || header.vendor_id != props.vendorID
+            || header.device_id != props.deviceID
+            || header.driver_version != props.driverVersion
+            || std::memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            std::cout << "[vkDeviceContext] pipeline cache rejected : device or driver changed\n";
+            return {};
+        }
+
+        // the size comes from disk, never allocate more than the file actually holds
+        const auto data_begin = f.tellg();
+        f.seekg(0, std::ios::end);
+        const auto data_end = f.tellg();
+        if (data_begin < 0 || data_end < data_begin || header.data_bytes == 0
+            || header.data_bytes != static_cast<u64>(data_end - data_begin))
+        {
+            std::cout << "[vkDeviceContext] pipeline cache rejected : truncated or corrupt\n";
+            return {};
+        }
+        f.seekg(data_begin);
+
+        std::vector<u8> blob(header.data_bytes);
+        if (!f.read(reinterpret_cast<char*>(blob.data()), blob.size()))
+            return {};
+        return blob;
+    }
 }
 
 vkDeviceContext::~vkDeviceContext()
 {
+    // waits for in-flight uploads before their pools and staging go away
+    onetime_submitter.reset();
     imageview_cache->clear();
     imageview_cache.reset();
+    shader_modules.clear(device);
+    if (pipeline_cache != VK_NULL_HANDLE)
+    {
+        save_pipeline_cache();
+        vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+    }
     if (device != VK_NULL_HANDLE)
         vkDestroyDevice(device, nullptr);
 }
 
 std::unique_ptr<rhiCommandList> vkDeviceContext::create_commandlist(u32 queue_family)
+{
+    return create_commandlist(queue_family, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+}
+
+std::unique_ptr<rhiCommandList> vkDeviceContext::create_secondary_commandlist(u32 queue_family)
+{
+    return create_commandlist(queue_family, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+}
+
+std::unique_ptr<rhiCommandList> vkDeviceContext::create_commandlist(u32 queue_family, VkCommandBufferLevel level)
 {
     VkCommandPoolCreateInfo create_info
     {
@@ -300,7 +403,7 @@ std::unique_ptr<rhiCommandList> vkDeviceContext::create_commandlist(u32 queue_fa
     {
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .commandPool = pool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .level = level,
         .commandBufferCount = 1
     };
     VkCommandBuffer buffer;
@@ -326,21 +429,31 @@ std::unique_ptr<rhiTextureBindlessTable> vkDeviceContext::create_bindless_table(
 
 std::unique_ptr<rhiBuffer> vkDeviceContext::create_buffer(const rhiBufferDesc& desc)
 {
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
     return std::make_unique<vkBuffer>(this, desc);
 }
 
 std::unique_ptr<rhiTexture> vkDeviceContext::create_texture(const rhiTextureDesc& desc)
 {
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
     return std::make_unique<vkTexture>(this, desc);
 }
 
 std::unique_ptr<rhiTexture> vkDeviceContext::create_texture_from_path(std::string_view path, bool is_hdr, bool srgb)
 {
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
     return std::make_unique<vkTexture>(this, path, is_hdr, srgb);
 }
 
+std::unique_ptr<rhiTexture> vkDeviceContext::create_texture_from_image(rhiTextureImage&& image)
+{
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
+    return std::make_unique<vkTexture>(this, std::move(image));
+}
+
 std::shared_ptr<rhiTextureCubeMap> vkDeviceContext::create_texture_cubemap(const rhiTextureDesc& desc)
 {
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
     return std::make_unique<vkTextureCubemap>(this, desc);
 }
 
@@ -349,9 +462,9 @@ std::unique_ptr<rhiSampler> vkDeviceContext::create_sampler(const rhiSamplerDesc
     return std::make_unique<vkSampler>(this, desc);
 }
 
-std::unique_ptr<rhiSemaphore> vkDeviceContext::create_semaphore()
+std::unique_ptr<rhiSemaphore> vkDeviceContext::create_semaphore(const bool timeline)
 {
-    return std::make_unique<vkSemaphore>(device);
+    return std::make_unique<vkSemaphore>(device, timeline);
 }
 
 std::unique_ptr<rhiFence> vkDeviceContext::create_fence(bool signaled)
@@ -359,6 +472,11 @@ std::unique_ptr<rhiFence> vkDeviceContext::create_fence(bool signaled)
     return std::make_unique<vkFence>(device, signaled);
 }
 
+std::unique_ptr<rhiTimestampPool> vkDeviceContext::create_timestamp_pool(const u32 count)
+{
+    return std::make_unique<vkTimestampPool>(this, count);
+}
+
 rhiDescriptorSetLayout vkDeviceContext::create_descriptor_set_layout(const std::vector<rhiDescriptorSetLayoutBinding>& bindings, u32 set_index)
 {
     std::vector<VkDescriptorSetLayoutBinding> vk_bindings;
@@ -427,6 +545,7 @@ rhiDescriptorPool vkDeviceContext::create_descriptor_pool(const rhiDescriptorPoo
 
 std::vector<rhiDescriptorSet> vkDeviceContext::allocate_descriptor_sets(rhiDescriptorPool pool, const std::vector<rhiDescriptorSetLayout>& layouts)
 {
+    CPU_ZONE("vk::allocate_descriptor_sets");
     auto vk_pool = reinterpret_cast<VkDescriptorPool>(pool.native);
     if (!vk_pool)
     {
@@ -465,6 +584,7 @@ std::vector<rhiDescriptorSet> vkDeviceContext::allocate_descriptor_sets(rhiDescr
             .native = sets[index],
             .set_index = layouts[index].set_index
         });
+        descriptor_cache.forget(result.back());
     }
     return result;
 }
@@ -516,15 +636,30 @@ std::vector<rhiDescriptorSet> vkDeviceContext::allocate_descriptor_indexing_sets
                 .native = sets[index],
                 .set_index = layouts[index].set_index
             });
+        descriptor_cache.forget(result.back());
     }
     return result;
 }
 
 void vkDeviceContext::update_descriptors(const std::vector<rhiWriteDescriptor>& writes)
 {
+    CPU_ZONE("vk::update_descriptors");
+    // passes rewrite their sets every frame, in steady state nothing reaches the driver
+    std::vector<const rhiWriteDescriptor*> dirty;
+    dirty.reserve(writes.size());
+    for (const auto& w : writes)
+    {
+        if (descriptor_cache.changed(w))
+            dirty.push_back(&w);
+    }
+    if (dirty.empty())
+        return;
+    descriptor_cache.count_update();
+
     u32 total_img = 0, total_buf = 0;
-    for (const auto& w : writes) 
+    for (const rhiWriteDescriptor* w_ptr : dirty)
     {
+        const rhiWriteDescriptor& w = *w_ptr;
         const u32 n = std::max<u32>(1, w.count);
         switch (w.type) 
         {
@@ -548,10 +683,11 @@ void vkDeviceContext::update_descriptors(const std::vector<rhiWriteDescriptor>&
     std::vector<VkDescriptorBufferInfo> buf_infos;
     buf_infos.reserve(total_buf);
     std::vector<VkWriteDescriptorSet> vk_writes;
-    vk_writes.reserve(writes.size());
+    vk_writes.reserve(dirty.size());
 
-    for (const auto& write : writes)
+    for (const rhiWriteDescriptor* write_ptr : dirty)
     {
+        const rhiWriteDescriptor& write = *write_ptr;
         VkWriteDescriptorSet write_set
         {
             .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
@@ -655,79 +791,78 @@ rhiPipelineLayout vkDeviceContext::create_pipeline_layout(std::vector<rhiDescrip
 
 std::unique_ptr<rhiPipeline> vkDeviceContext::create_graphics_pipeline(const rhiGraphicsPipelineDesc& desc, const rhiPipelineLayout& layout)
 {
-    return vk_create_graphics_pipeline(device, desc, layout);
+    CPU_ZONE("vk::create_graphics_pipeline");
+    const auto begin = std::chrono::steady_clock::now();
+    auto p = vk_create_graphics_pipeline(device, pipeline_cache, shader_modules, desc, layout);
+    pipeline_ms += elapsed_ms(begin);
+    ++pipeline_count;
+    return p;
 }
 
 std::unique_ptr<rhiPipeline> vkDeviceContext::create_compute_pipeline(const rhiComputePipelineDesc& desc, const rhiPipelineLayout& layout)
 {
-    return vk_create_compute_pipeline(device, desc, layout);
+    CPU_ZONE("vk::create_compute_pipeline");
+    const auto begin = std::chrono::steady_clock::now();
+    auto p = vk_create_compute_pipeline(device, pipeline_cache, shader_modules, desc, layout);
+    pipeline_ms += elapsed_ms(begin);
+    ++pipeline_count;
+    return p;
 }
 
 std::shared_ptr<rhiCommandList> vkDeviceContext::begin_onetime_commands(rhiQueueType t)
 {
+    CPU_ZONE("vk::begin_onetime_commands");
     ASSERT(queue.contains(t));
-    
-    const VkCommandPoolCreateInfo create_info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-        .queueFamilyIndex = queue[t]->q_index()
-    };
-    VkCommandPool cmd_pool;
-    VK_CHECK_ERROR(vkCreateCommandPool(device, &create_info, nullptr, &cmd_pool));
-
-    const VkCommandBufferAllocateInfo alloc_info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .commandPool = cmd_pool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
-    VkCommandBuffer cmd;
-    VK_CHECK_ERROR(vkAllocateCommandBuffers(device, &alloc_info, &cmd));
-
-    const VkCommandBufferBeginInfo begin_info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
-    };
-    VK_CHECK_ERROR(vkBeginCommandBuffer(cmd, &begin_info));
+    ASSERT(onetime_submitter);
 
+    const auto [cmd_pool, cmd] = onetime_submitter->acquire(t, queue[t]->q_index());
     return std::make_shared<vkCommandList>(this, cmd_pool, cmd, true);
 }
 
 void vkDeviceContext::submit_and_wait(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t)
 {
+    CPU_ZONE("vk::submit_and_wait");
+    wait(submit_async(std::move(cmd), t));
+}
+
+rhiSubmitTicket vkDeviceContext::submit_async(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t, std::vector<std::unique_ptr<rhiBuffer>> keep_alive)
+{
+    CPU_ZONE("vk::submit_async");
     ASSERT(queue.contains(t));
 
     auto vk_cmdlst = std::dynamic_pointer_cast<vkCommandList>(cmd);
     ASSERT(vk_cmdlst);
-    auto vk_cmd = vk_cmdlst->get_cmd_buffer();
-    ASSERT(vk_cmd != VK_NULL_HANDLE);
-    VK_CHECK_ERROR(vkEndCommandBuffer(vk_cmd));
-
-    const VkFenceCreateInfo fence_ci{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-    VkFence submit_fence;
-    VK_CHECK_ERROR(vkCreateFence(device, &fence_ci, nullptr, &submit_fence));
-
-    const VkSubmitInfo submit_info{
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &vk_cmd
-    };
+    vk_cmdlst->end();
+
     auto q = reinterpret_cast<VkQueue>(queue[t]->handle());
     ASSERT(q != VK_NULL_HANDLE);
-    VK_CHECK_ERROR(vkQueueSubmit(q, 1, &submit_info, submit_fence));
-    VK_CHECK_ERROR(vkWaitForFences(device, 1, &submit_fence, VK_TRUE, UINT64_MAX));
-    vkDestroyFence(device, submit_fence, nullptr);
+    return onetime_submitter->submit(vk_cmdlst.get(), t, q, std::move(keep_alive));
+}
 
-    if (vk_cmdlst->is_transient_())
-    {
-        vkFreeCommandBuffers(device, vk_cmdlst->get_cmd_pool(), 1, &vk_cmd);
-        vk_cmdlst.reset();
-    }
+bool vkDeviceContext::is_complete(const rhiSubmitTicket& ticket)
+{
+    return onetime_submitter->is_complete(ticket);
+}
+
+void vkDeviceContext::wait(const rhiSubmitTicket& ticket)
+{
+    onetime_submitter->wait(ticket);
+}
+
+void vkDeviceContext::collect_submits()
+{
+    CPU_ZONE("vk::collect_submits");
+    onetime_submitter->collect();
+}
+
+rhiSemaphore* vkDeviceContext::get_submit_timeline(rhiQueueType t)
+{
+    return onetime_submitter->get_semaphore(t);
 }
 
 void vkDeviceContext::submit(rhiQueueType type, const rhiSubmitInfo& info)
 {
+    CPU_ZONE("vk::submit");
     ASSERT(queue.contains(type));
 
     std::vector<VkSemaphoreSubmitInfo> wait_semaphores;
@@ -788,11 +923,13 @@ void vkDeviceContext::submit(rhiQueueType type, const rhiSubmitInfo& info)
         vk_fence = static_cast<vkFence*>(info.fence)->handle();
 
     VkQueue q = reinterpret_cast<VkQueue>(queue[type]->handle());
+    std::scoped_lock lock(queue_mutex);
     VK_CHECK_ERROR(vkQueueSubmit2(q, 1, &submit_info, vk_fence));
 }
 
 void vkDeviceContext::wait(rhiFence* f)
 {
+    CPU_ZONE("vk::wait_fence");
     auto vk_f = static_cast<vkFence*>(f);
     ASSERT(vk_f);
     VkFence vk_fence = vk_f->handle();
@@ -807,11 +944,93 @@ void vkDeviceContext::reset(rhiFence* f)
     vkResetFences(device, 1, &vk_fence);
 }
 
+void vkDeviceContext::wait(rhiSemaphore* timeline, const u64 value)
+{
+    CPU_ZONE("vk::wait_timeline");
+    auto vk_s = static_cast<vkSemaphore*>(timeline);
+    ASSERT(vk_s);
+    VkSemaphore semaphore = vk_s->handle();
+    const VkSemaphoreWaitInfo wait_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &semaphore,
+        .pValues = &value
+    };
+    VK_CHECK_ERROR(vkWaitSemaphores(device, &wait_info, UINT64_MAX));
+}
+
+u64 vkDeviceContext::get_completed_value(rhiSemaphore* timeline)
+{
+    auto vk_s = static_cast<vkSemaphore*>(timeline);
+    ASSERT(vk_s);
+    u64 value = 0;
+    VK_CHECK_ERROR(vkGetSemaphoreCounterValue(device, vk_s->handle(), &value));
+    return value;
+}
+
+rhiMemoryStats vkDeviceContext::get_memory_stats() const
+{
+    rhiMemoryStats stats{ .allocations_made = allocations_made.load(std::memory_order_relaxed) };
+    if (allocator == VK_NULL_HANDLE)
+        return stats;
+
+    VmaTotalStatistics total{};
+    vmaCalculateStatistics(allocator, &total);
+    stats.allocation_count = total.total.statistics.allocationCount;
+    stats.allocation_bytes = total.total.statistics.allocationBytes;
+    stats.block_count = total.total.statistics.blockCount;
+    stats.block_bytes = total.total.statistics.blockBytes;
+    return stats;
+}
+
+rhiMemoryRequirements vkDeviceContext::get_memory_requirements(const rhiTextureDesc& desc) const
+{
+    const VkImageCreateInfo image_create_info = vkTexture::create_info(desc);
+    const VkDeviceImageMemoryRequirements query{
+        .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+        .pCreateInfo = &image_create_info
+    };
+    VkMemoryRequirements2 requirements{ .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+    vkGetDeviceImageMemoryRequirements(device, &query, &requirements);
+    return rhiMemoryRequirements{
+        .size = requirements.memoryRequirements.size,
+        .alignment = requirements.memoryRequirements.alignment,
+        .type_bits = requirements.memoryRequirements.memoryTypeBits
+    };
+}
+
+std::unique_ptr<rhiMemoryHeap> vkDeviceContext::create_memory_heap(const rhiMemoryRequirements& requirements)
+{
+    const VkMemoryRequirements memory_requirements{
+        .size = requirements.size,
+        .alignment = requirements.alignment,
+        .memoryTypeBits = requirements.type_bits
+    };
+    const VmaAllocationCreateInfo vma_create_info{
+        .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    };
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    VK_CHECK_ERROR(vmaAllocateMemory(allocator, &memory_requirements, &vma_create_info, &allocation, nullptr));
+    allocations_made.fetch_add(1, std::memory_order_relaxed);
+    return std::make_unique<vkMemoryHeap>(allocator, allocation, requirements.size);
+}
+
+std::unique_ptr<rhiTexture> vkDeviceContext::create_placed_texture(const rhiTextureDesc& desc, rhiMemoryHeap* heap, const u64 offset)
+{
+    ASSERT(heap && offset + get_memory_requirements(desc).size <= heap->size);
+    return std::make_unique<vkTexture>(this, desc, static_cast<vkMemoryHeap*>(heap)->allocation, offset);
+}
+
 void vkDeviceContext::create_imageview_cache()
 {
     imageview_cache = std::make_shared<vkImageViewCache>(device);
 }
 
+void vkDeviceContext::create_onetime_submitter()
+{
+    onetime_submitter = std::make_unique<vkOnetimeSubmitter>(device, queue_mutex);
+}
+
 void vkDeviceContext::create_vma_allocator(VkInstance instance)
 {
     VmaVulkanFunctions vma_funcs{};
@@ -827,6 +1046,53 @@ void vkDeviceContext::create_vma_allocator(VkInstance instance)
     VK_CHECK_ERROR(vmaCreateAllocator(&vma_alloc_crate_info, &allocator));
 }
 
+void vkDeviceContext::create_pipeline_cache()
+{
+    CPU_ZONE("vk::create_pipeline_cache");
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(phys_device, &props);
+    const std::vector<u8> blob = load_pipeline_cache_blob(props);
+
+    const VkPipelineCacheCreateInfo create_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = blob.size(),
+        .pInitialData = blob.empty() ? nullptr : blob.data()
+    };
+    // the driver validates its own header again and silently starts empty on mismatch
+    VK_CHECK_ERROR(vkCreatePipelineCache(device, &create_info, nullptr, &pipeline_cache));
+    pipeline_cache_warm = !blob.empty();
+}
+
+void vkDeviceContext::save_pipeline_cache()
+{
+    CPU_ZONE("vk::save_pipeline_cache");
+    std::cout << std::format("[vkDeviceContext] pipeline cache {} : {} pipelines created in {:.2f} ms\n",
+        pipeline_cache_warm ? "warm" : "cold", pipeline_count.load(), pipeline_ms.load());
+
+    // called from the destructor, a failed save only costs a cold start next run
+    size_t bytes = 0;
+    if (vkGetPipelineCacheData(device, pipeline_cache, &bytes, nullptr) != VK_SUCCESS || bytes == 0)
+        return;
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(phys_device, &props);
+    pipelineCacheHeader header{
+        .magic = pipeline_cache_magic,
+        .vendor_id = props.vendorID,
+        .device_id = props.deviceID,
+        .driver_version = props.driverVersion,
+        .data_bytes = bytes
+    };
+    std::memcpy(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
+
+    std::vector<u8> file(sizeof(header) + bytes);
+    if (vkGetPipelineCacheData(device, pipeline_cache, &bytes, file.data() + sizeof(header)) != VK_SUCCESS)
+        return;
+    header.data_bytes = bytes;
+    std::memcpy(file.data(), &header, sizeof(header));
+    save_binary(pipeline_cache_path, file.data(), static_cast<u32>(sizeof(header) + bytes));
+}
+
 void vkDeviceContext::create_queue(const std::unordered_map<rhiQueueType, u32>& queue_families)
 {
     for (const auto& [key, value] : queue_families)
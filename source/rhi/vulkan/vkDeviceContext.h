@@ -3,7 +3,11 @@
 #include "pch.h"
 #include "rhi/rhiDeviceContext.h"
 #include "vkCmdCenter.h"
+#include "vkPipeline.h"
 #include "vk_mem_alloc.h"
+#include "vkOnetimeSubmitter.h"
+#include <atomic>
+#include <mutex>
 
 class rhiBuffer;
 class rhiCommandList;
@@ -18,6 +22,7 @@ class vkImageViewCache;
 class rhiSampler;
 class rhiSemaphore;
 class rhiFence;
+class rhiTimestampPool;
 class rhiTextureBindlessTable;
 
 class vkDeviceContext final : public rhiDeviceContext
@@ -26,14 +31,17 @@ public:
 	virtual ~vkDeviceContext();
 
 	std::unique_ptr<rhiCommandList> create_commandlist(u32 queue_family) override;
+	std::unique_ptr<rhiCommandList> create_secondary_commandlist(u32 queue_family) override;
 	std::unique_ptr<rhiTextureBindlessTable> create_bindless_table(const rhiTextureBindlessDesc& desc, const u32 set_index = 0) override;
 	std::unique_ptr<rhiBuffer> create_buffer(const rhiBufferDesc& desc) override;
 	std::unique_ptr<rhiTexture> create_texture(const rhiTextureDesc& desc) override;
 	std::unique_ptr<rhiTexture> create_texture_from_path(std::string_view path, bool is_hdr = false, bool srgb = true) override;
+	std::unique_ptr<rhiTexture> create_texture_from_image(rhiTextureImage&& image) override;
 	std::shared_ptr<rhiTextureCubeMap> create_texture_cubemap(const rhiTextureDesc& desc) override;
 	std::unique_ptr<rhiSampler> create_sampler(const rhiSamplerDesc& desc) override;
-	std::unique_ptr<rhiSemaphore> create_semaphore() override;
+	std::unique_ptr<rhiSemaphore> create_semaphore(const bool timeline = false) override;
 	std::unique_ptr<rhiFence> create_fence(bool signaled) override;
+	std::unique_ptr<rhiTimestampPool> create_timestamp_pool(const u32 count) override;
 
 	rhiDescriptorSetLayout create_descriptor_set_layout(const std::vector<rhiDescriptorSetLayoutBinding>& bindings, u32 set_index = 0);
 	rhiDescriptorPool create_descriptor_pool(const rhiDescriptorPoolCreateInfo& create_info, u32 max_sets);
@@ -48,16 +56,32 @@ public:
 	
 	std::shared_ptr<rhiCommandList> begin_onetime_commands(rhiQueueType t = rhiQueueType::graphics) override;
 	void submit_and_wait(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics) override;
+	rhiSubmitTicket submit_async(std::shared_ptr<rhiCommandList> cmd, rhiQueueType t = rhiQueueType::graphics, std::vector<std::unique_ptr<rhiBuffer>> keep_alive = {}) override;
+	bool is_complete(const rhiSubmitTicket& ticket) override;
+	void wait(const rhiSubmitTicket& ticket) override;
+	void collect_submits() override;
+	rhiSemaphore* get_submit_timeline(rhiQueueType t) override;
 	void submit(rhiQueueType type, const rhiSubmitInfo& info) override;
 	void wait(class rhiFence* f) override;
 	void reset(class rhiFence* f) override;
+	void wait(rhiSemaphore* timeline, const u64 value) override;
+	u64 get_completed_value(rhiSemaphore* timeline) override;
+
+	rhiMemoryStats get_memory_stats() const override;
+	rhiMemoryRequirements get_memory_requirements(const rhiTextureDesc& desc) const override;
+	std::unique_ptr<rhiMemoryHeap> create_memory_heap(const rhiMemoryRequirements& requirements) override;
+	std::unique_ptr<rhiTexture> create_placed_texture(const rhiTextureDesc& desc, rhiMemoryHeap* heap, const u64 offset) override;
 
 	bool verify_device() const;
+	std::unique_ptr<rhiCommandList> create_commandlist(u32 queue_family, VkCommandBufferLevel level);
 	bool verify_phys_device() const;
 
 	void create_imageview_cache();
 	void create_vma_allocator(VkInstance instance);
+	void create_pipeline_cache();
+	void save_pipeline_cache();
 	void create_queue(const std::unordered_map<rhiQueueType, u32>& queue_families);
+	void create_onetime_submitter();
 	std::weak_ptr<vkImageViewCache> get_imageview_cache() const { return imageview_cache; }
 
 public:
@@ -70,5 +94,20 @@ private:
 	std::vector<std::shared_ptr<vkDescriptorPoolHolder>> kept_pools;
 	std::vector<std::shared_ptr<vkPipelineLayoutHolder>> kept_pipeline_layouts;
 	std::shared_ptr<vkImageViewCache> imageview_cache;
+
+	vkShaderModuleCache shader_modules;
+
+	// vkQueueSubmit needs the queue externally synchronized, one-time submits may come from loader threads
+	std::mutex queue_mutex;
+	std::unique_ptr<vkOnetimeSubmitter> onetime_submitter;
+
+	// driver pipeline cache, persisted across runs
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	bool pipeline_cache_warm = false;
+	// pipelines may be created from compile workers
+	std::atomic<u32> pipeline_count = 0;
+	std::atomic<f64> pipeline_ms = 0.0;
+	// buffers and textures may be created from loader threads
+	std::atomic<u64> allocations_made = 0;
 };
 
@@ -0,0 +1,80 @@
+#include "vkHeadlessSwapchain.h"
+#include "vkDeviceContext.h"
+#include "vkCommon.h"
+#include "vkSynchronize.h"
+#include "rhi/rhiTextureView.h"
+#include "util/cpuProfiler.h"
+
+vkHeadlessSwapchain::vkHeadlessSwapchain(vkHeadlessSwapchainCreateDesc&& desc)
+	: rhiSwapChain(desc.width, desc.height), desc(desc)
+{
+	ASSERT(desc.image_count > 0);
+	image_count = desc.image_count;
+	// nothing is shown, no vblank to wait for
+	present_mode = rhiPresentMode::immediate;
+
+	textures.reserve(image_count);
+	rt_views.reserve(image_count);
+	for (u32 i = 0; i < image_count; ++i)
+	{
+		textures.push_back(desc.context->create_texture(rhiTextureDesc{
+			.width = desc.width,
+			.height = desc.height,
+			.layers = 1,
+			.mips = 1,
+			.format = desc.format,
+			.usage = rhiTextureUsage::color_attachment | rhiTextureUsage::transfer_src | rhiTextureUsage::sampled
+			}));
+
+		rt_views.push_back(rhiRenderTargetView{
+			.texture = textures[i].get(),
+			.mip = 0,
+			.base_layer = 0,
+			.layer_count = 1,
+			.layout = rhiImageLayout::color_attachment
+			});
+	}
+}
+
+vkHeadlessSwapchain::~vkHeadlessSwapchain()
+{
+	rt_views.clear();
+	textures.clear();
+}
+
+rhiResult vkHeadlessSwapchain::acquire_next_image(u32* outIndex, rhiSemaphore* signal)
+{
+	CPU_ZONE("vk::acquire_next_image");
+	// images are rendered in order on the graphics queue, reuse needs no extra wait
+	*outIndex = next_image;
+	next_image = (next_image + 1) % image_count;
+	submit_semaphore(signal, true);
+	return rhiResult::ok;
+}
+
+rhiResult vkHeadlessSwapchain::present(u32 imageIndex, rhiSemaphore* wait)
+{
+	CPU_ZONE("vk::present");
+	submit_semaphore(wait, false);
+	return rhiResult::ok;
+}
+
+void vkHeadlessSwapchain::submit_semaphore(rhiSemaphore* semaphore, const bool signal)
+{
+	if (!semaphore)
+		return;
+
+	const VkSemaphoreSubmitInfo semaphore_info{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore = static_cast<vkSemaphore*>(semaphore)->handle(),
+		.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+	};
+	const VkSubmitInfo2 submit_info{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		.waitSemaphoreInfoCount = signal ? 0u : 1u,
+		.pWaitSemaphoreInfos = signal ? nullptr : &semaphore_info,
+		.signalSemaphoreInfoCount = signal ? 1u : 0u,
+		.pSignalSemaphoreInfos = signal ? &semaphore_info : nullptr
+	};
+	VK_CHECK_ERROR(vkQueueSubmit2(desc.queue, 1, &submit_info, VK_NULL_HANDLE));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "pch.h"
+#include "rhi/rhiSwapChain.h"
+
+class vkDeviceContext;
+class rhiTexture;
+struct vkHeadlessSwapchainCreateDesc
+{
+	vkDeviceContext* context;
+	VkQueue queue = VK_NULL_HANDLE;
+
+	u32 width = 0;
+	u32 height = 0;
+	u32 image_count = 3;
+	rhiFormat format = rhiFormat::RGBA8_UNORM;
+};
+
+// offscreen image ring standing in for a swapchain, no surface or present engine involved.
+// acquire and present are empty queue submits so the frame semaphores keep their signal/wait pairing.
+class vkHeadlessSwapchain : public rhiSwapChain
+{
+public:
+	explicit vkHeadlessSwapchain(vkHeadlessSwapchainCreateDesc&& desc);
+	~vkHeadlessSwapchain();
+
+public:
+	rhiResult acquire_next_image(u32* outIndex, class rhiSemaphore* signal) override;
+	rhiResult present(u32 imageIndex, class rhiSemaphore* wait) override;
+
+	rhiFormat format() const override { return desc.format; }
+	const std::vector<rhiRenderTargetView>& views() const override { return rt_views; }
+	// left ready for readback
+	rhiImageLayout present_layout() const override { return rhiImageLayout::transfer_src; }
+
+private:
+	void submit_semaphore(rhiSemaphore* semaphore, const bool signal);
+
+private:
+	vkHeadlessSwapchainCreateDesc desc;
+	u32 next_image = 0;
+
+	std::vector<std::unique_ptr<rhiTexture>> textures;
+	std::vector<rhiRenderTargetView> rt_views;
+};
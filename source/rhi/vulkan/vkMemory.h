@@ -2,8 +2,21 @@
 
 #include "pch.h"
 
+#include "rhi/rhiDeviceContext.h"
+
 class vkMemory
 {
 public:
 	static u32 get_memory_type(VkPhysicalDevice phys_device, u32 memory_type_bits, VkMemoryPropertyFlags flags);
+};
+
+class vkMemoryHeap final : public rhiMemoryHeap
+{
+public:
+	vkMemoryHeap(VmaAllocator allocator, VmaAllocation allocation, const u64 size) : rhiMemoryHeap(size), allocator(allocator), allocation(allocation) {}
+	~vkMemoryHeap() override { vmaFreeMemory(allocator, allocation); }
+
+public:
+	VmaAllocator allocator;
+	VmaAllocation allocation;
 };
\ No newline at end of file
@@ -0,0 +1,184 @@
+﻿#include "vkOnetimeSubmitter.h"
+#include "vkCommon.h"
+#include "vkCommandList.h"
+#include "rhi/rhiBuffer.h"
+#include "util/cpuProfiler.h"
+
+vkOnetimeSubmitter::vkOnetimeSubmitter(VkDevice device, std::mutex& queue_mutex)
+    : device(device), queue_mutex(queue_mutex)
+{
+}
+
+vkOnetimeSubmitter::~vkOnetimeSubmitter()
+{
+    wait_idle();
+    std::scoped_lock lock(mutex);
+    for (auto& [type, timeline] : timelines)
+    {
+        retire(timeline);
+        ASSERT(timeline.in_flight.empty());
+        for (const auto& c : timeline.free)
+            vkDestroyCommandPool(device, c.pool, nullptr);
+    }
+    timelines.clear();
+}
+
+std::pair<VkCommandPool, VkCommandBuffer> vkOnetimeSubmitter::acquire(const rhiQueueType type, const u32 family)
+{
+    std::scoped_lock lock(mutex);
+    auto& timeline = get_timeline(type);
+    retire(timeline);
+
+    pooledCommands c;
+    if (!timeline.free.empty())
+    {
+        c = timeline.free.back();
+        timeline.free.pop_back();
+        VK_CHECK_ERROR(vkResetCommandPool(device, c.pool, 0));
+    }
+    else
+    {
+        const VkCommandPoolCreateInfo create_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = family
+        };
+        VK_CHECK_ERROR(vkCreateCommandPool(device, &create_info, nullptr, &c.pool));
+
+        const VkCommandBufferAllocateInfo alloc_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = c.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VK_CHECK_ERROR(vkAllocateCommandBuffers(device, &alloc_info, &c.cmd));
+    }
+
+    const VkCommandBufferBeginInfo begin_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+    VK_CHECK_ERROR(vkBeginCommandBuffer(c.cmd, &begin_info));
+    return { c.pool, c.cmd };
+}
+
+rhiSubmitTicket vkOnetimeSubmitter::submit(vkCommandList* cmd, const rhiQueueType type, VkQueue queue, std::vector<std::unique_ptr<rhiBuffer>>&& keep_alive)
+{
+    CPU_ZONE("vkOnetimeSubmitter::submit");
+    ASSERT(cmd && cmd->is_transient_());
+
+    std::scoped_lock lock(mutex);
+    auto& timeline = get_timeline(type);
+    const u64 value = ++timeline.submitted;
+
+    const VkCommandBufferSubmitInfo cmd_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = cmd->get_cmd_buffer()
+    };
+    const VkSemaphoreSubmitInfo signal{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = timeline.semaphore->handle(),
+        .value = value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+    };
+    const VkSubmitInfo2 submit_info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &cmd_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos = &signal
+    };
+    {
+        std::scoped_lock queue_lock(queue_mutex);
+        VK_CHECK_ERROR(vkQueueSubmit2(queue, 1, &submit_info, VK_NULL_HANDLE));
+    }
+
+    timeline.in_flight.push_back(inFlight{
+        .commands = { cmd->get_cmd_pool(), cmd->get_cmd_buffer() },
+        .value = value,
+        .keep_alive = std::move(keep_alive)
+    });
+    return rhiSubmitTicket{ .queue = type, .value = value };
+}
+
+bool vkOnetimeSubmitter::is_complete(const rhiSubmitTicket& ticket)
+{
+    if (!ticket.valid())
+        return true;
+
+    std::scoped_lock lock(mutex);
+    auto& timeline = get_timeline(ticket.queue);
+    retire(timeline);
+    return timeline.completed >= ticket.value;
+}
+
+void vkOnetimeSubmitter::wait(const rhiSubmitTicket& ticket)
+{
+    CPU_ZONE("vkOnetimeSubmitter::wait");
+    if (!ticket.valid())
+        return;
+
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    {
+        std::scoped_lock lock(mutex);
+        semaphore = get_timeline(ticket.queue).semaphore->handle();
+    }
+    // other threads keep submitting while this one blocks
+    const VkSemaphoreWaitInfo wait_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &semaphore,
+        .pValues = &ticket.value
+    };
+    VK_CHECK_ERROR(vkWaitSemaphores(device, &wait_info, UINT64_MAX));
+
+    std::scoped_lock lock(mutex);
+    retire(get_timeline(ticket.queue));
+}
+
+void vkOnetimeSubmitter::wait_idle()
+{
+    std::vector<rhiSubmitTicket> last;
+    {
+        std::scoped_lock lock(mutex);
+        for (const auto& [type, timeline] : timelines)
+            last.push_back(rhiSubmitTicket{ .queue = type, .value = timeline.submitted });
+    }
+    for (const auto& ticket : last)
+        wait(ticket);
+}
+
+void vkOnetimeSubmitter::collect()
+{
+    std::scoped_lock lock(mutex);
+    for (auto& [type, timeline] : timelines)
+        retire(timeline);
+}
+
+rhiSemaphore* vkOnetimeSubmitter::get_semaphore(const rhiQueueType type)
+{
+    std::scoped_lock lock(mutex);
+    return get_timeline(type).semaphore.get();
+}
+
+vkOnetimeSubmitter::queueTimeline& vkOnetimeSubmitter::get_timeline(const rhiQueueType type)
+{
+    auto [it, inserted] = timelines.try_emplace(type);
+    if (inserted)
+        it->second.semaphore = std::make_unique<vkSemaphore>(device, true);
+    return it->second;
+}
+
+void vkOnetimeSubmitter::retire(queueTimeline& timeline)
+{
+    if (timeline.in_flight.empty())
+        return;
+
+    VK_CHECK_ERROR(vkGetSemaphoreCounterValue(device, timeline.semaphore->handle(), &timeline.completed));
+    // a queue retires its submits in order
+    while (!timeline.in_flight.empty() && timeline.in_flight.front().value <= timeline.completed)
+    {
+        timeline.free.push_back(timeline.in_flight.front().commands);
+        timeline.in_flight.pop_front();
+    }
+}
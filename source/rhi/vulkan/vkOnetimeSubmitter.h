@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiSubmitInfo.h"
+#include "vkSynchronize.h"
+#include <mutex>
+#include <deque>
+
+class rhiBuffer;
+class rhiCommandList;
+class vkCommandList;
+
+// one-time command buffers for uploads, mip generation and precompute.
+// command pools are recycled once their submit retired, every queue signals its own timeline
+class vkOnetimeSubmitter
+{
+public:
+    vkOnetimeSubmitter(VkDevice device, std::mutex& queue_mutex);
+    ~vkOnetimeSubmitter();
+
+public:
+    // returns a pool that finished executing, or a new one. recording has begun
+    std::pair<VkCommandPool, VkCommandBuffer> acquire(const rhiQueueType type, const u32 family);
+    // the command list has ended. keep_alive is released once the gpu is done with it
+    rhiSubmitTicket submit(vkCommandList* cmd, const rhiQueueType type, VkQueue queue, std::vector<std::unique_ptr<rhiBuffer>>&& keep_alive);
+    bool is_complete(const rhiSubmitTicket& ticket);
+    void wait(const rhiSubmitTicket& ticket);
+    void wait_idle();
+    // recycles everything that retired, without blocking
+    void collect();
+    // the queue's timeline, other submits wait on a ticket's value through it
+    rhiSemaphore* get_semaphore(const rhiQueueType type);
+
+private:
+    struct pooledCommands
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+    };
+    struct inFlight
+    {
+        pooledCommands commands;
+        u64 value = 0;
+        std::vector<std::unique_ptr<rhiBuffer>> keep_alive;
+    };
+    struct queueTimeline
+    {
+        std::unique_ptr<vkSemaphore> semaphore;
+        u64 submitted = 0;
+        u64 completed = 0;
+        std::vector<pooledCommands> free;
+        std::deque<inFlight> in_flight;
+    };
+
+    queueTimeline& get_timeline(const rhiQueueType type);
+    void retire(queueTimeline& timeline);
+
+private:
+    VkDevice device;
+    std::mutex& queue_mutex;
+
+    std::mutex mutex;
+    std::unordered_map<rhiQueueType, queueTimeline> timelines;
+};
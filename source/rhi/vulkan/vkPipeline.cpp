@@ -20,3 +20,49 @@ vkPipeline::~vkPipeline()
 {
 	vkDestroyPipeline(device, handle, nullptr);
 }
+
+namespace
+{
+	VkShaderModule vk_create_shader(VkDevice device, const rhiShaderBinary& bin)
+	{
+		const VkShaderModuleCreateInfo create_info
+		{
+			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+			.codeSize = bin.size,
+			.pCode = reinterpret_cast<const uint32_t*>(bin.data)
+		};
+		VkShaderModule m = VK_NULL_HANDLE;
+		VK_CHECK_ERROR(vkCreateShaderModule(device, &create_info, nullptr, &m));
+		return m;
+	}
+}
+
+VkShaderModule vkShaderModuleCache::acquire(VkDevice device, const rhiShaderBinary& bin)
+{
+	if (bin.hash == 0)
+		return vk_create_shader(device, bin);
+
+	std::scoped_lock lock(mutex);
+	auto it = modules.find(bin.hash);
+	if (it != modules.end())
+		return it->second;
+
+	VkShaderModule m = vk_create_shader(device, bin);
+	modules.emplace(bin.hash, m);
+	return m;
+}
+
+void vkShaderModuleCache::release(VkDevice device, const rhiShaderBinary& bin, VkShaderModule module)
+{
+	// cached modules live until clear()
+	if (bin.hash == 0 && module != VK_NULL_HANDLE)
+		vkDestroyShaderModule(device, module, nullptr);
+}
+
+void vkShaderModuleCache::clear(VkDevice device)
+{
+	std::scoped_lock lock(mutex);
+	for (auto& [hash, m] : modules)
+		vkDestroyShaderModule(device, m, nullptr);
+	modules.clear();
+}
@@ -2,6 +2,7 @@
 
 #include "pch.h"
 #include "rhi/rhiPipeline.h"
+#include <mutex>
 
 struct vkPipelineLayoutHolder 
 {
@@ -22,4 +23,17 @@ public:
     VkDevice  device;
     VkPipeline handle = VK_NULL_HANDLE;
     VkPipelineBindPoint bind_point;
-};
\ No newline at end of file
+};
+
+// modules keyed by spir-v content hash, shared across pipelines. binaries without a hash get a transient module
+class vkShaderModuleCache
+{
+public:
+    VkShaderModule acquire(VkDevice device, const rhiShaderBinary& bin);
+    void release(VkDevice device, const rhiShaderBinary& bin, VkShaderModule module);
+    void clear(VkDevice device);
+
+private:
+    std::mutex mutex;
+    std::unordered_map<u64, VkShaderModule> modules;
+};
@@ -0,0 +1,44 @@
+﻿#include "vkQuery.h"
+#include "vkCommon.h"
+#include "vkDeviceContext.h"
+
+vkTimestampPool::vkTimestampPool(vkDeviceContext* context, const u32 count)
+	: device(context->device), query_count(count)
+{
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(context->phys_device, &props);
+	period_ns = static_cast<f64>(props.limits.timestampPeriod);
+
+	const VkQueryPoolCreateInfo create_info{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = count
+	};
+	VK_CHECK_ERROR(vkCreateQueryPool(device, &create_info, nullptr, &pool));
+}
+
+vkTimestampPool::~vkTimestampPool()
+{
+	vkDestroyQueryPool(device, pool, nullptr);
+}
+
+bool vkTimestampPool::resolve(const u32 first, const u32 count, std::vector<u64>& ticks)
+{
+	ASSERT(first + count <= query_count);
+
+	// { value, availability } per query
+	std::vector<u64> results(count * 2);
+	const VkResult r = vkGetQueryPoolResults(device, pool, first, count, results.size() * sizeof(u64), results.data(), sizeof(u64) * 2,
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (r != VK_SUCCESS && r != VK_NOT_READY)
+		VK_CHECK_ERROR(r);
+
+	ticks.resize(count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (results[i * 2 + 1] == 0)
+			return false;
+		ticks[i] = results[i * 2];
+	}
+	return true;
+}
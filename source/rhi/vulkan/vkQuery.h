@@ -0,0 +1,25 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiQuery.h"
+
+class vkDeviceContext;
+class vkTimestampPool final : public rhiTimestampPool
+{
+public:
+	vkTimestampPool(vkDeviceContext* context, const u32 count);
+	virtual ~vkTimestampPool();
+
+public:
+	bool resolve(const u32 first, const u32 count, std::vector<u64>& ticks) override;
+	f64 ticks_to_ms(const u64 ticks) const override { return static_cast<f64>(ticks) * period_ns * 1e-6; }
+	u32 capacity() const override { return query_count; }
+
+	VkQueryPool handle() const { return pool; }
+
+private:
+	VkDevice device;
+	VkQueryPool pool = VK_NULL_HANDLE;
+	u32 query_count = 0;
+	f64 period_ns = 1.0;
+};
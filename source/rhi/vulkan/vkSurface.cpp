@@ -1,6 +1,5 @@
 #include "vkSurface.h"
 #include "vkCommon.h"
-#include "glfw3.h"
 
 void vkSurface::create_surface(VkInstance instance, GLFWwindow* window)
 {
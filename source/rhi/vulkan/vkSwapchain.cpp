@@ -5,6 +5,7 @@
 #include "vkSynchronize.h"
 #include "vkTexture.h"
 #include "rhi/rhiDefs.h"
+#include "util/cpuProfiler.h"
 
 vkSwapchain::vkSwapchain(vkSwapChainCreateDesc&& desc)
 	: rhiSwapChain(desc.width, desc.height), desc(desc)
@@ -17,17 +18,19 @@ vkSwapchain::~vkSwapchain()
 	textures.clear();
 }
 
-void vkSwapchain::acquire_next_image(u32* outIndex, class rhiSemaphore* signal)
+rhiResult vkSwapchain::acquire_next_image(u32* outIndex, class rhiSemaphore* signal)
 {
+	CPU_ZONE("vk::acquire_next_image");
 	VkSemaphore semaphore = VK_NULL_HANDLE;
 	if (signal)
 		semaphore = static_cast<vkSemaphore*>(signal)->handle();
 
-	VK_CHECK_ERROR(vkAcquireNextImageKHR(desc.context->device, swapchain, UINT64_MAX, semaphore, VK_NULL_HANDLE, outIndex));
+	return to_result(vkAcquireNextImageKHR(desc.context->device, swapchain, UINT64_MAX, semaphore, VK_NULL_HANDLE, outIndex));
 }
 
-void vkSwapchain::present(u32 imageIndex, rhiSemaphore* wait)
+rhiResult vkSwapchain::present(u32 imageIndex, rhiSemaphore* wait)
 {
+	CPU_ZONE("vk::present");
 	VkSemaphore semaphore = VK_NULL_HANDLE;
 	if (wait)
 		semaphore = static_cast<vkSemaphore*>(wait)->handle();
@@ -41,17 +44,32 @@ void vkSwapchain::present(u32 imageIndex, rhiSemaphore* wait)
 		.pImageIndices = &imageIndex
 	};
 
-	VK_CHECK_ERROR(vkQueuePresentKHR(desc.present_queue, &present_info));
+	return to_result(vkQueuePresentKHR(desc.present_queue, &present_info));
 }
 
-void vkSwapchain::recreate(u32 width, u32 height)
+rhiResult vkSwapchain::to_result(const VkResult result) const
 {
+	// a resized or moved window, the caller recreates
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		return rhiResult::out_of_date;
+	if (result == VK_SUBOPTIMAL_KHR)
+		return rhiResult::suboptimal;
+	VK_CHECK_ERROR(result);
+	return rhiResult::ok;
+}
+
+void vkSwapchain::recreate(const u32 width, const u32 height)
+{
+	CPU_ZONE("vk::recreate_swapchain");
+	// frames are drained by the caller, this also covers presents still holding the images
 	vkDeviceWaitIdle(desc.context->device);
 
 	textures.clear();
 	rt_views.clear();
 	vkDestroySwapchainKHR(desc.context->device, swapchain, nullptr);
-	
+
+	desc.width = width;
+	desc.height = height;
 	create_swapchain();
 }
 
@@ -83,7 +101,8 @@ void vkSwapchain::create_swapchain()
 	VkPresentModeKHR choose_present_mode = get_present_mode();
 	VkExtent2D extent = get_extent(surface_capabilities, desc.width, desc.height);
 
-	constexpr u32 desired_count = 3;
+	// mailbox needs a spare image to replace, three is the floor either way
+	const u32 desired_count = std::max(desc.min_image_count, 3u);
 	image_count= std::max(desired_count, surface_capabilities.minImageCount);
 	if (surface_capabilities.maxImageCount > 0 && image_count > surface_capabilities.maxImageCount)
 		image_count = surface_capabilities.maxImageCount;
@@ -98,7 +117,8 @@ void vkSwapchain::create_swapchain()
 		.imageColorSpace = choose_format.colorSpace,
 		.imageExtent = extent,
 		.imageArrayLayers = 1,
-		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+		// transfer source for screenshots through the readback queue
+		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
 		.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.queueFamilyIndexCount = queue_findices[0] == queue_findices[1] ? 0u : 2u,
 		.pQueueFamilyIndices = queue_findices.data(),
@@ -173,32 +193,32 @@ VkSurfaceFormatKHR vkSwapchain::get_surface_format()
 
 VkPresentModeKHR vkSwapchain::get_present_mode()
 {
-	VkPresentModeKHR choose_present_mode;
+	auto to_vk = [](const rhiPresentMode mode)
+		{
+			switch (mode)
+			{
+			case rhiPresentMode::mailbox: return VK_PRESENT_MODE_MAILBOX_KHR;
+			case rhiPresentMode::immediate: return VK_PRESENT_MODE_IMMEDIATE_KHR;
+			}
+			return VK_PRESENT_MODE_FIFO_KHR;
+		};
+
 	u32 present_mode_count = 0;
 	VK_CHECK_ERROR(vkGetPhysicalDeviceSurfacePresentModesKHR(desc.context->phys_device, desc.surface, &present_mode_count, nullptr));
-	if (present_mode_count > 0)
-	{
-		std::vector<VkPresentModeKHR> present_mode(present_mode_count);
-		VK_CHECK_ERROR(vkGetPhysicalDeviceSurfacePresentModesKHR(desc.context->phys_device, desc.surface, &present_mode_count, present_mode.data()));
-		auto iter_present_mode = present_mode | std::views::filter([](const VkPresentModeKHR& mode)
-			{
-				return mode == VK_PRESENT_MODE_MAILBOX_KHR;
-			});
-		if (iter_present_mode.begin() != iter_present_mode.end())
-		{
-			choose_present_mode = *iter_present_mode.begin();
-		}
-		else
-		{
-			ASSERT(false);
-		}
-	}
-	else
+	ASSERT(present_mode_count > 0);
+	std::vector<VkPresentModeKHR> modes(present_mode_count);
+	VK_CHECK_ERROR(vkGetPhysicalDeviceSurfacePresentModesKHR(desc.context->phys_device, desc.surface, &present_mode_count, modes.data()));
+
+	if (std::ranges::find(modes, to_vk(desc.present_mode)) != modes.end())
 	{
-		ASSERT(false);
+		present_mode = desc.present_mode;
+		return to_vk(desc.present_mode);
 	}
 
-	return choose_present_mode;
+	// fifo is the one mode every surface supports
+	std::cout << std::format("[vkSwapchain] present mode {} unsupported, using fifo\n", to_string(desc.present_mode));
+	present_mode = rhiPresentMode::fifo;
+	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
 VkExtent2D vkSwapchain::get_extent(const VkSurfaceCapabilitiesKHR& capabilities, const u32 width, const u32 height)
@@ -16,6 +16,8 @@ struct vkSwapChainCreateDesc
 
 	u32 width = 0;
 	u32 height = 0;
+	rhiPresentMode present_mode = rhiPresentMode::mailbox;
+	u32 min_image_count = 3;
 };
 
 class vkSwapchain : public rhiSwapChain
@@ -25,9 +27,9 @@ public:
 	~vkSwapchain();
 
 public:
-	void acquire_next_image(u32* outIndex, class rhiSemaphore* signal) override;
-	void present(u32 imageIndex, class rhiSemaphore* wait) override;
-	void recreate(u32 width, u32 height);
+	rhiResult acquire_next_image(u32* outIndex, class rhiSemaphore* signal) override;
+	rhiResult present(u32 imageIndex, class rhiSemaphore* wait) override;
+	void recreate(const u32 width, const u32 height) override;
 
 	rhiFormat format() const override;
 	const std::vector<rhiRenderTargetView>& views() const override { return rt_views; }
@@ -37,6 +39,7 @@ private:
 	VkSurfaceFormatKHR get_surface_format();
 	VkPresentModeKHR get_present_mode();
 	VkExtent2D get_extent(const VkSurfaceCapabilitiesKHR& capabilities, const u32 width, const u32 height);
+	rhiResult to_result(const VkResult result) const;
 	rhiFormat format(VkFormat format) const;
 
 private:
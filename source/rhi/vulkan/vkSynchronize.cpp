@@ -1,10 +1,17 @@
 ﻿#include "vkSynchronize.h"
 #include "vkCommon.h"
 
-vkSemaphore::vkSemaphore(VkDevice device)
+vkSemaphore::vkSemaphore(VkDevice device, const bool timeline)
 	: device(device)
 {
+	const VkSemaphoreTypeCreateInfo type_info{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0
+	};
 	VkSemaphoreCreateInfo create_info{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	if (timeline)
+		create_info.pNext = &type_info;
 	VK_CHECK_ERROR(vkCreateSemaphore(device, &create_info, nullptr, &semaphore));
 }
 
@@ -6,7 +6,7 @@
 class vkSemaphore final : public rhiSemaphore
 {
 public:
-	vkSemaphore(VkDevice device);
+	vkSemaphore(VkDevice device, const bool timeline = false);
 	virtual ~vkSemaphore();
 
 	VkSemaphore handle() { return semaphore; }
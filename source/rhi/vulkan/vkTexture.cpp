@@ -6,6 +6,23 @@
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiCommandList.h"
 
+VkImageCreateInfo vkTexture::create_info(const rhiTextureDesc& desc)
+{
+    return VkImageCreateInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = vk_format(desc.format),
+        .extent = { desc.width, desc.height, 1 },
+        .mipLevels = desc.mips,
+        .arrayLayers = desc.layers,
+        .samples = vk_sample(desc.samples),
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = vk_image_usage(desc.usage),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+}
+
 vkTexture::vkTexture(vkDeviceContext* context, const rhiTextureDesc& desc, bool external_image)
     : rhiTexture(desc), 
     device(context->device), 
@@ -19,67 +36,75 @@ vkTexture::vkTexture(vkDeviceContext* context, const rhiTextureDesc& desc, bool
 
     if (!external)
     {
-        const VkImageUsageFlags img_usage = vk_image_usage(desc.usage);
-        const VkImageCreateInfo image_create_info{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .imageType = VK_IMAGE_TYPE_2D,
-            .format = vk_format(desc.format),
-            .extent = { desc.width, desc.height, 1 },
-            .mipLevels = desc.mips,
-            .arrayLayers = desc.layers,
-            .samples = vk_sample(desc.samples),
-            .tiling = VK_IMAGE_TILING_OPTIMAL,
-            .usage = img_usage,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
-        };
+        const VkImageCreateInfo image_create_info = create_info(desc);
         const VmaAllocationCreateInfo vma_create_info{
             .usage = VMA_MEMORY_USAGE_AUTO
         };
         VK_CHECK_ERROR(vmaCreateImage(context->allocator, &image_create_info, &vma_create_info, &image, &allocation, nullptr));
+        create_views();
+    }
+}
+
+vkTexture::vkTexture(vkDeviceContext* context, const rhiTextureDesc& desc, VmaAllocation heap, const u64 offset)
+    : rhiTexture(desc),
+    device(context->device),
+    allocator(context->allocator),
+    allocation(VK_NULL_HANDLE),
+    image(VK_NULL_HANDLE),
+    imgview_cache(context->get_imageview_cache()),
+    aliased(true)
+{
+    format = vk_format(desc.format);
 
-        if (const auto ptr = imgview_cache.lock())
+    const VkImageCreateInfo image_create_info = create_info(desc);
+    VK_CHECK_ERROR(vmaCreateAliasingImage2(context->allocator, heap, offset, &image_create_info, &image));
+    create_views();
+}
+
+void vkTexture::create_views()
+{
+    const auto ptr = imgview_cache.lock();
+    if (!ptr)
+        return;
+
+    const viewKey key{
+        .image = image,
+        .format = format,
+        .aspect = vk_aspect_from_format(desc.format),
+        .base_mip = 0,
+        .mip_count = desc.mips,
+        .base_layer = 0,
+        .layer_count = desc.layers
+    };
+    view = ptr->get_or_create(key);
+    if (desc.is_depth && desc.is_separate_depth_stencil)
+    {
+        const viewKey depth_view_key{
+            .image = image,
+            .format = format,
+            .aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
+            .base_mip = 0,
+            .mip_count = desc.mips,
+            .base_layer = 0,
+            .layer_count = desc.layers
+        };
+        depth_view = ptr->get_or_create(depth_view_key);
+    }
+    if (desc.layers > 1)
+    {
+        layer_views.resize(desc.layers);
+        for (u32 index = 0; index < desc.layers; ++index)
         {
-            const viewKey key{
+            const viewKey layer_key{
                 .image = image,
                 .format = format,
                 .aspect = vk_aspect_from_format(desc.format),
                 .base_mip = 0,
                 .mip_count = desc.mips,
-                .base_layer = 0,
-                .layer_count = desc.layers
+                .base_layer = index,
+                .layer_count = 1
             };
-            view = ptr->get_or_create(key);
-            if (desc.is_depth && desc.is_separate_depth_stencil)
-            {
-                const viewKey depth_view_key{
-                    .image = image,
-                    .format = format,
-                    .aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
-                    .base_mip = 0,
-                    .mip_count = desc.mips,
-                    .base_layer = 0,
-                    .layer_count = desc.layers
-                };
-                depth_view = ptr->get_or_create(depth_view_key);
-            }
-            if (desc.layers > 1)
-            {
-                layer_views.resize(desc.layers);
-                for (u32 index = 0; index < desc.layers; ++index)
-                {
-                    const viewKey layer_key{
-                        .image = image,
-                        .format = format,
-                        .aspect = vk_aspect_from_format(desc.format),
-                        .base_mip = 0,
-                        .mip_count = desc.mips,
-                        .base_layer = index,
-                        .layer_count = 1
-                    };
-                    layer_views[index] = ptr->get_or_create(layer_key);
-                }
-            }
+            layer_views[index] = ptr->get_or_create(layer_key);
         }
     }
 }
@@ -91,22 +116,25 @@ vkTexture::vkTexture(vkDeviceContext* context, std::string_view path, bool is_hd
     allocation(VK_NULL_HANDLE),
     image(VK_NULL_HANDLE),
     imgview_cache(context->get_imageview_cache())
+{
+    create_from_file(context, is_hdr);
+}
+
+vkTexture::vkTexture(vkDeviceContext* context, rhiTextureImage&& source)
+    : rhiTexture(std::move(source)),
+    device(context->device),
+    allocator(context->allocator),
+    allocation(VK_NULL_HANDLE),
+    image(VK_NULL_HANDLE),
+    imgview_cache(context->get_imageview_cache())
+{
+    create_from_file(context, false);
+}
+
+void vkTexture::create_from_file(vkDeviceContext* context, bool is_hdr)
 {
     format = vk_format(desc.format);
-    const VkImageUsageFlags img_usage = vk_image_usage(desc.usage);
-    const VkImageCreateInfo image_create_info{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType = VK_IMAGE_TYPE_2D,
-        .format = vk_format(desc.format),
-        .extent = { desc.width, desc.height, 1 },
-        .mipLevels = desc.mips,
-        .arrayLayers = desc.layers,
-        .samples = vk_sample(desc.samples),
-        .tiling = VK_IMAGE_TILING_OPTIMAL,
-        .usage = img_usage,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
-    };
+    const VkImageCreateInfo image_create_info = create_info(desc);
     const VmaAllocationCreateInfo vma_create_info{
         .usage = VMA_MEMORY_USAGE_AUTO
     };
@@ -138,7 +166,9 @@ vkTexture::~vkTexture()
     {
         ptr->delete_imageview(image);
     }
-    if(!external)
+    if (aliased)
+        vkDestroyImage(device, image, nullptr);
+    else if(!external)
         vmaDestroyImage(allocator, image, allocation);
 }
 
@@ -186,14 +216,14 @@ void vkTexture::upload(vkDeviceContext* context)
     ASSERT(cmd);
 
     cmd->image_barrier(this, rhiImageLayout::undefined, rhiImageLayout::transfer_dst);
-    const u32 bytes = desc.width * desc.height * 4 * sizeof(f32);
+    const u32 bytes = desc.width * desc.height * 4 * sizeof(u16);
     auto staging = context->create_buffer(rhiBufferDesc{
         .size = bytes,
         .usage = rhiBufferUsage::transfer_src,
         .memory = rhiMem::auto_host
         });
     auto mapped = staging->map();
-    std::memcpy(mapped, rgba.data(), bytes);
+    std::memcpy(mapped, rgba16f.data(), bytes);
     staging->flush(0, bytes);
     staging->unmap();
     std::vector<rhiBufferImageCopy> regions = {
@@ -209,5 +239,10 @@ void vkTexture::upload(vkDeviceContext* context)
         } };
     cmd->copy_buffer_to_image(staging.get(), this, rhiImageLayout::transfer_dst, regions);
     cmd->image_barrier(this, rhiImageLayout::transfer_dst, rhiImageLayout::shader_readonly);
-    context->submit_and_wait(cmd);
+    std::vector<std::unique_ptr<rhiBuffer>> keep_alive;
+    keep_alive.push_back(std::move(staging));
+    context->submit_async(cmd, rhiQueueType::graphics, std::move(keep_alive));
+
+    rgba16f.clear();
+    rgba16f.shrink_to_fit();
 }
\ No newline at end of file
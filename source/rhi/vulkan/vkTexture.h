@@ -10,9 +10,13 @@ class vkTexture final : public rhiTexture
 public:
 	vkTexture(vkDeviceContext* context, const rhiTextureDesc& desc, bool external_image = false);
 	vkTexture(vkDeviceContext* context, std::string_view path, bool is_hdr = false, bool srgb = true);
+	vkTexture(vkDeviceContext* context, rhiTextureImage&& source);
+	// placed into memory owned by the caller, several textures may alias it
+	vkTexture(vkDeviceContext* context, const rhiTextureDesc& desc, VmaAllocation heap, const u64 offset);
 	virtual ~vkTexture();
 
 public:
+	static VkImageCreateInfo create_info(const rhiTextureDesc& desc);
 	void bind_external_image(VkImage image);
 	VkImage get_image() const { return image; }
 	VkFormat get_format() const { return format; }
@@ -22,6 +26,8 @@ public:
 	bool is_depth() const;
 
 private:
+	void create_views();
+	void create_from_file(vkDeviceContext* context, bool is_hdr);
 	void upload(vkDeviceContext* context);
 
 private:
@@ -34,6 +40,7 @@ private:
 	std::vector<VkImageView> layer_views;
 	VkFormat format;
 	bool external = false;
+	bool aliased = false;
 
 	std::weak_ptr<vkImageViewCache> imgview_cache;
 };
@@ -5,6 +5,7 @@
 #include "vkImageViewCache.h"
 #include "rhi/rhiTextureView.h"
 #include "rhi/rhiCommandList.h"
+#include "rhi/rhiQueue.h"
 
 vkTextureCubemap::vkTextureCubemap(vkDeviceContext* context, const rhiTextureDesc& desc)
     : rhiTextureCubeMap(desc),
@@ -16,6 +17,18 @@ vkTextureCubemap::vkTextureCubemap(vkDeviceContext* context, const rhiTextureDes
 {
     format = vk_format(desc.format);
 
+    // sampled by graphics while async compute reads it, no ownership to hand back and forth
+    std::vector<u32> families;
+    if (desc.shared_queues)
+    {
+        for (const auto& queue : context->get_queues() | std::views::values)
+        {
+            if (std::ranges::find(families, queue->q_index()) == families.end())
+                families.push_back(queue->q_index());
+        }
+    }
+    const bool concurrent = families.size() > 1;
+
     const VkImageCreateInfo image_create_info{
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
@@ -31,7 +44,9 @@ vkTextureCubemap::vkTextureCubemap(vkDeviceContext* context, const rhiTextureDes
             VK_IMAGE_USAGE_STORAGE_BIT |
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | 
             VK_IMAGE_USAGE_TRANSFER_SRC_BIT),
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = concurrent ? static_cast<u32>(families.size()) : 0u,
+        .pQueueFamilyIndices = concurrent ? families.data() : nullptr,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
     };
     const VmaAllocationCreateInfo vma_create_info{
@@ -3,6 +3,9 @@
 camera::camera(GLFWwindow* window)
     : window(window)
 {
+    // headless runs have no window to take input from
+    if (!window)
+        return;
     glfwSetWindowUserPointer(window, this);
     glfwSetCursorPosCallback(window, mouse_dispatch);
     glfwSetMouseButtonCallback(window, mouse_button_dispatch);
@@ -28,6 +31,8 @@ void camera::mouse_button_dispatch(GLFWwindow* window, i32 button, i32 action, i
 
 void camera::process_input(GLFWwindow* window, f32 delta)
 {
+    if (!window)
+        return;
     const f32 v = move_speed * delta;
     const vec3 right = glm::normalize(glm::cross(up, front));
 
@@ -91,6 +96,14 @@ void camera::mouse_action(i32 button, i32 action, i32 mods)
     }
 }
 
+void camera::set_pose(const vec3 new_position, const f32 new_yaw, const f32 new_pitch)
+{
+    position = new_position;
+    yaw = new_yaw;
+    pitch = glm::clamp(new_pitch, -89.0f, 89.0f);
+    update_front();
+}
+
 void camera::update_front()
 {
     f32 cy = glm::cos(glm::radians(yaw));
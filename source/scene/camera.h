@@ -15,6 +15,9 @@ public:
 	mat4 proj(const vec2 size) const;
 	vec3 get_position() { return position; }
 	vec3 get_front() { return front; }
+	f32 get_yaw() const { return yaw; }
+	f32 get_pitch() const { return pitch; }
+	void set_pose(const vec3 new_position, const f32 new_yaw, const f32 new_pitch);
 	f32 get_near() { return znear; }
 	f32 get_far() { return zfar; }
 
@@ -0,0 +1,130 @@
+﻿#include "cameraPath.h"
+#include "camera.h"
+#include <sstream>
+
+namespace
+{
+	template<typename T>
+	T catmull_rom(const T& p0, const T& p1, const T& p2, const T& p3, const f32 u)
+	{
+		const f32 u2 = u * u;
+		const f32 u3 = u2 * u;
+		return 0.5f * ((2.f * p1)
+			+ (p2 - p0) * u
+			+ (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * u2
+			+ (3.f * p1 - p0 - 3.f * p2 + p3) * u3);
+	}
+}
+
+std::optional<cameraPath> cameraPath::load(const std::filesystem::path& path)
+{
+	std::ifstream in(path);
+	if (!in)
+	{
+		std::cout << std::format("[cameraPath] cannot open {}\n", path.string());
+		return std::nullopt;
+	}
+
+	cameraPath out;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		if (const size_t comment = line.find('#'); comment != std::string::npos)
+			line.resize(comment);
+
+		std::istringstream ss(line);
+		cameraKey key;
+		if (!(ss >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch))
+			continue;
+		out.keys.push_back(key);
+	}
+
+	if (out.keys.empty())
+	{
+		std::cout << std::format("[cameraPath] no keys in {}\n", path.string());
+		return std::nullopt;
+	}
+	std::ranges::stable_sort(out.keys, {}, &cameraKey::time);
+	return out;
+}
+
+cameraPath cameraPath::fly_through()
+{
+	cameraPath out;
+	out.keys = {
+		{ .time = 0.f, .position = vec3(10.f, 6.f, 10.f), .yaw = -135.f, .pitch = -10.f },
+		{ .time = 2.f, .position = vec3(8.f, 2.f, 0.f), .yaw = -180.f, .pitch = 0.f },
+		{ .time = 4.f, .position = vec3(0.f, 2.f, 0.f), .yaw = -180.f, .pitch = 5.f },
+		{ .time = 6.f, .position = vec3(-8.f, 2.f, 0.f), .yaw = -200.f, .pitch = 10.f },
+		{ .time = 8.f, .position = vec3(-10.f, 6.f, -3.f), .yaw = -330.f, .pitch = -5.f },
+		{ .time = 10.f, .position = vec3(0.f, 9.f, -3.f), .yaw = -360.f, .pitch = -20.f },
+		{ .time = 12.f, .position = vec3(10.f, 6.f, 10.f), .yaw = -495.f, .pitch = -10.f },
+	};
+	return out;
+}
+
+bool cameraPath::save(const std::filesystem::path& path) const
+{
+	std::error_code ec;
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out)
+	{
+		std::cout << std::format("[cameraPath] cannot write {}\n", path.string());
+		return false;
+	}
+
+	out << "# time px py pz yaw pitch\n";
+	for (const cameraKey& key : keys)
+		out << std::format("{:.4f} {:.4f} {:.4f} {:.4f} {:.3f} {:.3f}\n", key.time, key.position.x, key.position.y, key.position.z, key.yaw, key.pitch);
+
+	std::cout << std::format("[cameraPath] wrote {} keys to {}\n", keys.size(), path.string());
+	return static_cast<bool>(out);
+}
+
+void cameraPath::record(const f32 time, camera* cam)
+{
+	ASSERT(cam);
+	if (!keys.empty() && time <= keys.back().time)
+		return;
+	keys.push_back(cameraKey{ .time = time, .position = cam->get_position(), .yaw = cam->get_yaw(), .pitch = cam->get_pitch() });
+}
+
+cameraKey cameraPath::sample(const f32 time) const
+{
+	ASSERT(!keys.empty());
+	if (keys.size() == 1 || time <= keys.front().time)
+		return keys.front();
+	if (time >= keys.back().time)
+		return keys.back();
+
+	const auto next = std::ranges::upper_bound(keys, time, {}, &cameraKey::time);
+	const size_t i1 = static_cast<size_t>(std::distance(keys.begin(), next)) - 1;
+	const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+	const size_t i2 = i1 + 1;
+	const size_t i3 = std::min(i2 + 1, keys.size() - 1);
+
+	const cameraKey& k0 = keys[i0];
+	const cameraKey& k1 = keys[i1];
+	const cameraKey& k2 = keys[i2];
+	const cameraKey& k3 = keys[i3];
+	const f32 u = (time - k1.time) / std::max(k2.time - k1.time, 1e-6f);
+
+	return cameraKey{
+		.time = time,
+		.position = catmull_rom(k0.position, k1.position, k2.position, k3.position, u),
+		.yaw = catmull_rom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, u),
+		.pitch = catmull_rom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, u)
+	};
+}
+
+void cameraPath::apply(camera* cam, const f32 t) const
+{
+	ASSERT(cam);
+	if (keys.empty())
+		return;
+	const cameraKey key = sample(keys.front().time + duration() * glm::clamp(t, 0.f, 1.f));
+	cam->set_pose(key.position, key.yaw, key.pitch);
+}
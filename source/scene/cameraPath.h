@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include "pch.h"
+
+class camera;
+
+struct cameraKey
+{
+	f32 time = 0.f; // seconds
+	vec3 position = vec3(0.f);
+	f32 yaw = 0.f;
+	f32 pitch = 0.f;
+};
+
+// catmull-rom through timed camera keys.
+// text format, one key per line : time px py pz yaw pitch, '#' starts a comment
+class cameraPath
+{
+public:
+	static std::optional<cameraPath> load(const std::filesystem::path& path);
+	// built-in loop through the sponza atrium
+	static cameraPath fly_through();
+
+public:
+	bool save(const std::filesystem::path& path) const;
+	void record(const f32 time, camera* cam);
+	void clear() { keys.clear(); }
+
+	cameraKey sample(const f32 time) const;
+	// normalized [0, 1] over the whole path
+	void apply(camera* cam, const f32 t) const;
+
+	f32 duration() const { return keys.empty() ? 0.f : keys.back().time - keys.front().time; }
+	bool empty() const { return keys.empty(); }
+	size_t size() const { return keys.size(); }
+
+private:
+	std::vector<cameraKey> keys;
+};
@@ -2,16 +2,17 @@
 #include "mesh/meshModelManager.h"
 #include "actor/meshActor.h"
 #include "light/directionalLightActor.h"
+#include "util/assetPath.h"
 
 void sponzaScene::create_actor()
 {
 	scene::create_actor();
-	auto sponza = std::make_unique<meshActor>(mesh_model_manager, "E:\\Sponza\\resource\\sponza\\Sponza.gltf");
+	auto sponza = std::make_unique<meshActor>(mesh_model_manager, asset_path("sponza/Sponza.gltf").string());
 	actors.push_back(std::move(sponza));
-	//auto tree = std::make_unique<meshActor>(mesh_model_manager, "E:\\Sponza\\resource\\cherry_tree\\scene.gltf");
+	//auto tree = std::make_unique<meshActor>(mesh_model_manager, asset_path("cherry_tree/scene.gltf").string());
 	//tree->set_position(vec3(2.f, 0.f, 0.f));
 	//actors.push_back(std::move(tree));
-	//auto tree2 = std::make_unique<meshActor>(mesh_model_manager, "E:\\Sponza\\resource\\cherry_tree\\scene.gltf");
+	//auto tree2 = std::make_unique<meshActor>(mesh_model_manager, asset_path("cherry_tree/scene.gltf").string());
 	//tree2->set_position(vec3(-2.f, 0.f, 0.f));
 	//actors.push_back(std::move(tree2));
 
@@ -0,0 +1,184 @@
+﻿#include "stressScene.h"
+#include "mesh/meshModelManager.h"
+#include "mesh/glTFMesh.h"
+#include "mesh/proceduralMesh.h"
+#include "renderer/textureCache.h"
+#include "actor/meshActor.h"
+#include "light/directionalLightActor.h"
+#include "util/text.h"
+#include <charconv>
+#include <random>
+
+namespace
+{
+	// "32x1x32", a missing axis keeps its default
+	void read_grid(std::string_view arg, u32vec3& out)
+	{
+		constexpr std::string_view key = "--stress-grid=";
+		if (!arg.starts_with(key))
+			return;
+		arg.remove_prefix(key.size());
+		const std::string_view value = arg;
+		u32vec3 grid = out;
+		for (u32 axis = 0; axis < 3 && !arg.empty(); ++axis)
+		{
+			const auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), grid[axis]);
+			arg.remove_prefix(end - arg.data());
+			// each axis is a number, separated by 'x' with nothing after the last one
+			const bool separated = !arg.empty() && arg.front() == 'x' && axis < 2 && arg.size() > 1;
+			if (ec != std::errc{} || (!arg.empty() && !separated))
+			{
+				std::cout << std::format("[args] ignoring {} : '{}' is not a valid grid\n", key, value);
+				return;
+			}
+			if (separated)
+				arg.remove_prefix(1);
+		}
+		out = grid;
+	}
+
+	// evenly spread hues, material i is stable across runs and grid sizes
+	u32 palette(const u32 index, const u32 count, const bool translucent)
+	{
+		const f32 h = static_cast<f32>(index) / static_cast<f32>(std::max(count, 1u)) * 6.f;
+		const f32 x = 1.f - glm::abs(glm::mod(h, 2.f) - 1.f);
+		vec3 rgb;
+		switch (static_cast<u32>(h) % 6)
+		{
+		case 0: rgb = vec3(1.f, x, 0.f); break;
+		case 1: rgb = vec3(x, 1.f, 0.f); break;
+		case 2: rgb = vec3(0.f, 1.f, x); break;
+		case 3: rgb = vec3(0.f, x, 1.f); break;
+		case 4: rgb = vec3(x, 0.f, 1.f); break;
+		default: rgb = vec3(1.f, 0.f, x); break;
+		}
+		rgb = glm::mix(vec3(0.2f), vec3(0.9f), rgb);
+		const u32 alpha = translucent ? 0x80 : 0xff;
+		return (u32(rgb.x * 255.f) << 24) | (u32(rgb.y * 255.f) << 16) | (u32(rgb.z * 255.f) << 8) | alpha;
+	}
+}
+
+std::optional<stressSceneDesc> stressSceneDesc::from_args(const std::vector<std::string_view>& args)
+{
+	if (std::ranges::find(args, std::string_view("--stress")) == args.end())
+		return std::nullopt;
+
+	stressSceneDesc desc;
+	for (const std::string_view arg : args)
+	{
+		read_grid(arg, desc.grid);
+		read_arg(arg, "--stress-spacing=", desc.spacing);
+		read_arg(arg, "--stress-segments=", desc.segments);
+		read_arg(arg, "--stress-materials=", desc.materials);
+		read_arg(arg, "--stress-translucent=", desc.translucent_ratio);
+		read_arg(arg, "--stress-seed=", desc.seed);
+		if (arg.starts_with("--stress-mesh="))
+			desc.mesh = arg.substr(std::string_view("--stress-mesh=").size());
+	}
+	desc.grid = glm::max(desc.grid, u32vec3(1));
+	desc.materials = std::max(desc.materials, 1u);
+	desc.translucent_ratio = glm::clamp(desc.translucent_ratio, 0.f, 1.f);
+	return desc;
+}
+
+std::string stressSceneDesc::to_string() const
+{
+	return std::format("{}x{}x{} {} materials={} translucent={:.2f} seed={}", grid.x, grid.y, grid.z, mesh, materials, translucent_ratio, seed);
+}
+
+std::shared_ptr<glTFMesh> stressScene::create_base_mesh() const
+{
+	if (desc.mesh == "box")
+		return procedural::make_box();
+	if (desc.mesh == "sphere")
+		return procedural::make_sphere(desc.segments);
+	return mesh_model_manager->get_or_create_asset(desc.mesh).lock();
+}
+
+void stressScene::create_variants(const std::shared_ptr<glTFMesh>& base)
+{
+	const bool generated = desc.mesh == "box" || desc.mesh == "sphere";
+	const std::string prefix = generated ? std::format("{}{}{}", textureCache::procedural_prefix, desc.mesh, desc.segments) : desc.mesh;
+
+	// [material * 2 + translucent]
+	variant_keys.resize(desc.materials * 2);
+	for (u32 m = 0; m < desc.materials; ++m)
+	{
+		for (u32 t = 0; t < 2; ++t)
+		{
+			auto variant = std::make_shared<glTFMesh>(*base);
+			for (auto& sm : variant->submeshes)
+			{
+				// generated geometry gets a flat colour, glTF keeps its textures and varies the factors
+				if (generated)
+				{
+					sm.base_tex = textureCache::procedural_color(palette(m, desc.materials, t == 1));
+					sm.normal_tex = textureCache::procedural_color(0x8080ffff);
+					sm.metalic_roughness_tex = textureCache::procedural_color(0xffffffff);
+				}
+				sm.metalic_factor = static_cast<f32>(m % 2);
+				sm.roughness_factor = 0.25f + 0.75f * static_cast<f32>(m) / static_cast<f32>(desc.materials);
+				sm.is_alpha_blend = t == 1;
+			}
+			variant->invalidate_hash();
+
+			std::string& key = variant_keys[m * 2 + t];
+			key = std::format("{}#m{}{}", prefix, m, t == 1 ? "t" : "");
+			mesh_model_manager->add_asset(key, std::move(variant));
+		}
+	}
+}
+
+void stressScene::create_actor()
+{
+	scene::create_actor();
+
+	const auto base = create_base_mesh();
+	if (!base || base->submeshes.empty())
+	{
+		std::cout << std::format("[stressScene] failed to create mesh {}\n", desc.mesh);
+		return;
+	}
+	create_variants(base);
+
+	// fixed seed, the same arguments always give the same scene
+	std::mt19937 rng(desc.seed);
+	std::uniform_real_distribution<f32> jitter(-desc.jitter, desc.jitter);
+	std::uniform_real_distribution<f32> angle(0.f, glm::two_pi<f32>());
+	std::uniform_real_distribution<f32> scale(desc.scale_range.x, desc.scale_range.y);
+	std::uniform_int_distribution<u32> material(0, desc.materials - 1);
+	std::bernoulli_distribution translucent(desc.translucent_ratio);
+
+	const vec3 center = vec3(desc.grid.x - 1, 0, desc.grid.z - 1) * 0.5f;
+	u64 translucent_count = 0;
+	actors.reserve(actors.size() + desc.actor_count());
+	for (u32 y = 0; y < desc.grid.y; ++y)
+	{
+		for (u32 z = 0; z < desc.grid.z; ++z)
+		{
+			for (u32 x = 0; x < desc.grid.x; ++x)
+			{
+				const u32 m = material(rng);
+				const bool t = translucent(rng);
+				translucent_count += t ? 1 : 0;
+
+				auto a = std::make_unique<meshActor>(mesh_model_manager, variant_keys[m * 2 + (t ? 1 : 0)]);
+				const vec3 cell = vec3(x, y, z) - center + vec3(jitter(rng), 0.f, jitter(rng));
+				a->set_position(cell * desc.spacing + vec3(0.f, 0.5f, 0.f));
+				a->set_rotation(glm::angleAxis(angle(rng), vec3(0.f, 1.f, 0.f)));
+				a->set_scale(vec3(scale(rng)));
+				actors.push_back(std::move(a));
+			}
+		}
+	}
+
+	u64 triangles = 0;
+	for (const auto& sm : base->submeshes)
+		triangles += sm.indexCount / 3;
+	triangles *= desc.actor_count();
+	std::cout << std::format("[stressScene] {} actors, {} translucent, {} variants, {} triangles\n",
+		desc.actor_count(), translucent_count, variant_keys.size(), triangles);
+
+	directional_light->set_position(vec3(0.f, 50.f, 0.f));
+	directional_light->set_direction(glm::normalize(vec3(0.3f, -1.f, 0.2f)));
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "scene/scene.h"
+
+class glTFMesh;
+
+// --stress [--stress-grid=XxYxZ] [--stress-spacing=X] [--stress-mesh=box|sphere|file.gltf] [--stress-segments=N]
+//          [--stress-materials=N] [--stress-translucent=X] [--stress-seed=N]
+struct stressSceneDesc
+{
+	u32vec3 grid = { 32, 1, 32 };
+	f32 spacing = 3.f;
+	f32 jitter = 0.25f; // of spacing
+	vec2 scale_range = { 0.5f, 1.5f };
+	std::string mesh = "sphere";
+	u32 segments = 32; // sphere only
+	u32 materials = 8;
+	f32 translucent_ratio = 0.1f;
+	u32 seed = 1;
+
+	static std::optional<stressSceneDesc> from_args(const std::vector<std::string_view>& args);
+	u64 actor_count() const { return u64(grid.x) * grid.y * grid.z; }
+	std::string to_string() const;
+};
+
+// grid of instances sharing one mesh, split into material and translucency variants
+class stressScene : public scene
+{
+public:
+	explicit stressScene(const stressSceneDesc& desc) : desc(desc) {}
+
+protected:
+	void create_actor() final override;
+
+private:
+	std::shared_ptr<glTFMesh> create_base_mesh() const;
+	void create_variants(const std::shared_ptr<glTFMesh>& base);
+
+private:
+	stressSceneDesc desc;
+	// meshActor keeps a view of its mesh key, sized once so the views stay valid
+	std::vector<std::string> variant_keys;
+};
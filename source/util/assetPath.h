@@ -0,0 +1,15 @@
+﻿#pragma once
+
+#include "pch.h"
+
+// scene and sky assets live under SH_ASSET_ROOT, ./resource otherwise
+inline std::filesystem::path asset_path(const std::filesystem::path& relative)
+{
+#if defined(_MSC_VER)
+#pragma warning(suppress : 4996)
+#endif
+    if (const char* env = std::getenv("SH_ASSET_ROOT"); env && *env)
+        return std::filesystem::path(env) / relative;
+    std::error_code ec;
+    return std::filesystem::current_path(ec) / "resource" / relative;
+}
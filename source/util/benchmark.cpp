@@ -0,0 +1,140 @@
+﻿#include "benchmark.h"
+#include "text.h"
+
+namespace
+{
+    std::string to_json(const benchmarkStats& s)
+    {
+        return std::format("{{\"avg\":{:.4f},\"min\":{:.4f},\"max\":{:.4f},\"p50\":{:.4f},\"p95\":{:.4f},\"p99\":{:.4f},\"samples\":{}}}",
+            s.avg, s.min, s.max, s.p50, s.p95, s.p99, s.samples);
+    }
+
+    std::string to_json(const gpuZoneStats& s)
+    {
+        return std::format("{{\"avg\":{:.4f},\"p50\":{:.4f},\"p95\":{:.4f},\"p99\":{:.4f},\"samples\":{}}}",
+            s.avg_ms, s.p50_ms, s.p95_ms, s.p99_ms, s.samples);
+    }
+}
+
+benchmarkOptions benchmarkOptions::from_args(const std::vector<std::string_view>& args)
+{
+    benchmarkOptions options;
+    for (const std::string_view arg : args)
+    {
+        if (arg == "--benchmark")
+            options.enabled = true;
+        read_arg(arg, "--bench-frames=", options.frames);
+        read_arg(arg, "--bench-warmup=", options.warmup);
+        read_arg(arg, "--bench-budget-ms=", options.cpu_budget_ms);
+        read_arg(arg, "--bench-gpu-budget-ms=", options.gpu_budget_ms);
+        if (arg.starts_with("--bench-path="))
+            options.camera_path = arg.substr(std::string_view("--bench-path=").size());
+        if (arg.starts_with("--bench-out="))
+            options.output = arg.substr(std::string_view("--bench-out=").size());
+    }
+    options.frames = std::max(options.frames, 1u);
+    return options;
+}
+
+benchmarkStats benchmarkStats::from(std::vector<f64> values)
+{
+    if (values.empty())
+        return {};
+
+    std::ranges::sort(values);
+
+    f64 sum = 0.0;
+    for (const f64 v : values)
+        sum += v;
+
+    return benchmarkStats{
+        .avg = sum / static_cast<f64>(values.size()),
+        .min = values.front(),
+        .max = values.back(),
+        .p50 = percentile(values, 0.50),
+        .p95 = percentile(values, 0.95),
+        .p99 = percentile(values, 0.99),
+        .samples = static_cast<u32>(values.size())
+    };
+}
+
+void benchmarkRecorder::begin_measure(const benchmarkCounters& counters)
+{
+    begin = counters;
+    cpu_frame_ms.clear();
+    cpu_frame_ms.reserve(options.frames);
+    latency_present_ms.clear();
+    latency_complete_ms.clear();
+}
+
+void benchmarkRecorder::end_measure(const benchmarkCounters& counters, std::vector<std::pair<std::string, gpuZoneStats>> gpu_stats)
+{
+    end = counters;
+    gpu_passes = std::move(gpu_stats);
+    std::ranges::sort(gpu_passes, {}, &std::pair<std::string, gpuZoneStats>::first);
+}
+
+benchmarkExit benchmarkRecorder::write_report(const std::vector<std::pair<std::string, std::string>>& config) const
+{
+    if (cpu_frame_ms.empty())
+    {
+        std::cout << "[benchmark] no frames measured\n";
+        return benchmarkExit::failed;
+    }
+
+    const benchmarkStats cpu = benchmarkStats::from(cpu_frame_ms);
+    f64 gpu_p95_sum = 0.0;
+    for (const auto& [name, stats] : gpu_passes)
+        gpu_p95_sum += stats.p95_ms;
+
+    const f64 frames = static_cast<f64>(cpu_frame_ms.size());
+    const u64 allocations = end.memory.allocations_made - begin.memory.allocations_made;
+    const u64 uploaded_bytes = end.uploaded_bytes - begin.uploaded_bytes;
+    const u64 uploads = end.upload_count - begin.upload_count;
+
+    const bool cpu_over = options.cpu_budget_ms > 0.0 && cpu.p95 > options.cpu_budget_ms;
+    const bool gpu_over = options.gpu_budget_ms > 0.0 && gpu_p95_sum > options.gpu_budget_ms;
+    const benchmarkExit result = cpu_over || gpu_over ? benchmarkExit::over_budget : benchmarkExit::ok;
+
+    std::error_code ec;
+    if (options.output.has_parent_path())
+        std::filesystem::create_directories(options.output.parent_path(), ec);
+
+    std::ofstream out(options.output, std::ios::trunc);
+    if (!out)
+    {
+        std::cout << std::format("[benchmark] cannot write {}\n", options.output.string());
+        return benchmarkExit::failed;
+    }
+
+    out << "{\n  \"config\": {";
+    for (size_t i = 0; i < config.size(); ++i)
+        out << std::format("{}\"{}\":\"{}\"", i == 0 ? "" : ",", json_escape(config[i].first), json_escape(config[i].second));
+    out << "},\n";
+    out << std::format("  \"warmup_frames\": {},\n  \"measured_frames\": {},\n", options.warmup, cpu_frame_ms.size());
+    out << std::format("  \"cpu_frame_ms\": {},\n", to_json(cpu));
+    out << std::format("  \"input_latency_ms\": {{\"present\":{},\"gpu_done\":{}}},\n",
+        to_json(benchmarkStats::from(latency_present_ms)), to_json(benchmarkStats::from(latency_complete_ms)));
+
+    out << "  \"gpu_pass_ms\": {";
+    for (size_t i = 0; i < gpu_passes.size(); ++i)
+        out << std::format("{}\n    \"{}\": {}", i == 0 ? "" : ",", json_escape(gpu_passes[i].first), to_json(gpu_passes[i].second));
+    out << "\n  },\n";
+    out << std::format("  \"gpu_pass_p95_sum_ms\": {:.4f},\n", gpu_p95_sum);
+
+    out << std::format("  \"memory\": {{\"allocations\":{},\"allocations_per_frame\":{:.3f},\"live_allocations\":{},\"live_allocation_bytes\":{},\"block_count\":{},\"block_bytes\":{}}},\n",
+        allocations, static_cast<f64>(allocations) / frames, end.memory.allocation_count, end.memory.allocation_bytes, end.memory.block_count, end.memory.block_bytes);
+    out << std::format("  \"uploads\": {{\"bytes\":{},\"count\":{},\"bytes_per_frame\":{:.1f}}},\n",
+        uploaded_bytes, uploads, static_cast<f64>(uploaded_bytes) / frames);
+
+    out << std::format("  \"budget\": {{\"cpu_p95_ms\":{:.4f},\"gpu_p95_sum_ms\":{:.4f},\"cpu_over\":{},\"gpu_over\":{}}},\n",
+        options.cpu_budget_ms, options.gpu_budget_ms, cpu_over, gpu_over);
+    out << std::format("  \"exit_code\": {}\n}}\n", static_cast<i32>(result));
+
+    std::cout << std::format("[benchmark] {} frames, cpu avg {:.3f} ms p95 {:.3f} p99 {:.3f}, gpu pass p95 sum {:.3f} ms, {} allocations, {} bytes uploaded -> {}\n",
+        cpu.samples, cpu.avg, cpu.p95, cpu.p99, gpu_p95_sum, allocations, uploaded_bytes, options.output.string());
+    if (result == benchmarkExit::over_budget)
+        std::cout << std::format("[benchmark] over budget (cpu p95 {:.3f} / {:.3f}, gpu {:.3f} / {:.3f})\n", cpu.p95, options.cpu_budget_ms, gpu_p95_sum, options.gpu_budget_ms);
+
+    return out ? result : benchmarkExit::failed;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include "pch.h"
+#include "rhi/rhiDeviceContext.h"
+#include "rhi/rhiFrameContext.h"
+#include "renderer/gpuProfiler.h"
+
+// --benchmark [--bench-frames=N] [--bench-warmup=N] [--bench-path=file] [--bench-out=file]
+//             [--bench-budget-ms=X] [--bench-gpu-budget-ms=X]
+struct benchmarkOptions
+{
+    bool enabled = false;
+    u32 frames = 600; // measured, after warm-up
+    u32 warmup = 120;
+    std::filesystem::path camera_path; // empty plays the built-in fly-through
+    std::filesystem::path output = "cache/benchmark.json";
+    f64 cpu_budget_ms = 0.0; // cpu frame p95, 0 disables
+    f64 gpu_budget_ms = 0.0; // sum of gpu pass p95, 0 disables
+
+    static benchmarkOptions from_args(const std::vector<std::string_view>& args);
+};
+
+// process exit codes, kept stable for ci gating
+enum class benchmarkExit : i32
+{
+    ok = 0,
+    failed = 1,
+    over_budget = 2
+};
+
+struct benchmarkStats
+{
+    f64 avg = 0.0;
+    f64 min = 0.0;
+    f64 max = 0.0;
+    f64 p50 = 0.0;
+    f64 p95 = 0.0;
+    f64 p99 = 0.0;
+    u32 samples = 0;
+
+    static benchmarkStats from(std::vector<f64> values);
+};
+
+struct benchmarkCounters
+{
+    rhiMemoryStats memory;
+    u64 uploaded_bytes = 0;
+    u64 upload_count = 0;
+};
+
+// collects the measured window and writes it as one json report
+class benchmarkRecorder
+{
+public:
+    explicit benchmarkRecorder(const benchmarkOptions& options) : options(options) {}
+
+public:
+    void begin_measure(const benchmarkCounters& counters);
+    void add_frame(const f64 cpu_ms) { cpu_frame_ms.push_back(cpu_ms); }
+    // retires lag the frames by the frames in flight, like the gpu zones
+    void add_latency(const rhiFrameLatency& latency)
+    {
+        latency_present_ms.push_back(latency.present_ms);
+        latency_complete_ms.push_back(latency.complete_ms);
+    }
+    void end_measure(const benchmarkCounters& counters, std::vector<std::pair<std::string, gpuZoneStats>> gpu_stats);
+
+    // config is echoed into the report as strings
+    benchmarkExit write_report(const std::vector<std::pair<std::string, std::string>>& config) const;
+
+private:
+    benchmarkOptions options;
+    benchmarkCounters begin;
+    benchmarkCounters end;
+    std::vector<f64> cpu_frame_ms;
+    std::vector<f64> latency_present_ms;
+    std::vector<f64> latency_complete_ms;
+    std::vector<std::pair<std::string, gpuZoneStats>> gpu_passes;
+};
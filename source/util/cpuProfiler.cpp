@@ -0,0 +1,102 @@
+﻿#include "cpuProfiler.h"
+#include "text.h"
+#include <mutex>
+
+namespace profiler
+{
+    namespace
+    {
+        const auto epoch = std::chrono::steady_clock::now();
+
+        // rings outlive their threads so a trace still shows finished workers
+        std::mutex registry_mutex;
+        std::vector<std::shared_ptr<cpuThreadRing>> registry;
+        u32 next_thread_id = 1;
+
+        std::shared_ptr<cpuThreadRing> register_thread()
+        {
+            auto ring = std::make_shared<cpuThreadRing>();
+            std::lock_guard lock(registry_mutex);
+            ring->thread_id = next_thread_id++;
+            ring->thread_name = std::format("thread {}", ring->thread_id);
+            registry.push_back(ring);
+            return ring;
+        }
+    }
+
+    u64 now_ns()
+    {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    cpuThreadRing& thread_ring()
+    {
+        // registration locks once per thread, recording never does
+        thread_local std::shared_ptr<cpuThreadRing> ring = register_thread();
+        return *ring;
+    }
+
+    void set_thread_name(std::string_view name)
+    {
+        cpuThreadRing& ring = thread_ring();
+        std::lock_guard lock(registry_mutex);
+        ring.thread_name = name;
+    }
+
+    bool dump_chrome_trace(const std::filesystem::path& path)
+    {
+        std::vector<std::shared_ptr<cpuThreadRing>> rings;
+        {
+            std::lock_guard lock(registry_mutex);
+            rings = registry;
+        }
+
+        std::error_code ec;
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path(), ec);
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+        {
+            std::cout << std::format("[cpuProfiler] cannot write {}\n", path.string());
+            return false;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        u64 written = 0;
+        std::vector<cpuZoneEvent> events;
+        for (const auto& ring : rings)
+        {
+            {
+                std::lock_guard lock(registry_mutex);
+                out << std::format("{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                    first ? "" : ",\n", ring->thread_id, json_escape(ring->thread_name));
+            }
+            first = false;
+
+            const u64 head = ring->head.load(std::memory_order_acquire);
+            const u64 begin = head > cpuThreadRing::capacity ? head - cpuThreadRing::capacity : 0;
+            events.clear();
+            for (u64 i = begin; i < head; ++i)
+                events.push_back(ring->events[i & cpuThreadRing::mask]);
+
+            // the writer may have lapped the oldest entries while they were copied, the slot after head can be mid write
+            const u64 head_after = ring->head.load(std::memory_order_acquire) + 1;
+            const u64 valid_from = head_after > cpuThreadRing::capacity ? head_after - cpuThreadRing::capacity : 0;
+            const u64 skip = valid_from > begin ? std::min(valid_from - begin, static_cast<u64>(events.size())) : 0;
+
+            for (u64 i = skip; i < events.size(); ++i)
+            {
+                const cpuZoneEvent& e = events[i];
+                out << std::format(",\n{{\"name\":\"{}\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                    json_escape(e.name), ring->thread_id, static_cast<f64>(e.begin_ns) * 1e-3, static_cast<f64>(e.end_ns - e.begin_ns) * 1e-3);
+                ++written;
+            }
+        }
+        out << "\n]}\n";
+
+        std::cout << std::format("[cpuProfiler] wrote {} zones from {} threads to {}\n", written, rings.size(), path.string());
+        return static_cast<bool>(out);
+    }
+}
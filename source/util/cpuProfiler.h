@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "pch.h"
+#include <atomic>
+#include <chrono>
+
+// scoped cpu zones into a per-thread ring, CPU_PROFILER 0 compiles every zone out
+namespace profiler
+{
+    struct cpuZoneEvent
+    {
+        const char* name; // string literal
+        u64 begin_ns;
+        u64 end_ns;
+    };
+
+    // single writer (the owning thread), readers copy without locking and drop what was overwritten meanwhile
+    struct cpuThreadRing
+    {
+        static constexpr u64 capacity = 1ull << 16;
+        static constexpr u64 mask = capacity - 1;
+
+        std::unique_ptr<cpuZoneEvent[]> events = std::make_unique<cpuZoneEvent[]>(capacity);
+        std::atomic<u64> head = 0;
+        u32 thread_id = 0;
+        std::string thread_name;
+    };
+
+    u64 now_ns();
+    cpuThreadRing& thread_ring();
+    void set_thread_name(std::string_view name);
+
+    inline void record(const char* name, const u64 begin_ns, const u64 end_ns)
+    {
+        cpuThreadRing& ring = thread_ring();
+        const u64 index = ring.head.load(std::memory_order_relaxed);
+        ring.events[index & cpuThreadRing::mask] = cpuZoneEvent{ name, begin_ns, end_ns };
+        ring.head.store(index + 1, std::memory_order_release);
+    }
+
+    // chrome://tracing / perfetto json of every thread's retained zones
+    bool dump_chrome_trace(const std::filesystem::path& path);
+
+    class cpuZone
+    {
+    public:
+        explicit cpuZone(const char* name) : name(name), begin_ns(now_ns()) {}
+        ~cpuZone() { record(name, begin_ns, now_ns()); }
+        cpuZone(const cpuZone&) = delete;
+        cpuZone& operator=(const cpuZone&) = delete;
+
+    private:
+        const char* name;
+        u64 begin_ns;
+    };
+}
+
+#define CPU_ZONE_CONCAT_INNER(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b) CPU_ZONE_CONCAT_INNER(a, b)
+#if CPU_PROFILER
+#define CPU_ZONE(name) profiler::cpuZone CPU_ZONE_CONCAT(cpu_zone_, __LINE__){ name }
+#define CPU_THREAD_NAME(name) profiler::set_thread_name(name)
+#else
+#define CPU_ZONE(name) ((void)0)
+#define CPU_THREAD_NAME(name) ((void)0)
+#endif
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <glm.hpp>
+#include <cstring>
 
 inline glm::u64 fnv1a64(const void* data, glm::u32 size, glm::u64 hash = 1469598103934665603ull)
 {
@@ -13,6 +14,33 @@ inline glm::u64 fnv1a64(const void* data, glm::u32 size, glm::u64 hash = 1469598
     return hash;
 }
 
+inline glm::u64 hash_mix64(glm::u64 h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// word-at-a-time hash for large blobs (pixels, spirv)
+inline glm::u64 fast_hash64(const void* data, size_t size, glm::u64 seed = 1469598103934665603ull)
+{
+    const auto* ptr = static_cast<const unsigned char*>(data);
+    glm::u64 hash = seed ^ (static_cast<glm::u64>(size) * 0x9e3779b97f4a7c15ull);
+    while (size >= sizeof(glm::u64))
+    {
+        glm::u64 k;
+        std::memcpy(&k, ptr, sizeof(glm::u64));
+        hash = (hash ^ hash_mix64(k)) * 0x9e3779b97f4a7c15ull;
+        ptr += sizeof(glm::u64);
+        size -= sizeof(glm::u64);
+    }
+    hash = fnv1a64(ptr, static_cast<glm::u32>(size), hash);
+    return hash_mix64(hash);
+}
+
 template <typename T>
 inline glm::u64 hash_combine(glm::u64 h, const T& v)
 {
@@ -0,0 +1,89 @@
+﻿#include "jobSystem.h"
+#include "util/cpuProfiler.h"
+
+jobSystem::jobSystem(u32 worker_count)
+{
+    if (worker_count == 0)
+        worker_count = std::clamp(std::thread::hardware_concurrency(), 2u, 9u) - 1;
+
+    workers.reserve(worker_count);
+    for (u32 i = 0; i < worker_count; ++i)
+        workers.emplace_back([this](std::stop_token stop) { worker_loop(stop); });
+}
+
+jobSystem::~jobSystem()
+{
+    for (auto& w : workers)
+        w.request_stop();
+    job_cv.notify_all();
+    workers.clear();
+}
+
+void jobSystem::parallel_for(const u32 count, const std::function<void(u32)>& fn)
+{
+    if (count == 0)
+        return;
+
+    if (count == 1 || workers.empty())
+    {
+        for (u32 index = 0; index < count; ++index)
+            fn(index);
+        return;
+    }
+
+    std::unique_lock lock(mutex);
+    ASSERT(next == batch_count);
+    batch_fn = &fn;
+    batch_count = count;
+    next = 0;
+    completed = 0;
+    job_cv.notify_all();
+
+    while (next < batch_count)
+    {
+        const u32 index = next++;
+        lock.unlock();
+        run(fn, index);
+        lock.lock();
+        ++completed;
+    }
+    done_cv.wait(lock, [this]() { return completed == batch_count; });
+    batch_fn = nullptr;
+
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void jobSystem::run(const std::function<void(u32)>& fn, const u32 index)
+{
+    try
+    {
+        fn(index);
+    }
+    catch (...)
+    {
+        std::scoped_lock lock(mutex);
+        if (!error)
+            error = std::current_exception();
+    }
+}
+
+void jobSystem::worker_loop(std::stop_token stop)
+{
+    CPU_THREAD_NAME("job worker");
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        if (!job_cv.wait(lock, stop, [this]() { return next < batch_count; }))
+            return;
+
+        // a claimed index keeps the batch alive, parallel_for waits for its completion
+        const u32 index = next++;
+        const auto* fn = batch_fn;
+        lock.unlock();
+        run(*fn, index);
+        lock.lock();
+        if (++completed == batch_count)
+            done_cv.notify_all();
+    }
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// fixed worker pool for per-frame cpu work, the calling thread takes part in every batch.
+// batches are few and coarse (one per recorded chunk), so indices are claimed under the lock
+class jobSystem
+{
+public:
+    explicit jobSystem(u32 worker_count = 0);
+    ~jobSystem();
+
+public:
+    // runs fn(index) for every index in [0, count) and returns once all of them finished.
+    // indices run in any order on any thread, the first exception is rethrown here
+    void parallel_for(const u32 count, const std::function<void(u32)>& fn);
+    u32 get_thread_count() const { return static_cast<u32>(workers.size()) + 1; }
+
+private:
+    void worker_loop(std::stop_token stop);
+    void run(const std::function<void(u32)>& fn, const u32 index);
+
+private:
+    std::vector<std::jthread> workers;
+
+    std::mutex mutex;
+    std::condition_variable_any job_cv;
+    std::condition_variable done_cv;
+    const std::function<void(u32)>* batch_fn = nullptr;
+    u32 batch_count = 0;
+    u32 next = 0;
+    u32 completed = 0;
+    std::exception_ptr error;
+};
@@ -0,0 +1,45 @@
+﻿#pragma once
+
+#include "pch.h"
+#include <charconv>
+#include <span>
+
+// "--key=value" command line options, leaves out untouched when the key does not match or the value does not parse
+template<typename T>
+inline bool read_arg(std::string_view arg, std::string_view key, T& out)
+{
+    if (!arg.starts_with(key))
+        return false;
+    const std::string_view value = arg.substr(key.size());
+    T parsed{};
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (ec != std::errc{} || end != value.data() + value.size())
+    {
+        std::cout << std::format("[args] ignoring {} : '{}' is not a valid value\n", key, value);
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+inline std::string json_escape(std::string_view s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (const char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out.push_back('\\');
+        out.push_back(c);
+    }
+    return out;
+}
+
+// nearest rank on ascending samples, p in [0, 1]
+inline f64 percentile(std::span<const f64> sorted, const f64 p)
+{
+    if (sorted.empty())
+        return 0.0;
+    const size_t index = static_cast<size_t>(p * static_cast<f64>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}